@@ -0,0 +1,60 @@
+#include "Benchmarks.h"
+#include <cstdio>
+
+namespace
+{
+    // The processors log their settings on prepare(); keep the tables readable
+    class SilentLogger : public juce::Logger
+    {
+        void logMessage(const juce::String&) override {}
+    };
+
+    struct Benchmark
+    {
+        const char* name;
+        void (*run)();
+    };
+
+    const Benchmark benchmarks[] = {
+        {"multitf", Benchmarks::runMultiTF},
+        {"mtw", Benchmarks::runMTW},
+        {"fft", Benchmarks::runFFTBackends},
+        {"fftbatch", Benchmarks::runFFTBatch},
+    };
+}
+
+// Usage: AudioCoPilotBenchmarks [name ...]   (no names: run all)
+int main(int argc, char* argv[])
+{
+    SilentLogger logger;
+    juce::Logger::setCurrentLogger(&logger);
+
+    int numRun = 0;
+    for (const auto& benchmark : benchmarks)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            selected = selected || juce::String(argv[i]).equalsIgnoreCase(benchmark.name);
+
+        if (!selected)
+            continue;
+
+        std::printf("== %s\n", benchmark.name);
+        benchmark.run();
+        std::printf("\n");
+        ++numRun;
+    }
+
+    juce::Logger::setCurrentLogger(nullptr);
+
+    if (numRun == 0)
+    {
+        std::printf("unknown benchmark; available:");
+        for (const auto& benchmark : benchmarks)
+            std::printf(" %s", benchmark.name);
+        std::printf("\n");
+        return 1;
+    }
+
+    return 0;
+}
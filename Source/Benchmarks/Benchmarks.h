@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../JuceHeader.h"
+
+/**
+ * Benchmarks
+ *
+ * Entry points of the AudioCoPilotBenchmarks console app (configure with
+ * -DAUDIOCOPILOT_BENCHMARKS=ON). Each one prints its own table to stdout.
+ */
+namespace Benchmarks
+{
+    // Shared-reference multi-pair TF engine vs independent TFProcessors at 1, 4, 8 and 16 pairs
+    void runMultiTF();
+
+    // Multi-time-window TF (decimated 1k FFTs) vs one 16k TF, per 16k hop
+    void runMTW();
+
+    // JUCE vs native FFT backend at every size the analyzers use: time per transform, error
+    // against a double-precision FFT and equivalence of the bins (results: FFTBackendResults.md)
+    void runFFTBackends();
+
+    // Per-channel loop vs batched magnitude spectra at 8, 32 and 64 channels (2k and 4k)
+    void runFFTBatch();
+
+    // Wall-clock milliseconds
+    inline double nowMs() { return juce::Time::getMillisecondCounterHiRes(); }
+}
@@ -0,0 +1,151 @@
+#include "Benchmarks.h"
+#include "../Core/FFTEngine.h"
+#include "../Core/FFTPlanCache.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    // 1k: MTW levels, 2k: AI Stage Hand, 4k: RTA, Bark, smallest TF; up to the largest TF
+    constexpr int minOrder = 10;
+    constexpr int maxOrder = 17;
+
+    // Largest bin difference allowed vs JUCE, relative to the spectrum's peak magnitude
+    constexpr double equivalenceTolerance = 1.0e-5;
+
+    constexpr int warmupTransforms = 8;
+    constexpr double pointsPerMeasurement = 1 << 24;  // enough transforms of every size to time
+
+    // Microseconds per real forward transform of input
+    double timeTransforms(const AudioCoPilot::FFTEngine& engine, const std::vector<float>& input, std::vector<float>& buffer)
+    {
+        const int size = engine.getSize();
+        const int count = std::max(16, static_cast<int>(pointsPerMeasurement / size));
+
+        double start = 0.0;
+        for (int i = 0; i < warmupTransforms + count; ++i)
+        {
+            if (i == warmupTransforms)
+                start = Benchmarks::nowMs();
+
+            std::copy(input.begin(), input.end(), buffer.begin());
+            engine.performRealForward(buffer.data());
+        }
+        return 1000.0 * (Benchmarks::nowMs() - start) / count;
+    }
+
+    // Bins 0 .. size / 2 of the first size samples of input, in double precision with
+    // directly computed twiddles: the yardstick both backends are measured against
+    std::vector<std::complex<double>> referenceSpectrum(const std::vector<float>& input, int size)
+    {
+        std::vector<std::complex<double>> x(static_cast<size_t>(size));
+        for (int j = 0, i = 0; i < size; ++i)
+        {
+            x[static_cast<size_t>(j)] = input[static_cast<size_t>(i)];
+            int bit = size >> 1;
+            for (; (j & bit) != 0; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+        }
+
+        for (int length = 2; length <= size; length <<= 1)
+        {
+            const int half = length / 2;
+            for (int k = 0; k < half; ++k)
+            {
+                const auto w = std::polar(1.0, -juce::MathConstants<double>::twoPi * k / length);
+                for (int start = 0; start < size; start += length)
+                {
+                    auto& a = x[static_cast<size_t>(start + k)];
+                    auto& b = x[static_cast<size_t>(start + k + half)];
+                    const auto t = b * w;
+                    b = a - t;
+                    a += t;
+                }
+            }
+        }
+
+        x.resize(static_cast<size_t>(size / 2 + 1));
+        return x;
+    }
+
+    // Largest |X - X_expected| over bins 0 .. size / 2, relative to the largest |X_expected|
+    double relativeError(const std::vector<std::complex<double>>& expected, const std::vector<float>& bins)
+    {
+        double peak = 0.0, error = 0.0;
+        for (size_t bin = 0; bin < expected.size(); ++bin)
+        {
+            const std::complex<double> value(bins[2 * bin], bins[2 * bin + 1]);
+            peak = std::max(peak, std::abs(expected[bin]));
+            error = std::max(error, std::abs(value - expected[bin]));
+        }
+        return peak > 0.0 ? error / peak : error;
+    }
+
+    std::vector<std::complex<double>> toComplex(const std::vector<float>& bins, int size)
+    {
+        std::vector<std::complex<double>> values(static_cast<size_t>(size / 2 + 1));
+        for (size_t bin = 0; bin < values.size(); ++bin)
+            values[bin] = { bins[2 * bin], bins[2 * bin + 1] };
+        return values;
+    }
+}
+
+void Benchmarks::runFFTBackends()
+{
+    using AudioCoPilot::FFTEngine;
+
+    juce::Random random(11);
+
+    const char* juceLabel = AudioCoPilot::FFTPlanCache::juceHasNativeEngine ? "juce (platform)" : "juce (fallback)";
+
+    std::printf("platform: %s, %s, %d-bit\n", juce::SystemStats::getOperatingSystemName().toRawUTF8(),
+                juce::SystemStats::getCpuModel().toRawUTF8(), juce::SystemStats::isOperatingSystem64Bit() ? 64 : 32);
+    std::printf("default backend: %s\n", FFTEngine::getBackendName(FFTEngine::getDefaultBackend()));
+    std::printf("ref. error: vs a double-precision FFT; vs JUCE: native bins vs JUCE's, relative to the peak\n\n");
+    std::printf("%8s  %-16s  %12s  %8s  %12s  %12s  %10s\n",
+                "size", "backend", "us/transform", "speedup", "ref. error", "vs JUCE", "tables kB");
+
+    int mismatches = 0;
+    for (int order = minOrder; order <= maxOrder; ++order)
+    {
+        const int size = 1 << order;
+        const auto juceEngine = FFTEngine::create(order, FFTEngine::Backend::juce);
+        const auto nativeEngine = FFTEngine::create(order, FFTEngine::Backend::native);
+
+        // Windowed noise plus a tone, as the analyzers feed it
+        const auto window = AudioCoPilot::FFTPlanCache::getWindow(size, AudioCoPilot::FFTPlanCache::Window::hann);
+        std::vector<float> input(static_cast<size_t>(2 * size), 0.0f);
+        for (int n = 0; n < size; ++n)
+        {
+            const float tone = 0.5f * std::sin(0.1f * static_cast<float>(n));
+            input[static_cast<size_t>(n)] = window->samples[static_cast<size_t>(n)] * (tone + random.nextFloat() * 2.0f - 1.0f);
+        }
+
+        const auto reference = referenceSpectrum(input, size);
+
+        // Equivalence: the same bins 0 .. size / 2, to float rounding
+        std::vector<float> juceBins(input), nativeBins(input);
+        juceEngine->performRealForward(juceBins.data());
+        nativeEngine->performRealForward(nativeBins.data());
+        const double juceDifference = relativeError(toComplex(juceBins, size), nativeBins);
+        const bool equivalent = juceDifference <= equivalenceTolerance;
+        mismatches += equivalent ? 0 : 1;
+
+        std::vector<float> buffer(input.size());
+        const double juceUs = timeTransforms(*juceEngine, input, buffer);
+        const double nativeUs = timeTransforms(*nativeEngine, input, buffer);
+
+        std::printf("%8d  %-16s  %12.2f  %7.2fx  %12.3g  %12s  %10s\n",
+                    size, juceLabel, juceUs, 1.0, relativeError(reference, juceBins), "-", "-");
+        std::printf("%8d  %-16s  %12.2f  %7.2fx  %12.3g  %12.3g  %10.1f%s\n",
+                    size, "native", nativeUs, juceUs / nativeUs, relativeError(reference, nativeBins), juceDifference,
+                    nativeEngine->getMemoryBytes() / 1024.0, equivalent ? "" : "  MISMATCH");
+    }
+
+    std::printf("\nnative matches JUCE (relative difference <= %.0e): %s\n", equivalenceTolerance,
+                mismatches == 0 ? "all sizes" : "NO");
+}
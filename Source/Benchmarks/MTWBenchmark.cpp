@@ -0,0 +1,109 @@
+#include "Benchmarks.h"
+#include "../Core/TransferFunction/FFTAnalyzer.h"
+#include "../Core/TransferFunction/MTWProcessor.h"
+#include "../Core/TransferFunction/TFProcessor.h"
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr int fftSize = 16384;
+    constexpr int hopSize = fftSize / 4;   // TFProcessor's default 75% overlap
+    constexpr double sampleRate = 48000.0;
+    constexpr int warmupHops = 40;         // MTW: the 128k level has produced frames by then
+    constexpr int measuredHops = 256;
+
+    std::vector<float> makeNoise(int numSamples, juce::Random& random)
+    {
+        std::vector<float> noise(static_cast<size_t>(numSamples));
+        for (auto& s : noise)
+            s = random.nextFloat() * 2.0f - 1.0f;
+        return noise;
+    }
+
+    // Transform counts per hop, as n * log2(n) butterflies (radix-2 model)
+    double fftWork(double n) { return n * std::log2(n); }
+
+    template <typename Function>
+    double timeHops(Function&& processHop)
+    {
+        double start = 0.0;
+        for (int hop = 0; hop < warmupHops + measuredHops; ++hop)
+        {
+            if (hop == warmupHops)
+                start = Benchmarks::nowMs();
+            processHop(hop);
+        }
+        return (Benchmarks::nowMs() - start) / measuredHops;
+    }
+}
+
+void Benchmarks::runMTW()
+{
+    juce::Random random(7);
+    const int numSamples = fftSize + (warmupHops + measuredHops) * hopSize;
+    const auto reference = makeNoise(numSamples, random);
+    auto measurement = makeNoise(numSamples, random);
+    for (int n = 0; n < numSamples; ++n)
+        measurement[static_cast<size_t>(n)] = 0.5f * reference[static_cast<size_t>(n)] + 0.05f * measurement[static_cast<size_t>(n)];
+
+    const double hopMs = 1000.0 * hopSize / sampleRate;
+
+    // Bare transforms: the reference and measurement FFTs of one 16k TF frame
+    FFTAnalyzer referenceFFT, measurementFFT;
+    referenceFFT.prepare(fftSize, sampleRate);
+    measurementFFT.prepare(fftSize, sampleRate);
+    std::vector<std::complex<float>> referenceSpectrum, measurementSpectrum;
+    const double fftPair = timeHops([&](int hop)
+    {
+        const size_t offset = static_cast<size_t>(hop * hopSize);
+        referenceFFT.processBlock(reference.data() + offset, fftSize, referenceSpectrum);
+        measurementFFT.processBlock(measurement.data() + offset, fftSize, measurementSpectrum);
+    });
+
+    // Complete 16k TF: one frame per hop
+    TFProcessor tf;
+    tf.setMagnitudeHistorySeconds(10.0);
+    tf.prepare(fftSize, sampleRate);
+    tf.processBlock(reference.data(), measurement.data(), fftSize - hopSize);
+    const double single = timeHops([&](int hop)
+    {
+        const size_t offset = static_cast<size_t>(fftSize - hopSize + hop * hopSize);
+        tf.processBlock(reference.data() + offset, measurement.data() + offset, hopSize);
+    });
+
+    // Multi-time-window: decimation, every level's frames and the log-grid output of one hop
+    MTWProcessor mtw;
+    MTWProcessor::Settings settings;
+    settings.publishSeconds = hopSize / sampleRate;
+    mtw.prepare(sampleRate, settings);
+    const double multi = timeHops([&](int hop)
+    {
+        const size_t offset = static_cast<size_t>(hop * hopSize);
+        mtw.processBlock(reference.data() + offset, measurement.data() + offset, hopSize);
+    });
+
+    std::printf("sample rate %.0f, hop %d (%.1f ms), %d hops timed\n\n", sampleRate, hopSize, hopMs, measuredHops);
+
+    // Per hop, level L makes hopSize / (fftSize_mtw / 2) / 2^L frames of two transforms
+    std::printf("%5s  %8s  %10s  %20s  %12s\n", "level", "window", "bin Hz", "band Hz", "frames/hop");
+    const int levelFFT = settings.fftSize;
+    double mtwWork = 0.0;
+    for (int l = 0; l < mtw.getNumLevels(); ++l)
+    {
+        const auto info = mtw.getLevelInfo(l);
+        const double framesPerHop = static_cast<double>(hopSize) / (levelFFT / 2) / (1 << l);
+        mtwWork += 2.0 * framesPerHop * fftWork(levelFFT);
+        std::printf("%5d  %8d  %10.3f  %9.1f-%9.1f  %12.4f\n", l, info.equivalentFFTSize, info.binHz, info.lowHz, info.highHz, framesPerHop);
+    }
+
+    const double singleWork = 2.0 * fftWork(fftSize);
+    std::printf("\nFFT work per hop (n log2 n): mtw %.0f, 16k TF %.0f (x%.2f)\n\n", mtwWork, singleWork, mtwWork / singleWork);
+
+    std::printf("%-34s  %10s  %8s  %8s\n", "", "ms/hop", "vs 16k", "load");
+    std::printf("%-34s  %10.4f  %8.2f  %7.2f%%\n", "16k FFT pair (transforms only)", fftPair, fftPair / fftPair, 100.0 * fftPair / hopMs);
+    std::printf("%-34s  %10.4f  %8.2f  %7.2f%%\n", "16k TFProcessor", single, single / fftPair, 100.0 * single / hopMs);
+    std::printf("%-34s  %10.4f  %8.2f  %7.2f%%\n", "MTW (8 levels of 1k)", multi, multi / fftPair, 100.0 * multi / hopMs);
+}
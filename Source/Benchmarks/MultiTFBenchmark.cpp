@@ -0,0 +1,148 @@
+#include "Benchmarks.h"
+#include "../Core/TransferFunction/MultiTFEngine.h"
+#include "../Core/TransferFunction/TFProcessor.h"
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr int fftSize = 16384;
+    constexpr double sampleRate = 48000.0;
+    constexpr int warmupHops = 8;
+    constexpr int measuredHops = 64;
+    const int pairCounts[] = {1, 4, 8, 16};
+
+    // White-noise reference; mic i hears it 1 + 0.37 * i ms later, plus some uncorrelated noise
+    struct Signals
+    {
+        std::vector<float> reference;
+        std::vector<std::vector<float>> mics;
+        std::vector<const float*> micPointers;
+    };
+
+    Signals makeSignals(int numPairs, int numSamples)
+    {
+        juce::Random random(42);
+        Signals signals;
+        signals.reference.resize(static_cast<size_t>(numSamples));
+        for (auto& s : signals.reference)
+            s = random.nextFloat() * 2.0f - 1.0f;
+
+        for (int i = 0; i < numPairs; ++i)
+        {
+            const int delay = juce::roundToInt((1.0 + 0.37 * i) * 0.001 * sampleRate);
+            std::vector<float> mic(static_cast<size_t>(numSamples));
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const float direct = n >= delay ? signals.reference[static_cast<size_t>(n - delay)] : 0.0f;
+                mic[static_cast<size_t>(n)] = 0.5f * direct + 0.05f * (random.nextFloat() * 2.0f - 1.0f);
+            }
+            signals.mics.push_back(std::move(mic));
+        }
+
+        for (const auto& mic : signals.mics)
+            signals.micPointers.push_back(mic.data());
+
+        return signals;
+    }
+
+    // Today's path: one TFProcessor per mic, each transforming and averaging the reference itself
+    double timeIndependent(const Signals& signals, int numPairs, int hopSize)
+    {
+        std::vector<std::unique_ptr<TFProcessor>> processors;
+        for (int i = 0; i < numPairs; ++i)
+        {
+            processors.push_back(std::make_unique<TFProcessor>());
+            processors.back()->setMagnitudeHistorySeconds(10.0);
+            processors.back()->prepare(fftSize, sampleRate);
+        }
+
+        // Fill the first frame, then feed one hop per iteration (each triggers one frame)
+        for (int i = 0; i < numPairs; ++i)
+            processors[static_cast<size_t>(i)]->processBlock(signals.reference.data(), signals.micPointers[static_cast<size_t>(i)], fftSize - hopSize);
+
+        double start = 0.0;
+        for (int hop = 0; hop < warmupHops + measuredHops; ++hop)
+        {
+            if (hop == warmupHops)
+                start = Benchmarks::nowMs();
+
+            const int offset = fftSize - hopSize + hop * hopSize;
+            for (int i = 0; i < numPairs; ++i)
+                processors[static_cast<size_t>(i)]->processBlock(signals.reference.data() + offset,
+                                                                 signals.micPointers[static_cast<size_t>(i)] + offset, hopSize);
+        }
+
+        return (Benchmarks::nowMs() - start) / measuredHops;
+    }
+
+    // Shared reference; numWorkerThreads 0: every pair on the calling thread, < 0: one per spare core
+    double timeEngine(const Signals& signals, int numPairs, int hopSize, int numWorkerThreads, int& workersUsed)
+    {
+        const int numThreads = numWorkerThreads < 0 ? juce::SystemStats::getNumCpus() - 1 : numWorkerThreads;
+        std::unique_ptr<juce::ThreadPool> pool;
+        if (numThreads > 0)
+            pool = std::make_unique<juce::ThreadPool>(numThreads);
+
+        MultiTFEngine engine;
+        engine.setPairHistorySeconds(10.0);
+        engine.prepare(fftSize, sampleRate, numPairs, pool.get());
+        workersUsed = engine.getNumWorkerJobs();
+
+        std::vector<const float*> measurements(static_cast<size_t>(numPairs));
+        double start = 0.0;
+
+        for (int hop = 0; hop < warmupHops + measuredHops; ++hop)
+        {
+            if (hop == warmupHops)
+                start = Benchmarks::nowMs();
+
+            const int offset = hop * hopSize;
+            for (int i = 0; i < numPairs; ++i)
+                measurements[static_cast<size_t>(i)] = signals.micPointers[static_cast<size_t>(i)] + offset;
+
+            engine.processFrame(signals.reference.data() + offset, measurements.data());
+        }
+
+        return (Benchmarks::nowMs() - start) / measuredHops;
+    }
+}
+
+void Benchmarks::runMultiTF()
+{
+    const int hopSize = fftSize / 4;
+    const double hopMs = 1000.0 * hopSize / sampleRate;
+    const int maxPairs = pairCounts[std::size(pairCounts) - 1];
+    const auto signals = makeSignals(maxPairs, fftSize + (warmupHops + measuredHops + 1) * hopSize);
+
+    std::printf("fft %d, hop %d (%.1f ms), %d hops timed, %d cpus\n",
+                fftSize, hopSize, hopMs, measuredHops, juce::SystemStats::getNumCpus());
+    std::printf("%6s  %22s  %22s  %26s\n", "pairs", "independent ms/hop", "shared 1 thread", "shared parallel (workers)");
+
+    double independentOne = 0.0, sharedOne = 0.0, parallelOne = 0.0;
+
+    for (const int numPairs : pairCounts)
+    {
+        int workers = 0;
+        const double independent = timeIndependent(signals, numPairs, hopSize);
+        const double shared = timeEngine(signals, numPairs, hopSize, 0, workers);
+        const double parallel = timeEngine(signals, numPairs, hopSize, -1, workers);
+
+        if (numPairs == 1)
+        {
+            independentOne = independent;
+            sharedOne = shared;
+            parallelOne = parallel;
+        }
+
+        // (xN): cost relative to one pair; linear scaling would read numPairs
+        std::printf("%6d  %9.3f (x%5.2f)      %9.3f (x%5.2f)      %9.3f (x%5.2f) (%2d)  load %5.1f%%\n",
+                    numPairs,
+                    independent, independent / independentOne,
+                    shared, shared / sharedOne,
+                    parallel, parallel / parallelOne, workers,
+                    100.0 * parallel / hopMs);
+    }
+}
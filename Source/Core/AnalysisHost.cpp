@@ -0,0 +1,85 @@
+#include "AnalysisHost.h"
+#include <algorithm>
+
+AnalysisHost::AnalysisHost(DeviceManager& dm, int numWorkerThreads)
+    : deviceManager(dm)
+{
+    numWorkers = numWorkerThreads < 0 ? juce::jmax(1, juce::SystemStats::getNumCpus() - 1)
+                                      : juce::jmax(1, numWorkerThreads);
+    pool = std::make_unique<juce::ThreadPool>(numWorkers);
+
+    deviceManager.getAudioDeviceManager().addChangeListener(this);
+}
+
+AnalysisHost::~AnalysisHost()
+{
+    deviceManager.getAudioDeviceManager().removeChangeListener(this);
+
+    // Modules stop their callbacks and threads (and wait for their pool jobs) before the pool goes
+    for (auto* module : modules)
+    {
+        module->deactivate();
+        module->setWorkerPool(nullptr);
+    }
+
+    modules.clear();
+    pool.reset();
+}
+
+void AnalysisHost::addModule(AnalysisModule& module)
+{
+    if (std::find(modules.begin(), modules.end(), &module) != modules.end())
+        return;
+
+    modules.push_back(&module);
+    module.setWorkerPool(pool.get());
+    module.setBudget(&module == foreground ? foregroundBudget : backgroundBudget);
+    module.activate();
+}
+
+void AnalysisHost::removeModule(AnalysisModule& module)
+{
+    const auto it = std::find(modules.begin(), modules.end(), &module);
+    if (it == modules.end())
+        return;
+
+    module.deactivate();
+    module.setWorkerPool(nullptr);
+    modules.erase(it);
+
+    if (foreground == &module)
+        foreground = nullptr;
+}
+
+void AnalysisHost::setForeground(AnalysisModule* module)
+{
+    foreground = module;
+    applyBudgets();
+
+    // A module that could not start earlier gets another chance when it is shown
+    if (foreground != nullptr && !foreground->isAnalysisActive())
+        foreground->activate();
+}
+
+void AnalysisHost::setBudgets(const AnalysisBudget& newForegroundBudget, const AnalysisBudget& newBackgroundBudget)
+{
+    foregroundBudget = newForegroundBudget;
+    backgroundBudget = newBackgroundBudget;
+    applyBudgets();
+}
+
+void AnalysisHost::applyBudgets()
+{
+    for (auto* module : modules)
+        module->setBudget(module == foreground ? foregroundBudget : backgroundBudget);
+}
+
+void AnalysisHost::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if (source != &deviceManager.getAudioDeviceManager())
+        return;
+
+    for (auto* module : modules)
+        if (!module->isAnalysisActive())
+            module->activate();
+}
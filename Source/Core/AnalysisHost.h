@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "DeviceManager.h"
+#include <memory>
+#include <vector>
+
+/**
+ * AnalysisBudget
+ *
+ * How much CPU a module may spend. Hidden modules keep their averaging state (so switching
+ * views is instant) but do the display-only part of their work less often.
+ */
+struct AnalysisBudget
+{
+    bool visible{true};
+    int maxWorkerJobs{-1};     // concurrent jobs on the shared pool (-1: one per pool thread)
+    int displayDivider{1};     // display-only work (smoothing, band mapping, snapshots) every Nth update
+
+    static AnalysisBudget foreground() { return {}; }
+    static AnalysisBudget background()
+    {
+        AnalysisBudget budget;
+        budget.visible = false;
+        budget.maxWorkerJobs = 1;
+        budget.displayDivider = 8;
+        return budget;
+    }
+};
+
+/**
+ * AnalysisModule
+ *
+ * A module's controller as seen by the AnalysisHost. activate() may fail (no device yet);
+ * the host retries whenever the device changes.
+ */
+class AnalysisModule
+{
+public:
+    virtual ~AnalysisModule() = default;
+
+    virtual void activate() = 0;
+    virtual void deactivate() = 0;
+    virtual bool isAnalysisActive() const = 0;
+
+    // Message thread; takes effect on the next update of the module's DSP
+    virtual void setBudget(const AnalysisBudget& budget) = 0;
+
+    // Modules with parallel work run it on the host's pool (not owned)
+    virtual void setWorkerPool(juce::ThreadPool* pool) { juce::ignoreUnused(pool); }
+};
+
+/**
+ * AnalysisHost
+ *
+ * Keeps every analysis module running, visible or not:
+ * - Modules are activated when added and stay active until the host goes away; switching
+ *   views only moves the foreground budget from one module to another
+ * - One worker pool (one thread per spare core) shared by all modules instead of a pool each
+ * - The per-module budgets bound what hidden modules cost
+ */
+class AnalysisHost : public juce::ChangeListener
+{
+public:
+    // numWorkerThreads < 0: one per core, minus one for the audio thread
+    AnalysisHost(DeviceManager& deviceManager, int numWorkerThreads = -1);
+    ~AnalysisHost() override;
+
+    // Message thread. The module must outlive the host (or be removed first).
+    void addModule(AnalysisModule& module);
+    void removeModule(AnalysisModule& module);
+
+    // The visible module (nullptr: none); every other module gets the background budget
+    void setForeground(AnalysisModule* module);
+    AnalysisModule* getForeground() const { return foreground; }
+
+    void setBudgets(const AnalysisBudget& foregroundBudget, const AnalysisBudget& backgroundBudget);
+
+    juce::ThreadPool& getWorkerPool() { return *pool; }
+    int getNumWorkerThreads() const { return numWorkers; }
+
+    // Device changes: activate modules that could not start before
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+
+private:
+    void applyBudgets();
+
+    DeviceManager& deviceManager;
+    int numWorkers{1};
+    std::unique_ptr<juce::ThreadPool> pool;
+
+    std::vector<AnalysisModule*> modules;
+    AnalysisModule* foreground{nullptr};
+    AnalysisBudget foregroundBudget{AnalysisBudget::foreground()};
+    AnalysisBudget backgroundBudget{AnalysisBudget::background()};
+};
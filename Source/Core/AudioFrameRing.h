@@ -0,0 +1,208 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+namespace AudioCoPilot
+{
+/**
+ * AudioFrameRing
+ *
+ * SPSC ring of multi-channel audio frames (single producer: audio callback,
+ * single consumer: worker/analysis thread).
+ *
+ * - Planar storage: one contiguous lane per channel inside a single allocation
+ * - One shared read/write index for all channels, so channels can never drift
+ *   relative to each other (a frame is written or dropped for every channel at once)
+ * - Bulk copies split in at most two memcpy segments at the wrap point
+ * - peek()/commit() lets consumers read straight from the ring without copying
+ *
+ * For consumers that process every frame once (AntiMasking, SessionRecorder,
+ * MultiTFEngine). Readers that only look at the latest window, like the TF
+ * auto-analysis in TFController, use MirroredAudioHistory instead.
+ */
+class AudioFrameRing
+{
+public:
+    struct Stats
+    {
+        int capacity { 0 };
+        int highWaterMark { 0 };
+        uint64_t overflowedFrames { 0 };
+    };
+
+    // A readable range of frames: [offset1, offset1 + size1) followed by [0, size2)
+    struct Region
+    {
+        int offset1 { 0 };
+        int size1 { 0 };
+        int size2 { 0 };
+
+        int getTotal() const noexcept { return size1 + size2; }
+    };
+
+    // Not real-time safe. Reuses the existing allocation when the layout is unchanged.
+    void prepare (int numChannelsToUse, int capacityFrames)
+    {
+        // capacity is rounded up to a power of 2 for fast wrap
+        const int newCapacity = juce::nextPowerOfTwo (juce::jmax (2, capacityFrames));
+        const int newChannels = juce::jmax (1, numChannelsToUse);
+
+        if (newCapacity != capacity || newChannels != numChannels)
+        {
+            capacity = newCapacity;
+            numChannels = newChannels;
+            mask = (size_t) (capacity - 1);
+            storage.reset (new float[(size_t) capacity * (size_t) numChannels]);
+        }
+
+        reset();
+    }
+
+    // Not thread-safe with respect to push/pop
+    void reset() noexcept
+    {
+        if (storage != nullptr)
+            std::memset (storage.get(), 0, sizeof (float) * (size_t) capacity * (size_t) numChannels);
+
+        writeIndex.store (0, std::memory_order_release);
+        readIndex.store (0, std::memory_order_release);
+        highWaterMark.store (0, std::memory_order_relaxed);
+        overflowedFrames.store (0, std::memory_order_relaxed);
+    }
+
+    int getCapacity() const noexcept { return capacity; }
+    int getNumChannels() const noexcept { return numChannels; }
+
+    // Producer: write up to numFrames frames. channelData must hold getNumChannels() pointers;
+    // a nullptr entry writes silence for that channel. Returns frames written.
+    int push (const float* const* channelData, int numFrames) noexcept
+    {
+        if (storage == nullptr || channelData == nullptr || numFrames <= 0) return 0;
+
+        const size_t w = writeIndex.load (std::memory_order_relaxed);
+        const size_t r = readIndex.load (std::memory_order_acquire);
+        const int free = capacity - (int) (w - r);
+        const int toWrite = juce::jmin (free, numFrames);
+
+        if (toWrite > 0)
+        {
+            const int start = (int) (w & mask);
+            const int size1 = juce::jmin (toWrite, capacity - start);
+            const int size2 = toWrite - size1;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* lane = getLane (ch);
+                const float* src = channelData[ch];
+
+                if (src != nullptr)
+                {
+                    std::memcpy (lane + start, src, sizeof (float) * (size_t) size1);
+                    if (size2 > 0)
+                        std::memcpy (lane, src + size1, sizeof (float) * (size_t) size2);
+                }
+                else
+                {
+                    std::memset (lane + start, 0, sizeof (float) * (size_t) size1);
+                    if (size2 > 0)
+                        std::memset (lane, 0, sizeof (float) * (size_t) size2);
+                }
+            }
+
+            writeIndex.store (w + (size_t) toWrite, std::memory_order_release);
+        }
+
+        updateStats ((int) (w - r) + toWrite, numFrames - toWrite);
+        return toWrite;
+    }
+
+    // Consumer: number of frames ready to read
+    int available() const noexcept
+    {
+        const size_t r = readIndex.load (std::memory_order_relaxed);
+        const size_t w = writeIndex.load (std::memory_order_acquire);
+        return (int) (w - r);
+    }
+
+    // Consumer: locate up to numFrames readable frames without consuming them
+    Region peek (int numFrames) const noexcept
+    {
+        Region region;
+        const int toRead = juce::jmin (available(), juce::jmax (0, numFrames));
+        const int start = (int) (readIndex.load (std::memory_order_relaxed) & mask);
+
+        region.offset1 = start;
+        region.size1 = juce::jmin (toRead, capacity - start);
+        region.size2 = toRead - region.size1;
+        return region;
+    }
+
+    // Consumer: direct pointer into a channel lane (valid until the frames are committed)
+    const float* getReadPointer (int channel, int index) const noexcept { return getLane (channel) + index; }
+
+    // Consumer: release frames obtained via peek()
+    void commit (int numFrames) noexcept
+    {
+        const int toRelease = juce::jmin (available(), juce::jmax (0, numFrames));
+        readIndex.store (readIndex.load (std::memory_order_relaxed) + (size_t) toRelease,
+                         std::memory_order_release);
+    }
+
+    // Consumer: copy up to numFrames frames into dest (getNumChannels() pointers, nullptr entries
+    // are skipped) and release them. Returns frames read.
+    int pop (float* const* dest, int numFrames) noexcept
+    {
+        if (storage == nullptr || dest == nullptr) return 0;
+
+        const auto region = peek (numFrames);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (dest[ch] == nullptr)
+                continue;
+
+            const float* lane = getLane (ch);
+            std::memcpy (dest[ch], lane + region.offset1, sizeof (float) * (size_t) region.size1);
+            if (region.size2 > 0)
+                std::memcpy (dest[ch] + region.size1, lane, sizeof (float) * (size_t) region.size2);
+        }
+
+        commit (region.getTotal());
+        return region.getTotal();
+    }
+
+    Stats getStats() const noexcept
+    {
+        return { capacity,
+                 highWaterMark.load (std::memory_order_relaxed),
+                 overflowedFrames.load (std::memory_order_relaxed) };
+    }
+
+private:
+    float* getLane (int channel) const noexcept { return storage.get() + (size_t) channel * (size_t) capacity; }
+
+    void updateStats (int used, int dropped) noexcept
+    {
+        if (used > highWaterMark.load (std::memory_order_relaxed))
+            highWaterMark.store (used, std::memory_order_relaxed);
+        if (dropped > 0)
+            overflowedFrames.fetch_add ((uint64_t) dropped, std::memory_order_relaxed);
+    }
+
+    int capacity { 0 };
+    int numChannels { 0 };
+    size_t mask { 0 };
+    std::unique_ptr<float[]> storage;
+
+    // Producer- and consumer-owned indices on separate cache lines
+    alignas (64) std::atomic<size_t> writeIndex { 0 };
+    alignas (64) std::atomic<size_t> readIndex { 0 };
+
+    // Written by the producer only
+    alignas (64) std::atomic<int> highWaterMark { 0 };
+    std::atomic<uint64_t> overflowedFrames { 0 };
+};
+}
@@ -31,6 +31,7 @@ void DeviceStateModel::updateChannelLevel(int channelIndex, bool isInput, float
         channels[channelIndex].rmsLevel = rms;
         channels[channelIndex].peakLevel = peak;
         channels[channelIndex].isActive = (rms > 0.001f || peak > 0.001f);
+        levelGeneration.fetch_add(1, std::memory_order_release);
         
         // Debug: Log first few updates to verify data is coming
         static int updateCount = 0;
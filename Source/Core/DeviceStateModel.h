@@ -43,6 +43,9 @@ public:
     std::vector<ChannelInfo> getInputChannels() const;
     std::vector<ChannelInfo> getOutputChannels() const;
     
+    // Incremented on every level update, so meters only redraw when new levels arrived
+    uint64_t getLevelGeneration() const { return levelGeneration.load(std::memory_order_acquire); }
+    
     // Thread-safe channel count updates
     void setChannelCounts(int numInputs, int numOutputs);
     int getNumInputChannels() const;
@@ -57,4 +60,5 @@ private:
     
     std::atomic<int> numInputChannels{0};
     std::atomic<int> numOutputChannels{0};
+    std::atomic<uint64_t> levelGeneration{0};
 };
@@ -0,0 +1,421 @@
+#include "FFTEngine.h"
+#include "FFTPlanCache.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+namespace AudioCoPilot
+{
+namespace
+{
+    FFTEngine::Backend resolve (FFTEngine::Backend backend)
+    {
+        // juce until the native engine has passed FFTEngineTest on a full build and its JUCE
+        // comparison is in Source/Benchmarks/FFTBackendResults.md
+        return backend != FFTEngine::Backend::automatic ? backend : FFTEngine::Backend::juce;
+    }
+
+    std::atomic<FFTEngine::Backend>& getDefaultBackendSlot()
+    {
+        static std::atomic<FFTEngine::Backend> backend { [] {
+            const auto name = juce::SystemStats::getEnvironmentVariable ("AUDIOCOPILOT_FFT_BACKEND", {}).trim();
+
+            if (name.equalsIgnoreCase ("juce"))
+                return FFTEngine::Backend::juce;
+
+            if (name.equalsIgnoreCase ("native"))
+                return FFTEngine::Backend::native;
+
+            return FFTEngine::Backend::automatic;
+        }() };
+
+        return backend;
+    }
+
+    //==============================================================================
+    class JuceEngine final : public FFTEngine
+    {
+    public:
+        explicit JuceEngine (int fftOrder)
+            : FFTEngine (fftOrder), fft { FFTPlanCache::getFFT (fftOrder) }
+        {
+        }
+
+        Backend getBackend() const override { return Backend::juce; }
+
+        // JUCE's fallback takes its scratch from the heap from FFTPlanCache::maxStackScratchPoints on
+        size_t getScratchSize() const override { return 2 * FFTPlanCache::getRealForwardScratchSize (*fft); }
+
+        void performRealForward (float* data, float* scratch) const override
+        {
+            FFTPlanCache::performRealForward (*fft, data, reinterpret_cast<juce::dsp::Complex<float>*> (scratch));
+        }
+
+    private:
+        std::shared_ptr<const juce::dsp::FFT> fft;
+    };
+
+    //==============================================================================
+    class NativeEngine final : public FFTEngine
+    {
+    public:
+        explicit NativeEngine (int fftOrder)
+            : FFTEngine (fftOrder), numPoints { getSize() / 2 }
+        {
+            constexpr double twoPi = juce::MathConstants<double>::twoPi;
+            const int bits = fftOrder - 1;
+
+            // Index pairs swapped by the bit-reversal permutation of the numPoints complex values
+            for (int i = 0; i < numPoints; ++i)
+            {
+                int reversed = 0;
+                for (int bit = 0; bit < bits; ++bit)
+                    reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+
+                if (i < reversed)
+                {
+                    swaps.push_back ((uint32_t) i);
+                    swaps.push_back ((uint32_t) reversed);
+                }
+            }
+
+            // Stage with butterflies half points apart uses entries half .. 2 * half - 1:
+            // exp (-2 pi i j / (2 * half)), so every stage reads its twiddles in order
+            stageTwiddles.resize ((size_t) juce::jmax (2, 2 * numPoints));
+            for (int half = 4; half < numPoints; half <<= 1)
+            {
+                for (int j = 0; j < half; ++j)
+                {
+                    const double phase = -twoPi * j / (2.0 * half);
+                    stageTwiddles[(size_t) (2 * (half + j))]     = (float) std::cos (phase);
+                    stageTwiddles[(size_t) (2 * (half + j) + 1)] = (float) std::sin (phase);
+                }
+            }
+
+            // Split of the packed transform into the real input's bins: exp (-2 pi i k / size)
+            splitTwiddles.resize ((size_t) (2 * (numPoints / 2 + 1)));
+            for (int k = 0; k <= numPoints / 2; ++k)
+            {
+                const double phase = -twoPi * k / (double) getSize();
+                splitTwiddles[(size_t) (2 * k)]     = (float) std::cos (phase);
+                splitTwiddles[(size_t) (2 * k + 1)] = (float) std::sin (phase);
+            }
+        }
+
+        Backend getBackend() const override { return Backend::native; }
+
+        void performRealForward (float* data, float* = nullptr) const override
+        {
+            // The real samples read as numPoints complex values z[n] = x[2n] + i x[2n + 1]
+            transformPacked (data);
+            splitPacked (data);
+        }
+
+        void performRealForwardBatch (float* const* data, int numChannels, float* scratch) const override
+        {
+            int channel = 0;
+            if (scratch != nullptr)
+                for (; channel + batchLanes <= numChannels; channel += batchLanes)
+                    transformLanes (data + channel, scratch);
+
+            for (; channel < numChannels; ++channel)
+                performRealForward (data[channel]);
+        }
+
+        size_t getScratchSize() const override { return (size_t) (2 * numPoints * batchLanes); }
+
+        size_t getMemoryBytes() const override
+        {
+            return swaps.size() * sizeof (uint32_t)
+                 + (stageTwiddles.size() + splitTwiddles.size()) * sizeof (float);
+        }
+
+    private:
+        // In-place numPoints-point complex FFT of the interleaved values in z
+        void transformPacked (float* z) const
+        {
+            for (size_t i = 0; i < swaps.size(); i += 2)
+            {
+                const auto a = 2 * (size_t) swaps[i];
+                const auto b = 2 * (size_t) swaps[i + 1];
+                std::swap (z[a], z[b]);
+                std::swap (z[a + 1], z[b + 1]);
+            }
+
+            if (numPoints == 2)
+            {
+                const float r0 = z[0], i0 = z[1], r1 = z[2], i1 = z[3];
+                z[0] = r0 + r1; z[1] = i0 + i1;
+                z[2] = r0 - r1; z[3] = i0 - i1;
+                return;
+            }
+
+            // First two stages as one twiddle-free radix-4 butterfly (their twiddles are 1 and -i)
+            for (int block = 0; block + 4 <= numPoints; block += 4)
+            {
+                float* p = z + 2 * block;
+
+                const float r0 = p[0] + p[2], i0 = p[1] + p[3];
+                const float r1 = p[0] - p[2], i1 = p[1] - p[3];
+                const float r2 = p[4] + p[6], i2 = p[5] + p[7];
+                const float r3 = p[4] - p[6], i3 = p[5] - p[7];
+
+                p[0] = r0 + r2; p[1] = i0 + i2;
+                p[4] = r0 - r2; p[5] = i0 - i2;
+                p[2] = r1 + i3; p[3] = i1 - r3;
+                p[6] = r1 - i3; p[7] = i1 + r3;
+            }
+
+            for (int half = 4; half < numPoints; half <<= 1)
+            {
+                const float* w = stageTwiddles.data() + 2 * half;
+
+                for (int block = 0; block < numPoints; block += 2 * half)
+                {
+                    float* lo = z + 2 * block;
+                    float* hi = lo + 2 * half;
+
+                    for (int j = 0; j < 2 * half; j += 2)
+                    {
+                        const float tr = hi[j] * w[j] - hi[j + 1] * w[j + 1];
+                        const float ti = hi[j] * w[j + 1] + hi[j + 1] * w[j];
+                        const float lr = lo[j], li = lo[j + 1];
+
+                        lo[j] = lr + tr; lo[j + 1] = li + ti;
+                        hi[j] = lr - tr; hi[j + 1] = li - ti;
+                    }
+                }
+            }
+        }
+
+        // Packed transform Z -> bins X[0 .. size / 2] in place: with E = (Z[k] + conj Z[M - k]) / 2
+        // and O = (Z[k] - conj Z[M - k]) / 2i, X[k] = E + w^k O and X[M - k] = conj (E - w^k O)
+        void splitPacked (float* data) const
+        {
+            const int m = numPoints;
+
+            const float dcRe = data[0], dcIm = data[1];
+            data[0] = dcRe + dcIm;     data[1] = 0.0f;
+            data[2 * m] = dcRe - dcIm; data[2 * m + 1] = 0.0f;
+
+            int k = 1;
+            for (; k < m - k; ++k)
+            {
+                float* a = data + 2 * k;
+                float* b = data + 2 * (m - k);
+
+                const float eRe = 0.5f * (a[0] + b[0]), eIm = 0.5f * (a[1] - b[1]);
+                const float oRe = 0.5f * (a[1] + b[1]), oIm = -0.5f * (a[0] - b[0]);
+
+                const float wRe = splitTwiddles[(size_t) (2 * k)];
+                const float wIm = splitTwiddles[(size_t) (2 * k + 1)];
+                const float tRe = wRe * oRe - wIm * oIm;
+                const float tIm = wRe * oIm + wIm * oRe;
+
+                a[0] = eRe + tRe; a[1] = eIm + tIm;
+                b[0] = eRe - tRe; b[1] = tIm - eIm;
+            }
+
+            // Middle bin (w^k = -i): X[M / 2] = conj Z[M / 2]
+            if (k == m - k)
+                data[2 * k + 1] = -data[2 * k + 1];
+        }
+
+        // performRealForward() on batchLanes channels at once. The packed values go to the
+        // scratch (getScratchSize() floats) with the lanes interleaved: lane l of point p
+        // has its real part at z[2 p L + l] and its imaginary part at z[(2 p + 1) L + l], so
+        // every butterfly below is one loop over L adjacent floats with shared twiddles.
+        void transformLanes (float* const* data, float* z) const
+        {
+            constexpr int L = batchLanes;
+            const int m = numPoints;
+
+            for (int p = 0; p < m; ++p)
+            {
+                float* zp = z + 2 * L * p;
+                for (int l = 0; l < L; ++l)
+                {
+                    zp[l]     = data[l][2 * p];
+                    zp[L + l] = data[l][2 * p + 1];
+                }
+            }
+
+            for (size_t i = 0; i < swaps.size(); i += 2)
+            {
+                float* a = z + 2 * L * (size_t) swaps[i];
+                float* b = z + 2 * L * (size_t) swaps[i + 1];
+                for (int f = 0; f < 2 * L; ++f)
+                    std::swap (a[f], b[f]);
+            }
+
+            if (m == 2)
+            {
+                for (int f = 0; f < 2 * L; ++f)
+                {
+                    const float lo = z[f], hi = z[2 * L + f];
+                    z[f] = lo + hi;
+                    z[2 * L + f] = lo - hi;
+                }
+            }
+
+            // Radix-4 first stages, as in transformPacked()
+            for (int block = 0; block + 4 <= m; block += 4)
+            {
+                float* p0 = z + 2 * L * block;
+                float* p1 = p0 + 2 * L;
+                float* p2 = p1 + 2 * L;
+                float* p3 = p2 + 2 * L;
+
+                for (int l = 0; l < L; ++l)
+                {
+                    const float r0 = p0[l] + p1[l], i0 = p0[L + l] + p1[L + l];
+                    const float r1 = p0[l] - p1[l], i1 = p0[L + l] - p1[L + l];
+                    const float r2 = p2[l] + p3[l], i2 = p2[L + l] + p3[L + l];
+                    const float r3 = p2[l] - p3[l], i3 = p2[L + l] - p3[L + l];
+
+                    p0[l] = r0 + r2; p0[L + l] = i0 + i2;
+                    p2[l] = r0 - r2; p2[L + l] = i0 - i2;
+                    p1[l] = r1 + i3; p1[L + l] = i1 - r3;
+                    p3[l] = r1 - i3; p3[L + l] = i1 + r3;
+                }
+            }
+
+            for (int half = 4; half < m; half <<= 1)
+            {
+                const float* w = stageTwiddles.data() + 2 * half;
+
+                for (int block = 0; block < m; block += 2 * half)
+                {
+                    for (int j = 0; j < half; ++j)
+                    {
+                        const float wRe = w[2 * j], wIm = w[2 * j + 1];
+                        float* lo = z + 2 * L * (block + j);
+                        float* hi = lo + 2 * L * half;
+
+                        for (int l = 0; l < L; ++l)
+                        {
+                            const float tr = hi[l] * wRe - hi[L + l] * wIm;
+                            const float ti = hi[l] * wIm + hi[L + l] * wRe;
+                            const float lr = lo[l], li = lo[L + l];
+
+                            lo[l] = lr + tr; lo[L + l] = li + ti;
+                            hi[l] = lr - tr; hi[L + l] = li - ti;
+                        }
+                    }
+                }
+            }
+
+            // Split into each channel's bins, as in splitPacked()
+            for (int l = 0; l < L; ++l)
+            {
+                float* x = data[l];
+                x[0] = z[l] + z[L + l];     x[1] = 0.0f;
+                x[2 * m] = z[l] - z[L + l]; x[2 * m + 1] = 0.0f;
+            }
+
+            int k = 1;
+            for (; k < m - k; ++k)
+            {
+                const float* a = z + 2 * L * k;
+                const float* b = z + 2 * L * (m - k);
+                const float wRe = splitTwiddles[(size_t) (2 * k)];
+                const float wIm = splitTwiddles[(size_t) (2 * k + 1)];
+
+                for (int l = 0; l < L; ++l)
+                {
+                    const float eRe = 0.5f * (a[l] + b[l]), eIm = 0.5f * (a[L + l] - b[L + l]);
+                    const float oRe = 0.5f * (a[L + l] + b[L + l]), oIm = -0.5f * (a[l] - b[l]);
+                    const float tRe = wRe * oRe - wIm * oIm;
+                    const float tIm = wRe * oIm + wIm * oRe;
+
+                    float* x = data[l];
+                    x[2 * k] = eRe + tRe;           x[2 * k + 1] = eIm + tIm;
+                    x[2 * (m - k)] = eRe - tRe;     x[2 * (m - k) + 1] = tIm - eIm;
+                }
+            }
+
+            if (k == m - k)
+            {
+                for (int l = 0; l < L; ++l)
+                {
+                    data[l][2 * k]     = z[2 * L * k + l];
+                    data[l][2 * k + 1] = -z[2 * L * k + L + l];
+                }
+            }
+        }
+
+        const int numPoints;                // complex points of the packed transform
+        std::vector<uint32_t> swaps;        // bit-reversal index pairs
+        std::vector<float> stageTwiddles;   // interleaved, see the constructor
+        std::vector<float> splitTwiddles;   // interleaved, k = 0 .. numPoints / 2
+    };
+}
+
+const char* FFTEngine::getBackendName (Backend backend)
+{
+    switch (backend)
+    {
+        case Backend::juce:      return "JUCE";
+        case Backend::native:    return "native";
+        case Backend::automatic: break;
+    }
+
+    return "automatic";
+}
+
+FFTEngine::Backend FFTEngine::getDefaultBackend()
+{
+    return resolve (getDefaultBackendSlot().load (std::memory_order_relaxed));
+}
+
+void FFTEngine::setDefaultBackend (Backend backend)
+{
+    getDefaultBackendSlot().store (backend, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const FFTEngine> FFTEngine::create (int order, Backend backend)
+{
+    order = juce::jlimit (FFTPlanCache::minOrder, FFTPlanCache::maxOrder, order);
+    backend = (backend == Backend::automatic) ? getDefaultBackend() : backend;
+
+    if (backend == Backend::juce)
+        return std::make_shared<const JuceEngine> (order);
+
+    return std::make_shared<const NativeEngine> (order);
+}
+
+void FFTEngine::performFrequencyOnlyForward (float* data, float* scratch) const
+{
+    performRealForward (data, scratch);
+    toMagnitudes (data);
+}
+
+void FFTEngine::performRealForwardBatch (float* const* data, int numChannels, float* scratch) const
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        performRealForward (data[channel], scratch);
+}
+
+void FFTEngine::performFrequencyOnlyForwardBatch (float* const* data, int numChannels, float* scratch) const
+{
+    performRealForwardBatch (data, numChannels, scratch);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        toMagnitudes (data[channel]);
+}
+
+void FFTEngine::toMagnitudes (float* data) const
+{
+    const int size = getSize();
+    const int numBins = size / 2 + 1;
+
+    // Bin b reads floats 2b and 2b + 1, which lie at or after b: safe in place. sqrt rather
+    // than std::abs (hypot): audio levels are far from overflow, and hypot costs more than
+    // the transform itself at these sizes
+    for (int bin = 0; bin < numBins; ++bin)
+        data[bin] = std::sqrt (data[2 * bin] * data[2 * bin] + data[2 * bin + 1] * data[2 * bin + 1]);
+
+    std::fill (data + numBins, data + 2 * size, 0.0f);
+}
+}
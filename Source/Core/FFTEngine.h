@@ -0,0 +1,94 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <memory>
+
+namespace AudioCoPilot
+{
+/**
+ * FFTEngine
+ *
+ * Forward real-to-complex transform behind the analyzers (FFTAnalyzer, RTA, Bark, AI
+ * Stage Hand), with the backend picked at runtime:
+ *
+ * - juce: juce::dsp::FFT through FFTPlanCache. Fast where JUCE has a native engine
+ *   (vDSP on Apple, IPP, MKL or FFTW when enabled), otherwise its generic fallback, which
+ *   does a full N-point complex transform of the real input.
+ * - native: the in-tree engine. Packs the N real samples into N / 2 complex ones,
+ *   runs an iterative radix-2 transform on those (bit-reversal table, per-stage
+ *   contiguous twiddles, twiddle-free first two stages) and splits the result into bins
+ *   0 .. N / 2. Works in place in the caller's buffer with no scratch or lock, so one
+ *   engine per size serves every thread. Batches run the same transform on groups of
+ *   batchLanes channels, interleaved in the caller's scratch (lane l of every value next
+ *   to lane l + 1): each twiddle is loaded once per group and every butterfly is one
+ *   SIMD-friendly loop over the lanes. That only pays off once the lane loops are
+ *   vectorised, so CMakeLists.txt builds FFTEngine.cpp at -O3.
+ * - automatic (the default): juce. native is opt-in until it has passed FFTEngineTest
+ *   (Source/Tests) on a build with the JUCE submodule and its JUCE rows in
+ *   Source/Benchmarks/FFTBackendResults.md are measured. The AUDIOCOPILOT_FFT_BACKEND
+ *   environment variable (juce / native) overrides it at startup, setDefaultBackend()
+ *   afterwards.
+ *
+ * Engines come from FFTPlanCache::getEngine() and are immutable; the backend is fixed
+ * when an analyzer takes its engine in prepare().
+ */
+class FFTEngine
+{
+public:
+    enum class Backend
+    {
+        automatic,
+        juce,
+        native
+    };
+
+    static const char* getBackendName (Backend backend);
+
+    // Backend automatic resolves to; set from AUDIOCOPILOT_FFT_BACKEND on first use
+    static Backend getDefaultBackend();
+    static void setDefaultBackend (Backend backend);
+
+    // Uncached engine for 2^order points (FFTPlanCache::getEngine() is the usual way in)
+    static std::shared_ptr<const FFTEngine> create (int order, Backend backend = Backend::automatic);
+
+    virtual ~FFTEngine() = default;
+
+    int getOrder() const noexcept { return order; }
+    int getSize() const noexcept  { return 1 << order; }
+
+    virtual Backend getBackend() const = 0;
+
+    // Every transform below takes an optional scratch of getScratchSize() floats, allocated
+    // by the caller in its prepare() so that no call allocates. Without it the juce backend
+    // lets JUCE allocate where it needs to, and native batches go channel by channel.
+    virtual size_t getScratchSize() const { return 0; }
+
+    // As juce::dsp::FFT::performRealOnlyForwardTransform (data, true): data holds
+    // 2 * getSize() floats, real input in the first half, interleaved bins 0 .. size / 2
+    // out (floats above size + 1 are unspecified)
+    virtual void performRealForward (float* data, float* scratch = nullptr) const = 0;
+
+    // As juce::dsp::FFT::performFrequencyOnlyForwardTransform (data, true): magnitudes of
+    // bins 0 .. size / 2 in data[0 .. size / 2], the rest of the 2 * size floats zeroed
+    void performFrequencyOnlyForward (float* data, float* scratch = nullptr) const;
+
+    // performRealForward() / performFrequencyOnlyForward() on numChannels planar buffers
+    // (data[c]: 2 * getSize() floats each). The juce backend transforms them one by one.
+    virtual void performRealForwardBatch (float* const* data, int numChannels, float* scratch) const;
+    void performFrequencyOnlyForwardBatch (float* const* data, int numChannels, float* scratch) const;
+
+    static constexpr int batchLanes = 4;  // native: channels per interleaved group
+
+    // Tables held by this engine (0 for juce: its plan is counted by FFTPlanCache)
+    virtual size_t getMemoryBytes() const { return 0; }
+
+protected:
+    explicit FFTEngine (int fftOrder) : order { fftOrder } {}
+
+private:
+    // Bins from performRealForward() to their magnitudes, in place
+    void toMagnitudes (float* data) const;
+
+    const int order;
+};
+}
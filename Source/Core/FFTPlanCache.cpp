@@ -0,0 +1,201 @@
+#include "FFTPlanCache.h"
+#include <array>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+namespace AudioCoPilot
+{
+namespace
+{
+    struct PlanSlot
+    {
+        std::array<std::shared_ptr<const juce::dsp::FFT>, FFTPlanCache::plansPerSize> instances;
+        int next { 0 };
+    };
+
+    struct WindowKey
+    {
+        int size;
+        FFTPlanCache::Window window;
+        bool normalised;
+
+        bool operator< (const WindowKey& other) const noexcept
+        {
+            return std::tie (size, window, normalised) < std::tie (other.size, other.window, other.normalised);
+        }
+    };
+
+    struct Cache
+    {
+        Cache()
+        {
+            // Creates JUCE's leak counter for FFT before this object is complete, so the counter
+            // is destroyed after the cached plans (otherwise they would be reported as leaks)
+            juce::dsp::FFT warmUp (FFTPlanCache::minOrder);
+        }
+
+        juce::CriticalSection lock;
+        std::map<int, PlanSlot> plans;
+        std::map<int, std::shared_ptr<const FFTEngine>> nativeEngines;
+        std::map<WindowKey, std::shared_ptr<const FFTPlanCache::WindowTable>> windows;
+    };
+
+    Cache& getCache()
+    {
+        static Cache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const FFTPlanCache::WindowTable> buildWindow (int size, FFTPlanCache::Window window, bool normalised)
+    {
+        static constexpr double hann[] = { 0.5, 0.5 };
+        static constexpr double blackmanHarris[] = { 0.35875, 0.48829, 0.14128, 0.01168 };
+        static constexpr double flatTop[] = { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 };
+
+        const double* coefficients = hann;
+        int numCoefficients = 2;
+
+        switch (window)
+        {
+            case FFTPlanCache::Window::blackmanHarris: coefficients = blackmanHarris; numCoefficients = 4; break;
+            case FFTPlanCache::Window::flatTop:        coefficients = flatTop;        numCoefficients = 5; break;
+            case FFTPlanCache::Window::hann:           break;
+        }
+
+        auto table = std::make_shared<FFTPlanCache::WindowTable>();
+        table->samples.resize ((size_t) size);
+
+        // Symmetric: sum of (-1)^term * a_term * cos (term * 2 pi i / (size - 1))
+        for (int i = 0; i < size; ++i)
+        {
+            const double phase = 2.0 * juce::MathConstants<double>::pi * i / juce::jmax (1, size - 1);
+            double value = 0.0;
+            for (int term = 0; term < numCoefficients; ++term)
+                value += ((term % 2 == 0) ? 1.0 : -1.0) * coefficients[term] * std::cos (term * phase);
+
+            table->samples[(size_t) i] = (float) value;
+            table->sum += value;
+            table->power += value * value;
+        }
+
+        if (normalised)
+        {
+            // As juce::dsp::WindowingFunction: float sum, then size / sum
+            float sum = 0.0f;
+            for (auto sample : table->samples)
+                sum += sample;
+
+            const float factor = (float) size / sum;
+            juce::FloatVectorOperations::multiply (table->samples.data(), factor, size);
+
+            table->sum = 0.0;
+            table->power = 0.0;
+            for (auto sample : table->samples)
+            {
+                table->sum += sample;
+                table->power += (double) sample * sample;
+            }
+        }
+
+        return table;
+    }
+}
+
+std::shared_ptr<const juce::dsp::FFT> FFTPlanCache::getFFT (int order)
+{
+    order = juce::jlimit (minOrder, maxOrder, order);
+
+    auto& cache = getCache();
+    const juce::ScopedLock lock (cache.lock);
+
+    // Round-robin over the instances of this order, building each one the first time it is due
+    auto& slot = cache.plans[order];
+    auto& instance = slot.instances[(size_t) slot.next];
+    slot.next = (slot.next + 1) % plansPerSize;
+
+    if (instance == nullptr)
+        instance = std::make_shared<const juce::dsp::FFT> (order);
+
+    return instance;
+}
+
+std::shared_ptr<const FFTEngine> FFTPlanCache::getEngine (int order, FFTEngine::Backend backend)
+{
+    order = juce::jlimit (minOrder, maxOrder, order);
+
+    if (backend == FFTEngine::Backend::automatic)
+        backend = FFTEngine::getDefaultBackend();
+
+    // The wrapper is small; its plan comes from getFFT() (and so round-robin)
+    if (backend == FFTEngine::Backend::juce)
+        return FFTEngine::create (order, backend);
+
+    auto& cache = getCache();
+    const juce::ScopedLock lock (cache.lock);
+
+    auto& engine = cache.nativeEngines[order];
+    if (engine == nullptr)
+        engine = FFTEngine::create (order, backend);
+
+    return engine;
+}
+
+std::shared_ptr<const FFTPlanCache::WindowTable> FFTPlanCache::getWindow (int size, Window window, bool normalised)
+{
+    size = juce::jmax (1, size);
+
+    auto& cache = getCache();
+    const juce::ScopedLock lock (cache.lock);
+
+    auto& table = cache.windows[{ size, window, normalised }];
+    if (table == nullptr)
+        table = buildWindow (size, window, normalised);
+
+    return table;
+}
+
+size_t FFTPlanCache::getRealForwardScratchSize (const juce::dsp::FFT& fft)
+{
+    const int size = fft.getSize();
+    return (juceHasNativeEngine || size < maxStackScratchPoints) ? 0 : (size_t) size;
+}
+
+void FFTPlanCache::performRealForward (const juce::dsp::FFT& fft, float* data, juce::dsp::Complex<float>* scratch)
+{
+    const int size = fft.getSize();
+    if (scratch == nullptr || getRealForwardScratchSize (fft) == 0)
+    {
+        fft.performRealOnlyForwardTransform (data, true);
+        return;
+    }
+
+    // What the real-only transform does internally, with the caller's scratch
+    for (int i = 0; i < size; ++i)
+        scratch[i] = { data[i], 0.0f };
+
+    fft.perform (scratch, reinterpret_cast<juce::dsp::Complex<float>*> (data), false);
+}
+
+size_t FFTPlanCache::getMemoryBytes()
+{
+    auto& cache = getCache();
+    const juce::ScopedLock lock (cache.lock);
+
+    size_t bytes = 0;
+
+    // Forward and inverse twiddles of the fallback engine, one complex value per point each
+    for (const auto& [order, slot] : cache.plans)
+        for (const auto& instance : slot.instances)
+            if (instance != nullptr)
+                bytes += 2 * sizeof (juce::dsp::Complex<float>) * ((size_t) 1 << order);
+
+    for (const auto& [order, engine] : cache.nativeEngines)
+        bytes += engine->getMemoryBytes();
+
+    for (const auto& [key, table] : cache.windows)
+        bytes += table->samples.size() * sizeof (float);
+
+    return bytes;
+}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "FFTEngine.h"
+#include <memory>
+#include <vector>
+
+namespace AudioCoPilot
+{
+/**
+ * FFTPlanCache
+ *
+ * Process-wide cache of FFT plans and analysis windows. Every analyzer used to build its own
+ * juce::dsp::FFT and window table in prepare(), so a device restart rebuilt the same
+ * 2048/4096/16384-point twiddles and cosine tables several times over on the message thread.
+ *
+ * - Keyed by FFT order, and by (size, window, normalised) for windows. Entries are built on
+ *   first use and never change afterwards: they are handed out as shared_ptr<const ...> and
+ *   kept for the life of the process (the few sizes the app uses cost a few MB)
+ * - juce::dsp::FFT's fallback engine serializes concurrent transforms on one instance, so
+ *   up to plansPerSize instances of each order are built and handed out round-robin:
+ *   analyzers of the same size on parallel threads (e.g. multi-pair TF) rarely share one
+ * - performRealForward() does the real-only transform through the caller's scratch from
+ *   the size where JUCE's fallback engine would allocate its scratch on the heap on every
+ *   call (platform engines keep their own buffers and are called directly)
+ * - getEngine() hands out the analyzers' forward transform on the selected FFTEngine
+ *   backend: native engines are reentrant and cached once per order, juce ones wrap the
+ *   next round-robin plan
+ * - Thread-safe: lookups take a short lock, using what they return does not
+ */
+class FFTPlanCache
+{
+public:
+    // Symmetric cosine-sum windows: Hann, 4-term Blackman-Harris, 5-term flat-top
+    enum class Window
+    {
+        hann,
+        blackmanHarris,
+        flatTop
+    };
+
+    struct WindowTable
+    {
+        std::vector<float> samples;
+        double sum { 0.0 };    // coherent gain (times the size)
+        double power { 0.0 };  // sum of squares: gain on noise power
+    };
+
+    static constexpr int plansPerSize = 4;
+    static constexpr int minOrder = 1;
+    static constexpr int maxOrder = 20;
+
+    // Plan for 2^order points (order within minOrder .. maxOrder)
+    static std::shared_ptr<const juce::dsp::FFT> getFFT (int order);
+
+    // Forward real transform of 2^order points on backend (automatic: the current default)
+    static std::shared_ptr<const FFTEngine> getEngine (int order, FFTEngine::Backend backend = FFTEngine::Backend::automatic);
+
+    // Window of size points. normalised: scaled to a mean of 1, as juce::dsp::WindowingFunction
+    // does by default (coherent gain 1), otherwise the plain cosine sum (peak 1)
+    static std::shared_ptr<const WindowTable> getWindow (int size, Window window, bool normalised = false);
+
+    // fft.performRealOnlyForwardTransform (data, true): data holds 2 * fft.getSize() floats,
+    // real input in the first half, interleaved bins 0 .. size / 2 out. On JUCE's fallback
+    // engine, from maxStackScratchPoints on the transform goes through scratch (owned by the
+    // caller, sized in its prepare() from getRealForwardScratchSize()) instead of a heap block
+    // per call. scratch may be nullptr where that size is 0.
+    static void performRealForward (const juce::dsp::FFT& fft, float* data, juce::dsp::Complex<float>* scratch);
+    static size_t getRealForwardScratchSize (const juce::dsp::FFT& fft);
+
+    // Memory held by the cached plans' twiddles (estimated), native engines and windows
+    static size_t getMemoryBytes();
+
+    // juce::dsp::FFT runs on a platform engine (vDSP, IPP, MKL, FFTW) instead of its fallback
+   #if JUCE_MAC || JUCE_IOS || JUCE_IPP_AVAILABLE || JUCE_DSP_USE_INTEL_MKL || JUCE_DSP_USE_SHARED_FFTW || JUCE_DSP_USE_STATIC_FFTW
+    static constexpr bool juceHasNativeEngine = true;
+   #else
+    static constexpr bool juceHasNativeEngine = false;
+   #endif
+
+    // The fallback's real-only transform needs 16 + size * 8 bytes of scratch and only
+    // takes it from the stack below 256 kB: 32768 points (262160 bytes) is the first size
+    // that goes to the heap
+    static constexpr int maxStackScratchPoints = 32768;
+};
+}
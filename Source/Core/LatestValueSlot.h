@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace AudioCoPilot
+{
+/**
+ * LatestValueSlot
+ *
+ * Lock-free "latest value wins" slot (triple buffer) for one producer and one consumer.
+ * The producer fills the value returned by beginWrite() and calls publish(); the consumer
+ * calls update()/read() and always gets the most recently published value without ever
+ * blocking the producer. Intermediate values the consumer did not pick up are simply overwritten.
+ */
+template <typename ValueType>
+class LatestValueSlot
+{
+public:
+    LatestValueSlot() = default;
+
+    // Not thread-safe: only call while neither side is active
+    void reset (const ValueType& initialValue)
+    {
+        for (auto& s : slots)
+            s = initialValue;
+
+        backIndex = 0;
+        frontIndex = 1;
+        middle.store (2, std::memory_order_release);
+    }
+
+    // Producer: slot to fill before calling publish()
+    ValueType& beginWrite() noexcept { return slots[(size_t) backIndex]; }
+
+    // Producer: hands the filled slot to the consumer and takes back the stale one
+    void publish() noexcept
+    {
+        const int previous = middle.exchange (backIndex | freshFlag, std::memory_order_acq_rel);
+        backIndex = previous & indexMask;
+    }
+
+    // Consumer: true if a value was published since the last update()
+    bool hasNewValue() const noexcept { return (middle.load (std::memory_order_acquire) & freshFlag) != 0; }
+
+    // Consumer: picks up the latest published value, returns false if nothing new arrived
+    bool update() noexcept
+    {
+        if (! hasNewValue())
+            return false;
+
+        const int previous = middle.exchange (frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & indexMask;
+        return true;
+    }
+
+    // Consumer: value picked up by the last update() (stable until the next update())
+    const ValueType& current() const noexcept { return slots[(size_t) frontIndex]; }
+
+    // Consumer: update() + current()
+    const ValueType& read() noexcept
+    {
+        update();
+        return current();
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshFlag = 4;
+
+    std::array<ValueType, 3> slots {};
+
+    // Producer and consumer indices live on separate cache lines to avoid false sharing
+    alignas (64) int backIndex { 0 };
+    alignas (64) int frontIndex { 1 };
+    alignas (64) std::atomic<int> middle { 2 };
+};
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+namespace AudioCoPilot
+{
+/**
+ * MirroredAudioHistory
+ *
+ * Multi-channel "last N samples" store for one writer (audio callback) and any
+ * number of readers that only look, never consume.
+ *
+ * - Each channel lane is 2x the capacity and every frame is written twice
+ *   (at i and i + capacity), so the most recent N frames are always one
+ *   contiguous block: readers get plain pointers, no copy, no modulo
+ * - A monotonic frame counter doubles as a sequence number: a reader takes a
+ *   View, uses it in place, then calls isValid() to find out whether the writer
+ *   overwrote any of it in the meantime (and drops the result if so)
+ */
+class MirroredAudioHistory
+{
+public:
+    // Linear window over the last numFrames frames, ending at frame endFrame (exclusive)
+    struct View
+    {
+        static constexpr int maxChannels = 8;
+
+        const float* channels[maxChannels] {};
+        int numChannels { 0 };
+        int numFrames { 0 };
+        uint64_t endFrame { 0 };
+
+        const float* getChannel (int channel) const noexcept { return channels[channel]; }
+        bool isEmpty() const noexcept { return numFrames <= 0; }
+    };
+
+    // Not real-time safe and not thread-safe: call while the writer is stopped.
+    // Reuses the existing allocation when the layout is unchanged.
+    void prepare (int numChannelsToUse, int capacityFrames)
+    {
+        const int newCapacity = juce::nextPowerOfTwo (juce::jmax (2, capacityFrames));
+        const int newChannels = juce::jlimit (1, View::maxChannels, numChannelsToUse);
+
+        if (newCapacity != capacity || newChannels != numChannels)
+        {
+            capacity = newCapacity;
+            numChannels = newChannels;
+            mask = (uint64_t) (capacity - 1);
+            storage.reset (new float[(size_t) capacity * 2 * (size_t) numChannels]);
+        }
+
+        std::memset (storage.get(), 0, sizeof (float) * (size_t) capacity * 2 * (size_t) numChannels);
+        writtenFrames.store (0, std::memory_order_release);
+        claimedFrames.store (0, std::memory_order_release);
+        validFromFrame.store (0, std::memory_order_release);
+    }
+
+    int getCapacity() const noexcept { return capacity; }
+    int getNumChannels() const noexcept { return numChannels; }
+
+    // Producer: append numFrames frames. channelData must hold getNumChannels() pointers;
+    // a nullptr entry writes silence for that channel.
+    void write (const float* const* channelData, int numFrames) noexcept
+    {
+        if (storage == nullptr || channelData == nullptr || numFrames <= 0)
+            return;
+
+        // Only the newest 'capacity' frames can ever be read back
+        const int skip = juce::jmax (0, numFrames - capacity);
+        const int toWrite = numFrames - skip;
+
+        const uint64_t w = writtenFrames.load (std::memory_order_relaxed);
+
+        // Announce the frames about to be overwritten before touching them
+        claimedFrames.store (w + (uint64_t) toWrite, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        const int start = (int) (w & mask);
+        const int size1 = juce::jmin (toWrite, capacity - start);
+        const int size2 = toWrite - size1;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* lane = getLane (ch);
+            const float* src = channelData[ch] != nullptr ? channelData[ch] + skip : nullptr;
+
+            writeMirrored (lane, start, src, size1);
+            if (size2 > 0)
+                writeMirrored (lane, 0, src != nullptr ? src + size1 : nullptr, size2);
+        }
+
+        writtenFrames.store (w + (uint64_t) toWrite, std::memory_order_release);
+    }
+
+    // Any thread: frames written so far (also the sequence number used by isValid())
+    uint64_t getTotalFrames() const noexcept { return writtenFrames.load (std::memory_order_acquire); }
+
+    // Any thread: frames currently readable (bounded by capacity and by the last discard())
+    int getNumAvailable() const noexcept
+    {
+        const uint64_t w = writtenFrames.load (std::memory_order_acquire);
+        const uint64_t from = validFromFrame.load (std::memory_order_acquire);
+        return (int) juce::jmin ((uint64_t) capacity, w > from ? w - from : (uint64_t) 0);
+    }
+
+    // Any thread: forget everything written so far (e.g. after a device or channel change)
+    void discard() noexcept
+    {
+        validFromFrame.store (writtenFrames.load (std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // Reader: linear view of the most recent frames (up to numFrames, fewer if not enough history)
+    View getLatest (int numFrames) const noexcept
+    {
+        View view;
+        if (storage == nullptr)
+            return view;
+
+        const uint64_t w = writtenFrames.load (std::memory_order_acquire);
+        const int n = juce::jmin (getNumAvailable(), juce::jmax (0, numFrames));
+
+        // start + n <= 2 * capacity always holds, thanks to the mirror
+        const int start = (int) ((w - (uint64_t) n) & mask);
+
+        view.numChannels = numChannels;
+        view.numFrames = n;
+        view.endFrame = w;
+        for (int ch = 0; ch < numChannels; ++ch)
+            view.channels[ch] = getLane (ch) + start;
+
+        return view;
+    }
+
+    // Reader: true if nothing inside the view has been overwritten since getLatest().
+    // Call after using the data; a false result means the data may be torn.
+    bool isValid (const View& view) const noexcept
+    {
+        std::atomic_thread_fence (std::memory_order_acquire);
+        const uint64_t claimed = claimedFrames.load (std::memory_order_relaxed);
+        const uint64_t oldestFrame = view.endFrame - (uint64_t) view.numFrames;
+
+        // The writer reaches the view's oldest slot again once it claims frame oldest + capacity
+        return claimed <= oldestFrame + (uint64_t) capacity;
+    }
+
+private:
+    float* getLane (int channel) const noexcept { return storage.get() + (size_t) channel * (size_t) capacity * 2; }
+
+    void writeMirrored (float* lane, int start, const float* src, int numFrames) const noexcept
+    {
+        const size_t bytes = sizeof (float) * (size_t) numFrames;
+
+        if (src != nullptr)
+        {
+            std::memcpy (lane + start, src, bytes);
+            std::memcpy (lane + start + capacity, src, bytes);
+        }
+        else
+        {
+            std::memset (lane + start, 0, bytes);
+            std::memset (lane + start + capacity, 0, bytes);
+        }
+    }
+
+    int capacity { 0 };
+    int numChannels { 0 };
+    uint64_t mask { 0 };
+    std::unique_ptr<float[]> storage;
+
+    alignas (64) std::atomic<uint64_t> writtenFrames { 0 };
+    std::atomic<uint64_t> claimedFrames { 0 };
+    alignas (64) std::atomic<uint64_t> validFromFrame { 0 };
+};
+}
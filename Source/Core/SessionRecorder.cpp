@@ -0,0 +1,616 @@
+#include "SessionRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    // Creates file with bytes of disk blocks actually allocated. Seeking to the end and
+    // writing one byte only makes a sparse file: on a full disk, the first memcpy into a
+    // hole of the mapping would then raise SIGBUS (an in-page error on Windows) instead of
+    // failing here, where the segment can be refused.
+    juce::Result reserveFile(const juce::File& file, juce::int64 bytes)
+    {
+       #if JUCE_WINDOWS
+        // NTFS allocates the clusters in SetEndOfFile (files are not sparse unless asked)
+        HANDLE handle = CreateFileW(file.getFullPathName().toWideCharPointer(), GENERIC_READ | GENERIC_WRITE,
+                                    0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            return juce::Result::fail("cannot create file (error " + juce::String((int) GetLastError()) + ")");
+
+        LARGE_INTEGER size;
+        size.QuadPart = bytes;
+        const bool ok = SetFilePointerEx(handle, size, nullptr, FILE_BEGIN) && SetEndOfFile(handle);
+        const auto error = GetLastError();
+        CloseHandle(handle);
+
+        if (!ok)
+            return juce::Result::fail("cannot allocate " + juce::File::descriptionOfSizeInBytes(bytes)
+                                      + " (error " + juce::String((int) error) + ")");
+       #else
+        const int fd = ::open(file.getFullPathName().toRawUTF8(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return juce::Result::fail(std::strerror(errno));
+
+        int error = 0;
+       #if JUCE_MAC || JUCE_IOS
+        fstore_t store{F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(bytes), 0};
+        if (::fcntl(fd, F_PREALLOCATE, &store) == -1)
+        {
+            store.fst_flags = F_ALLOCATEALL;   // contiguous space not available: any will do
+            if (::fcntl(fd, F_PREALLOCATE, &store) == -1)
+                error = errno;
+        }
+
+        if (error == 0 && ::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+            error = errno;
+       #else
+        error = ::posix_fallocate(fd, 0, static_cast<off_t>(bytes));   // returns the error
+       #endif
+
+        ::close(fd);
+
+        if (error != 0)
+            return juce::Result::fail("cannot allocate " + juce::File::descriptionOfSizeInBytes(bytes)
+                                      + ": " + std::strerror(error));
+       #endif
+
+        return juce::Result::ok();
+    }
+}
+
+struct SessionRecorder::Segment
+{
+    int index{0};
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    uint64_t firstFrame{0};
+    uint64_t numFrames{0};
+    int usedBlocks{0};
+};
+
+SessionRecorder::SessionRecorder(DeviceManager& dm)
+    : deviceManager(dm)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    stop();
+}
+
+bool SessionRecorder::start(const juce::File& parentDirectory, const Settings& newSettings)
+{
+    stop();
+
+    {
+        const juce::ScopedLock lock(errorLock);
+        errorMessage.clear();
+    }
+
+    auto* device = deviceManager.getAudioDeviceManager().getCurrentAudioDevice();
+    if (device == nullptr || !device->isOpen())
+    {
+        setError("no audio device is running");
+        return false;
+    }
+
+    settings = newSettings;
+    settings.blockFrames = juce::jlimit(256, 65536, settings.blockFrames);
+    sampleRate = device->getCurrentSampleRate();
+    numChannels = device->getActiveInputChannels().countNumberOfSetBits();
+
+    if (numChannels <= 0 || sampleRate <= 0.0)
+    {
+        setError("the device has no active inputs");
+        return false;
+    }
+
+    sessionDirectory = parentDirectory.getChildFile("Session_" + juce::Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S"));
+    const auto created = sessionDirectory.createDirectory();
+    if (created.failed())
+    {
+        setError("cannot create " + sessionDirectory.getFullPathName() + ": " + created.getErrorMessage());
+        return false;
+    }
+
+    const auto framesFor = [this](double seconds) { return juce::roundToInt(std::ceil(seconds * sampleRate)); };
+
+    // Everything the audio and drain threads touch is sized here, before they start
+    captureRing.prepare(numChannels, framesFor(juce::jmax(0.1, settings.captureRingSeconds)));
+    channelPointers.assign(static_cast<size_t>(numChannels), nullptr);
+    blockLanes.assign(static_cast<size_t>(numChannels), nullptr);
+
+    maxSpillBlocks = juce::jmax(2, framesFor(settings.maxSpillSeconds) / settings.blockFrames + 1);
+    blocksPerSegment = juce::jmax(1, framesFor(settings.segmentSeconds) / settings.blockFrames);
+
+    filledBlocks.clear();
+    freeBlocks.clear();
+    allocatedBlocks = 0;
+    for (int i = 0; i < residentBlocks; ++i)
+    {
+        auto block = std::make_unique<Block>();
+        block->samples.reset(new float[static_cast<size_t>(settings.blockFrames) * static_cast<size_t>(numChannels)]);
+        freeBlocks.push_back(std::move(block));
+        ++allocatedBlocks;
+    }
+
+    capturedFrames.store(0);
+    droppedFrames.store(0);
+    dropoutCount.store(0);
+    lastDropEnd = ~uint64_t(0);
+    dropoutFifo.reset();
+    dropouts.clear();
+    finishedSegments.clear();
+    spillHighWater.store(0);
+    writtenFrames.store(0);
+    lostOnDiskFrames.store(0);
+    maxBlockWriteMs.store(0.0);
+    numSegments.store(0);
+    diskFailed.store(false);
+
+    currentSegment = createSegment(0);
+    nextSegment.reset();
+    if (currentSegment == nullptr)
+        return false;
+
+    writeIndex();
+
+    drainThread = std::make_unique<Worker>("SessionRecorder drain", [this] { drainLoop(); });
+    diskThread = std::make_unique<Worker>("SessionRecorder disk", [this] { diskLoop(); });
+    drainThread->startThread(juce::Thread::Priority::high);
+    diskThread->startThread(juce::Thread::Priority::normal);
+
+    recording.store(true, std::memory_order_release);
+    deviceManager.addAudioCallback(this);
+
+    juce::Logger::writeToLog("SessionRecorder: recording " + juce::String(numChannels) + " ch @ "
+                             + juce::String(sampleRate, 0) + " Hz to " + sessionDirectory.getFullPathName());
+    return true;
+}
+
+void SessionRecorder::stop()
+{
+    if (drainThread == nullptr)
+        return;
+
+    // After removeAudioCallback() returns the audio thread is out of the callback for good
+    recording.store(false, std::memory_order_release);
+    deviceManager.removeAudioCallback(this);
+
+    // Drain thread flushes what is left in the ring (including a partial last block),
+    // then the disk thread writes out the spill; both may take a while after a stall
+    drainThread->signalThreadShouldExit();
+    drainThread->notify();
+    drainThread->stopThread(-1);
+
+    diskThread->signalThreadShouldExit();
+    diskThread->notify();
+    diskThread->stopThread(-1);
+
+    drainThread.reset();
+    diskThread.reset();
+
+    collectDropouts();
+
+    if (currentSegment != nullptr)
+        finishSegment(*currentSegment);
+
+    // A pre-created segment that was never used
+    if (nextSegment != nullptr)
+    {
+        nextSegment->mapping.reset();
+        nextSegment->file.deleteFile();
+    }
+
+    writeIndex();
+    currentSegment.reset();
+    nextSegment.reset();
+
+    {
+        const juce::ScopedLock lock(spillLock);
+        filledBlocks.clear();
+        freeBlocks.clear();
+        allocatedBlocks = 0;
+    }
+
+    const auto stats = getStats();
+    juce::Logger::writeToLog("SessionRecorder: stopped, " + juce::String(static_cast<juce::int64>(stats.writtenFrames))
+                             + " frames written, " + juce::String(static_cast<juce::int64>(stats.droppedFrames))
+                             + " dropped in " + juce::String(static_cast<juce::int64>(stats.dropouts))
+                             + " dropouts, spill peak " + juce::String(stats.spillHighWaterBlocks) + "/"
+                             + juce::String(stats.maxSpillBlocks) + " blocks, slowest block "
+                             + juce::String(stats.maxBlockWriteMs, 1) + " ms");
+}
+
+SessionRecorder::Stats SessionRecorder::getStats() const
+{
+    Stats stats;
+    stats.recording = recording.load();
+    stats.capturedFrames = capturedFrames.load();
+    stats.writtenFrames = writtenFrames.load();
+    stats.droppedFrames = droppedFrames.load();
+    stats.dropouts = dropoutCount.load();
+    stats.lostOnDiskFrames = lostOnDiskFrames.load();
+    stats.spillHighWaterBlocks = spillHighWater.load();
+    stats.maxSpillBlocks = maxSpillBlocks;
+    stats.maxBlockWriteMs = maxBlockWriteMs.load();
+    stats.numSegments = numSegments.load();
+
+    {
+        const juce::ScopedLock lock(spillLock);
+        stats.spillBlocks = static_cast<int>(filledBlocks.size());
+    }
+
+    {
+        const juce::ScopedLock lock(errorLock);
+        stats.error = errorMessage;
+    }
+
+    return stats;
+}
+
+//==============================================================================
+void SessionRecorder::audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                                       int numInputChannels,
+                                                       float* const* outputChannelData,
+                                                       int numOutputChannels,
+                                                       int numSamples,
+                                                       const juce::AudioIODeviceCallbackContext& context)
+{
+    juce::ignoreUnused(outputChannelData, numOutputChannels, context);
+
+    if (!recording.load(std::memory_order_acquire) || inputChannelData == nullptr || numSamples <= 0)
+        return;
+
+    // Channels the device did not deliver this time are recorded as silence
+    const int numDelivered = juce::jmin(numInputChannels, numChannels);
+    for (int ch = 0; ch < numChannels; ++ch)
+        channelPointers[static_cast<size_t>(ch)] = ch < numDelivered ? inputChannelData[ch] : nullptr;
+
+    const int pushed = captureRing.push(channelPointers.data(), numSamples);
+    const uint64_t captured = capturedFrames.load(std::memory_order_relaxed) + static_cast<uint64_t>(pushed);
+    capturedFrames.store(captured, std::memory_order_relaxed);
+
+    if (pushed == numSamples)
+        return;
+
+    const auto missing = static_cast<uint64_t>(numSamples - pushed);
+    droppedFrames.fetch_add(missing, std::memory_order_relaxed);
+
+    // Consecutive dropped blocks form one gap; the disk thread merges their queue entries
+    if (captured != lastDropEnd)
+        dropoutCount.fetch_add(1, std::memory_order_relaxed);
+    lastDropEnd = captured;
+
+    int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+    dropoutFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+    {
+        dropoutQueue[static_cast<size_t>(start1)] = {captured, missing};
+        dropoutFifo.finishedWrite(1);
+    }
+}
+
+void SessionRecorder::audioDeviceAboutToStart(juce::AudioIODevice* device)
+{
+    if (device == nullptr || !recording.load())
+        return;
+
+    // The files have one sample rate and channel layout: a different device ends the capture
+    if (device->getCurrentSampleRate() != sampleRate
+        || device->getActiveInputChannels().countNumberOfSetBits() != numChannels)
+    {
+        recording.store(false);
+        setError("device format changed, capture stopped");
+    }
+}
+
+void SessionRecorder::audioDeviceStopped()
+{
+}
+
+//==============================================================================
+void SessionRecorder::drainLoop()
+{
+    while (!drainThread->threadShouldExit())
+    {
+        while (drainOnce(false))
+        {
+        }
+
+        // Polled: the audio thread never signals anything. A few ms is far below the ring length.
+        drainThread->wait(2);
+    }
+
+    // Final flush; waits for the disk thread to hand back blocks if the spill is full
+    while (captureRing.available() > 0)
+    {
+        if (!drainOnce(true))
+            drainThread->wait(5);
+    }
+}
+
+bool SessionRecorder::drainOnce(bool flushPartial)
+{
+    const int available = captureRing.available();
+    if (available <= 0 || (available < settings.blockFrames && !flushPartial))
+        return false;
+
+    std::unique_ptr<Block> block;
+    bool allocate = false;
+    {
+        const juce::ScopedLock lock(spillLock);
+        if (!freeBlocks.empty())
+        {
+            block = std::move(freeBlocks.back());
+            freeBlocks.pop_back();
+        }
+        else if (allocatedBlocks < maxSpillBlocks)
+        {
+            ++allocatedBlocks;
+            allocate = true;
+        }
+    }
+
+    // Spill full: leave the frames in the ring (which starts dropping once it is full too)
+    if (block == nullptr && !allocate)
+        return false;
+
+    const size_t laneSize = static_cast<size_t>(settings.blockFrames);
+    if (allocate)
+    {
+        block = std::make_unique<Block>();
+        block->samples.reset(new float[laneSize * static_cast<size_t>(numChannels)]);
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        blockLanes[static_cast<size_t>(ch)] = block->samples.get() + static_cast<size_t>(ch) * laneSize;
+
+    const int frames = captureRing.pop(blockLanes.data(), juce::jmin(available, settings.blockFrames));
+
+    // Only the last block of a session is partial: pad it, the index has the real length
+    if (frames < settings.blockFrames)
+        for (auto* lane : blockLanes)
+            std::fill(lane + frames, lane + laneSize, 0.0f);
+
+    block->numFrames = frames;
+
+    {
+        const juce::ScopedLock lock(spillLock);
+        filledBlocks.push_back(std::move(block));
+        spillHighWater.store(juce::jmax(spillHighWater.load(), static_cast<int>(filledBlocks.size())));
+    }
+
+    diskThread->notify();
+    return true;
+}
+
+void SessionRecorder::diskLoop()
+{
+    for (;;)
+    {
+        // Create the next segment early, so a roll-over never waits for the file system
+        if (nextSegment == nullptr && currentSegment != nullptr && !diskFailed.load()
+            && currentSegment->usedBlocks >= blocksPerSegment / 2)
+            nextSegment = createSegment(numSegments.load());
+
+        std::unique_ptr<Block> block;
+        {
+            const juce::ScopedLock lock(spillLock);
+            if (!filledBlocks.empty())
+            {
+                block = std::move(filledBlocks.front());
+                filledBlocks.pop_front();
+            }
+        }
+
+        if (block == nullptr)
+        {
+            // stop() only asks us to exit once the drain thread has flushed everything
+            if (diskThread->threadShouldExit())
+                break;
+
+            diskThread->wait(20);
+            continue;
+        }
+
+        writeBlock(*block);
+
+        {
+            const juce::ScopedLock lock(spillLock);
+            freeBlocks.push_back(std::move(block));
+
+            // Give back memory taken during a stall once the backlog is gone
+            if (filledBlocks.empty())
+            {
+                while (static_cast<int>(freeBlocks.size()) > residentBlocks)
+                {
+                    freeBlocks.pop_back();
+                    --allocatedBlocks;
+                }
+            }
+        }
+
+        collectDropouts();
+    }
+}
+
+void SessionRecorder::writeBlock(Block& block)
+{
+    if (diskFailed.load())
+    {
+        lostOnDiskFrames.fetch_add(static_cast<uint64_t>(block.numFrames));
+        return;
+    }
+
+    if (currentSegment->usedBlocks >= blocksPerSegment)
+    {
+        finishSegment(*currentSegment);
+        currentSegment = nextSegment != nullptr ? std::move(nextSegment) : createSegment(numSegments.load());
+
+        if (currentSegment == nullptr)
+        {
+            diskFailed.store(true);
+            lostOnDiskFrames.fetch_add(static_cast<uint64_t>(block.numFrames));
+            writeIndex();
+            return;
+        }
+
+        currentSegment->firstFrame = writtenFrames.load();
+        writeIndex();
+    }
+
+    const size_t blockBytes = sizeof(float) * static_cast<size_t>(settings.blockFrames) * static_cast<size_t>(numChannels);
+    auto* destination = static_cast<char*>(currentSegment->mapping->getData())
+                      + blockBytes * static_cast<size_t>(currentSegment->usedBlocks);
+
+    // Page faults on the mapping are where a slow disk shows up
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    std::memcpy(destination, block.samples.get(), blockBytes);
+    const double ms = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+
+    if (ms > maxBlockWriteMs.load())
+        maxBlockWriteMs.store(ms);
+
+    ++currentSegment->usedBlocks;
+    currentSegment->numFrames += static_cast<uint64_t>(block.numFrames);
+    writtenFrames.fetch_add(static_cast<uint64_t>(block.numFrames));
+}
+
+std::unique_ptr<SessionRecorder::Segment> SessionRecorder::createSegment(int index)
+{
+    auto segment = std::make_unique<Segment>();
+    segment->index = index;
+    segment->file = sessionDirectory.getChildFile(juce::String::formatted("capture_%04d.raw", index));
+
+    const juce::int64 bytes = static_cast<juce::int64>(sizeof(float)) * settings.blockFrames * numChannels * blocksPerSegment;
+
+    // Reserve the full segment on disk, then map it. Running out of space fails here
+    // (diskFailed, lostOnDiskFrames) rather than as a fault in writeBlock()'s memcpy.
+    const auto reserved = reserveFile(segment->file, bytes);
+    if (reserved.failed())
+    {
+        segment->file.deleteFile();
+        setError("cannot create " + segment->file.getFullPathName() + ": " + reserved.getErrorMessage());
+        return nullptr;
+    }
+
+    segment->mapping = std::make_unique<juce::MemoryMappedFile>(segment->file, juce::MemoryMappedFile::readWrite);
+    if (segment->mapping->getData() == nullptr || static_cast<juce::int64>(segment->mapping->getSize()) < bytes)
+    {
+        setError("cannot map " + segment->file.getFullPathName());
+        return nullptr;
+    }
+
+    numSegments.fetch_add(1);
+    return segment;
+}
+
+void SessionRecorder::finishSegment(Segment& segment)
+{
+    segment.mapping.reset();
+
+    if (segment.usedBlocks == 0)
+    {
+        segment.file.deleteFile();
+        numSegments.fetch_sub(1);
+        return;
+    }
+
+    // Cut off the preallocated space that was never used (last segment only)
+    if (segment.usedBlocks < blocksPerSegment)
+    {
+        juce::FileOutputStream out(segment.file);
+        if (out.openedOk() && out.setPosition(static_cast<juce::int64>(sizeof(float)) * settings.blockFrames * numChannels
+                                              * segment.usedBlocks))
+            out.truncate();
+    }
+
+    auto* entry = new juce::DynamicObject();
+    entry->setProperty("file", segment.file.getFileName());
+    entry->setProperty("firstFrame", static_cast<juce::int64>(segment.firstFrame));
+    entry->setProperty("numFrames", static_cast<juce::int64>(segment.numFrames));
+    entry->setProperty("blocks", segment.usedBlocks);
+    finishedSegments.push_back(juce::var(entry));
+}
+
+void SessionRecorder::collectDropouts()
+{
+    int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+    const int ready = dropoutFifo.getNumReady();
+    dropoutFifo.prepareToRead(ready, start1, size1, start2, size2);
+
+    const auto add = [this](const Dropout& dropout)
+    {
+        if (!dropouts.empty() && dropouts.back().fileFrame == dropout.fileFrame)
+            dropouts.back().missingFrames += dropout.missingFrames;
+        else
+            dropouts.push_back(dropout);
+    };
+
+    for (int i = 0; i < size1; ++i)
+        add(dropoutQueue[static_cast<size_t>(start1 + i)]);
+    for (int i = 0; i < size2; ++i)
+        add(dropoutQueue[static_cast<size_t>(start2 + i)]);
+
+    dropoutFifo.finishedRead(size1 + size2);
+}
+
+void SessionRecorder::writeIndex()
+{
+    auto* root = new juce::DynamicObject();
+    root->setProperty("format", "AudioCoPilot raw planar float32");
+    root->setProperty("version", 1);
+    root->setProperty("byteOrder", juce::ByteOrder::isBigEndian() ? "big" : "little");
+    root->setProperty("sampleRate", sampleRate);
+    root->setProperty("numChannels", numChannels);
+    root->setProperty("blockFrames", settings.blockFrames);
+    root->setProperty("totalFrames", static_cast<juce::int64>(writtenFrames.load()));
+    root->setProperty("droppedFrames", static_cast<juce::int64>(droppedFrames.load()));
+    root->setProperty("lostOnDiskFrames", static_cast<juce::int64>(lostOnDiskFrames.load()));
+
+    juce::Array<juce::var> segments(finishedSegments.data(), static_cast<int>(finishedSegments.size()));
+    if (currentSegment != nullptr && currentSegment->usedBlocks > 0 && currentSegment->mapping != nullptr)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("file", currentSegment->file.getFileName());
+        entry->setProperty("firstFrame", static_cast<juce::int64>(currentSegment->firstFrame));
+        entry->setProperty("numFrames", static_cast<juce::int64>(currentSegment->numFrames));
+        entry->setProperty("blocks", currentSegment->usedBlocks);
+        segments.add(juce::var(entry));
+    }
+    root->setProperty("segments", segments);
+
+    // Gaps: missingFrames were lost right before file frame fileFrame
+    juce::Array<juce::var> gaps;
+    for (const auto& dropout : dropouts)
+    {
+        auto* gap = new juce::DynamicObject();
+        gap->setProperty("fileFrame", static_cast<juce::int64>(dropout.fileFrame));
+        gap->setProperty("missingFrames", static_cast<juce::int64>(dropout.missingFrames));
+        gaps.add(juce::var(gap));
+    }
+    root->setProperty("dropouts", gaps);
+
+    sessionDirectory.getChildFile("session.json").replaceWithText(juce::JSON::toString(juce::var(root)));
+}
+
+void SessionRecorder::setError(const juce::String& message)
+{
+    juce::Logger::writeToLog("SessionRecorder: " + message);
+
+    const juce::ScopedLock lock(errorLock);
+    errorMessage = message;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "DeviceManager.h"
+#include "AudioFrameRing.h"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * SessionRecorder
+ *
+ * Captures every input channel the device delivers to disk, for re-analysis after
+ * the show.
+ *
+ * Audio thread -> capture ring -> drain thread -> spill blocks -> disk thread -> segment files
+ *
+ * - Audio callback: one AudioFrameRing::push per block, no allocation, no locks.
+ *   Frames that do not fit are dropped and counted, and the position of the gap is
+ *   queued (lock-free) so the index can say where the timeline has holes
+ * - Drain thread: moves the ring into fixed-size planar blocks. Blocks are allocated on
+ *   demand up to maxSpillSeconds, so a disk stall costs RAM instead of audio; only when
+ *   the spill is full does the capture ring fill up and drop
+ * - Disk thread: copies each block into a preallocated, memory-mapped segment file
+ *   (the next segment is created while the current one is still half empty)
+ *
+ * On-disk format (raw planar float32 with a sidecar index):
+ *   <session>/capture_0000.raw, capture_0001.raw, ...  consecutive blocks of blockFrames
+ *       frames; inside a block channel 0's samples first, then channel 1, ...
+ *   <session>/session.json  sample rate, channels, block size, segments, total frames,
+ *       dropouts (file frame + missing frames); rewritten on every segment and at stop()
+ */
+class SessionRecorder : public juce::AudioIODeviceCallback
+{
+public:
+    struct Settings
+    {
+        int blockFrames{4096};
+        double segmentSeconds{60.0};
+        double captureRingSeconds{1.0};
+        double maxSpillSeconds{20.0};
+    };
+
+    struct Stats
+    {
+        bool recording{false};
+        uint64_t capturedFrames{0};     // accepted by the capture ring
+        uint64_t writtenFrames{0};      // copied into segment files
+        uint64_t droppedFrames{0};      // lost at the capture ring (spill and ring full)
+        uint64_t dropouts{0};           // number of separate gaps
+        uint64_t lostOnDiskFrames{0};   // discarded after a disk error
+        int spillBlocks{0};             // blocks waiting for the disk right now
+        int spillHighWaterBlocks{0};
+        int maxSpillBlocks{0};
+        double maxBlockWriteMs{0.0};    // slowest block copy into the mapping (page faults, stalls)
+        int numSegments{0};
+        juce::String error;
+    };
+
+    SessionRecorder(DeviceManager& deviceManager);
+    ~SessionRecorder() override;
+
+    // Message thread. Records all active inputs of the running device into a new
+    // "Session_<date>" folder inside parentDirectory. False (and getStats().error) on failure.
+    bool start(const juce::File& parentDirectory, const Settings& settings);
+    bool start(const juce::File& parentDirectory) { return start(parentDirectory, Settings()); }
+
+    // Message thread. Flushes everything captured so far and finalizes files and index.
+    void stop();
+
+    bool isRecording() const { return recording.load(); }
+    juce::File getSessionDirectory() const { return sessionDirectory; }
+
+    // Any thread
+    Stats getStats() const;
+
+    // Audio callbacks
+    void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                          int numInputChannels,
+                                          float* const* outputChannelData,
+                                          int numOutputChannels,
+                                          int numSamples,
+                                          const juce::AudioIODeviceCallbackContext& context) override;
+    void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+
+private:
+    // Planar block of blockFrames frames per channel (same layout as in the file)
+    struct Block
+    {
+        std::unique_ptr<float[]> samples;
+        int numFrames{0};
+    };
+
+    struct Segment;
+
+    struct Dropout
+    {
+        uint64_t fileFrame{0};
+        uint64_t missingFrames{0};
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(const juce::String& name, std::function<void()> body) : juce::Thread(name), loop(std::move(body)) {}
+        void run() override { loop(); }
+
+    private:
+        std::function<void()> loop;
+    };
+
+    void drainLoop();
+    void diskLoop();
+    bool drainOnce(bool flushPartial);
+    void writeBlock(Block& block);
+    std::unique_ptr<Segment> createSegment(int index);
+    void finishSegment(Segment& segment);
+    void collectDropouts();
+    void writeIndex();
+    void setError(const juce::String& message);
+
+    DeviceManager& deviceManager;
+    Settings settings;
+    double sampleRate{0.0};
+    int numChannels{0};
+    juce::File sessionDirectory;
+
+    // Audio thread side
+    AudioCoPilot::AudioFrameRing captureRing;
+    std::vector<const float*> channelPointers;
+    std::atomic<bool> recording{false};
+    std::atomic<uint64_t> capturedFrames{0};
+    std::atomic<uint64_t> droppedFrames{0};
+    uint64_t lastDropEnd{0};   // audio thread only: captured frame count at the last drop
+
+    // Gaps reported by the audio thread (single producer / single consumer)
+    static constexpr int maxQueuedDropouts = 256;
+    juce::AbstractFifo dropoutFifo{maxQueuedDropouts};
+    std::array<Dropout, maxQueuedDropouts> dropoutQueue;
+    std::atomic<uint64_t> dropoutCount{0};
+
+    // Spill: filled blocks waiting for the disk, and recycled empty ones
+    juce::CriticalSection spillLock;
+    std::deque<std::unique_ptr<Block>> filledBlocks;
+    std::vector<std::unique_ptr<Block>> freeBlocks;
+    int allocatedBlocks{0};
+    static constexpr int residentBlocks = 8;   // kept allocated between stalls
+    int maxSpillBlocks{0};
+    std::atomic<int> spillHighWater{0};
+    std::vector<float*> blockLanes;   // drain thread scratch
+
+    // Disk thread side
+    std::unique_ptr<Segment> currentSegment;
+    std::unique_ptr<Segment> nextSegment;
+    std::vector<juce::var> finishedSegments;
+    std::vector<Dropout> dropouts;
+    int blocksPerSegment{0};
+    std::atomic<uint64_t> writtenFrames{0};
+    std::atomic<uint64_t> lostOnDiskFrames{0};
+    std::atomic<double> maxBlockWriteMs{0.0};
+    std::atomic<int> numSegments{0};
+    std::atomic<bool> diskFailed{false};
+
+    std::unique_ptr<Worker> drainThread;
+    std::unique_ptr<Worker> diskThread;
+
+    mutable juce::CriticalSection errorLock;
+    juce::String errorMessage;
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace AudioCoPilot
+{
+/**
+ * SpectrumHistory
+ *
+ * Fixed-memory history of spectra for the spectrogram / waterfall views, one writer
+ * (the analysis that produces the spectra) and any number of readers.
+ *
+ * - Each column is one spectrum resampled onto a fixed log-frequency grid
+ *   (rowsPerOctave rows between minHz and maxHz, peak of the FFT bins per row), so
+ *   the size does not depend on the FFT size or on the RTA resolution
+ * - Values are stored as 8-bit dB codes between floorDb and ceilingDb (256 steps,
+ *   e.g. 0.4 dB for a 100 dB range): minutes of history cost a few MB
+ * - The ring never grows; once full, the oldest column is overwritten
+ * - Same sequence scheme as MirroredAudioHistory: readers copy a column, then check
+ *   that the writer did not reach it in the meantime
+ *
+ * prepare() swaps in a new block of storage; readers holding the previous Columns
+ * keep it alive until they let go, so a re-prepare never pulls memory from under the UI.
+ * createColumns() + install() split it in two, so the writer can switch layouts without
+ * allocating (the storage is built elsewhere and the old one is released elsewhere).
+ */
+class SpectrumHistory
+{
+public:
+    struct Settings
+    {
+        double sampleRate { 48000.0 };
+        int fftSize { 4096 };
+        double columnsPerSecond { 10.0 };
+        double historySeconds { 300.0 };
+        float floorDb { -100.0f };
+        float ceilingDb { 0.0f };
+        float minHz { 20.0f };
+        float maxHz { 20000.0f };
+        int rowsPerOctave { 48 };
+    };
+
+    // One prepared layout: the ring plus everything needed to interpret it
+    class Columns
+    {
+    public:
+        int getNumRows() const noexcept { return numRows; }
+        int getCapacity() const noexcept { return capacity; }
+        double getColumnsPerSecond() const noexcept { return settings.columnsPerSecond; }
+        float getFloorDb() const noexcept { return settings.floorDb; }
+        float getCeilingDb() const noexcept { return settings.ceilingDb; }
+
+        // Centre frequency of a row (row 0 = minHz)
+        float getRowFrequency (int row) const noexcept
+        {
+            return settings.minHz * std::pow (2.0f, (float) row / (float) settings.rowsPerOctave);
+        }
+
+        // Fractional row of a frequency (inverse of getRowFrequency)
+        float getRowForFrequency (float hz) const noexcept
+        {
+            return std::log2 (juce::jmax (1.0f, hz) / settings.minHz) * (float) settings.rowsPerOctave;
+        }
+
+        float decode (uint8_t code) const noexcept
+        {
+            return settings.floorDb + (float) code * (settings.ceilingDb - settings.floorDb) / 255.0f;
+        }
+
+        // Columns written so far; column indices are absolute (0 = first column after prepare)
+        uint64_t getTotal() const noexcept { return written.load (std::memory_order_acquire); }
+
+        // First column that can still be read
+        uint64_t getOldest() const noexcept
+        {
+            const uint64_t w = getTotal();
+            return w > (uint64_t) capacity ? w - (uint64_t) capacity : 0;
+        }
+
+        // Reader: copies getNumRows() codes of one column (row 0 first). False if the column
+        // does not exist yet or was overwritten while copying (dest is then undefined).
+        bool readColumn (uint64_t column, uint8_t* dest) const noexcept
+        {
+            if (column >= getTotal() || column < getOldest())
+                return false;
+
+            std::memcpy (dest, getColumn (column), (size_t) numRows);
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+            return column + (uint64_t) capacity > claimed.load (std::memory_order_relaxed);
+        }
+
+    private:
+        friend class SpectrumHistory;
+
+        uint8_t* getColumn (uint64_t column) const noexcept
+        {
+            return codes.get() + (size_t) (column % (uint64_t) capacity) * (size_t) numRows;
+        }
+
+        Settings settings;
+        int numRows { 0 };
+        int capacity { 0 };
+        std::vector<int> rowFirstBin, rowLastBin;
+        std::unique_ptr<uint8_t[]> codes;
+        std::vector<uint8_t> scratch;   // writer only: one quantized column
+        std::atomic<uint64_t> written { 0 };
+        std::atomic<uint64_t> claimed { 0 };
+    };
+
+    // Not real-time safe: call while the writer is stopped. Readers may keep running.
+    void prepare (const Settings& newSettings)
+    {
+        auto columns = createColumns (newSettings);
+        install (columns);
+    }
+
+    // Any thread, not real-time safe: storage for install()
+    static std::shared_ptr<Columns> createColumns (const Settings& newSettings)
+    {
+        auto columns = std::make_shared<Columns>();
+        auto& s = columns->settings;
+        s = newSettings;
+        s.fftSize = juce::jmax (2, s.fftSize);
+        s.rowsPerOctave = juce::jlimit (1, 96, s.rowsPerOctave);
+        s.columnsPerSecond = juce::jmax (0.1, s.columnsPerSecond);
+        s.maxHz = juce::jlimit (s.minHz * 2.0f, (float) s.sampleRate * 0.5f, s.maxHz);
+        if (s.ceilingDb <= s.floorDb)
+            s.ceilingDb = s.floorDb + 1.0f;
+
+        columns->numRows = juce::jmax (1, (int) std::floor (std::log2 (s.maxHz / s.minHz) * (float) s.rowsPerOctave) + 1);
+        columns->capacity = juce::jlimit (2, maxCapacity, (int) std::ceil (s.historySeconds * s.columnsPerSecond));
+        columns->codes.reset (new uint8_t[(size_t) columns->capacity * (size_t) columns->numRows]);
+        std::memset (columns->codes.get(), 0, (size_t) columns->capacity * (size_t) columns->numRows);
+
+        // FFT bins covered by each row (edges halfway between row centres in log frequency);
+        // rows narrower than a bin take the nearest bin
+        const double binWidth = s.sampleRate / (double) s.fftSize;
+        const int lastBin = s.fftSize / 2;
+        const double halfRow = std::pow (2.0, 0.5 / (double) s.rowsPerOctave);
+
+        columns->rowFirstBin.resize ((size_t) columns->numRows);
+        columns->rowLastBin.resize ((size_t) columns->numRows);
+
+        for (int row = 0; row < columns->numRows; ++row)
+        {
+            const double centre = (double) columns->getRowFrequency (row);
+            int first = (int) std::ceil (centre / halfRow / binWidth);
+            int last = (int) std::floor (centre * halfRow / binWidth);
+
+            if (last < first)
+                first = last = (int) std::lround (centre / binWidth);
+
+            columns->rowFirstBin[(size_t) row] = juce::jlimit (0, lastBin, first);
+            columns->rowLastBin[(size_t) row] = juce::jlimit (0, lastBin, last);
+        }
+
+        columns->scratch.assign ((size_t) columns->numRows, 0);
+        return columns;
+    }
+
+    // Writer (or while the writer is stopped): switches to columns from createColumns(), without
+    // allocating or freeing. On return, columns holds the previous storage (may be nullptr);
+    // readers still holding it keep it alive.
+    void install (std::shared_ptr<Columns>& columns) noexcept
+    {
+        std::swap (writerColumns, columns);
+        std::atomic_store (&current, std::shared_ptr<const Columns> (writerColumns));
+        generation.fetch_add (1, std::memory_order_release);
+    }
+
+    // Any thread: the current layout and ring (nullptr before the first prepare)
+    std::shared_ptr<const Columns> getColumns() const { return std::atomic_load (&current); }
+
+    // Any thread: advances with every column and every prepare (for FrameScheduler)
+    uint64_t getGeneration() const noexcept { return generation.load (std::memory_order_acquire); }
+
+    // Writer: one spectrum of linear magnitudes (bins 0 .. fftSize / 2), stored as 20 * log10
+    void pushMagnitudes (const float* magnitudes, int numBins) noexcept
+    {
+        push (magnitudes, numBins, [] (float peak) { return 20.0f * std::log10 (peak + 1.0e-5f); });
+    }
+
+    // Writer: one spectrum already in dB (bins 0 .. fftSize / 2)
+    void pushDecibels (const float* decibels, int numBins) noexcept
+    {
+        push (decibels, numBins, [] (float peak) { return peak; });
+    }
+
+private:
+    template <typename ToDecibels>
+    void push (const float* bins, int numBins, ToDecibels toDecibels) noexcept
+    {
+        auto* columns = writerColumns.get();
+        if (columns == nullptr || bins == nullptr || numBins <= 0)
+            return;
+
+        const auto& s = columns->settings;
+        const float scale = 255.0f / (s.ceilingDb - s.floorDb);
+
+        // Quantize into scratch first, so the ring slot is claimed only for the copy
+        for (int row = 0; row < columns->numRows; ++row)
+        {
+            const int first = juce::jmin (columns->rowFirstBin[(size_t) row], numBins - 1);
+            const int last = juce::jmin (columns->rowLastBin[(size_t) row], numBins - 1);
+
+            float peak = bins[first];
+            for (int bin = first + 1; bin <= last; ++bin)
+                peak = juce::jmax (peak, bins[bin]);
+
+            const float code = (toDecibels (peak) - s.floorDb) * scale;
+            columns->scratch[(size_t) row] = (uint8_t) juce::jlimit (0, 255, (int) (code + 0.5f));
+        }
+
+        const uint64_t w = columns->written.load (std::memory_order_relaxed);
+
+        columns->claimed.store (w + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        std::memcpy (columns->getColumn (w), columns->scratch.data(), (size_t) columns->numRows);
+
+        columns->written.store (w + 1, std::memory_order_release);
+        generation.fetch_add (1, std::memory_order_release);
+    }
+
+    // 1 hour at 100 columns per second
+    static constexpr int maxCapacity = 360000;
+
+    std::shared_ptr<const Columns> current;
+    std::shared_ptr<Columns> writerColumns;
+    std::atomic<uint64_t> generation { 0 };
+};
+}
@@ -9,7 +9,7 @@ FFTAnalyzer::~FFTAnalyzer()
 {
 }
 
-void FFTAnalyzer::prepare(int newFFTSize, double newSampleRate)
+void FFTAnalyzer::prepare(int newFFTSize, double newSampleRate, Window newWindow)
 {
     juce::ScopedLock lock(processLock);
     
@@ -20,27 +20,34 @@ void FFTAnalyzer::prepare(int newFFTSize, double newSampleRate)
     
     sampleRate = newSampleRate;
     
-    // Create FFT
-    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+    // Shared FFT engine on the selected backend (see FFTPlanCache, FFTEngine)
+    fft = AudioCoPilot::FFTPlanCache::getEngine(fftOrder);
     
     // Prepare buffers
     fftData.resize(fftSize * 2);  // Real + Imaginary
+    fftScratch.assign(fft->getScratchSize(), 0.0f);
     windowedData.resize(fftSize);
     
-    // Create Hann window
-    window.resize(fftSize);
-    for (int i = 0; i < fftSize; ++i)
+    // Window (cosine sums, symmetric), also shared
+    windowType = newWindow;
+    window = AudioCoPilot::FFTPlanCache::getWindow(fftSize, windowType);
+    windowPower = window->power;
+}
+
+juce::String FFTAnalyzer::getWindowName(Window window)
+{
+    switch (window)
     {
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / (fftSize - 1)));
+        case Window::blackmanHarris: return "Blackman-Harris";
+        case Window::flatTop:        return "Flat-top";
+        case Window::hann:
+        default:                     return "Hann";
     }
 }
 
 void FFTAnalyzer::applyWindow(float* data, int size)
 {
-    for (int i = 0; i < size; ++i)
-    {
-        data[i] *= window[i];
-    }
+    juce::FloatVectorOperations::multiply(data, window->samples.data(), size);
 }
 
 void FFTAnalyzer::processBlock(const float* input, int numSamples, std::vector<std::complex<float>>& output)
@@ -70,10 +77,10 @@ void FFTAnalyzer::processBlock(const float* input, int numSamples, std::vector<s
     std::copy(windowedData.begin(), windowedData.end(), fftData.begin());
     std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
     
-    // Perform FFT using juce::dsp::FFT
+    // Perform FFT
     if (fft != nullptr)
     {
-        fft->performRealOnlyForwardTransform(fftData.data(), true);
+        fft->performRealForward(fftData.data(), fftScratch.data());
         
         // Convert to complex output (only positive frequencies)
         // After performRealOnlyForwardTransform, fftData contains interleaved complex pairs
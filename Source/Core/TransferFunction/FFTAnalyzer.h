@@ -1,21 +1,28 @@
 #pragma once
 
 #include "../../JuceHeader.h"
+#include "../FFTPlanCache.h"
 
 /**
  * FFTAnalyzer
  * 
  * Performs FFT analysis on audio buffers.
  * Thread-safe for use in audio callback and processing thread.
+ * The FFT engine (backend: see AudioCoPilot::FFTEngine) and window come from
+ * AudioCoPilot::FFTPlanCache, so prepare() only allocates this analyzer's buffers.
  */
 class FFTAnalyzer
 {
 public:
+    // Analysis window: Hann (default), Blackman-Harris (4-term, lower leakage),
+    // flat-top (amplitude-accurate peaks, wide main lobe)
+    using Window = AudioCoPilot::FFTPlanCache::Window;
+    
     FFTAnalyzer();
     ~FFTAnalyzer();
     
     // Setup FFT with desired size (must be power of 2)
-    void prepare(int fftSize, double sampleRate);
+    void prepare(int fftSize, double sampleRate, Window window = Window::hann);
     
     // Process audio buffer and return FFT result
     // Returns complex spectrum (size = fftSize/2 + 1)
@@ -27,15 +34,25 @@ public:
     // Get current sample rate
     double getSampleRate() const { return sampleRate; }
     
+    Window getWindow() const { return windowType; }
+    
+    // Sum of the squared window samples: the gain of the window on noise power
+    double getWindowPower() const { return windowPower; }
+    
+    static juce::String getWindowName(Window window);
+    
 private:
     void applyWindow(float* data, int size);
     
     int fftSize{2048};
     double sampleRate{44100.0};
+    Window windowType{Window::hann};
+    double windowPower{0.0};
     
-    std::unique_ptr<juce::dsp::FFT> fft;
-    std::vector<float> window;
+    std::shared_ptr<const AudioCoPilot::FFTEngine> fft;
+    std::shared_ptr<const AudioCoPilot::FFTPlanCache::WindowTable> window;
     std::vector<float> fftData;
+    std::vector<float> fftScratch;  // FFTEngine::getScratchSize(): processBlock() never allocates
     std::vector<float> windowedData;
     
     juce::CriticalSection processLock;
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../FFTPlanCache.h"
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <vector>
+
+/**
+ * MTWProcessor - multi-time-window transfer function
+ *
+ * One FFT size cannot serve the whole audio band: 16k samples give ~3 Hz bins at 48 kHz
+ * but a 340 ms window (sluggish, smeared by reflections) at 10 kHz. Here each octave band
+ * is measured with a window of roughly the same number of cycles:
+ *
+ * - Levels 0 .. numLevels-1 all use the same small FFT (fftSize, e.g. 1024), but level L
+ *   runs on the input decimated by 2^L (cascaded half-band filters), so its window is
+ *   fftSize * 2^L input samples long: 1k at the top, 128k for the lowest band with 8 levels
+ * - Level L covers (fs_L / 8, fs_L / 4] with fs_L = sampleRate / 2^L (level 0 up to Nyquist,
+ *   the last level down to DC), i.e. fftSize / 8 bins per octave in every band
+ * - A frame every fftSize / 2 decimated samples: deep levels cost almost nothing, so all
+ *   levels together do fewer FFT operations than one 16k frame pair per 16k hop (see the
+ *   "mtw" benchmark)
+ * - Cross-spectra are averaged per level; the output is resampled onto a fixed log grid
+ *   (pointsPerOctave between minHz and maxHz) by summing Gxy/Gxx/Gyy over each point's bins
+ *
+ * Delay: a window as short as 21 ms cannot contain the system delay, so the input is
+ * aligned in time first (setDelayCompensation, e.g. from TFProcessor's delay finder).
+ * Reference and measurement run through identical filters, so their ripple cancels in H.
+ *
+ * processBlock() runs on the audio thread and does not allocate.
+ */
+class MTWProcessor
+{
+public:
+    struct Settings
+    {
+        int fftSize{1024};           // per level, power of 2 (256 .. 8192)
+        int numLevels{8};            // 1 .. 10
+        int pointsPerOctave{48};
+        float minHz{20.0f};
+        float maxHz{20000.0f};
+        double publishSeconds{0.085};  // output update interval (~ one 16k hop at 48 kHz)
+    };
+
+    struct LevelInfo
+    {
+        int equivalentFFTSize{0};    // window length in input samples
+        double binHz{0.0};
+        double lowHz{0.0};
+        double highHz{0.0};
+    };
+
+    MTWProcessor();
+    ~MTWProcessor();
+
+    // Not real-time safe
+    void prepare(double sampleRate, const Settings& settings);
+    void prepare(double sampleRate) { prepare(sampleRate, Settings()); }
+
+    // Audio thread: synchronized reference and measurement blocks (any size)
+    void processBlock(const float* reference, const float* measurement, int numSamples);
+
+    void reset();
+
+    // Exponential averaging time constant (seconds); each level converts it to its own frame rate
+    void setAveragingTime(double seconds) { averagingTime.store(juce::jmax(0.01, seconds)); }
+    double getAveragingTime() const { return averagingTime.load(); }
+
+    // Time alignment in seconds (same sign as TFProcessor::getEstimatedDelay(): positive when
+    // the measurement lags). Rounded to whole samples, limited to maxDelaySeconds.
+    void setDelayCompensation(double seconds) { delaySeconds.store(seconds); }
+    static constexpr double maxDelaySeconds = 1.0;  // as far as TFDelayFinder searches
+
+    // Results on the log grid (any thread)
+    void getResults(std::vector<float>& magnitudeDb, std::vector<float>& phaseDegrees, std::vector<float>& coherence);
+    void getFrequencies(std::vector<float>& frequencies) const;
+    uint64_t getOutputGeneration() const { return outputGeneration.load(std::memory_order_acquire); }
+
+    bool isReady() const { return ready.load(); }
+    int getNumLevels() const { return static_cast<int>(levels.size()); }
+    LevelInfo getLevelInfo(int level) const;
+
+private:
+    // Half-band low-pass + decimation by 2 (linear phase, every other tap zero)
+    class Decimator
+    {
+    public:
+        void prepare(const std::vector<float>* coefficients, int maxInput);
+        void reset();
+        int process(const float* input, int numInput, float* output);  // returns the number of outputs
+
+    private:
+        const std::vector<float>* taps{nullptr};
+        std::vector<float> buffer;   // history (taps - 1) followed by the current input
+        int historySize{0};
+        int parity{0};
+    };
+
+    // Integer delay, block in / block out
+    class DelayLine
+    {
+    public:
+        void prepare(int maxDelay, int maxBlock);
+        void reset();
+        void process(const float* input, float* output, int numSamples, int delay);
+
+    private:
+        std::vector<float> ring;
+        int mask{0};
+        int writePosition{0};
+    };
+
+    struct Level
+    {
+        int factor{1};               // decimation 2^L
+        double frameSeconds{0.0};    // time between frames
+        int firstBin{0};             // bins that feed the output
+        int lastBin{0};
+        int frames{0};
+
+        Decimator referenceDecimator;    // from the previous level's rate to this one
+        Decimator measurementDecimator;
+
+        std::vector<float> referenceFrame;     // fftSize: fill, transform, shift by hop
+        std::vector<float> measurementFrame;
+        int filled{0};
+
+        std::vector<double> Gxx, Gyy;          // indexed by bin - firstBin
+        std::vector<std::complex<double>> Gxy;
+    };
+
+    struct Point
+    {
+        int level{0};
+        int firstBin{0};
+        int lastBin{0};
+    };
+
+    void processChunk(const float* reference, const float* measurement, int numSamples);
+    void feedLevel(Level& level, const float* reference, const float* measurement, int numSamples);
+    void processFrame(Level& level);
+    void publish();
+
+    static constexpr int chunkSize = 512;
+
+    Settings settings;
+    double sampleRate{48000.0};
+    int fftSize{1024};
+    int hopSize{512};
+
+    std::shared_ptr<const juce::dsp::FFT> fft;  // from FFTPlanCache
+    std::vector<float> window;
+    std::vector<float> referenceData;      // 2 * fftSize, transformed in place
+    std::vector<float> measurementData;
+    std::vector<float> halfbandTaps;
+
+    std::vector<Level> levels;
+    std::vector<Point> points;
+    std::vector<float> pointFrequencies;
+
+    // Per-chunk scratch: delayed input, then each level's decimated signal
+    DelayLine referenceDelay, measurementDelay;
+    std::vector<float> referenceScratch[2];
+    std::vector<float> measurementScratch[2];
+
+    juce::CriticalSection processLock;  // processBlock() vs reset()
+    std::atomic<double> averagingTime{1.5};
+    std::atomic<double> delaySeconds{0.0};
+    int samplesSincePublish{0};
+    int publishInterval{4096};
+
+    // Output (built on the audio thread, double-buffered for readers)
+    std::vector<float> magnitudeDb, phaseDegrees, coherence;
+    std::vector<float> magnitudeDbBuffer, phaseDegreesBuffer, coherenceBuffer;
+    juce::CriticalSection bufferLock;
+    std::atomic<uint64_t> outputGeneration{0};
+    std::atomic<bool> ready{false};
+
+    static constexpr double eps = 1e-12;
+};
@@ -0,0 +1,222 @@
+#include "MultiTFEngine.h"
+#include <cstring>
+
+MultiTFEngine::MultiTFEngine()
+{
+}
+
+MultiTFEngine::~MultiTFEngine()
+{
+    release();
+}
+
+void MultiTFEngine::prepare(int newFFTSize, double newSampleRate, int newNumPairs, juce::ThreadPool* workerPool)
+{
+    release();
+
+    numPairs = juce::jlimit(1, maxPairs, newNumPairs);
+    sampleRate = newSampleRate;
+
+    referenceFFT.prepare(newFFTSize, sampleRate);
+    fftSize = referenceFFT.getFFTSize();  // rounded to a power of 2, like TFProcessor
+    hopSize = fftSize / 4;                // TFProcessor's 75% overlap
+
+    for (int i = 0; i < numPairs; ++i)
+    {
+        auto pair = std::make_unique<Pair>();
+        pair->processor.setMagnitudeHistorySeconds(pairHistorySeconds);
+        pair->processor.prepare(fftSize, sampleRate);
+        pair->processor.setPublishDivider(publishDivider);
+        pair->fft.prepare(fftSize, sampleRate);
+        pair->spectrum.assign(static_cast<size_t>(fftSize / 2 + 1), std::complex<float>(0.0f, 0.0f));
+        pairs.push_back(std::move(pair));
+    }
+
+    const int numBins = fftSize / 2 + 1;
+    referenceSpectrum.assign(static_cast<size_t>(numBins), std::complex<float>(0.0f, 0.0f));
+    shared.X.assign(static_cast<size_t>(numBins), std::complex<double>(0.0, 0.0));
+    shared.Gxx.assign(static_cast<size_t>(numBins), 0.0);
+    shared.alpha = 0.0;
+    frameCount = 0;
+
+    pool = workerPool;
+
+    // Half a second of slack (at least two frames) before the audio thread has to drop
+    const int numChannels = 1 + numPairs;
+    ring.prepare(numChannels, juce::jmax(2 * fftSize, juce::roundToInt(sampleRate * 0.5)));
+    inputPointers.assign(static_cast<size_t>(numChannels), nullptr);
+
+    frames.assign(static_cast<size_t>(numChannels) * static_cast<size_t>(fftSize), 0.0f);
+    hopDestinations.resize(static_cast<size_t>(numChannels));
+    measurementFrames.resize(static_cast<size_t>(numPairs));
+    for (int ch = 0; ch < numChannels; ++ch)
+        hopDestinations[static_cast<size_t>(ch)] = frames.data() + static_cast<size_t>(ch) * static_cast<size_t>(fftSize)
+                                                   + static_cast<size_t>(fftSize - hopSize);
+    for (int i = 0; i < numPairs; ++i)
+        measurementFrames[static_cast<size_t>(i)] = frames.data() + static_cast<size_t>(1 + i) * static_cast<size_t>(fftSize);
+    filledFrames = 0;
+
+    engineThread = std::make_unique<Worker>("MultiTFEngine", [this] { engineLoop(); });
+    engineThread->startThread(juce::Thread::Priority::high);
+}
+
+void MultiTFEngine::release()
+{
+    if (engineThread != nullptr)
+    {
+        engineThread->signalThreadShouldExit();
+        engineThread->stopThread(-1);
+        engineThread.reset();
+    }
+
+    // Jobs of the last hop may still be queued behind other modules' work on the shared
+    // pool; they find no pairs left, but must be gone before the pairs are
+    while (runningJobs.load() > 0)
+        juce::Thread::sleep(1);
+
+    pairs.clear();
+    numPairs = 0;
+    pool = nullptr;
+}
+
+int MultiTFEngine::getNumWorkerJobs() const
+{
+    if (pool == nullptr)
+        return 0;
+
+    // The engine thread always takes pairs itself, so it counts as one of the helpers
+    const int maxJobs = maxWorkerJobs.load();
+    const int poolThreads = pool->getNumThreads();
+    return juce::jlimit(0, juce::jmax(0, numPairs - 1), maxJobs < 0 ? poolThreads : juce::jmin(maxJobs, poolThreads));
+}
+
+void MultiTFEngine::pushBlock(const float* reference, const float* const* measurements, int numSamples)
+{
+    if (numPairs == 0 || numSamples <= 0)
+        return;
+
+    inputPointers[0] = reference;
+    for (int i = 0; i < numPairs; ++i)
+        inputPointers[static_cast<size_t>(1 + i)] = measurements[i];
+
+    ring.push(inputPointers.data(), numSamples);
+}
+
+void MultiTFEngine::engineLoop()
+{
+    const int numChannels = 1 + numPairs;
+    const size_t keep = static_cast<size_t>(fftSize - hopSize);
+
+    while (!engineThread->threadShouldExit())
+    {
+        if (ring.available() < hopSize)
+        {
+            engineThread->wait(5);
+            continue;
+        }
+
+        // Slide every frame by one hop; the new hop lands at the end
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* frame = frames.data() + static_cast<size_t>(ch) * static_cast<size_t>(fftSize);
+            std::memmove(frame, frame + hopSize, sizeof(float) * keep);
+        }
+
+        ring.pop(hopDestinations.data(), hopSize);
+        filledFrames = juce::jmin(fftSize, filledFrames + hopSize);
+
+        if (filledFrames >= fftSize)
+            processFrame(frames.data(), measurementFrames.data());
+    }
+}
+
+void MultiTFEngine::processFrame(const float* reference, const float* const* measurements)
+{
+    if (numPairs == 0)
+        return;
+
+    juce::ScopedLock lock(frameLock);
+
+    // Shared part, once per hop: reference FFT and its averaged auto-spectrum
+    referenceFFT.processBlock(reference, fftSize, referenceSpectrum);
+
+    const int numBins = static_cast<int>(shared.X.size());
+    for (int k = 0; k < numBins; ++k)
+        shared.X[static_cast<size_t>(k)] = std::complex<double>(referenceSpectrum[static_cast<size_t>(k)].real(),
+                                                                referenceSpectrum[static_cast<size_t>(k)].imag());
+
+    ++frameCount;
+    shared.alpha = pairs.front()->processor.getFrameAlpha(frameCount);
+    TFProcessor::updateReferenceAverage(shared.X.data(), shared.Gxx.data(), numBins, shared.alpha);
+
+    // Per-pair part, in parallel
+    currentMeasurements = measurements;
+    runPairs();
+}
+
+void MultiTFEngine::runPairs()
+{
+    pairsDone.reset();
+    remainingPairs.store(numPairs);
+    nextPair.store(0);
+
+    // Each job takes pairs until none are left; a job that starts late simply finds none
+    const int numJobs = getNumWorkerJobs();
+    for (int i = 0; i < numJobs; ++i)
+    {
+        runningJobs.fetch_add(1);
+        pool->addJob([this]
+        {
+            for (int index = nextPair.fetch_add(1); index < numPairs; index = nextPair.fetch_add(1))
+                processPair(index);
+            runningJobs.fetch_sub(1);
+        });
+    }
+
+    for (int index = nextPair.fetch_add(1); index < numPairs; index = nextPair.fetch_add(1))
+        processPair(index);
+
+    while (remainingPairs.load() > 0)
+        pairsDone.wait(-1);
+}
+
+void MultiTFEngine::processPair(int index)
+{
+    auto& pair = *pairs[static_cast<size_t>(index)];
+
+    pair.fft.processBlock(currentMeasurements[index], fftSize, pair.spectrum);
+    pair.processor.processPairFrame(shared, pair.spectrum);
+
+    if (remainingPairs.fetch_sub(1) == 1)
+        pairsDone.signal();
+}
+
+void MultiTFEngine::reset()
+{
+    juce::ScopedLock lock(frameLock);
+
+    std::fill(shared.Gxx.begin(), shared.Gxx.end(), 0.0);
+    frameCount = 0;
+
+    for (auto& pair : pairs)
+        pair->processor.reset();
+}
+
+void MultiTFEngine::setAveragingTime(double seconds)
+{
+    for (auto& pair : pairs)
+        pair->processor.setAveragingTime(seconds);
+}
+
+void MultiTFEngine::setSmoothingOctaves(double octaves)
+{
+    for (auto& pair : pairs)
+        pair->processor.setSmoothingOctaves(octaves);
+}
+
+void MultiTFEngine::setPublishDivider(int divider)
+{
+    publishDivider = divider;
+    for (auto& pair : pairs)
+        pair->processor.setPublishDivider(divider);
+}
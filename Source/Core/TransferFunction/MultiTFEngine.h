@@ -0,0 +1,132 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../AudioFrameRing.h"
+#include "FFTAnalyzer.h"
+#include "TFProcessor.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * MultiTFEngine
+ *
+ * Transfer functions of one reference against several measurement mics at once.
+ *
+ * Audio thread -> frame ring (reference + mics) -> engine thread -> per-pair jobs
+ *
+ * - Per hop the reference is transformed once and its auto-spectrum Gxx averaged once
+ *   (TFProcessor::SharedReference); every pair reuses both
+ * - Per pair the measurement FFT, cross-spectrum, coherence, delay finder, smoothing and
+ *   publishing form one job. Jobs run in parallel on a worker pool shared with the other
+ *   modules (AnalysisHost); the engine thread takes pairs too, so a busy pool only means
+ *   fewer helpers, never a stalled hop
+ * - Each pair is a complete TFProcessor, so plots, snapshots and the waterfall work on it
+ */
+class MultiTFEngine
+{
+public:
+    static constexpr int maxPairs = 16;
+
+    MultiTFEngine();
+    ~MultiTFEngine();
+
+    // Message thread, not concurrently with pushBlock(). Stops the engine thread, prepares
+    // numPairs pairs and starts it again. workerPool (not owned, must outlive release())
+    // helps with the pairs; nullptr runs every pair on the engine thread.
+    void prepare(int fftSize, double sampleRate, int numPairs, juce::ThreadPool* workerPool = nullptr);
+
+    // Message thread. Stops the engine thread, waits for its pool jobs and frees the pairs.
+    void release();
+
+    // Audio thread: measurements holds getNumPairs() pointers (nullptr = silence).
+    // No allocation and no locks; frames that do not fit the ring are dropped.
+    void pushBlock(const float* reference, const float* const* measurements, int numSamples);
+
+    // One hop on the calling thread (plus the pool): fftSize samples of the reference and
+    // of each measurement. Called by the engine thread; the benchmarks call it directly
+    // (the engine thread stays idle while nothing is pushed).
+    void processFrame(const float* reference, const float* const* measurements);
+
+    int getNumPairs() const { return numPairs; }
+    // Pool jobs started per hop: min(max jobs, pool threads, numPairs - 1)
+    int getNumWorkerJobs() const;
+    int getFFTSize() const { return fftSize; }
+    int getHopSize() const { return hopSize; }
+    double getSampleRate() const { return sampleRate; }
+
+    // Results of pair index (0 .. getNumPairs() - 1)
+    TFProcessor& getPair(int index) { return pairs[static_cast<size_t>(index)]->processor; }
+
+    // Frames lost at the input ring since prepare() (engine thread too slow)
+    uint64_t getDroppedFrames() const { return ring.getStats().overflowedFrames; }
+
+    // Settings, applied to every pair
+    void reset();
+    void setAveragingTime(double seconds);
+    void setSmoothingOctaves(double octaves);
+    void setPublishDivider(int divider);
+
+    // Limit on the pool jobs of one hop (< 0: one per pool thread); any thread
+    void setMaxWorkerJobs(int maxJobs) { maxWorkerJobs.store(maxJobs); }
+
+    // Magnitude history kept per pair (seconds); applies from the next prepare()
+    void setPairHistorySeconds(double seconds) { pairHistorySeconds = seconds; }
+
+private:
+    struct Pair
+    {
+        TFProcessor processor;
+        FFTAnalyzer fft;
+        std::vector<std::complex<float>> spectrum;
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(const juce::String& name, std::function<void()> body) : juce::Thread(name), loop(std::move(body)) {}
+        void run() override { loop(); }
+
+    private:
+        std::function<void()> loop;
+    };
+
+    void engineLoop();
+    void runPairs();
+    void processPair(int index);
+
+    int fftSize{16384};
+    int hopSize{4096};
+    double sampleRate{48000.0};
+    int numPairs{0};
+    double pairHistorySeconds{60.0};
+    int publishDivider{1};
+
+    std::vector<std::unique_ptr<Pair>> pairs;
+
+    // Shared reference of the current hop
+    FFTAnalyzer referenceFFT;
+    std::vector<std::complex<float>> referenceSpectrum;
+    TFProcessor::SharedReference shared;
+    int frameCount{0};
+    juce::CriticalSection frameLock;  // held for a whole hop; reset() waits for it
+
+    // Hand-out of the current hop's pairs to the engine thread and the pool
+    const float* const* currentMeasurements{nullptr};
+    std::atomic<int> nextPair{0};
+    std::atomic<int> remainingPairs{0};
+    juce::WaitableEvent pairsDone;
+    juce::ThreadPool* pool{nullptr};
+    std::atomic<int> maxWorkerJobs{-1};
+    std::atomic<int> runningJobs{0};   // pool jobs that may still touch this engine
+
+    // Audio input (channel 0 = reference, 1.. = measurements) and the sliding analysis frames
+    AudioCoPilot::AudioFrameRing ring;
+    std::vector<const float*> inputPointers;   // audio thread scratch
+    std::vector<float> frames;                 // (1 + numPairs) * fftSize, channel after channel
+    std::vector<float*> hopDestinations;       // where the next hop of each channel goes
+    std::vector<const float*> measurementFrames;
+    int filledFrames{0};
+    std::unique_ptr<Worker> engineThread;
+};
@@ -0,0 +1,62 @@
+#include "TFAnalysisJobQueue.h"
+
+TFAnalysisJobQueue::TFAnalysisJobQueue()
+    : juce::Thread("TFAnalysisJobQueue")
+{
+}
+
+TFAnalysisJobQueue::~TFAnalysisJobQueue()
+{
+    cancelAll();
+    signalThreadShouldExit();
+    jobAvailable.signal();
+    stopThread(2000);
+}
+
+void TFAnalysisJobQueue::submit(Job job)
+{
+    {
+        juce::ScopedLock lock(queueLock);
+        pendingJob = std::move(job);
+        generation.fetch_add(1);
+    }
+
+    jobAvailable.signal();
+}
+
+void TFAnalysisJobQueue::cancelAll()
+{
+    juce::ScopedLock lock(queueLock);
+    pendingJob = nullptr;
+    generation.fetch_add(1);
+}
+
+void TFAnalysisJobQueue::run()
+{
+    while (!threadShouldExit())
+    {
+        // Wait for a job or timeout to allow graceful stop
+        jobAvailable.wait(100);
+
+        Job job;
+        uint64_t jobGeneration = 0;
+        {
+            juce::ScopedLock lock(queueLock);
+            job = std::move(pendingJob);
+            pendingJob = nullptr;
+            jobGeneration = generation.load();
+        }
+
+        if (!job)
+            continue;
+
+        const ShouldCancel shouldCancel = [this, jobGeneration]
+        {
+            return threadShouldExit() || generation.load() != jobGeneration;
+        };
+
+        busy.store(true);
+        job(shouldCancel);
+        busy.store(false);
+    }
+}
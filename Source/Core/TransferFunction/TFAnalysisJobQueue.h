@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <atomic>
+#include <functional>
+
+/**
+ * TFAnalysisJobQueue
+ *
+ * Background thread for Transfer Function auto-analysis (correlation, band scans,
+ * knowledge base lookups), so none of it runs on the message thread.
+ *
+ * "Latest job wins": submitting a job replaces any job that has not started yet and
+ * asks the running one to stop. Jobs poll the ShouldCancel callback between stages
+ * and simply return when their input has been superseded.
+ */
+class TFAnalysisJobQueue : public juce::Thread
+{
+public:
+    using ShouldCancel = std::function<bool()>;
+    using Job = std::function<void(const ShouldCancel&)>;
+
+    TFAnalysisJobQueue();
+    ~TFAnalysisJobQueue() override;
+
+    // Any thread: queue a job, superseding pending and running ones
+    void submit(Job job);
+
+    // Any thread: drop the pending job and cancel the running one (thread keeps running)
+    void cancelAll();
+
+    // Any thread: true while a job is being executed
+    bool isBusy() const { return busy.load(); }
+
+    void run() override;
+
+private:
+    juce::CriticalSection queueLock;
+    Job pendingJob;
+    juce::WaitableEvent jobAvailable;
+
+    // Incremented on every submit/cancel; a running job is stale once it differs from its own
+    std::atomic<uint64_t> generation{0};
+    std::atomic<bool> busy{false};
+};
@@ -15,10 +15,162 @@ void TFAutoAnalyzer::prepare(int newFFTSize, double newSampleRate)
 {
     fftSize = newFFTSize;
     sampleRate = newSampleRate;
-    correlationBuffer.resize(maxDelaySamples * 2);
+    
+    // Bins lineares do TFProcessor: f = k * sampleRate / fftSize, k = 0..fftSize/2
+    buildBandIndex(fftSize / 2 + 1, sampleRate / static_cast<double>(fftSize));
     reset();
 }
 
+void TFAutoAnalyzer::buildBandIndex(int numBins, double binWidthHz)
+{
+    indexedBins = juce::jmax(0, numBins);
+    indexedBinWidth = binWidthHz;
+    
+    // Bandas largas (mesmos limites de sempre, agora meio-abertas para cada bin cair numa só)
+    analysisBands = {
+        {20.0f, 100.0f}, {100.0f, 250.0f}, {250.0f, 500.0f}, {500.0f, 2000.0f},
+        {2000.0f, 5000.0f}, {5000.0f, 10000.0f}, {10000.0f, 20000.0f}
+    };
+    
+    // Bandas de 1/6 de oitava centradas em 1 kHz * 2^(k/6), cobrindo 20 Hz - 20 kHz
+    diagnosticBands.clear();
+    const int firstBand = static_cast<int>(std::ceil(6.0 * std::log2(20.0 / 1000.0)));
+    const int lastBand = static_cast<int>(std::floor(6.0 * std::log2(20000.0 / 1000.0)));
+    for (int k = firstBand; k <= lastBand; ++k)
+    {
+        const double centre = 1000.0 * std::pow(2.0, k / 6.0);
+        const double halfBand = std::pow(2.0, 1.0 / 12.0);
+        diagnosticBands.push_back({static_cast<float>(centre / halfBand), static_cast<float>(centre * halfBand)});
+    }
+    
+    phaseCriticalBands = { {200.0f, 500.0f}, {1000.0f, 3000.0f}, {3000.0f, 8000.0f} };
+    
+    analysisBandOfBin.assign(static_cast<size_t>(indexedBins), -1);
+    diagnosticBandOfBin.assign(static_cast<size_t>(indexedBins), -1);
+    phaseBandOfBin.assign(static_cast<size_t>(indexedBins), -1);
+    
+    assignBins(analysisBands, analysisBandOfBin, binWidthHz);
+    assignBins(diagnosticBands, diagnosticBandOfBin, binWidthHz);
+    assignBins(phaseCriticalBands, phaseBandOfBin, binWidthHz);
+    
+    // Posição em oitavas de cada bin (DC fica com o valor do bin 1)
+    binOctave.resize(static_cast<size_t>(indexedBins));
+    for (int i = 0; i < indexedBins; ++i)
+    {
+        const double f = juce::jmax(1, i) * binWidthHz;
+        binOctave[static_cast<size_t>(i)] = static_cast<float>(std::log2(juce::jmax(1.0e-3, f) / 1000.0));
+    }
+    
+    analysisBandStats.assign(analysisBands.size(), {});
+    diagnosticBandStats.assign(diagnosticBands.size(), {});
+    hasMagnitudeStats = false;
+}
+
+void TFAutoAnalyzer::assignBins(std::vector<BandRange>& bands, std::vector<int>& bandOfBin, double binWidthHz)
+{
+    const int numBins = static_cast<int>(bandOfBin.size());
+    
+    for (size_t b = 0; b < bands.size(); ++b)
+    {
+        auto& band = bands[b];
+        if (binWidthHz <= 0.0 || numBins == 0)
+        {
+            band.startBin = band.endBin = 0;
+            continue;
+        }
+        
+        // Bins com minFreq <= f < maxFreq
+        band.startBin = juce::jlimit(0, numBins, static_cast<int>(std::ceil(band.minFreq / binWidthHz)));
+        band.endBin = juce::jlimit(band.startBin, numBins, static_cast<int>(std::ceil(band.maxFreq / binWidthHz)));
+        
+        for (int i = band.startBin; i < band.endBin; ++i)
+            bandOfBin[static_cast<size_t>(i)] = static_cast<int>(b);
+    }
+}
+
+void TFAutoAnalyzer::ensureBandIndex(const std::vector<float>& frequencies)
+{
+    // Normalmente já construído em prepare(); só reconstrói se o layout recebido for outro
+    const double binWidth = frequencies.size() > 1 ? static_cast<double>(frequencies[1] - frequencies[0]) : 0.0;
+    if (static_cast<int>(frequencies.size()) != indexedBins || std::abs(binWidth - indexedBinWidth) > 1.0e-3)
+        buildBandIndex(static_cast<int>(frequencies.size()), binWidth);
+}
+
+void TFAutoAnalyzer::BandAccumulator::add(float value, float octave)
+{
+    if (count == 0)
+    {
+        minValue = value;
+        maxValue = value;
+    }
+    else
+    {
+        minValue = juce::jmin(minValue, value);
+        maxValue = juce::jmax(maxValue, value);
+    }
+    
+    sum += value;
+    sumSquares += static_cast<double>(value) * value;
+    sumX += octave;
+    sumXX += static_cast<double>(octave) * octave;
+    sumXY += static_cast<double>(octave) * value;
+    ++count;
+}
+
+TFAutoAnalyzer::BandStats TFAutoAnalyzer::BandAccumulator::finish() const
+{
+    BandStats stats;
+    stats.count = count;
+    if (count == 0)
+        return stats;
+    
+    const double n = static_cast<double>(count);
+    const double mean = sum / n;
+    stats.mean = static_cast<float>(mean);
+    stats.minValue = minValue;
+    stats.maxValue = maxValue;
+    stats.variance = static_cast<float>(juce::jmax(0.0, sumSquares / n - mean * mean));
+    
+    const double denominator = n * sumXX - sumX * sumX;
+    if (count > 1 && std::abs(denominator) > 1.0e-12)
+        stats.slopePerOctave = static_cast<float>((n * sumXY - sumX * sum) / denominator);
+    
+    return stats;
+}
+
+void TFAutoAnalyzer::computeMagnitudeStats(const std::vector<float>& magnitudeDb)
+{
+    std::vector<BandAccumulator> broad(analysisBands.size());
+    std::vector<BandAccumulator> diagnostic(diagnosticBands.size());
+    BandAccumulator overall;
+    
+    // Um único passe: cada bin alimenta o espectro inteiro, sua banda larga e sua banda de 1/6 de oitava
+    const int numBins = juce::jmin(indexedBins, static_cast<int>(magnitudeDb.size()));
+    for (int i = 0; i < numBins; ++i)
+    {
+        const float mag = magnitudeDb[static_cast<size_t>(i)];
+        const float octave = binOctave[static_cast<size_t>(i)];
+        
+        overall.add(mag, octave);
+        
+        const int broadBand = analysisBandOfBin[static_cast<size_t>(i)];
+        if (broadBand >= 0)
+            broad[static_cast<size_t>(broadBand)].add(mag, octave);
+        
+        const int diagnosticBand = diagnosticBandOfBin[static_cast<size_t>(i)];
+        if (diagnosticBand >= 0)
+            diagnostic[static_cast<size_t>(diagnosticBand)].add(mag, octave);
+    }
+    
+    for (size_t b = 0; b < broad.size(); ++b)
+        analysisBandStats[b] = broad[b].finish();
+    for (size_t b = 0; b < diagnostic.size(); ++b)
+        diagnosticBandStats[b] = diagnostic[b].finish();
+    
+    overallMagnitudeStats = overall.finish();
+    hasMagnitudeStats = numBins > 0;
+}
+
 void TFAutoAnalyzer::reset()
 {
     delayCompensation.store(0);
@@ -28,36 +180,49 @@ TFAutoAnalyzer::AnalysisResult TFAutoAnalyzer::analyze(const float* reference, i
                                                        const float* measurement, int measSamples,
                                                        const std::vector<float>& magnitudeDb,
                                                        const std::vector<float>& phaseDegrees,
-                                                       const std::vector<float>& frequencies)
+                                                       const std::vector<float>& frequencies,
+                                                       const ShouldCancel& shouldCancel)
 {
     AnalysisResult result;
+    auto cancelled = [&shouldCancel] { return shouldCancel != nullptr && shouldCancel(); };
     
     // 1. Detectar delay via cross-correlation
     if (refSamples > 0 && measSamples > 0 && reference != nullptr && measurement != nullptr)
     {
-        int detectedDelay = detectDelayCrossCorrelation(reference, refSamples, measurement, measSamples);
+        int detectedDelay = detectDelayCrossCorrelation(reference, refSamples, measurement, measSamples, shouldCancel);
+        if (cancelled())
+            return result;
+        
         result.detectedDelaySamples = detectedDelay;
         result.detectedDelayMs = static_cast<float>(detectedDelay * 1000.0 / sampleRate);
         delayCompensation.store(detectedDelay);
         result.delayCompensated = (detectedDelay != 0);
     }
     
-    // 2. Análise de magnitude
-    if (!magnitudeDb.empty() && !frequencies.empty())
+    // 2. Análise de magnitude (passe único: bandas, bandas de diagnóstico e espectro inteiro)
+    hasMagnitudeStats = false;
+    if (!frequencies.empty())
+        ensureBandIndex(frequencies);
+    
+    if (!magnitudeDb.empty() && magnitudeDb.size() == frequencies.size())
     {
-        analyzeMagnitude(magnitudeDb, frequencies, result);
+        computeMagnitudeStats(magnitudeDb);
+        analyzeMagnitude(result);
     }
     
+    if (cancelled())
+        return result;
+    
     // 3. Análise de fase
-    if (!phaseDegrees.empty() && !frequencies.empty())
+    if (!phaseDegrees.empty() && phaseDegrees.size() == frequencies.size())
     {
-        analyzePhase(phaseDegrees, frequencies, result);
+        analyzePhase(phaseDegrees, result);
     }
     
     // 4. Calcular flatness score
-    if (!magnitudeDb.empty())
+    if (hasMagnitudeStats)
     {
-        result.overallFlatness = calculateFlatness(magnitudeDb);
+        result.overallFlatness = calculateFlatness(overallMagnitudeStats);
     }
     
     // 5. Gerar resumo
@@ -88,14 +253,28 @@ TFAutoAnalyzer::AnalysisResult TFAutoAnalyzer::analyze(const float* reference, i
     return result;
 }
 
+void TFAutoAnalyzer::prepareCorrelation(int searchRange)
+{
+    const int size = juce::nextPowerOfTwo(2 * juce::jmax(1, searchRange));
+    if (size == correlationSize)
+        return;
+    
+    correlationFFT = AudioCoPilot::FFTPlanCache::getFFT(juce::roundToInt(std::log2(static_cast<double>(size))));
+    correlationSize = size;
+    referenceSpectrum.assign(static_cast<size_t>(2 * size), 0.0f);
+    measurementSpectrum.assign(static_cast<size_t>(2 * size), 0.0f);
+    fftScratch.resize(AudioCoPilot::FFTPlanCache::getRealForwardScratchSize(*correlationFFT));
+}
+
 int TFAutoAnalyzer::detectDelayCrossCorrelation(const float* ref, int refSize,
-                                                const float* meas, int measSize)
+                                                const float* meas, int measSize,
+                                                const ShouldCancel& shouldCancel)
 {
     if (refSize == 0 || measSize == 0 || ref == nullptr || meas == nullptr)
         return 0;
     
-    // Limitar tamanho para performance
-    int searchRange = juce::jmin(maxDelaySamples, refSize, measSize);
+    // A janela inteira (o TFController limita ao histórico); o maior plano do FFTPlanCache é o teto
+    int searchRange = juce::jmin(maxSearchRange, refSize, measSize);
     if (searchRange < 64)  // Mínimo para análise confiável
         return 0;
     
@@ -113,40 +292,50 @@ int TFAutoAnalyzer::detectDelayCrossCorrelation(const float* ref, int refSize,
     if (refRms < 1e-6f || measRms < 1e-6f)
         return 0;
     
-    // Cross-correlation
+    // Cross-correlation via FFT, zero-padded para >= 2x a janela: IFFT(Y * conj(X))[d] é
+    // sum_i ref[i] * meas[i + d], lags negativos no fim do buffer
+    prepareCorrelation(searchRange);
+    const int size = correlationSize;
+    
+    std::copy(ref, ref + searchRange, referenceSpectrum.begin());
+    std::copy(meas, meas + searchRange, measurementSpectrum.begin());
+    std::fill(referenceSpectrum.begin() + searchRange, referenceSpectrum.end(), 0.0f);
+    std::fill(measurementSpectrum.begin() + searchRange, measurementSpectrum.end(), 0.0f);
+    
+    AudioCoPilot::FFTPlanCache::performRealForward(*correlationFFT, referenceSpectrum.data(), fftScratch.data());
+    AudioCoPilot::FFTPlanCache::performRealForward(*correlationFFT, measurementSpectrum.data(), fftScratch.data());
+    
+    // Abort early when a newer analysis has been requested
+    if (shouldCancel != nullptr && shouldCancel())
+        return 0;
+    
+    float* correlation = measurementSpectrum.data();
+    for (int k = 0; k <= size / 2; ++k)
+    {
+        const std::complex<float> x(referenceSpectrum[2 * k], referenceSpectrum[2 * k + 1]);
+        const std::complex<float> y(correlation[2 * k], correlation[2 * k + 1]);
+        const std::complex<float> c = y * std::conj(x);
+        correlation[2 * k] = c.real();
+        correlation[2 * k + 1] = c.imag();
+    }
+    
+    correlationFFT->performRealOnlyInverseTransform(correlation);
+    
+    // Procurar delay de -searchRange/2 a +searchRange/2; a média de cada lag é sobre as
+    // searchRange - |delay| amostras que se sobrepõem
     float maxCorrelation = -1.0f;
     int bestDelay = 0;
+    const float norm = 1.0f / (refRms * measRms);
     
-    // Procurar delay de -searchRange/2 a +searchRange/2
-    int delayStart = -searchRange / 2;
-    int delayEnd = searchRange / 2;
-    
-    for (int delay = delayStart; delay <= delayEnd; ++delay)
+    for (int delay = -searchRange / 2; delay <= searchRange / 2; ++delay)
     {
-        float correlation = 0.0f;
-        int validSamples = 0;
+        const float sum = correlation[delay >= 0 ? delay : size + delay];
+        const float value = sum * norm / static_cast<float>(searchRange - std::abs(delay));
         
-        for (int i = 0; i < searchRange; ++i)
+        if (value > maxCorrelation)
         {
-            int refIdx = i;
-            int measIdx = i + delay;
-            
-            if (measIdx >= 0 && measIdx < searchRange)
-            {
-                correlation += (ref[refIdx] / refRms) * (meas[measIdx] / measRms);
-                validSamples++;
-            }
-        }
-        
-        if (validSamples > 0)
-        {
-            correlation /= validSamples;
-            
-            if (correlation > maxCorrelation)
-            {
-                maxCorrelation = correlation;
-                bestDelay = delay;
-            }
+            maxCorrelation = value;
+            bestDelay = delay;
         }
     }
     
@@ -159,108 +348,143 @@ int TFAutoAnalyzer::detectDelayCrossCorrelation(const float* ref, int refSize,
     return 0;
 }
 
-void TFAutoAnalyzer::analyzeMagnitude(const std::vector<float>& magnitudeDb,
-                                     const std::vector<float>& frequencies,
-                                     AnalysisResult& result)
+void TFAutoAnalyzer::analyzeMagnitude(AnalysisResult& result)
 {
-    if (magnitudeDb.size() != frequencies.size() || magnitudeDb.size() < 10)
+    if (!hasMagnitudeStats || overallMagnitudeStats.count < 10)
         return;
     
     // Target: resposta plana (0 dB)
-    const float tolerance = 3.0f;  // ±3dB considerado aceitável
     const float warningThreshold = 6.0f;  // ±6dB requer atenção
     
-    // Análise por bandas de frequência
-    struct FrequencyBand
-    {
-        float minFreq, maxFreq;
-        juce::String name;
-    };
-    
     auto& strings = LocalizedStrings::getInstance();
     
-    const FrequencyBand bands[] = {
-        {20.0f, 100.0f, strings.getTFBandSubBass()},
-        {100.0f, 250.0f, strings.getTFBandBass()},
-        {250.0f, 500.0f, strings.getTFBandLowMid()},
-        {500.0f, 2000.0f, strings.getTFBandMid()},
-        {2000.0f, 5000.0f, strings.getTFBandHighMid()},
-        {5000.0f, 10000.0f, strings.getTFBandHigh()},
-        {10000.0f, 20000.0f, strings.getTFBandVeryHigh()}
+    // Mesma ordem de analysisBands
+    const juce::String bandNames[] = {
+        strings.getTFBandSubBass(),
+        strings.getTFBandBass(),
+        strings.getTFBandLowMid(),
+        strings.getTFBandMid(),
+        strings.getTFBandHighMid(),
+        strings.getTFBandHigh(),
+        strings.getTFBandVeryHigh()
     };
     
-    for (const auto& band : bands)
+    for (size_t b = 0; b < analysisBands.size(); ++b)
     {
-        float bandAvg = 0.0f;
-        float bandMax = -100.0f;
-        float bandMin = 100.0f;
-        int count = 0;
+        const auto& band = analysisBands[b];
+        const auto& stats = analysisBandStats[b];
+        if (stats.count == 0)
+            continue;
         
-        for (size_t i = 0; i < frequencies.size(); ++i)
+        float bandAvg = stats.mean;
+        float deviation = std::abs(bandAvg);
+        float range = stats.maxValue - stats.minValue;
+        
+        if (deviation > warningThreshold || range > warningThreshold * 2)
         {
-            if (frequencies[i] >= band.minFreq && frequencies[i] <= band.maxFreq)
+            result.magnitudeIssues.push_back((band.minFreq + band.maxFreq) / 2.0f);
+            
+            if (bandAvg > warningThreshold)
             {
-                float mag = magnitudeDb[i];
-                bandAvg += mag;
-                bandMax = juce::jmax(bandMax, mag);
-                bandMin = juce::jmin(bandMin, mag);
-                count++;
+                result.magnitudeSuggestions.push_back(strings.getTFIssueBoost(bandNames[b], bandAvg));
+            }
+            else if (bandAvg < -warningThreshold)
+            {
+                result.magnitudeSuggestions.push_back(strings.getTFIssueCut(bandNames[b], bandAvg));
+            }
+            
+            if (range > warningThreshold * 2)
+            {
+                result.magnitudeSuggestions.push_back(strings.getTFIssueVariation(bandNames[b], range));
             }
         }
+    }
+    
+    // Diagnóstico fino: picos/vales de 1/6 de oitava em relação à banda larga que os contém
+    struct NarrowbandIssue
+    {
+        float frequency;
+        float deviation;
+    };
+    std::vector<NarrowbandIssue> narrowband;
+    
+    for (size_t d = 0; d < diagnosticBands.size(); ++d)
+    {
+        const auto& stats = diagnosticBandStats[d];
+        if (stats.count == 0)
+            continue;
         
-        if (count > 0)
+        const float centre = diagnosticBands[d].getCentreFrequency();
+        for (size_t b = 0; b < analysisBands.size(); ++b)
         {
-            bandAvg /= count;
-            float deviation = std::abs(bandAvg);
-            float range = bandMax - bandMin;
+            if (centre < analysisBands[b].minFreq || centre >= analysisBands[b].maxFreq || analysisBandStats[b].count == 0)
+                continue;
             
-            if (deviation > warningThreshold || range > warningThreshold * 2)
-            {
-                result.magnitudeIssues.push_back((band.minFreq + band.maxFreq) / 2.0f);
-                
-                if (bandAvg > warningThreshold)
-                {
-                    result.magnitudeSuggestions.push_back(strings.getTFIssueBoost(band.name, bandAvg));
-                }
-                else if (bandAvg < -warningThreshold)
-                {
-                    result.magnitudeSuggestions.push_back(strings.getTFIssueCut(band.name, bandAvg));
-                }
-                
-                if (range > warningThreshold * 2)
-                {
-                    result.magnitudeSuggestions.push_back(strings.getTFIssueVariation(band.name, range));
-                }
-            }
+            const float deviation = stats.mean - analysisBandStats[b].mean;
+            if (std::abs(deviation) > warningThreshold)
+                narrowband.push_back({centre, deviation});
+            break;
         }
     }
+    
+    // Só os mais fortes, para não inundar as sugestões
+    std::sort(narrowband.begin(), narrowband.end(), [](const NarrowbandIssue& a, const NarrowbandIssue& b)
+    {
+        return std::abs(a.deviation) > std::abs(b.deviation);
+    });
+    if (narrowband.size() > static_cast<size_t>(maxNarrowbandIssues))
+        narrowband.resize(static_cast<size_t>(maxNarrowbandIssues));
+    
+    for (const auto& issue : narrowband)
+    {
+        const juce::String label = issue.frequency < 1000.0f
+            ? juce::String(issue.frequency, 0) + " Hz"
+            : juce::String(issue.frequency / 1000.0f, 1) + " kHz";
+        
+        result.magnitudeIssues.push_back(issue.frequency);
+        result.magnitudeSuggestions.push_back(issue.deviation > 0.0f ? strings.getTFIssueBoost(label, issue.deviation)
+                                                                     : strings.getTFIssueCut(label, issue.deviation));
+    }
 }
 
 void TFAutoAnalyzer::analyzePhase(const std::vector<float>& phaseDegrees,
-                                  const std::vector<float>& frequencies,
                                   AnalysisResult& result)
 {
-    if (phaseDegrees.size() != frequencies.size() || phaseDegrees.size() < 10)
+    if (phaseDegrees.size() < 10)
         return;
     
     // Análise de linearidade de fase
     // Fase linear é ideal, mas pequenas variações são normais
     
-    // Calcular desvio de linearidade
-    float phaseRange = 0.0f;
-    float phaseAvg = 0.0f;
+    // Passe único: média/min/max globais, wraps e min/max das bandas críticas
+    std::vector<BandAccumulator> critical(phaseCriticalBands.size());
+    BandAccumulator overall;
+    int wrapCount = 0;
     
-    for (float phase : phaseDegrees)
+    const int numBins = juce::jmin(indexedBins, static_cast<int>(phaseDegrees.size()));
+    for (int i = 0; i < numBins; ++i)
     {
-        phaseAvg += phase;
+        const float phase = phaseDegrees[static_cast<size_t>(i)];
+        const float octave = binOctave[static_cast<size_t>(i)];
+        
+        overall.add(phase, octave);
+        
+        // Detectar wraps de fase problemáticos
+        if (i > 0 && std::abs(phase - phaseDegrees[static_cast<size_t>(i - 1)]) > 180.0f)
+            wrapCount++;
+        
+        const int band = phaseBandOfBin[static_cast<size_t>(i)];
+        if (band >= 0)
+            critical[static_cast<size_t>(band)].add(phase, octave);
     }
-    phaseAvg /= phaseDegrees.size();
     
-    for (float phase : phaseDegrees)
-    {
-        float deviation = std::abs(phase - phaseAvg);
-        phaseRange = juce::jmax(phaseRange, deviation);
-    }
+    if (overall.count == 0)
+        return;
+    
+    // Maior desvio em relação à média
+    const auto overallStats = overall.finish();
+    const float phaseRange = juce::jmax(overallStats.maxValue - overallStats.mean,
+                                        overallStats.mean - overallStats.minValue);
     
     auto& strings = LocalizedStrings::getInstance();
     
@@ -270,59 +494,19 @@ void TFAutoAnalyzer::analyzePhase(const std::vector<float>& phaseDegrees,
         result.phaseSuggestions.push_back(strings.getTFIssuePhaseVariation(phaseRange));
     }
     
-    // Detectar wraps de fase problemáticos
-    int wrapCount = 0;
-    for (size_t i = 1; i < phaseDegrees.size(); ++i)
-    {
-        float diff = phaseDegrees[i] - phaseDegrees[i-1];
-        if (std::abs(diff) > 180.0f)
-        {
-            wrapCount++;
-        }
-    }
-    
-    if (wrapCount > phaseDegrees.size() * 0.1f)  // Mais de 10% dos pontos têm wraps
+    if (wrapCount > overall.count * 0.1f)  // Mais de 10% dos pontos têm wraps
     {
         result.phaseSuggestions.push_back(strings.getTFIssuePhaseWraps());
     }
     
     // Análise por bandas críticas
-    struct CriticalBand
-    {
-        float minFreq, maxFreq;
-        juce::String issue;
-    };
-    
-    const CriticalBand criticalBands[] = {
-        {200.0f, 500.0f, "Fase crítica em low-mid pode causar cancelamento"},
-        {1000.0f, 3000.0f, "Fase em mid-range afeta clareza vocal"},
-        {3000.0f, 8000.0f, "Fase em high-mid afeta definição e presença"}
-    };
-    
-    for (const auto& band : criticalBands)
+    for (size_t b = 0; b < phaseCriticalBands.size(); ++b)
     {
-        float bandPhaseRange = 0.0f;
-        int count = 0;
-        
-        for (size_t i = 0; i < frequencies.size(); ++i)
-        {
-            if (frequencies[i] >= band.minFreq && frequencies[i] <= band.maxFreq)
-            {
-                if (count == 0)
-                {
-                    bandPhaseRange = phaseDegrees[i];
-                }
-                else
-                {
-                    float minPhase = juce::jmin(bandPhaseRange, phaseDegrees[i]);
-                    float maxPhase = juce::jmax(bandPhaseRange, phaseDegrees[i]);
-                    bandPhaseRange = maxPhase - minPhase;
-                }
-                count++;
-            }
-        }
+        const auto& band = phaseCriticalBands[b];
+        const auto stats = critical[b].finish();
+        const float bandPhaseRange = stats.maxValue - stats.minValue;
         
-        if (count > 0 && bandPhaseRange > 60.0f)
+        if (stats.count > 0 && bandPhaseRange > 60.0f)
         {
             result.phaseIssues.push_back((band.minFreq + band.maxFreq) / 2.0f);
             juce::String freqRange = juce::String(band.minFreq, 0) + "-" + juce::String(band.maxFreq, 0) + "Hz";
@@ -331,27 +515,14 @@ void TFAutoAnalyzer::analyzePhase(const std::vector<float>& phaseDegrees,
     }
 }
 
-float TFAutoAnalyzer::calculateFlatness(const std::vector<float>& magnitudeDb)
+float TFAutoAnalyzer::calculateFlatness(const BandStats& overall) const
 {
-    if (magnitudeDb.empty())
+    if (overall.count == 0)
         return 0.0f;
     
-    // Calcular desvio padrão da magnitude
-    float mean = 0.0f;
-    for (float mag : magnitudeDb)
-    {
-        mean += mag;
-    }
-    mean /= magnitudeDb.size();
-    
-    float variance = 0.0f;
-    for (float mag : magnitudeDb)
-    {
-        float diff = mag - mean;
-        variance += diff * diff;
-    }
-    variance /= magnitudeDb.size();
-    float stdDev = std::sqrt(variance);
+    // Desvio padrão da magnitude (do passe único)
+    float mean = overall.mean;
+    float stdDev = std::sqrt(overall.variance);
     
     // Score de 0-100 baseado em quão próximo de 0dB e quão plano
     // Ideal: média próxima de 0dB e stdDev baixo
@@ -1,16 +1,21 @@
 #pragma once
 
 #include "../../JuceHeader.h"
+#include "../FFTPlanCache.h"
 #include <vector>
 #include <complex>
 #include <atomic>
+#include <cmath>
+#include <functional>
 
 /**
  * TFAutoAnalyzer
  * 
  * Sistema inteligente de análise automática de Transfer Function.
- * - Auto-detecta delay via cross-correlation
+ * - Auto-detecta delay via cross-correlation (via FFT: a busca cobre ±metade da janela
+ *   recebida, então janelas de segundos acham delays de segundos)
  * - Analisa magnitude e fase para detectar problemas
+ *   (bandas largas + bandas de 1/6 de oitava, todas a partir de um único passe)
  * - Gera sugestões de correção baseadas em análise profissional
  */
 class TFAutoAnalyzer
@@ -41,13 +46,18 @@ public:
     // Setup
     void prepare(int fftSize, double sampleRate);
     
+    // Returns true when the caller no longer needs the result (checked between stages
+    // and inside the correlation loop; a cancelled analyze() returns a partial result)
+    using ShouldCancel = std::function<bool()>;
+    
     // Análise principal
     // reference e measurement são buffers de áudio no domínio do tempo
     AnalysisResult analyze(const float* reference, int refSamples,
                           const float* measurement, int measSamples,
                           const std::vector<float>& magnitudeDb,
                           const std::vector<float>& phaseDegrees,
-                          const std::vector<float>& frequencies);
+                          const std::vector<float>& frequencies,
+                          const ShouldCancel& shouldCancel = nullptr);
     
     // Get delay compensation offset (em samples)
     int getDelayCompensation() const { return delayCompensation.load(); }
@@ -56,29 +66,93 @@ public:
     void reset();
     
 private:
-    // Cross-correlation para detectar delay
+    // Faixa contígua de bins de uma banda: [startBin, endBin), construída uma vez em prepare()
+    struct BandRange
+    {
+        float minFreq{0.0f};
+        float maxFreq{0.0f};
+        int startBin{0};
+        int endBin{0};
+        
+        float getCentreFrequency() const { return std::sqrt(minFreq * maxFreq); }
+    };
+    
+    // Estatísticas de uma banda, todas calculadas no mesmo passe
+    struct BandStats
+    {
+        float mean{0.0f};
+        float minValue{0.0f};
+        float maxValue{0.0f};
+        float variance{0.0f};
+        float slopePerOctave{0.0f};  // regressão linear sobre log2(f)
+        int count{0};
+    };
+    
+    // Acumulador de um passe (soma, soma dos quadrados, min/max, regressão)
+    struct BandAccumulator
+    {
+        double sum{0.0}, sumSquares{0.0};
+        double sumX{0.0}, sumXX{0.0}, sumXY{0.0};
+        float minValue{0.0f}, maxValue{0.0f};
+        int count{0};
+        
+        void add(float value, float octave);
+        BandStats finish() const;
+    };
+    
+    // Index de bandas log-frequência (bin -> banda), reconstruído só quando o layout muda
+    void buildBandIndex(int numBins, double binWidthHz);
+    void ensureBandIndex(const std::vector<float>& frequencies);
+    static void assignBins(std::vector<BandRange>& bands, std::vector<int>& bandOfBin, double binWidthHz);
+    
+    // Passe único sobre a magnitude: bandas largas + bandas de 1/6 de oitava + espectro inteiro
+    void computeMagnitudeStats(const std::vector<float>& magnitudeDb);
+    
+    // Cross-correlation para detectar delay, lags -N/2 .. N/2 da janela de N samples
     int detectDelayCrossCorrelation(const float* ref, int refSize,
-                                    const float* meas, int measSize);
+                                    const float* meas, int measSize,
+                                    const ShouldCancel& shouldCancel);
     
-    // Análise de magnitude
-    void analyzeMagnitude(const std::vector<float>& magnitudeDb,
-                         const std::vector<float>& frequencies,
-                         AnalysisResult& result);
+    // Análise de magnitude (usa as estatísticas de computeMagnitudeStats)
+    void analyzeMagnitude(AnalysisResult& result);
     
     // Análise de fase
     void analyzePhase(const std::vector<float>& phaseDegrees,
-                     const std::vector<float>& frequencies,
                      AnalysisResult& result);
     
-    // Calcula flatness score (0-100)
-    float calculateFlatness(const std::vector<float>& magnitudeDb);
+    // Calcula flatness score (0-100) a partir das estatísticas do espectro inteiro
+    float calculateFlatness(const BandStats& overall) const;
     
     int fftSize{2048};
     double sampleRate{44100.0};
     
     std::atomic<int> delayCompensation{0};
     
-    // Buffers para cross-correlation
-    std::vector<float> correlationBuffer;
-    static constexpr int maxDelaySamples = 4096;  // ~93ms @ 44.1kHz
+    // Cross-correlation (thread de análise): plano e buffers do tamanho da última janela
+    void prepareCorrelation(int searchRange);
+    std::shared_ptr<const juce::dsp::FFT> correlationFFT;  // from FFTPlanCache
+    int correlationSize{0};                  // >= 2 * janela: correlação linear, sem wrap
+    std::vector<float> referenceSpectrum;    // 2 * correlationSize: real in, complexo intercalado out
+    std::vector<float> measurementSpectrum;  // ... e depois a correlação
+    std::vector<juce::dsp::Complex<float>> fftScratch;  // FFTPlanCache::getRealForwardScratchSize()
+    static constexpr int maxSearchRange = (1 << AudioCoPilot::FFTPlanCache::maxOrder) / 2;
+    
+    // Bandas de análise (faixas de bins precomputadas)
+    std::vector<BandRange> analysisBands;      // 7 bandas largas (sub-bass ... very high)
+    std::vector<BandRange> diagnosticBands;    // 1/6 de oitava, 20 Hz - 20 kHz
+    std::vector<BandRange> phaseCriticalBands; // low-mid, mid, high-mid
+    std::vector<int> analysisBandOfBin;        // -1 = fora de qualquer banda
+    std::vector<int> diagnosticBandOfBin;
+    std::vector<int> phaseBandOfBin;
+    std::vector<float> binOctave;              // log2(f / 1 kHz) por bin
+    int indexedBins{0};
+    double indexedBinWidth{0.0};
+    
+    // Resultado do último passe de magnitude
+    std::vector<BandStats> analysisBandStats;
+    std::vector<BandStats> diagnosticBandStats;
+    BandStats overallMagnitudeStats;
+    bool hasMagnitudeStats{false};
+    
+    static constexpr int maxNarrowbandIssues = 4;
 };
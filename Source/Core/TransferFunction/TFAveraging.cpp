@@ -0,0 +1,380 @@
+#include "TFAveraging.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double eps = 1e-12;
+
+    // Per-frame ring entry of one bin: |X|^2, |Y|^2, Y conj(X)
+    constexpr int fifoFloatsPerBin = 4;
+
+    int getFifoFramesFor(const TFAveragingEngine::Settings& settings, int numBins)
+    {
+        const size_t bytesPerFrame = static_cast<size_t>(juce::jmax(1, numBins)) * fifoFloatsPerBin * sizeof(float);
+        const int fitting = static_cast<int>(TFAveragingEngine::maxFifoBytes / bytesPerFrame);
+        return juce::jlimit(TFAveragingEngine::minFifoFrames, juce::jmax(TFAveragingEngine::minFifoFrames, fitting),
+                            settings.fifoFrames);
+    }
+
+    class ExponentialAveraging : public TFAveragingEngine
+    {
+    public:
+        explicit ExponentialAveraging(int bins) : numBins(bins) {}
+
+        bool addFrame(const std::complex<double>* x, const std::complex<double>* y, double alpha,
+                      double* gxx, double* gyy, std::complex<double>* gxy) override
+        {
+            // Gxx = avg(X * conj(X)), Gyy = avg(Y * conj(Y)), Gxy = avg(Y * conj(X))  (MEAS * conj(REF))
+            for (int k = 0; k < numBins; ++k)
+            {
+                gxx[k] = alpha * gxx[k] + (1.0 - alpha) * std::norm(x[k]);
+                gxy[k] = alpha * gxy[k] + (1.0 - alpha) * (y[k] * std::conj(x[k]));
+                gyy[k] = alpha * gyy[k] + (1.0 - alpha) * std::norm(y[k]);
+            }
+
+            ++framesAveraged;
+            return true;
+        }
+
+        void reset() override { framesAveraged = 0; }
+        Mode getMode() const override { return Mode::exponential; }
+        int getFramesAveraged() const override { return framesAveraged; }
+
+    private:
+        int numBins;
+        int framesAveraged{0};
+    };
+
+    class FifoAveraging : public TFAveragingEngine
+    {
+    public:
+        FifoAveraging(int bins, int frames)
+            : numBins(bins), numFrames(frames),
+              ring(static_cast<size_t>(bins) * fifoFloatsPerBin * static_cast<size_t>(frames), 0.0f),
+              sumXX(static_cast<size_t>(bins), 0.0), sumYY(static_cast<size_t>(bins), 0.0),
+              sumXY(static_cast<size_t>(bins), std::complex<double>(0.0, 0.0))
+        {
+        }
+
+        bool addFrame(const std::complex<double>* x, const std::complex<double>* y, double,
+                      double* gxx, double* gyy, std::complex<double>* gxy) override
+        {
+            float* slot = getSlot(head);
+            const bool full = count == numFrames;
+
+            for (int k = 0; k < numBins; ++k)
+            {
+                float* entry = slot + k * fifoFloatsPerBin;
+
+                // The frame leaving the ring (its slot is reused for the new one)
+                if (full)
+                {
+                    sumXX[k] -= entry[0];
+                    sumYY[k] -= entry[1];
+                    sumXY[k] -= std::complex<double>(entry[2], entry[3]);
+                }
+
+                const auto cross = y[k] * std::conj(x[k]);
+                entry[0] = static_cast<float>(std::norm(x[k]));
+                entry[1] = static_cast<float>(std::norm(y[k]));
+                entry[2] = static_cast<float>(cross.real());
+                entry[3] = static_cast<float>(cross.imag());
+
+                // Sums of exactly what is stored, so removing an entry later cancels it
+                sumXX[k] += entry[0];
+                sumYY[k] += entry[1];
+                sumXY[k] += std::complex<double>(entry[2], entry[3]);
+            }
+
+            head = (head + 1) % numFrames;
+            count = juce::jmin(count + 1, numFrames);
+
+            resumSlice();
+            writeMeans(gxx, gyy, gxy);
+            return true;
+        }
+
+        void seed(const double* gxx, const double* gyy, const std::complex<double>* gxy) override
+        {
+            reset();
+
+            float* slot = getSlot(0);
+            for (int k = 0; k < numBins; ++k)
+            {
+                float* entry = slot + k * fifoFloatsPerBin;
+                entry[0] = static_cast<float>(gxx[k]);
+                entry[1] = static_cast<float>(gyy[k]);
+                entry[2] = static_cast<float>(gxy[k].real());
+                entry[3] = static_cast<float>(gxy[k].imag());
+                sumXX[k] = entry[0];
+                sumYY[k] = entry[1];
+                sumXY[k] = std::complex<double>(entry[2], entry[3]);
+            }
+
+            head = 1 % numFrames;
+            count = 1;
+        }
+
+        void reset() override
+        {
+            std::fill(sumXX.begin(), sumXX.end(), 0.0);
+            std::fill(sumYY.begin(), sumYY.end(), 0.0);
+            std::fill(sumXY.begin(), sumXY.end(), std::complex<double>(0.0, 0.0));
+            head = 0;
+            count = 0;
+            resumBin = 0;
+        }
+
+        Mode getMode() const override { return Mode::fifo; }
+        int getFramesAveraged() const override { return count; }
+        int getFifoFrames() const override { return numFrames; }
+
+        size_t getMemoryBytes() const override
+        {
+            return ring.size() * sizeof(float) + sumXX.size() * sizeof(double) * 2 + sumXY.size() * sizeof(std::complex<double>);
+        }
+
+    private:
+        float* getSlot(int frame) { return ring.data() + static_cast<size_t>(frame) * static_cast<size_t>(numBins) * fifoFloatsPerBin; }
+
+        void resumSlice()
+        {
+            // numBins / numFrames bins per frame (rounded up): every bin once per N frames
+            const int sliceBins = (numBins + numFrames - 1) / numFrames;
+            const int end = juce::jmin(numBins, resumBin + sliceBins);
+
+            for (int k = resumBin; k < end; ++k)
+            {
+                double xx = 0.0, yy = 0.0;
+                std::complex<double> xy(0.0, 0.0);
+                for (int i = 0; i < count; ++i)
+                {
+                    // The newest 'count' slots, wherever the ring currently starts
+                    const int frame = (head - 1 - i + numFrames) % numFrames;
+                    const float* entry = getSlot(frame) + k * fifoFloatsPerBin;
+                    xx += entry[0];
+                    yy += entry[1];
+                    xy += std::complex<double>(entry[2], entry[3]);
+                }
+
+                sumXX[k] = xx;
+                sumYY[k] = yy;
+                sumXY[k] = xy;
+            }
+
+            resumBin = end >= numBins ? 0 : end;
+        }
+
+        void writeMeans(double* gxx, double* gyy, std::complex<double>* gxy) const
+        {
+            const double scale = 1.0 / juce::jmax(1, count);
+            for (int k = 0; k < numBins; ++k)
+            {
+                gxx[k] = juce::jmax(0.0, sumXX[k]) * scale;
+                gyy[k] = juce::jmax(0.0, sumYY[k]) * scale;
+                gxy[k] = sumXY[k] * scale;
+            }
+        }
+
+        int numBins;
+        int numFrames;
+        std::vector<float> ring;  // numFrames slots of numBins entries
+        std::vector<double> sumXX, sumYY;
+        std::vector<std::complex<double>> sumXY;
+        int head{0};       // slot the next frame goes into
+        int count{0};      // frames in the ring
+        int resumBin{0};   // first bin of the next exact re-sum
+    };
+
+    class InfiniteAveraging : public TFAveragingEngine
+    {
+    public:
+        explicit InfiniteAveraging(int bins)
+            : numBins(bins), sumXX(static_cast<size_t>(bins), 0.0), sumYY(static_cast<size_t>(bins), 0.0),
+              sumXY(static_cast<size_t>(bins), std::complex<double>(0.0, 0.0))
+        {
+        }
+
+        bool addFrame(const std::complex<double>* x, const std::complex<double>* y, double,
+                      double* gxx, double* gyy, std::complex<double>* gxy) override
+        {
+            ++count;
+            const double scale = 1.0 / count;
+
+            for (int k = 0; k < numBins; ++k)
+            {
+                sumXX[k] += std::norm(x[k]);
+                sumYY[k] += std::norm(y[k]);
+                sumXY[k] += y[k] * std::conj(x[k]);
+
+                gxx[k] = sumXX[k] * scale;
+                gyy[k] = sumYY[k] * scale;
+                gxy[k] = sumXY[k] * scale;
+            }
+
+            return true;
+        }
+
+        void seed(const double* gxx, const double* gyy, const std::complex<double>* gxy) override
+        {
+            std::copy(gxx, gxx + numBins, sumXX.begin());
+            std::copy(gyy, gyy + numBins, sumYY.begin());
+            std::copy(gxy, gxy + numBins, sumXY.begin());
+            count = 1;
+        }
+
+        void reset() override
+        {
+            std::fill(sumXX.begin(), sumXX.end(), 0.0);
+            std::fill(sumYY.begin(), sumYY.end(), 0.0);
+            std::fill(sumXY.begin(), sumXY.end(), std::complex<double>(0.0, 0.0));
+            count = 0;
+        }
+
+        Mode getMode() const override { return Mode::infinite; }
+        int getFramesAveraged() const override { return count; }
+
+        size_t getMemoryBytes() const override
+        {
+            return sumXX.size() * sizeof(double) * 2 + sumXY.size() * sizeof(std::complex<double>);
+        }
+
+    private:
+        int numBins;
+        std::vector<double> sumXX, sumYY;
+        std::vector<std::complex<double>> sumXY;
+        int count{0};
+    };
+
+    class CoherenceGatedAveraging : public TFAveragingEngine
+    {
+    public:
+        CoherenceGatedAveraging(std::unique_ptr<TFAveragingEngine> averaging, int bins, double coherenceThreshold)
+            : inner(std::move(averaging)), numBins(bins), threshold(coherenceThreshold)
+        {
+        }
+
+        bool addFrame(const std::complex<double>* x, const std::complex<double>* y, double alpha,
+                      double* gxx, double* gyy, std::complex<double>* gxy) override
+        {
+            // Until there is a model to compare with, and after a long run of rejections (the
+            // system itself changed, e.g. the mic was moved), frames are taken as they come
+            const bool learning = inner->getFramesAveraged() < learningFrames || consecutiveRejected >= maxConsecutiveRejected;
+
+            if (!learning && getFrameCoherence(x, y, gxx, gxy) < threshold)
+            {
+                ++rejected;
+                ++consecutiveRejected;
+                return false;
+            }
+
+            consecutiveRejected = 0;
+            return inner->addFrame(x, y, alpha, gxx, gyy, gxy);
+        }
+
+        void seed(const double* gxx, const double* gyy, const std::complex<double>* gxy) override { inner->seed(gxx, gyy, gxy); }
+
+        void reset() override
+        {
+            inner->reset();
+            rejected = 0;
+            consecutiveRejected = 0;
+        }
+
+        Mode getMode() const override { return Mode::coherenceGated; }
+        size_t getMemoryBytes() const override { return inner->getMemoryBytes(); }
+        int getFramesAveraged() const override { return inner->getFramesAveraged(); }
+        int getFramesRejected() const override { return rejected; }
+        int getFifoFrames() const override { return inner->getFifoFrames(); }
+
+    private:
+        double getFrameCoherence(const std::complex<double>* x, const std::complex<double>* y,
+                                 const double* gxx, const std::complex<double>* gxy) const
+        {
+            // Prediction of this frame's measurement from the averaged H1
+            std::complex<double> cross(0.0, 0.0);
+            double measured = 0.0, predicted = 0.0;
+            for (int k = 1; k < numBins; ++k)
+            {
+                const auto prediction = gxy[k] / (gxx[k] + eps) * x[k];
+                cross += y[k] * std::conj(prediction);
+                measured += std::norm(y[k]);
+                predicted += std::norm(prediction);
+            }
+
+            return std::norm(cross) / (measured * predicted + eps);
+        }
+
+        static constexpr int learningFrames = 8;
+        static constexpr int maxConsecutiveRejected = 64;
+
+        std::unique_ptr<TFAveragingEngine> inner;
+        int numBins;
+        double threshold;
+        int rejected{0};
+        int consecutiveRejected{0};
+    };
+}
+
+TFAveragingEngine::Settings TFAveragingEngine::clampSettings(const Settings& requested)
+{
+    Settings settings = requested;
+    settings.fifoFrames = juce::jlimit(minFifoFrames, maxFifoFrames, requested.fifoFrames);
+    settings.coherenceThreshold = juce::jlimit(0.0, 0.99, requested.coherenceThreshold);
+    return settings;
+}
+
+const char* TFAveragingEngine::getModeName(Mode mode)
+{
+    switch (mode)
+    {
+        case Mode::exponential:    return "Exponential";
+        case Mode::fifo:           return "FIFO";
+        case Mode::infinite:       return "Infinite";
+        case Mode::coherenceGated: return "Coherence-gated";
+    }
+
+    return "";
+}
+
+std::unique_ptr<TFAveragingEngine> TFAveragingEngine::create(const Settings& requested, int numBins)
+{
+    const auto settings = clampSettings(requested);
+    numBins = juce::jmax(1, numBins);
+
+    switch (settings.mode)
+    {
+        case Mode::fifo:
+            return std::make_unique<FifoAveraging>(numBins, getFifoFramesFor(settings, numBins));
+        case Mode::infinite:
+            return std::make_unique<InfiniteAveraging>(numBins);
+        case Mode::coherenceGated:
+            return std::make_unique<CoherenceGatedAveraging>(std::make_unique<ExponentialAveraging>(numBins), numBins,
+                                                             settings.coherenceThreshold);
+        case Mode::exponential:
+            break;
+    }
+
+    return std::make_unique<ExponentialAveraging>(numBins);
+}
+
+size_t TFAveragingEngine::estimateMemoryBytes(const Settings& requested, int numBins)
+{
+    const auto settings = clampSettings(requested);
+    const size_t sums = static_cast<size_t>(numBins) * (2 * sizeof(double) + sizeof(std::complex<double>));
+
+    switch (settings.mode)
+    {
+        case Mode::fifo:
+            return static_cast<size_t>(numBins) * fifoFloatsPerBin * sizeof(float)
+                       * static_cast<size_t>(getFifoFramesFor(settings, numBins)) + sums;
+        case Mode::infinite:
+            return sums;
+        case Mode::exponential:
+        case Mode::coherenceGated:
+            break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <complex>
+#include <memory>
+#include <vector>
+
+/**
+ * TFAveragingEngine - how TFProcessor averages its cross-spectra (Gxx, Gyy, Gxy)
+ *
+ * - exponential: IIR with the processor's averaging time (fast start, then averagingTime);
+ *   the state is the averages themselves. The default, and the only mode the multi-pair
+ *   engine can share its reference average with.
+ * - fifo: plain mean of the last N frames. A ring of the per-frame spectra (float) and
+ *   running sums (double): adding a frame subtracts the one leaving the ring, O(1) per bin
+ *   whatever N is. Each frame also re-sums numBins / N bins from the ring, so every running
+ *   sum is exact again once per N frames (no drift, no periodic spike).
+ * - infinite: cumulative mean of every frame since the start (or the last reset), for
+ *   stationary noise.
+ * - coherenceGated: exponential averaging that rejects frames the current average does not
+ *   explain. Frame coherence is |sum Y conj(H X)|^2 / (sum |Y|^2 * sum |H X|^2) over all
+ *   bins (1: the frame is the averaged system applied to X; wind and other uncorrelated noise
+ *   pull it down, mostly at low frequencies where they carry their energy).
+ *
+ * Engines are built off the audio thread (create() allocates); addFrame() does not allocate.
+ */
+class TFAveragingEngine
+{
+public:
+    enum class Mode
+    {
+        exponential,
+        fifo,
+        infinite,
+        coherenceGated
+    };
+
+    struct Settings
+    {
+        Mode mode{Mode::exponential};
+        int fifoFrames{16};               // fifo: frames averaged
+        double coherenceThreshold{0.5};   // coherenceGated: frames below are rejected
+    };
+
+    static constexpr int minFifoFrames = 2;
+    static constexpr int maxFifoFrames = 256;
+    static constexpr size_t maxFifoBytes = size_t(256) << 20;  // fifoFrames is lowered to fit
+
+    static Settings clampSettings(const Settings& settings);
+    static const char* getModeName(Mode mode);
+
+    // Engine for settings, prepared for numBins bins
+    static std::unique_ptr<TFAveragingEngine> create(const Settings& settings, int numBins);
+
+    // Memory create() would need beyond the averages themselves (for the UI, before switching)
+    static size_t estimateMemoryBytes(const Settings& settings, int numBins);
+
+    virtual ~TFAveragingEngine() = default;
+
+    // Adds the frame (x: reference, y: measurement spectrum) and writes the current averages
+    // to gxx, gyy and gxy, which also hold the previous averages on entry. alpha is the
+    // processor's exponential coefficient for this frame (ignored by fifo and infinite).
+    // Returns false if the frame was rejected (averages untouched).
+    virtual bool addFrame(const std::complex<double>* x, const std::complex<double>* y, double alpha,
+                          double* gxx, double* gyy, std::complex<double>* gxy) = 0;
+
+    // Take over averages carried from another layout as if they were one frame
+    virtual void seed(const double* gxx, const double* gyy, const std::complex<double>* gxy) { juce::ignoreUnused(gxx, gyy, gxy); }
+
+    virtual void reset() = 0;
+
+    virtual Mode getMode() const = 0;
+    virtual size_t getMemoryBytes() const { return 0; }  // state beyond the averages
+    virtual int getFramesAveraged() const = 0;           // frames in the current average
+    virtual int getFramesRejected() const { return 0; }  // since the last reset
+    virtual int getFifoFrames() const { return 0; }      // fifo: N actually used
+};
@@ -10,9 +10,8 @@ TFController::TFController(DeviceManager& dm)
     // Listen to localization changes
     LocalizedStrings::getInstance().addChangeListener(this);
     
-    // Initialize analysis buffers
-    referenceBuffer.resize(analysisBufferSize, 0.0f);
-    measurementBuffer.resize(analysisBufferSize, 0.0f);
+    // Initialize analysis history
+    prepareHistory();
 }
 
 TFController::~TFController()
@@ -49,6 +48,15 @@ void TFController::activate()
         measurementChannel.store((numInputs > 1) ? 1 : 0);
     
     isActive.store(true);
+    
+    // Auto-analysis: worker thread does the work, timer only schedules it
+    analysisQueue.startThread(juce::Thread::Priority::low);
+    delayFinder.start();
+    startTimer(analysisIntervalMs);
+    
+    if (impulseResponseEnabled.load())
+        impulseResponse.start();
+    
     juce::Logger::writeToLog("TFController activated with device: " + device->getName() + 
                              ", refCh: " + juce::String(referenceChannel.load()) + 
                              ", measCh: " + juce::String(measurementChannel.load()));
@@ -59,11 +67,17 @@ void TFController::deactivate()
     if (!isActive.load())
         return;
     
-    // Stop timer before deactivating
+    // Stop timer and analysis before deactivating
     stopTimer();
+    analysisQueue.cancelAll();
+    analysisQueue.stopThread(2000);
+    delayFinder.stop();
+    impulseResponse.stop();
     
     deviceManager.getAudioDeviceManager().removeAudioCallback(this);
     processor.reset();
+    multiPairEngine.reset();
+    mtwProcessor.reset();
     autoAnalyzer.reset();
     isActive.store(false);
 }
@@ -71,13 +85,81 @@ void TFController::deactivate()
 void TFController::setReferenceChannel(int channelIndex)
 {
     referenceChannel.store(channelIndex);
+    analysisHistory.discard();
+    delayFinder.reset();
     processor.reset();
+    mtwProcessor.reset();
 }
 
 void TFController::setMeasurementChannel(int channelIndex)
 {
     measurementChannel.store(channelIndex);
+    analysisHistory.discard();
+    delayFinder.reset();
     processor.reset();
+    mtwProcessor.reset();
+}
+
+void TFController::setMultiPairChannels(const std::vector<int>& channels)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(multiPairLock);
+        multiPairChannels.assign(channels.begin(), channels.begin() + juce::jmin(static_cast<int>(channels.size()),
+                                                                                 MultiTFEngine::maxPairs));
+    }
+    
+    prepareMultiPair();
+}
+
+std::vector<int> TFController::getMultiPairChannels() const
+{
+    const juce::SpinLock::ScopedLockType lock(multiPairLock);
+    return multiPairChannels;
+}
+
+void TFController::prepareMultiPair()
+{
+    // Held while the engine is re-prepared: the audio callback skips it meanwhile
+    const juce::SpinLock::ScopedLockType lock(multiPairLock);
+    
+    if (multiPairChannels.empty())
+        multiPairEngine.release();
+    else
+        multiPairEngine.prepare(currentFFTSize, currentSampleRate, static_cast<int>(multiPairChannels.size()), workerPool);
+}
+
+void TFController::setBudget(const AnalysisBudget& newBudget)
+{
+    budget = newBudget;
+    processor.setPublishDivider(budget.displayDivider);
+    multiPairEngine.setPublishDivider(budget.displayDivider);
+    multiPairEngine.setMaxWorkerJobs(budget.maxWorkerJobs);
+}
+
+void TFController::setWorkerPool(juce::ThreadPool* pool)
+{
+    workerPool = pool;
+    
+    // Restarts the engine (if any) on the new pool
+    if (!getMultiPairChannels().empty())
+        prepareMultiPair();
+}
+
+void TFController::setMTWEnabled(bool shouldBeEnabled)
+{
+    // Starts from empty averages either way
+    mtwProcessor.reset();
+    mtwEnabled.store(shouldBeEnabled);
+}
+
+void TFController::setImpulseResponseEnabled(bool shouldBeEnabled)
+{
+    impulseResponseEnabled.store(shouldBeEnabled);
+    
+    if (shouldBeEnabled && isActive.load())
+        impulseResponse.start();
+    else if (!shouldBeEnabled)
+        impulseResponse.stop();
 }
 
 int TFController::getAvailableInputChannels() const
@@ -126,24 +208,35 @@ void TFController::audioDeviceIOCallbackWithContext(const float* const* inputCha
         measurementChannel.store(measCh);
     }
     
-    // Store audio buffers for analysis (circular buffer)
-    // Use atomic operations for thread-safe access
+    // Store audio for analysis (mirrored history, bulk copy of both channels)
     if (inputChannelData[refCh] != nullptr && inputChannelData[measCh] != nullptr)
     {
-        int currentIdx = bufferWriteIndex.load(std::memory_order_relaxed);
-        for (int i = 0; i < numSamples; ++i)
-        {
-            referenceBuffer[currentIdx] = inputChannelData[refCh][i];
-            measurementBuffer[currentIdx] = inputChannelData[measCh][i];
-            currentIdx = (currentIdx + 1) % analysisBufferSize;
-        }
-        bufferWriteIndex.store(currentIdx, std::memory_order_release);
+        const float* frames[2] = { inputChannelData[refCh], inputChannelData[measCh] };
+        analysisHistory.write(frames, numSamples);
     }
     
     // Process both channels together (synchronized) - FIXED
     if (inputChannelData[refCh] != nullptr && inputChannelData[measCh] != nullptr)
     {
         processor.processBlock(inputChannelData[refCh], inputChannelData[measCh], numSamples);
+        
+        if (mtwEnabled.load())
+            mtwProcessor.processBlock(inputChannelData[refCh], inputChannelData[measCh], numSamples);
+    }
+    
+    // Multi-pair engine: same reference, every selected mic (missing channels feed silence)
+    const juce::SpinLock::ScopedTryLockType multiPairGuard(multiPairLock);
+    if (multiPairGuard.isLocked() && !multiPairChannels.empty() && inputChannelData[refCh] != nullptr)
+    {
+        const float* measurements[MultiTFEngine::maxPairs] = {};
+        const int numPairs = juce::jmin(static_cast<int>(multiPairChannels.size()), MultiTFEngine::maxPairs);
+        for (int i = 0; i < numPairs; ++i)
+        {
+            const int ch = multiPairChannels[static_cast<size_t>(i)];
+            measurements[i] = (ch >= 0 && ch < numInputChannels) ? inputChannelData[ch] : nullptr;
+        }
+        
+        multiPairEngine.pushBlock(inputChannelData[refCh], measurements, numSamples);
     }
     
     // NOTE: Auto-analysis is now handled by Timer on message thread (see timerCallback)
@@ -156,15 +249,23 @@ void TFController::audioDeviceAboutToStart(juce::AudioIODevice* device)
         return;
     
     updateProcessorSettings();
+    
+    // Callbacks are not running yet, so the history can be resized for the new sample rate
+    prepareHistory();
+    delayFinder.reset();  // the history's frame count starts again
 }
 
 void TFController::audioDeviceStopped()
 {
     processor.reset();
-    autoAnalyzer.reset();
-    std::fill(referenceBuffer.begin(), referenceBuffer.end(), 0.0f);
-    std::fill(measurementBuffer.begin(), measurementBuffer.end(), 0.0f);
-    bufferWriteIndex.store(0, std::memory_order_release);
+    
+    {
+        analysisQueue.cancelAll();
+        juce::ScopedLock lock(analysisLock);
+        autoAnalyzer.reset();
+    }
+    
+    analysisHistory.discard();
 }
 
 void TFController::audioDeviceError(const juce::String& errorMessage)
@@ -188,7 +289,12 @@ void TFController::changeListenerCallback(juce::ChangeBroadcaster* source)
             measurementChannel.store(juce::jmin(1, availableChannels - 1));
         
         processor.reset();
-        autoAnalyzer.reset();
+        
+        {
+            analysisQueue.cancelAll();
+            juce::ScopedLock lock(analysisLock);
+            autoAnalyzer.reset();
+        }
         
         // Notify UI
         sendChangeMessage();
@@ -204,20 +310,100 @@ void TFController::changeListenerCallback(juce::ChangeBroadcaster* source)
 
 void TFController::timerCallback()
 {
-    // This runs on the message thread - safe to call performAutoAnalysis
-    if (isActive.load())
+    if (!isActive.load())
+        return;
+    
+    // Confident sub-sample delays take over from the processor's own estimate (the last one
+    // holds while the finder is unsure, e.g. during a pause in the program material)
+    const auto delayGeneration = delayFinder.getGeneration();
+    if (delayGeneration != lastDelayGeneration)
     {
-        // Only analyze if we have enough data
-        if (bufferWriteIndex.load() > analysisBufferSize / 2)
-        {
-            performAutoAnalysis();
-        }
+        lastDelayGeneration = delayGeneration;
+        const auto delay = delayFinder.getResult();
+        if (delay.confident)
+            processor.setExternalDelay(delay.delaySeconds);
+    }
+    
+    // Reported by the audio thread through a counter, logged here
+    const auto delayResets = processor.getDelayResetCount();
+    if (delayResets != lastDelayResetCount)
+    {
+        juce::Logger::writeToLog("TFProcessor - delay reset (beyond " + juce::String(TFProcessor::maxCompensatedDelay, 1)
+                                 + " s), " + juce::String(delayResets - lastDelayResetCount) + " time(s)");
+        lastDelayResetCount = delayResets;
     }
+    
+    // The MTW windows are too short to find the delay themselves
+    if (mtwEnabled.load())
+    {
+        mtwProcessor.setDelayCompensation(processor.getEstimatedDelay());
+        mtwProcessor.setAveragingTime(processor.getAveragingTime());
+    }
+    
+    // Hidden views keep their averages but need no fresh auto-analysis
+    if (budget.visible)
+        scheduleAutoAnalysis();
 }
 
-void TFController::performAutoAnalysis()
+void TFController::scheduleAutoAnalysis()
 {
-    // This is now called from message thread, so it's safe to access LocalizedStrings
+    // Only analyze if we have enough data, and only when new audio arrived since the last job
+    const int window = analysisWindowSamples.load();
+    if (analysisHistory.getNumAvailable() <= window / 2)
+        return;
+    
+    const uint64_t totalFrames = analysisHistory.getTotalFrames();
+    if (totalFrames < lastScheduledFrame + static_cast<uint64_t>(window / 2))
+        return;
+    
+    lastScheduledFrame = totalFrames;
+    
+    // Supersedes (cancels) any analysis that is still working on older data
+    analysisQueue.submit([this](const TFAnalysisJobQueue::ShouldCancel& shouldCancel)
+    {
+        performAutoAnalysis(shouldCancel);
+    });
+}
+
+void TFController::prepareHistory()
+{
+    analysisQueue.cancelAll();
+    juce::ScopedLock lock(analysisLock);
+    
+    lastScheduledFrame = 0;
+    const int capacity = static_cast<int>(currentSampleRate * maxHistorySeconds);
+    analysisHistory.prepare(2, capacity);
+    setAnalysisWindowSamples(analysisWindowSamples.load());
+}
+
+void TFController::setAnalysisWindowSamples(int numSamples)
+{
+    analysisWindowSamples.store(juce::jlimit(256, analysisHistory.getCapacity(), numSamples));
+}
+
+juce::File TFController::saveSnapshot(const juce::String& name, bool quantize16)
+{
+    std::vector<float> magnitudeDb, phaseDegrees, coherence;
+    processor.getResults(magnitudeDb, phaseDegrees, coherence);
+    
+    TFSnapshot::Metadata metadata;
+    metadata.name = name;
+    metadata.timeMs = juce::Time::currentTimeMillis();
+    metadata.sampleRate = processor.getSampleRate();
+    metadata.fftSize = 2 * (static_cast<int>(magnitudeDb.size()) - 1);  // bins of this result (the size can change at runtime)
+    metadata.delaySeconds = processor.getEstimatedDelay();
+    metadata.averagingTime = processor.getAveragingTime();
+    metadata.smoothingOctaves = processor.getSmoothingOctaves();
+    metadata.referenceChannel = referenceChannel.load();
+    metadata.measurementChannel = measurementChannel.load();
+    
+    return snapshotStore.save(metadata, magnitudeDb, phaseDegrees, coherence, quantize16);
+}
+
+void TFController::performAutoAnalysis(const TFAnalysisJobQueue::ShouldCancel& shouldCancel)
+{
+    // Runs on the analysis thread (TFAnalysisJobQueue)
+    juce::ScopedLock lock(analysisLock);
     
     // Get current TF data
     std::vector<float> magnitudeDb;
@@ -231,24 +417,18 @@ void TFController::performAutoAnalysis()
     if (magnitudeDb.empty() || phaseDegrees.empty() || frequencies.empty())
         return;
     
-    // Prepare buffers for cross-correlation (circular to linear)
-    // Copy buffer data safely (quick copy)
-    std::vector<float> refLinear(analysisBufferSize);
-    std::vector<float> measLinear(analysisBufferSize);
+    // Linear view of the last N samples straight from the history (oldest first, no copy)
+    const auto view = analysisHistory.getLatest(analysisWindowSamples.load());
+    if (view.isEmpty())
+        return;
     
-    // Quick copy of buffer data (atomic read ensures we get consistent snapshot)
-    int currentWriteIdx = bufferWriteIndex.load(std::memory_order_acquire);
-    for (int i = 0; i < analysisBufferSize; ++i)
-    {
-        int idx = (currentWriteIdx + i) % analysisBufferSize;
-        refLinear[i] = referenceBuffer[idx];
-        measLinear[i] = measurementBuffer[idx];
-    }
+    auto result = autoAnalyzer.analyze(view.getChannel(0), view.numFrames,
+                                       view.getChannel(1), view.numFrames,
+                                       magnitudeDb, phaseDegrees, frequencies, shouldCancel);
     
-    // Perform analysis
-    auto result = autoAnalyzer.analyze(refLinear.data(), analysisBufferSize,
-                                       measLinear.data(), analysisBufferSize,
-                                       magnitudeDb, phaseDegrees, frequencies);
+    // Superseded by newer data, or the audio thread overwrote our window while we analysed
+    if (shouldCancel() || !analysisHistory.isValid(view))
+        return;
     
     // Generate suggestions from knowledge base
     std::vector<TFKnowledgeBase::Suggestion> allSuggestions;
@@ -268,6 +448,9 @@ void TFController::performAutoAnalysis()
         }
     }
     
+    if (shouldCancel())
+        return;
+    
     // Add suggestions from phase issues
     for (size_t i = 0; i < result.phaseIssues.size(); ++i)
     {
@@ -283,24 +466,33 @@ void TFController::performAutoAnalysis()
         }
     }
     
-    // Store results (thread-safe)
-    {
-        juce::ScopedLock lock(analysisLock);
-        lastAnalysisResult = result;
-        lastSuggestions = allSuggestions;
-    }
+    if (shouldCancel())
+        return;
+    
+    // Publish results: readers swap in the new snapshot, nobody waits on this thread
+    auto snapshot = std::make_shared<AutoAnalysisSnapshot>();
+    snapshot->result = std::move(result);
+    snapshot->suggestions = std::move(allSuggestions);
+    snapshot->sequence = ++analysisSequence;
+    
+    std::atomic_store(&latestAnalysis, std::shared_ptr<const AutoAnalysisSnapshot>(std::move(snapshot)));
+}
+
+std::shared_ptr<const TFController::AutoAnalysisSnapshot> TFController::getLatestAnalysis() const
+{
+    return std::atomic_load(&latestAnalysis);
 }
 
 TFAutoAnalyzer::AnalysisResult TFController::getAnalysisResults()
 {
-    juce::ScopedLock lock(analysisLock);
-    return lastAnalysisResult;
+    auto snapshot = getLatestAnalysis();
+    return snapshot != nullptr ? snapshot->result : TFAutoAnalyzer::AnalysisResult{};
 }
 
 std::vector<TFKnowledgeBase::Suggestion> TFController::getSuggestions()
 {
-    juce::ScopedLock lock(analysisLock);
-    return lastSuggestions;
+    auto snapshot = getLatestAnalysis();
+    return snapshot != nullptr ? snapshot->suggestions : std::vector<TFKnowledgeBase::Suggestion>{};
 }
 
 void TFController::updateProcessorSettings()
@@ -315,7 +507,7 @@ void TFController::updateProcessorSettings()
     int deviceBufferSize = device->getCurrentBufferSizeSamples();
     
     currentSampleRate = deviceSampleRate;
-    currentFFTSize = 16384;  // Smaart-style: 16384 for good resolution
+    currentFFTSize = processor.getAnalysisSettings().fftSize;  // Smaart-style: 16384 by default
     
     juce::Logger::writeToLog(juce::String("TFController::updateProcessorSettings - ") +
                              juce::String("device: ") + deviceName +
@@ -324,10 +516,16 @@ void TFController::updateProcessorSettings()
                              juce::String(", fftSize: ") + juce::String(currentFFTSize));
     
     processor.prepare(currentFFTSize, currentSampleRate);
-    autoAnalyzer.prepare(currentFFTSize, currentSampleRate);
+    delayFinder.setSampleRate(currentSampleRate);
+    mtwProcessor.prepare(currentSampleRate);
+    prepareMultiPair();
+    
+    {
+        analysisQueue.cancelAll();
+        juce::ScopedLock lock(analysisLock);
+        autoAnalyzer.prepare(currentFFTSize, currentSampleRate);
+    }
     
-    // Reset buffers
-    std::fill(referenceBuffer.begin(), referenceBuffer.end(), 0.0f);
-    std::fill(measurementBuffer.begin(), measurementBuffer.end(), 0.0f);
-    bufferWriteIndex.store(0, std::memory_order_release);
+    // Reset history (old samples no longer match the new settings)
+    analysisHistory.discard();
 }
@@ -2,10 +2,19 @@
 
 #include "../../JuceHeader.h"
 #include "../DeviceManager.h"
+#include "../AnalysisHost.h"
+#include "../MirroredAudioHistory.h"
 #include "TFProcessor.h"
 #include "TFAutoAnalyzer.h"
 #include "TFKnowledgeBase.h"
+#include "TFAnalysisJobQueue.h"
+#include "TFSnapshotStore.h"
+#include "MultiTFEngine.h"
+#include "MTWProcessor.h"
+#include "TFImpulseResponse.h"
+#include "TFDelayFinder.h"
 #include <atomic>
+#include <memory>
 #include <vector>
 
 /**
@@ -14,19 +23,27 @@
  * Controller for Transfer Function module.
  * Integrates with Phase 1 DeviceManager without owning audio devices.
  * Now includes intelligent auto-analysis with delay compensation.
+ * Auto-analysis runs on a background job queue; the UI only picks up finished results.
  */
 class TFController : public juce::AudioIODeviceCallback,
                      public juce::ChangeListener,
                      public juce::ChangeBroadcaster,
-                     public juce::Timer
+                     public juce::Timer,
+                     public AnalysisModule
 {
 public:
     TFController(DeviceManager& deviceManager);
     ~TFController() override;
     
     // Setup/teardown
-    void activate();
-    void deactivate();
+    void activate() override;
+    void deactivate() override;
+    bool isAnalysisActive() const override { return isActive.load(); }
+    
+    // Hidden: averaging and delay tracking continue, the display chain runs every
+    // displayDivider frames, auto-analysis pauses and the multi-pair engine gets fewer helpers
+    void setBudget(const AnalysisBudget& budget) override;
+    void setWorkerPool(juce::ThreadPool* pool) override;
     
     // Channel selection
     void setReferenceChannel(int channelIndex);
@@ -55,26 +72,91 @@ public:
     // Change listener (for device changes)
     void changeListenerCallback(juce::ChangeBroadcaster* source) override;
     
-    // Timer callback (runs on message thread for auto-analysis)
+    // Timer callback (message thread): schedules auto-analysis when new audio has arrived
     void timerCallback() override;
     
     // Get processor for UI
     TFProcessor& getProcessor() { return processor; }
     
+    // Finished auto-analysis (result + suggestions from the same run), immutable once published
+    struct AutoAnalysisSnapshot
+    {
+        TFAutoAnalyzer::AnalysisResult result;
+        std::vector<TFKnowledgeBase::Suggestion> suggestions;
+        uint64_t sequence{0};
+    };
+    
+    // Latest finished analysis, or nullptr if none yet (any thread, lock-free)
+    std::shared_ptr<const AutoAnalysisSnapshot> getLatestAnalysis() const;
+    
     // Get auto-analysis results (called from UI thread)
     TFAutoAnalyzer::AnalysisResult getAnalysisResults();
     
     // Get knowledge base suggestions
     std::vector<TFKnowledgeBase::Suggestion> getSuggestions();
     
+    // Length of the reference/measurement window handed to the auto-analyzer.
+    // Clamped to the history length (maxHistorySeconds). The delay search covers half the
+    // window either way, so long-delay setups can use seconds.
+    void setAnalysisWindowSamples(int numSamples);
+    int getAnalysisWindowSamples() const { return analysisWindowSamples.load(); }
+    
+    // Stores the current result (magnitude, phase, coherence, delay, settings) as a snapshot.
+    // Message thread; returns the new file, or a non-existent File (see the store's last error).
+    juce::File saveSnapshot(const juce::String& name, bool quantize16 = true);
+    TFSnapshotStore& getSnapshotStore() { return snapshotStore; }
+    
+    // Additional measurement mics, each analysed against the reference channel in parallel
+    // (up to MultiTFEngine::maxPairs); an empty list turns the multi-pair engine off.
+    // Message thread. Results: getMultiPairEngine().getPair(i) for channels[i].
+    void setMultiPairChannels(const std::vector<int>& channels);
+    std::vector<int> getMultiPairChannels() const;
+    MultiTFEngine& getMultiPairEngine() { return multiPairEngine; }
+    
+    // Multi-time-window TF of the same reference/measurement pair (off by default). It follows
+    // the main processor's delay estimate and averaging time; results on its log grid.
+    void setMTWEnabled(bool shouldBeEnabled);
+    bool isMTWEnabled() const { return mtwEnabled.load(); }
+    MTWProcessor& getMTWProcessor() { return mtwProcessor; }
+    
+    // Live impulse response / ETC of the main pair (off by default; runs while active)
+    void setImpulseResponseEnabled(bool shouldBeEnabled);
+    bool isImpulseResponseEnabled() const { return impulseResponseEnabled.load(); }
+    TFImpulseResponse& getImpulseResponse() { return impulseResponse; }
+    
+    // Sub-sample delay finder on the analysis history (runs while active). Confident results
+    // replace the processor's own per-frame estimate; the MTW processor follows either.
+    void setDelaySearchWindowSeconds(double seconds) { delayFinder.setSearchWindowSeconds(seconds); }
+    TFDelayFinder& getDelayFinder() { return delayFinder; }
+    
 private:
     void updateProcessorSettings();
-    void performAutoAnalysis();
+    void prepareMultiPair();
+    void scheduleAutoAnalysis();
+    void performAutoAnalysis(const TFAnalysisJobQueue::ShouldCancel& shouldCancel);
+    void prepareHistory();
     
     DeviceManager& deviceManager;
     TFProcessor processor;
     TFAutoAnalyzer autoAnalyzer;
     TFKnowledgeBase knowledgeBase;
+    TFSnapshotStore snapshotStore{juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                                      .getChildFile("AudioCoPilot Snapshots")};
+    
+    // Multi-pair engine: the audio thread only try-locks multiPairLock, so while the message
+    // thread re-prepares the engine blocks are skipped instead of waited for
+    MultiTFEngine multiPairEngine;
+    std::vector<int> multiPairChannels;
+    mutable juce::SpinLock multiPairLock;
+    juce::ThreadPool* workerPool{nullptr};  // AnalysisHost's, for the multi-pair engine
+    
+    AnalysisBudget budget;
+    
+    MTWProcessor mtwProcessor;
+    std::atomic<bool> mtwEnabled{false};
+    
+    TFImpulseResponse impulseResponse{processor};
+    std::atomic<bool> impulseResponseEnabled{false};
     
     std::atomic<int> referenceChannel{0};
     std::atomic<int> measurementChannel{1};
@@ -83,17 +165,28 @@ private:
     int currentFFTSize{2048};
     double currentSampleRate{44100.0};
     
-    // Buffers para análise (armazenam últimos N samples)
+    // Histórico para análise (armazena últimos N samples, ref = ch 0, meas = ch 1)
+    // Written by the audio thread, read in place (no copy) by the analysis.
     static constexpr int analysisBufferSize = 4096;
-    std::vector<float> referenceBuffer;
-    std::vector<float> measurementBuffer;
-    std::atomic<int> bufferWriteIndex{0};  // Made atomic for thread-safe access
+    static constexpr double maxHistorySeconds = 8.0;
+    AudioCoPilot::MirroredAudioHistory analysisHistory;
+    std::atomic<int> analysisWindowSamples{analysisBufferSize};
     
-    // Resultados de análise (thread-safe)
+    // Auto-analysis runs here, off the message thread
+    static constexpr int analysisIntervalMs = 250;
+    TFAnalysisJobQueue analysisQueue;
+    uint64_t lastScheduledFrame{0};  // history position of the last submitted job (message thread)
+    
+    // Held by the analysis job while it uses autoAnalyzer/analysisHistory, and by
+    // anything that re-prepares them, so a job never sees them being resized
     juce::CriticalSection analysisLock;
-    TFAutoAnalyzer::AnalysisResult lastAnalysisResult;
-    std::vector<TFKnowledgeBase::Suggestion> lastSuggestions;
     
-    // Contador para análise periódica (não a cada frame)
-    int analysisCounter{0};
+    // Resultados de análise (published by the job, swapped in atomically)
+    std::shared_ptr<const AutoAnalysisSnapshot> latestAnalysis;
+    uint64_t analysisSequence{0};  // analysis thread only
+    
+    // Reads analysisHistory under analysisLock, so declared after both
+    TFDelayFinder delayFinder{analysisHistory, analysisLock};
+    uint64_t lastDelayGeneration{0};  // message thread
+    uint32_t lastDelayResetCount{0};  // message thread
 };
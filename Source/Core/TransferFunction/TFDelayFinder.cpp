@@ -0,0 +1,238 @@
+#include "TFDelayFinder.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+TFDelayFinder::TFDelayFinder(AudioCoPilot::MirroredAudioHistory& h, juce::CriticalSection& lock)
+    : juce::Thread("TF Delay Finder"), history(h), historyLock(lock)
+{
+}
+
+TFDelayFinder::~TFDelayFinder()
+{
+    stop();
+}
+
+void TFDelayFinder::start()
+{
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+void TFDelayFinder::stop()
+{
+    stopThread(2000);
+}
+
+void TFDelayFinder::reset()
+{
+    validFromFrame.store(history.getTotalFrames());
+
+    {
+        juce::ScopedLock lock(resultLock);
+        published = Result();
+    }
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+TFDelayFinder::Result TFDelayFinder::getResult() const
+{
+    juce::ScopedLock lock(resultLock);
+    return published;
+}
+
+int TFDelayFinder::getWindowSamples(double sampleRate, double searchWindowSeconds)
+{
+    // Twice the largest lag, so at least half of the window overlaps at any lag searched
+    const int maxLag = juce::jmax(1, juce::roundToInt(searchWindowSeconds * sampleRate));
+    return juce::jmax(2048, juce::nextPowerOfTwo(2 * maxLag));
+}
+
+void TFDelayFinder::run()
+{
+    uint64_t sequence = 0;
+
+    while (!threadShouldExit())
+    {
+        const double sampleRate = requestedSampleRate.load();
+        const double search = searchSeconds.load();
+        const int window = getWindowSamples(sampleRate, search);
+
+        Result result;
+        bool found = false;
+
+        {
+            juce::ScopedLock lock(historyLock);
+
+            // Only new audio, and only audio written since the last reset()
+            const auto view = history.getLatest(window);
+            if (view.numFrames == window && view.endFrame != lastHistoryFrame
+                && view.endFrame - static_cast<uint64_t>(view.numFrames) >= validFromFrame.load())
+            {
+                lastHistoryFrame = view.endFrame;
+                found = analyse(view.getChannel(0), view.getChannel(1), view.numFrames, sampleRate, search, result)
+                        && history.isValid(view);
+            }
+        }
+
+        if (found)
+        {
+            result.confident = result.peakToSidelobe >= minConfidence.load();
+            result.sequence = ++sequence;
+
+            {
+                juce::ScopedLock lock(resultLock);
+                published = result;
+            }
+            generation.fetch_add(1, std::memory_order_release);
+        }
+
+        wait(updateIntervalMs.load());
+    }
+}
+
+void TFDelayFinder::prepareFFT(int fftOrder)
+{
+    fft = AudioCoPilot::FFTPlanCache::getFFT(fftOrder);
+    fftSize = 1 << fftOrder;
+    referenceSpectrum.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+    measurementSpectrum.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+    correlation.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+    fftScratch.resize(AudioCoPilot::FFTPlanCache::getRealForwardScratchSize(*fft));
+}
+
+bool TFDelayFinder::analyse(const float* reference, const float* measurement, int numSamples, double sampleRate,
+                            double searchWindowSeconds, Result& result)
+{
+    if (reference == nullptr || measurement == nullptr || sampleRate <= 0.0)
+        return false;
+
+    const int window = getWindowSamples(sampleRate, searchWindowSeconds);
+    if (numSamples < window)
+        return false;
+
+    // Zero-padded to twice the window: linear (not circular) correlation for every lag searched
+    const int order = juce::roundToInt(std::log2(static_cast<double>(2 * window)));
+    if (fft == nullptr || fftSize != (1 << order))
+        prepareFFT(order);
+
+    const int offset = numSamples - window;
+    std::copy(reference + offset, reference + numSamples, referenceSpectrum.begin());
+    std::copy(measurement + offset, measurement + numSamples, measurementSpectrum.begin());
+    std::fill(referenceSpectrum.begin() + window, referenceSpectrum.end(), 0.0f);
+    std::fill(measurementSpectrum.begin() + window, measurementSpectrum.end(), 0.0f);
+
+    AudioCoPilot::FFTPlanCache::performRealForward(*fft, referenceSpectrum.data(), fftScratch.data());
+    AudioCoPilot::FFTPlanCache::performRealForward(*fft, measurementSpectrum.data(), fftScratch.data());
+
+    // PHAT: Y * conj(X) normalized to unit magnitude (DC and Nyquist left out)
+    const int half = fftSize / 2;
+    std::fill(correlation.begin(), correlation.end(), 0.0f);
+    for (int k = 1; k < half; ++k)
+    {
+        const std::complex<float> x(referenceSpectrum[2 * k], referenceSpectrum[2 * k + 1]);
+        const std::complex<float> y(measurementSpectrum[2 * k], measurementSpectrum[2 * k + 1]);
+        const std::complex<float> c = y * std::conj(x);
+        const float magnitude = std::abs(c);
+        if (magnitude > 1.0e-20f)
+        {
+            correlation[2 * k] = c.real() / magnitude;
+            correlation[2 * k + 1] = c.imag() / magnitude;
+        }
+    }
+
+    fft->performRealOnlyInverseTransform(correlation.data());
+
+    // Largest |r| within the search range
+    const int maxLag = juce::jmin(window - sincHalfTaps - 1, juce::jmax(1, juce::roundToInt(searchWindowSeconds * sampleRate)));
+    int peakLag = 0;
+    float peak = 0.0f;
+    for (int lag = -maxLag; lag <= maxLag; ++lag)
+    {
+        const float value = std::abs(correlationAt(lag));
+        if (value > peak)
+        {
+            peak = value;
+            peakLag = lag;
+        }
+    }
+
+    if (peak <= 0.0f)
+        return false;
+
+    // Peak-to-sidelobe ratio outside the main lobe (~0.25 ms either side)
+    const int mainLobe = juce::jmax(4, juce::roundToInt(0.00025 * sampleRate));
+    double sum = 0.0, sumSquares = 0.0;
+    int count = 0;
+    for (int lag = -maxLag; lag <= maxLag; ++lag)
+    {
+        if (std::abs(lag - peakLag) <= mainLobe)
+            continue;
+
+        const double value = std::abs(correlationAt(lag));
+        sum += value;
+        sumSquares += value * value;
+        ++count;
+    }
+
+    if (count < 2)
+        return false;
+
+    const double mean = sum / count;
+    const double deviation = std::sqrt(juce::jmax(0.0, sumSquares / count - mean * mean));
+
+    const bool negative = correlationAt(peakLag) < 0.0f;
+    result.delaySamples = refinePeak(peakLag, negative);
+    result.delaySeconds = result.delaySamples / sampleRate;
+    result.peakToSidelobe = (peak - mean) / juce::jmax(deviation, 1.0e-12);
+    result.polarityInverted = negative;
+    result.confident = result.peakToSidelobe >= minConfidence.load();
+    return true;
+}
+
+float TFDelayFinder::correlationAt(int lag) const
+{
+    return correlation[static_cast<size_t>(lag < 0 ? lag + fftSize : lag)];
+}
+
+double TFDelayFinder::refinePeak(int peakLag, bool negative) const
+{
+    const double sign = negative ? -1.0 : 1.0;
+
+    // Parabola through the peak and its neighbours: first guess, within half a sample
+    const double left = sign * correlationAt(peakLag - 1);
+    const double centre = sign * correlationAt(peakLag);
+    const double right = sign * correlationAt(peakLag + 1);
+    const double curvature = left - 2.0 * centre + right;
+    const double parabolic = curvature < 0.0 ? juce::jlimit(-0.5, 0.5, 0.5 * (left - right) / curvature) : 0.0;
+
+    // Band-limited reconstruction: Hann-windowed sinc over 2 * sincHalfTaps + 1 samples
+    const auto interpolate = [this, peakLag, sign](double t)
+    {
+        double value = 0.0;
+        for (int k = -sincHalfTaps; k <= sincHalfTaps; ++k)
+        {
+            const double x = t - k;
+            const double px = juce::MathConstants<double>::pi * x;
+            const double sinc = std::abs(x) < 1.0e-9 ? 1.0 : std::sin(px) / px;
+            const double hann = 0.5 * (1.0 + std::cos(px / (sincHalfTaps + 1)));
+            value += correlationAt(peakLag + k) * sinc * hann;
+        }
+        return sign * value;
+    };
+
+    // Ternary search for the maximum around the parabolic estimate (unimodal within the main lobe)
+    double low = juce::jmax(-1.0, parabolic - 0.5);
+    double high = juce::jmin(1.0, parabolic + 0.5);
+    for (int i = 0; i < refineIterations; ++i)
+    {
+        const double a = low + (high - low) / 3.0;
+        const double b = high - (high - low) / 3.0;
+        if (interpolate(a) < interpolate(b))
+            low = a;
+        else
+            high = b;
+    }
+
+    return peakLag + 0.5 * (low + high);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../FFTPlanCache.h"
+#include "../MirroredAudioHistory.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * TFDelayFinder - sub-sample delay between reference and measurement
+ *
+ * TFProcessor's built-in GCC-PHAT looks at one analysis frame: whole samples only (20 us at
+ * 48 kHz, enough to make the phase above a few kHz wander) and lags within that frame.
+ * This runs on its own low-priority thread, a few times per second, on the controller's
+ * audio history instead:
+ *
+ * - GCC-PHAT over a window of 2x the search range (zero-padded, so the correlation is linear),
+ *   so delays up to maxSearchSeconds are found with at least half the window overlapping
+ * - The peak is refined to a fraction of a sample: parabolic fit first, then a windowed-sinc
+ *   reconstruction of the correlation around it (PHAT peaks are band-limited sincs, where a
+ *   parabola alone is biased towards the nearest sample)
+ * - Confidence is the peak-to-sidelobe ratio (PSR): (peak - sidelobe mean) / sidelobe
+ *   standard deviation over the search range outside the main lobe
+ *
+ * The history holds the reference in channel 0 and the measurement in channel 1. Positive
+ * delays mean the measurement lags the reference (same sign as TFProcessor).
+ */
+class TFDelayFinder : private juce::Thread
+{
+public:
+    struct Result
+    {
+        double delaySeconds{0.0};
+        double delaySamples{0.0};
+        double peakToSidelobe{0.0};   // PSR, linear
+        bool polarityInverted{false}; // the peak is negative
+        bool confident{false};        // PSR >= minimum confidence
+        uint64_t sequence{0};         // 0: nothing found yet
+    };
+
+    static constexpr double maxSearchSeconds = 1.0;
+    static constexpr double defaultSearchSeconds = 0.5;
+    static constexpr double defaultMinConfidence = 10.0;  // uncorrelated noise stays around 6
+
+    // historyLock is held while the history is read (its owner holds it while re-preparing it)
+    TFDelayFinder(AudioCoPilot::MirroredAudioHistory& history, juce::CriticalSection& historyLock);
+    ~TFDelayFinder() override;
+
+    // Message thread
+    void start();
+    void stop();
+
+    // Any thread; the FFT is rebuilt on the worker when these change the layout
+    void setSampleRate(double sampleRate) { requestedSampleRate.store(sampleRate); }
+    void setSearchWindowSeconds(double seconds) { searchSeconds.store(juce::jlimit(0.001, maxSearchSeconds, seconds)); }
+    double getSearchWindowSeconds() const { return searchSeconds.load(); }
+    void setMinConfidence(double peakToSidelobe) { minConfidence.store(peakToSidelobe); }
+    double getMinConfidence() const { return minConfidence.load(); }
+    void setUpdateIntervalMs(int milliseconds) { updateIntervalMs.store(juce::jlimit(50, 5000, milliseconds)); }
+
+    // Forget the last result and ignore audio written before now (e.g. after a channel change)
+    void reset();
+
+    // Latest result (any thread)
+    Result getResult() const;
+    uint64_t getGeneration() const { return generation.load(std::memory_order_acquire); }
+
+    // One search over numSamples samples of each channel (the most recent window is used).
+    // Worker thread, or any thread when the finder is not running (e.g. benchmarks).
+    bool analyse(const float* reference, const float* measurement, int numSamples, double sampleRate,
+                 double searchWindowSeconds, Result& result);
+
+private:
+    static int getWindowSamples(double sampleRate, double searchWindowSeconds);
+    void run() override;
+    void prepareFFT(int fftOrder);
+    double refinePeak(int peakLag, bool negative) const;
+    float correlationAt(int lag) const;
+
+    AudioCoPilot::MirroredAudioHistory& history;
+    juce::CriticalSection& historyLock;
+
+    std::atomic<double> requestedSampleRate{48000.0};
+    std::atomic<double> searchSeconds{defaultSearchSeconds};
+    std::atomic<double> minConfidence{defaultMinConfidence};
+    std::atomic<int> updateIntervalMs{250};
+
+    // Worker side (or analyse() callers)
+    std::shared_ptr<const juce::dsp::FFT> fft;  // from FFTPlanCache
+    int fftSize{0};
+    std::vector<float> referenceSpectrum;  // 2 * fftSize: real in, interleaved complex out
+    std::vector<float> measurementSpectrum;
+    std::vector<float> correlation;
+    std::vector<juce::dsp::Complex<float>> fftScratch;  // FFTPlanCache::getRealForwardScratchSize()
+
+    static constexpr int sincHalfTaps = 16;
+    static constexpr int refineIterations = 24;
+
+    Result published;
+    mutable juce::CriticalSection resultLock;
+    std::atomic<uint64_t> generation{0};
+    uint64_t lastHistoryFrame{0};
+    std::atomic<uint64_t> validFromFrame{0};  // set by reset()
+};
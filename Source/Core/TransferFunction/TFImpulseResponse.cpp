@@ -0,0 +1,110 @@
+#include "TFImpulseResponse.h"
+#include <algorithm>
+#include <cmath>
+
+TFImpulseResponse::TFImpulseResponse(TFProcessor& p)
+    : juce::Thread("TF Impulse Response"), processor(p)
+{
+}
+
+TFImpulseResponse::~TFImpulseResponse()
+{
+    stop();
+}
+
+void TFImpulseResponse::start()
+{
+    processor.setImpulseResponseEnabled(true);
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+void TFImpulseResponse::stop()
+{
+    processor.setImpulseResponseEnabled(false);
+    stopThread(1000);
+}
+
+void TFImpulseResponse::getDisplay(Display& display)
+{
+    juce::ScopedLock lock(displayLock);
+    display = published;
+}
+
+void TFImpulseResponse::run()
+{
+    while (!threadShouldExit())
+    {
+        const auto processorGeneration = processor.getImpulseResponseGeneration();
+        if (processorGeneration != lastProcessorGeneration)
+        {
+            lastProcessorGeneration = processorGeneration;
+            processor.getImpulseResponse(impulseResponse, energy);
+            decimate(processor.getSampleRate());
+
+            {
+                juce::ScopedLock lock(displayLock);
+                std::swap(published, working);
+            }
+            generation.fetch_add(1, std::memory_order_release);
+        }
+
+        wait(pollIntervalMs);
+    }
+}
+
+void TFImpulseResponse::decimate(double sampleRate)
+{
+    const int size = static_cast<int>(juce::jmin(impulseResponse.size(), energy.size()));
+
+    working.irMin.assign(numColumns, 0.0f);
+    working.irMax.assign(numColumns, 0.0f);
+    working.etcDb.assign(numColumns, etcFloorDb);
+    working.valid = false;
+
+    if (size < numColumns || sampleRate <= 0.0)
+        return;
+
+    // Peaks (for normalization and the arrival marker)
+    int peakIndex = 0;
+    float peakEnergy = 0.0f;
+    float peakAmplitude = 0.0f;
+    for (int i = 0; i < size; ++i)
+    {
+        if (energy[i] > peakEnergy)
+        {
+            peakEnergy = energy[i];
+            peakIndex = i;
+        }
+        peakAmplitude = juce::jmax(peakAmplitude, std::abs(impulseResponse[i]));
+    }
+
+    const double msPerSample = 1000.0 / sampleRate;
+    const int preRoll = TFProcessor::getImpulsePreRoll(size);
+    const int samplesPerColumn = size / numColumns;
+    working.startMs = -preRoll * msPerSample;
+    working.columnMs = samplesPerColumn * msPerSample;
+    working.arrivalMs = (peakIndex - preRoll) * msPerSample;
+    working.peakDb = peakEnergy > 0.0f ? 10.0f * std::log10(peakEnergy) : -200.0f;
+
+    if (peakEnergy <= 0.0f || peakAmplitude <= 0.0f)
+        return;
+
+    const float amplitudeScale = 1.0f / peakAmplitude;
+    const float energyScale = 1.0f / peakEnergy;
+    const float energyFloor = std::pow(10.0f, etcFloorDb / 10.0f);
+
+    for (int c = 0; c < numColumns; ++c)
+    {
+        const float* ir = impulseResponse.data() + c * samplesPerColumn;
+        const float* e = energy.data() + c * samplesPerColumn;
+        const auto range = std::minmax_element(ir, ir + samplesPerColumn);
+        const float maxEnergy = *std::max_element(e, e + samplesPerColumn) * energyScale;
+
+        working.irMin[c] = *range.first * amplitudeScale;
+        working.irMax[c] = *range.second * amplitudeScale;
+        working.etcDb[c] = 10.0f * std::log10(juce::jmax(maxEnergy, energyFloor));
+    }
+
+    working.valid = true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "TFProcessor.h"
+#include <atomic>
+#include <vector>
+
+/**
+ * TFImpulseResponse - display data for the live impulse response
+ *
+ * TFProcessor inverse-transforms the averaged H1 on the audio thread (one IFFT per published
+ * frame). Everything else runs here, on a low-priority worker, so a 64k IR never costs the
+ * audio or message thread more than one copy:
+ *
+ * - The IR is decimated to numColumns min/max pairs (normalized to its peak), ready to draw
+ * - The ETC (energy-time curve) is the max-hold of |analytic IR|^2 per column, in dB re the peak
+ * - The arrival time is the position of the energy peak
+ *
+ * Results are double-buffered with a generation counter, like the processor's own results.
+ */
+class TFImpulseResponse : private juce::Thread
+{
+public:
+    struct Display
+    {
+        std::vector<float> irMin;    // per column, -1 .. 1 (re the IR's absolute peak)
+        std::vector<float> irMax;
+        std::vector<float> etcDb;    // per column, etcFloorDb .. 0
+        double startMs{0.0};         // time of column 0's first sample (negative: pre-roll)
+        double columnMs{0.0};        // time covered by one column
+        double arrivalMs{0.0};       // energy peak
+        float peakDb{-200.0f};       // energy peak re full scale (0 dB: unit gain IR sample)
+        bool valid{false};           // false until the first non-silent IR
+    };
+
+    static constexpr int numColumns = 1024;
+    static constexpr float etcFloorDb = -100.0f;
+
+    explicit TFImpulseResponse(TFProcessor& processor);
+    ~TFImpulseResponse() override;
+
+    // Message thread. Also turns the processor's IR computation on/off.
+    void start();
+    void stop();
+    bool isRunning() const { return isThreadRunning(); }
+
+    // Latest display data (any thread)
+    void getDisplay(Display& display);
+    uint64_t getGeneration() const { return generation.load(std::memory_order_acquire); }
+
+private:
+    void run() override;
+    void decimate(double sampleRate);
+
+    TFProcessor& processor;
+
+    static constexpr int pollIntervalMs = 20;
+    uint64_t lastProcessorGeneration{0};
+
+    // Worker side
+    std::vector<float> impulseResponse;
+    std::vector<float> energy;
+    Display working;
+
+    // Published
+    Display published;
+    juce::CriticalSection displayLock;
+    std::atomic<uint64_t> generation{0};
+};
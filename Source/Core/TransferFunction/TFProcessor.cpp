@@ -1,6 +1,7 @@
 #include "TFProcessor.h"
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 TFProcessor::TFProcessor()
     : referenceFFT(std::make_unique<FFTAnalyzer>())
@@ -10,125 +11,389 @@ TFProcessor::TFProcessor()
 
 TFProcessor::~TFProcessor()
 {
+    stopPipelineBuilder();
 }
 
 void TFProcessor::prepare(int newFFTSize, double newSampleRate)
 {
-    juce::ScopedLock lock(processLock);
+    // A pipeline still being built (or waiting) was made for the old layout
+    stopPipelineBuilder();
     
-    fftSize = newFFTSize;
-    sampleRate = newSampleRate;
+    analysisSettings.fftSize = newFFTSize;
+    preparedSampleRate = newSampleRate;
     
-    // Calculate hop size (75% overlap)
-    hopSize = static_cast<int>(fftSize * (1.0 - overlap));
-    frameDt = static_cast<double>(hopSize) / sampleRate;
+    // Already running (device change): the audio thread may be inside processBlock, so the
+    // new state is handed over like a settings change and reset there (see adoptPipeline)
+    if (ready.load())
+    {
+        resetOnAdopt.store(true);
+        pipelineBuilder = std::make_unique<PipelineBuilder>(*this, analysisSettings, newSampleRate);
+        pipelineBuilder->startThread(juce::Thread::Priority::low);
+        return;
+    }
     
-    // Update averaging alpha using time constant
-    // alpha = exp(-frameDt / Tavg) for exponential averaging
-    // Smaart-like time constant (1.5s) for stable display
-    // Use adaptive averaging: fast initially (0.3s), then stable (1.5s)
-    double Tavg = averagingTime.load();
-    averagingAlpha = std::exp(-frameDt / Tavg);
+    auto pipeline = buildPipeline(analysisSettings, newSampleRate);
+    
+    juce::ScopedLock lock(processLock);
+    
+    swapPipeline(*pipeline);
     
     // Log averaging settings for debugging
-    juce::Logger::writeToLog("TFProcessor::prepare - Averaging: Tavg=" + juce::String(Tavg, 3) + 
+    juce::Logger::writeToLog("TFProcessor::prepare - Averaging: Tavg=" + juce::String(averagingTime.load(), 3) + 
                              "s, alpha=" + juce::String(averagingAlpha, 4) + 
                              ", frameDt=" + juce::String(frameDt * 1000.0, 2) + "ms");
     
+    int spectrumSize = fftSize / 2 + 1;
+    
+    // DIAGNOSTIC LOG: Processor settings (Parte 3)
+    juce::Logger::writeToLog("TFProcessor::prepare - fftSize=" + juce::String(fftSize) + 
+                             ", overlap=" + juce::String(overlap, 2) +
+                             ", window=" + FFTAnalyzer::getWindowName(analysisSettings.window) +
+                             ", sampleRate=" + juce::String(sampleRate, 1) + 
+                             ", spectrumSize=" + juce::String(spectrumSize) +
+                             ", freq[0]=" + juce::String(frequencies[0], 2) +
+                             ", freq[100]=" + juce::String(frequencies[juce::jmin(100, spectrumSize-1)], 2) +
+                             ", freq[1000]=" + juce::String(frequencies[juce::jmin(1000, spectrumSize-1)], 2) +
+                             ", freq[last]=" + juce::String(frequencies[spectrumSize-1], 2));
+    
+    // Clear buffers
+    referenceBuffer.clear();
+    measurementBuffer.clear();
+    
+    // Reset delay state
+    lastDelaySec = 0.0;
+    stableDelayCount = 0;
+    delayLocked = false;
+    estimatedDelay = 0.0;
+    smoothedDelay = 0.0;
+    delayUpdateCounter = 0;
+    
+    reset();
+    ready.store(true);
+}
+
+TFProcessor::AnalysisSettings TFProcessor::clampSettings(const AnalysisSettings& requested)
+{
+    AnalysisSettings settings = requested;
+    settings.fftSize = juce::jlimit(minFFTSize, maxFFTSize, juce::nextPowerOfTwo(juce::jmax(1, requested.fftSize)));
+    settings.overlap = juce::jlimit(minOverlap, maxOverlap, requested.overlap);
+    settings.averaging = TFAveragingEngine::clampSettings(requested.averaging);
+    settings.logPointsPerOctave = requested.logPointsPerOctave > 0
+                                      ? juce::jlimit(minLogPointsPerOctave, maxLogPointsPerOctave, requested.logPointsPerOctave)
+                                      : 0;
+    return settings;
+}
+
+std::unique_ptr<TFProcessor::Pipeline> TFProcessor::buildPipeline(const AnalysisSettings& settings, double forSampleRate) const
+{
+    auto p = std::make_unique<Pipeline>();
+    p->settings = settings;
+    p->sampleRate = forSampleRate;
+    
     // Prepare FFT analyzers
     // NOTE: FFTAnalyzer rounds fftSize to nearest power of 2
-    referenceFFT->prepare(fftSize, sampleRate);
-    measurementFFT->prepare(fftSize, sampleRate);
+    p->referenceFFT = std::make_unique<FFTAnalyzer>();
+    p->measurementFFT = std::make_unique<FFTAnalyzer>();
+    p->referenceFFT->prepare(settings.fftSize, forSampleRate, settings.window);
+    p->measurementFFT->prepare(settings.fftSize, forSampleRate, settings.window);
     
     // Get the ACTUAL fftSize used by FFTAnalyzer (may be rounded to power of 2)
-    int actualFFTSize = referenceFFT->getFFTSize();
-    if (actualFFTSize != fftSize)
+    p->fftSize = p->referenceFFT->getFFTSize();
+    if (p->fftSize != settings.fftSize)
     {
         juce::Logger::writeToLog("TFProcessor::prepare - fftSize rounded: " + 
-                                 juce::String(fftSize) + " -> " + juce::String(actualFFTSize));
-        fftSize = actualFFTSize;  // Use the actual FFT size
+                                 juce::String(settings.fftSize) + " -> " + juce::String(p->fftSize));
     }
     
-    int spectrumSize = fftSize / 2 + 1;
+    // Hop size from the overlap (75% by default)
+    p->hopSize = juce::jmax(1, juce::roundToInt(p->fftSize * (1.0 - settings.overlap)));
+    p->frameDt = static_cast<double>(p->hopSize) / forSampleRate;
     
-    // Initialize double-buffered results (after spectrumSize is finalized)
-    magnitudeDbBuffer.resize(spectrumSize, -60.0f);
-    phaseDegreesBuffer.resize(spectrumSize, 0.0f);
-    coherenceBuffer.resize(spectrumSize, 0.0f);
+    // Update averaging alpha using time constant
+    // alpha = exp(-frameDt / Tavg) for exponential averaging
+    // Smaart-like time constant (1.5s) for stable display
+    // Use adaptive averaging: fast initially (0.3s), then stable (1.5s)
+    p->averagingAlpha = std::exp(-p->frameDt / averagingTime.load());
     
-    frameCount = 0;
+    const int spectrumSize = p->fftSize / 2 + 1;
+    
+    // Initialize double-buffered results (after spectrumSize is finalized)
+    p->magnitudeDbBuffer.assign(spectrumSize, -60.0f);
+    p->phaseDegreesBuffer.assign(spectrumSize, 0.0f);
+    p->coherenceBuffer.assign(spectrumSize, 0.0f);
     
     // Resize all vectors
-    X.resize(spectrumSize);
-    Y.resize(spectrumSize);
-    Gxx.resize(spectrumSize, 0.0);
-    Gyy.resize(spectrumSize, 0.0);
-    Gxy.resize(spectrumSize, std::complex<double>(0.0, 0.0));
-    H.resize(spectrumSize, std::complex<double>(0.0, 0.0));
-    H_compensated.resize(spectrumSize, std::complex<double>(0.0, 0.0));
-    H_smoothed.resize(spectrumSize, std::complex<double>(0.0, 0.0));
-    gamma2.resize(spectrumSize, 0.0);
-    
-    magnitudeDb.resize(spectrumSize, -60.0f);
-    phaseDegrees.resize(spectrumSize, 0.0f);
-    coherence.resize(spectrumSize, 0.0f);
-    frequencies.resize(spectrumSize);
+    p->X.assign(spectrumSize, std::complex<double>(0.0, 0.0));
+    p->Y.assign(spectrumSize, std::complex<double>(0.0, 0.0));
+    p->Gxx.assign(spectrumSize, 0.0);
+    p->Gyy.assign(spectrumSize, 0.0);
+    p->Gxy.assign(spectrumSize, std::complex<double>(0.0, 0.0));
+    p->H.assign(spectrumSize, std::complex<double>(0.0, 0.0));
+    p->H_smoothed.assign(spectrumSize, std::complex<double>(0.0, 0.0));
+    p->delayPhasors.assign(spectrumSize, std::complex<double>(1.0, 0.0));
+    p->gamma2.assign(spectrumSize, 0.0);
+    p->averaging = TFAveragingEngine::create(settings.averaging, spectrumSize);
+    
+    p->magnitudeDb.assign(spectrumSize, -60.0f);
+    p->phaseDegrees.assign(spectrumSize, 0.0f);
+    p->coherence.assign(spectrumSize, 0.0f);
+    p->frequencies.resize(spectrumSize);
     
     // Pre-compute frequency bins
     // CORRECT FORMULA: freqHz = k * sampleRate / fftSize
     // where k is the bin index (0..spectrumSize-1) and fftSize is the actual FFT size (e.g., 16384)
     for (int i = 0; i < spectrumSize; ++i)
     {
-        frequencies[i] = static_cast<float>(i * sampleRate / static_cast<double>(fftSize));
+        p->frequencies[i] = static_cast<float>(i * forSampleRate / static_cast<double>(p->fftSize));
     }
     
-    // DIAGNOSTIC LOG: Processor settings (Parte 3)
-    juce::Logger::writeToLog("TFProcessor::prepare - fftSize=" + juce::String(fftSize) + 
-                             ", sampleRate=" + juce::String(sampleRate, 1) + 
-                             ", spectrumSize=" + juce::String(spectrumSize) +
-                             ", freq[0]=" + juce::String(frequencies[0], 2) +
-                             ", freq[100]=" + juce::String(frequencies[juce::jmin(100, spectrumSize-1)], 2) +
-                             ", freq[1000]=" + juce::String(frequencies[juce::jmin(1000, spectrumSize-1)], 2) +
-                             ", freq[last]=" + juce::String(frequencies[spectrumSize-1], 2));
+    // Smoothing bands for the current width (rebuilt by applyDelayCompensationAndSmoothing() if it changes)
+    p->smoothingBandsOctaves = smoothingOctaves.load();
+    computeSmoothingBands(p->frequencies, p->smoothingBandsOctaves, p->smoothingFirstBin, p->smoothingLastBin,
+                          p->smoothingSumH, p->smoothingSumW);
     
-    // Clear buffers
-    referenceBuffer.clear();
-    measurementBuffer.clear();
+    // Log-frequency output: grid and bands (the band width follows the smoothing, like above)
+    p->logPointsPerOctave = settings.logPointsPerOctave;
+    if (p->logPointsPerOctave > 0)
+    {
+        computeLogGrid(p->frequencies, p->logPointsPerOctave, p->logFrequencies, p->logInterpolationBin,
+                       p->logInterpolationFraction);
+        p->logBandsOctaves = juce::jmax(p->smoothingBandsOctaves, 1.0 / p->logPointsPerOctave);
+        computeLogBands(p->frequencies, p->logFrequencies, p->logBandsOctaves, p->logFirstBin, p->logLastBin);
+        
+        const size_t numPoints = p->logFrequencies.size();
+        p->logMagnitudeDb.assign(numPoints, -60.0f);
+        p->logPhaseDegrees.assign(numPoints, 0.0f);
+        p->logCoherence.assign(numPoints, 0.0f);
+        p->logFrequenciesBuffer = p->logFrequencies;
+        p->logMagnitudeDbBuffer.assign(numPoints, -60.0f);
+        p->logPhaseDegreesBuffer.assign(numPoints, 0.0f);
+        p->logCoherenceBuffer.assign(numPoints, 0.0f);
+    }
     
     // Initialize GCC-PHAT FFT for fast delay detection
     // Calculate FFT order (must be power of 2)
-    phatFftOrder = static_cast<int>(std::round(std::log2(static_cast<double>(fftSize))));
-    int checkSize = 1 << phatFftOrder;
+    p->phatFftOrder = static_cast<int>(std::round(std::log2(static_cast<double>(p->fftSize))));
+    int checkSize = 1 << p->phatFftOrder;
     
-    if (checkSize == fftSize)
+    if (checkSize == p->fftSize)
     {
         // Valid power of 2 - create FFT for IFFT
-        phatFFT = std::make_unique<juce::dsp::FFT>(phatFftOrder);
-        phatFftBuffer.assign(fftSize, std::complex<float>(0.0f, 0.0f));
-        phatTime.assign(fftSize, 0.0f);
+        p->phatFFT = AudioCoPilot::FFTPlanCache::getFFT(p->phatFftOrder);
+        p->phatFftBuffer.assign(p->fftSize, std::complex<float>(0.0f, 0.0f));
+        p->phatTime.assign(p->fftSize, 0.0f);
+        p->impulseResponse.assign(p->fftSize, 0.0f);
+        p->impulseEnergy.assign(p->fftSize, 0.0f);
+        p->impulseResponseBuffer.assign(p->fftSize, 0.0f);
+        p->impulseEnergyBuffer.assign(p->fftSize, 0.0f);
         juce::Logger::writeToLog("TFProcessor::prepare - GCC-PHAT FFT initialized: order=" + 
-                                 juce::String(phatFftOrder) + ", size=" + juce::String(fftSize));
+                                 juce::String(p->phatFftOrder) + ", size=" + juce::String(p->fftSize));
     }
     else
     {
         // Not power of 2 - fallback to phase-based method
-        phatFFT.reset();
-        phatFftBuffer.clear();
-        phatTime.clear();
         juce::Logger::writeToLog("TFProcessor::prepare - GCC-PHAT disabled (fftSize not power of 2: " + 
-                                 juce::String(fftSize) + ")");
+                                 juce::String(p->fftSize) + ")");
     }
     
-    // Reset delay state
-    lastDelaySec = 0.0;
-    stableDelayCount = 0;
-    delayLocked = false;
-    estimatedDelay = 0.0;
-    smoothedDelay = 0.0;
-    delayUpdateCounter = 0;
+    // Waterfall storage: one column per hop
+    p->historyColumns = AudioCoPilot::SpectrumHistory::createColumns(getHistorySettings(p->fftSize, p->frameDt, forSampleRate));
     
-    reset();
-    ready.store(true);
+    return p;
+}
+
+void TFProcessor::swapPipeline(Pipeline& p)
+{
+    // Caller holds processLock; afterwards p holds the previous state
+    std::swap(sampleRate, p.sampleRate);
+    std::swap(fftSize, p.fftSize);
+    std::swap(hopSize, p.hopSize);
+    std::swap(frameDt, p.frameDt);
+    std::swap(averagingAlpha, p.averagingAlpha);
+    overlap = p.settings.overlap;
+    
+    std::swap(referenceFFT, p.referenceFFT);
+    std::swap(measurementFFT, p.measurementFFT);
+    
+    X.swap(p.X);
+    Y.swap(p.Y);
+    Gxx.swap(p.Gxx);
+    Gyy.swap(p.Gyy);
+    Gxy.swap(p.Gxy);
+    H.swap(p.H);
+    H_smoothed.swap(p.H_smoothed);
+    delayPhasors.swap(p.delayPhasors);
+    delayPhasorsTau = std::numeric_limits<double>::quiet_NaN();  // new bins (and maybe rate): rebuild
+    gamma2.swap(p.gamma2);
+    std::swap(averaging, p.averaging);
+    averagingMemoryBytes.store(averaging->getMemoryBytes(), std::memory_order_relaxed);
+    
+    magnitudeDb.swap(p.magnitudeDb);
+    phaseDegrees.swap(p.phaseDegrees);
+    coherence.swap(p.coherence);
+    frequencies.swap(p.frequencies);
+    
+    {
+        juce::ScopedLock bufferLockGuard(bufferLock);
+        magnitudeDbBuffer.swap(p.magnitudeDbBuffer);
+        phaseDegreesBuffer.swap(p.phaseDegreesBuffer);
+        coherenceBuffer.swap(p.coherenceBuffer);
+        impulseResponseBuffer.swap(p.impulseResponseBuffer);
+        impulseEnergyBuffer.swap(p.impulseEnergyBuffer);
+        logFrequenciesBuffer.swap(p.logFrequenciesBuffer);
+        logMagnitudeDbBuffer.swap(p.logMagnitudeDbBuffer);
+        logPhaseDegreesBuffer.swap(p.logPhaseDegreesBuffer);
+        logCoherenceBuffer.swap(p.logCoherenceBuffer);
+    }
+    
+    std::swap(phatFFT, p.phatFFT);
+    std::swap(phatFftOrder, p.phatFftOrder);
+    phatFftBuffer.swap(p.phatFftBuffer);
+    phatTime.swap(p.phatTime);
+    impulseResponse.swap(p.impulseResponse);
+    impulseEnergy.swap(p.impulseEnergy);
+    
+    std::swap(smoothingBandsOctaves, p.smoothingBandsOctaves);
+    smoothingFirstBin.swap(p.smoothingFirstBin);
+    smoothingLastBin.swap(p.smoothingLastBin);
+    smoothingSumH.swap(p.smoothingSumH);
+    smoothingSumW.swap(p.smoothingSumW);
+    
+    std::swap(logPointsPerOctave, p.logPointsPerOctave);
+    logFrequencies.swap(p.logFrequencies);
+    logInterpolationBin.swap(p.logInterpolationBin);
+    logInterpolationFraction.swap(p.logInterpolationFraction);
+    std::swap(logBandsOctaves, p.logBandsOctaves);
+    logFirstBin.swap(p.logFirstBin);
+    logLastBin.swap(p.logLastBin);
+    logMagnitudeDb.swap(p.logMagnitudeDb);
+    logPhaseDegrees.swap(p.logPhaseDegrees);
+    logCoherence.swap(p.logCoherence);
+    
+    magnitudeHistory.install(p.historyColumns);
+}
+
+void TFProcessor::setAnalysisSettings(const AnalysisSettings& requested)
+{
+    const auto settings = clampSettings(requested);
+    stopPipelineBuilder();
+    analysisSettings = settings;
+    
+    if (!ready.load())
+        return;  // prepare() builds with these
+    
+    pipelineBuilder = std::make_unique<PipelineBuilder>(*this, settings, preparedSampleRate);
+    pipelineBuilder->startThread(juce::Thread::Priority::low);
+}
+
+void TFProcessor::stopPipelineBuilder()
+{
+    if (pipelineBuilder != nullptr)
+    {
+        pipelineBuilder->signalThreadShouldExit();
+        pipelineBuilder->stopThread(-1);
+        pipelineBuilder.reset();
+    }
+    
+    // Nothing can hand over or retire a pipeline now, except an audio block already
+    // inside adoptPipeline(): take processLock so it has finished
+    juce::ScopedLock lock(processLock);
+    delete pendingPipeline.exchange(nullptr);
+    delete retiredPipeline.exchange(nullptr);
+}
+
+TFProcessor::PipelineBuilder::PipelineBuilder(TFProcessor& owner, const AnalysisSettings& s, double rate)
+    : juce::Thread("TF pipeline builder"), processor(owner), settings(s), sampleRate(rate)
+{
+}
+
+void TFProcessor::PipelineBuilder::run()
+{
+    auto pipeline = processor.buildPipeline(settings, sampleRate);
+    if (threadShouldExit())
+        return;
+    
+    const auto applied = "TFProcessor - analysis settings applied: fftSize=" + juce::String(pipeline->fftSize) +
+                         ", overlap=" + juce::String(pipeline->settings.overlap, 2) +
+                         ", window=" + FFTAnalyzer::getWindowName(pipeline->settings.window) +
+                         ", averaging=" + TFAveragingEngine::getModeName(pipeline->averaging->getMode()) +
+                         ", sampleRate=" + juce::String(sampleRate, 1);
+    
+    // Hand over; a pipeline the audio thread never picked up is replaced (and freed here)
+    delete processor.pendingPipeline.exchange(pipeline.release());
+    
+    // The audio thread gives back the state it swapped out: free it here, not there
+    while (!threadShouldExit())
+    {
+        if (auto* retired = processor.retiredPipeline.exchange(nullptr))
+        {
+            delete retired;
+            juce::Logger::writeToLog(applied);
+            return;
+        }
+        
+        wait(20);
+    }
+}
+
+void TFProcessor::adoptPipeline(Pipeline& next)
+{
+    juce::ScopedLock lock(processLock);
+    
+    const int oldBins = static_cast<int>(Gxx.size());
+    const int newBins = static_cast<int>(next.Gxx.size());
+    const bool resetState = resetOnAdopt.exchange(false);
+    const bool carryOver = !resetState && frameCount > 0 && oldBins > 1 && newBins > 1;
+    
+    if (carryOver)
+    {
+        // Old averages onto the new bins (linear interpolation in frequency). The window's noise
+        // gain changes the level of every spectrum alike, so H and coherence are unaffected,
+        // but the new frames must average into values of their own scale
+        const double gain = next.referenceFFT->getWindowPower() / juce::jmax(eps, referenceFFT->getWindowPower());
+        const double binRatio = static_cast<double>(fftSize) / static_cast<double>(next.fftSize);
+        
+        for (int k = 0; k < newBins; ++k)
+        {
+            const double position = juce::jmin(static_cast<double>(oldBins - 1), k * binRatio);
+            const int i0 = juce::jmin(static_cast<int>(position), oldBins - 2);
+            const double t = position - i0;
+            
+            next.Gxx[k] = gain * ((1.0 - t) * Gxx[i0] + t * Gxx[i0 + 1]);
+            next.Gyy[k] = gain * ((1.0 - t) * Gyy[i0] + t * Gyy[i0 + 1]);
+            next.Gxy[k] = gain * ((1.0 - t) * Gxy[i0] + t * Gxy[i0 + 1]);
+            
+            next.H[k] = next.Gxy[k] / (next.Gxx[k] + eps);
+            next.gamma2[k] = std::norm(next.Gxy[k]) / (next.Gxx[k] * next.Gyy[k] + eps);
+        }
+        
+        next.averaging->seed(next.Gxx.data(), next.Gyy.data(), next.Gxy.data());
+    }
+    
+    swapPipeline(next);
+    
+    // Cross-fade: new frames blend in at the normal averaging time (no fast start, which would
+    // throw the carried-over averages away), and the display moves to the new bins right away
+    if (resetState)
+    {
+        // Re-prepared: nothing of the old stream carries over, as in the first prepare()
+        lastDelaySec = 0.0;
+        stableDelayCount = 0;
+        delayLocked = false;
+        reset();
+    }
+    else if (carryOver)
+    {
+        frameCount = fastAveragingFrames;
+        publishFrame();
+    }
+    else
+    {
+        frameCount = 0;
+    }
+    
+    // No logging here (audio thread): PipelineBuilder logs once the old state comes back
+    retiredPipeline.store(&next);
 }
 
 // OLD methods removed - caused sync issues
@@ -139,6 +404,21 @@ void TFProcessor::processBlock(const float* ref, const float* meas, int numSampl
     if (!ready.load() || numSamples <= 0)
         return;
     
+    // New analysis settings (built by PipelineBuilder) take effect between frames
+    if (pendingPipeline.load(std::memory_order_relaxed) != nullptr)
+    {
+        juce::ScopedLock lock(processLock);
+        if (auto* next = pendingPipeline.exchange(nullptr))
+            adoptPipeline(*next);
+    }
+    
+    // reset() only requests this: the input buffers belong to the audio thread
+    if (clearInputRequested.exchange(false))
+    {
+        referenceBuffer.clear();
+        measurementBuffer.clear();
+    }
+    
     // Accumulate samples from both channels together (guaranteed synchronized)
     referenceBuffer.insert(referenceBuffer.end(), ref, ref + numSamples);
     measurementBuffer.insert(measurementBuffer.end(), meas, meas + numSamples);
@@ -193,110 +473,215 @@ void TFProcessor::processFrame()
     
     // Step 1: Adaptive averaging - fast initially, stable later
     // Use fast averaging (0.3s) for first 30 frames, then switch to stable (1.5s)
-    if (frameCount <= fastAveragingFrames)
-    {
-        // Fast averaging for quick initial response (0.3s time constant)
-        double fastAlpha = std::exp(-frameDt / 0.3);
-        double oldAlpha = averagingAlpha;
-        averagingAlpha = fastAlpha;
-        updateAverages();
-        averagingAlpha = oldAlpha;  // Restore for next frame
-    }
+    addToAverages(X.data(), getFrameAlpha(frameCount));
+    
+    finishFrame(X.data());
+}
+
+void TFProcessor::processPairFrame(const SharedReference& reference, const std::vector<std::complex<float>>& measurementSpectrum)
+{
+    if (!ready.load())
+        return;
+    
+    juce::ScopedLock lock(processLock);
+    
+    const int spectrumSize = static_cast<int>(Y.size());
+    if (static_cast<int>(reference.X.size()) != spectrumSize || static_cast<int>(measurementSpectrum.size()) < spectrumSize)
+        return;
+    
+    for (int i = 0; i < spectrumSize; ++i)
+        Y[i] = std::complex<double>(measurementSpectrum[i].real(), measurementSpectrum[i].imag());
+    
+    // Gxx and the averaging step come with the reference (shared by all pairs); the other
+    // modes keep per-pair state, so they average this pair's own Gxx
+    frameCount++;
+    if (averaging->getMode() == TFAveragingEngine::Mode::exponential)
+        updateAverages(reference.X.data(), reference.Gxx.data(), reference.alpha);
     else
-    {
-        // Normal averaging (1.5s time constant)
-        updateAverages();
-    }
+        addToAverages(reference.X.data(), reference.alpha);
     
-    // Step 2: Estimate delay using GCC-PHAT (uses instantaneous spectrum)
-    // Update delay more frequently when searching for faster response
-    delayUpdateCounter++;
-    int delayPeriod = delayLocked ? 20 : 2;  // Every 2 frames when searching (was 4), every 20 when locked
-    if (delayUpdateCounter >= delayPeriod)
-    {
-        delayUpdateCounter = 0;
-        estimateDelay();  // GCC-PHAT with instantaneous X/Y
-    }
+    finishFrame(reference.X.data());
+}
+
+double TFProcessor::getFrameAlpha(int frame) const
+{
+    // Fast averaging for quick initial response (0.3s time constant)
+    if (frame <= fastAveragingFrames)
+        return std::exp(-frameDt / 0.3);
     
-    // Step 3: Apply delay compensation ALWAYS (even without lock) for immediate display
-    // Smaart applies delay compensation immediately, not waiting for lock
-    if (std::abs(estimatedDelay) > 1e-6)
+    // Normal averaging (1.5s time constant)
+    return averagingAlpha;
+}
+
+void TFProcessor::finishFrame(const std::complex<double>* x)
+{
+    // Step 2: Estimate delay using GCC-PHAT (uses instantaneous spectrum)
+    // An external (sub-sample) estimate takes over while it is set
+    if (externalDelayValid.load())
     {
-        applyDelayCompensation();
+        estimatedDelay = externalDelay.load();
+        delayLocked = true;
     }
     else
     {
-        // No delay compensation if delay is negligible
-        H_compensated = H;
+        // Update delay more frequently when searching for faster response
+        delayUpdateCounter++;
+        int delayPeriod = delayLocked ? 20 : 2;  // Every 2 frames when searching (was 4), every 20 when locked
+        if (delayUpdateCounter >= delayPeriod)
+        {
+            delayUpdateCounter = 0;
+            estimateDelay(x);  // GCC-PHAT with instantaneous X/Y
+        }
     }
     
-    // Step 4: Apply smoothing in complex domain (1/12 octave, Smaart-like)
-    applySmoothing();
-    
-    // Step 5: Unwrap phase (still in complex domain) - Always apply for stable display
-    unwrapPhase();
+    // Divided: the waterfall gets the one column per skipped frame too, so its time axis holds
+    if (++framesSincePublish >= publishDivider.load())
+    {
+        publishFrame(framesSincePublish);
+        framesSincePublish = 0;
+    }
+}
+
+void TFProcessor::publishFrame(int historyColumns)
+{
+    // Steps 3 + 4: Delay compensation ALWAYS (even without lock) for immediate display, as
+    // Smaart does, and smoothing in the complex domain (1/12 octave), in one pass over H
+    applyDelayCompensationAndSmoothing();
     
-    // Step 6: Extract magnitude and phase (ONLY AFTER all processing)
+    // Step 5: Extract magnitude and phase (ONLY AFTER all processing), holding the phase over
+    // low-coherence bins for a stable display
     extractMagnitudeAndPhase();
     
-    // Step 7: Update double-buffered results for smooth UI (atomic swap)
+    if (logPointsPerOctave > 0)
+        computeLogOutput();
+    
+    // Step 6: Update double-buffered results for smooth UI (atomic swap)
     {
         juce::ScopedLock bufferLockGuard(bufferLock);
         magnitudeDbBuffer = magnitudeDb;
         phaseDegreesBuffer = phaseDegrees;
         coherenceBuffer = coherence;
+        logMagnitudeDbBuffer = logMagnitudeDb;
+        logPhaseDegreesBuffer = logPhaseDegrees;
+        logCoherenceBuffer = logCoherence;
     }
     
+    // Waterfall column (quantized onto the history's log grid, no allocation)
+    for (int i = 0; i < historyColumns; ++i)
+        magnitudeHistory.pushDecibels(magnitudeDb.data(), static_cast<int>(magnitudeDb.size()));
+    
     // Signal UI update (stable updates, not every frame)
     newDataAvailable.store(true);
+    outputGeneration.fetch_add(1, std::memory_order_release);
+    
+    if (impulseResponseEnabled.load())
+        computeImpulseResponse();
+}
+
+void TFProcessor::computeImpulseResponse()
+{
+    // Averaged H1 (not the delay-compensated one), so the IR shows the true arrival time
+    if (!phatFFT || impulseResponse.size() != static_cast<size_t>(fftSize))
+        return;
+    
+    const int N = fftSize;
+    const int half = N / 2;
+    
+    // One-sided spectrum (DC and Nyquist once, positive bins doubled, negative bins zero):
+    // its inverse is the analytic IR, real part = IR, magnitude = Hilbert envelope
+    phatFftBuffer[0] = std::complex<float>(static_cast<float>(H[0].real()), 0.0f);
+    for (int k = 1; k < half; ++k)
+        phatFftBuffer[k] = std::complex<float>(static_cast<float>(2.0 * H[k].real()), static_cast<float>(2.0 * H[k].imag()));
+    phatFftBuffer[half] = std::complex<float>(static_cast<float>(H[half].real()), 0.0f);
+    std::fill(phatFftBuffer.begin() + half + 1, phatFftBuffer.end(), std::complex<float>(0.0f, 0.0f));
+    
+    // Inverse (already scaled by 1 / N by juce::dsp::FFT): H = 1 gives a unit sample at t = 0
+    phatFFT->perform(phatFftBuffer.data(), phatFftBuffer.data(), true);
+    
+    // Rotate so the last preRoll samples (negative time, circular) come first
+    const int preRoll = getImpulsePreRoll(N);
+    for (int i = 0; i < N; ++i)
+    {
+        const auto a = phatFftBuffer[(i - preRoll + N) % N];
+        impulseResponse[i] = a.real();
+        impulseEnergy[i] = std::norm(a);
+    }
+    
+    {
+        juce::ScopedLock bufferLockGuard(bufferLock);
+        impulseResponseBuffer.swap(impulseResponse);
+        impulseEnergyBuffer.swap(impulseEnergy);
+    }
+    
+    impulseGeneration.fetch_add(1, std::memory_order_release);
 }
 
-// computeCrossSpectrum is now integrated into updateAverages
+void TFProcessor::updateReferenceAverage(const std::complex<double>* x, double* gxx, int numBins, double alpha)
+{
+    // Gxx = avg(X * conj(X)) = avg(|X|^2)
+    for (int k = 0; k < numBins; ++k)
+        gxx[k] = alpha * gxx[k] + (1.0 - alpha) * std::norm(x[k]);
+}
 
-void TFProcessor::updateAverages()
+void TFProcessor::updateAverages(const std::complex<double>* x, const double* gxx, double alpha)
 {
-    int spectrumSize = static_cast<int>(X.size());
-    double alpha = averagingAlpha;
+    int spectrumSize = static_cast<int>(Y.size());
     
     // Follow exact formula from document:
-    // Gxx = avg(X * conj(X))
+    // Gxx = avg(X * conj(X))   (already updated for this frame, see updateReferenceAverage)
     // Gxy = avg(Y * conj(X))
     // H = Gxy / (Gxx + eps)
     
     // Exponential averaging (IIR)
     for (int k = 0; k < spectrumSize; ++k)
     {
-        // Instantaneous values for this frame
-        // Gxx_k = X * conj(X) = |X|^2
-        double Gxx_k = std::norm(X[k]);
-        
         // Gxy_k = Y * conj(X)  (MEAS * conj(REF)) - CORRECT FORMULA
-        std::complex<double> Gxy_k = Y[k] * std::conj(X[k]);
+        std::complex<double> Gxy_k = Y[k] * std::conj(x[k]);
         
         // Update averages in complex domain (Smaart-like):
-        // avgGxx = alpha*avgGxx + (1-alpha)*Gxx_k
         // avgGxy = alpha*avgGxy + (1-alpha)*Gxy_k
         // This ensures fast convergence and stability
-        Gxx[k] = alpha * Gxx[k] + (1.0 - alpha) * Gxx_k;
         Gxy[k] = alpha * Gxy[k] + (1.0 - alpha) * Gxy_k;
         
         // Also compute Gyy for coherence calculation
         double Gyy_k = std::norm(Y[k]);
         Gyy[k] = alpha * Gyy[k] + (1.0 - alpha) * Gyy_k;
         
+    }
+    
+    updateEstimates(gxx);
+}
+
+void TFProcessor::addToAverages(const std::complex<double>* x, double alpha)
+{
+    // Rejected frames (coherence gate) leave the averages and H as they were
+    if (averaging->addFrame(x, Y.data(), alpha, Gxx.data(), Gyy.data(), Gxy.data()))
+        updateEstimates(Gxx.data());
+    else
+        framesRejected.store(averaging->getFramesRejected(), std::memory_order_relaxed);
+    
+    framesAveraged.store(averaging->getFramesAveraged(), std::memory_order_relaxed);
+}
+
+void TFProcessor::updateEstimates(const double* gxx)
+{
+    const int spectrumSize = static_cast<int>(Y.size());
+    
+    for (int k = 0; k < spectrumSize; ++k)
+    {
         // Compute H1 = avgGxy / (avgGxx + eps) - ONLY AFTER averaging
         // This ensures phase is stable and converges quickly
-        double denom = Gxx[k] + eps;
+        double denom = gxx[k] + eps;
         H[k] = Gxy[k] / denom;
         
         // Compute coherence: gamma2 = |Gxy|^2 / (Gxx * Gyy)
         double num = std::norm(Gxy[k]);
-        double denom_coh = Gxx[k] * Gyy[k] + eps;
+        double denom_coh = gxx[k] * Gyy[k] + eps;
         gamma2[k] = num / denom_coh;
     }
 }
 
-void TFProcessor::estimateDelay()
+void TFProcessor::estimateDelay(const std::complex<double>* x)
 {
     // Use GCC-PHAT with INSTANTANEOUS spectrum (X, Y) for fast delay detection
     // This avoids chicken-and-egg: doesn't depend on averaged coherence
@@ -317,7 +702,7 @@ void TFProcessor::estimateDelay()
     for (int k = 0; k < spectrumSize; ++k)
     {
         // Instantaneous cross-spectrum: Y * conj(X)
-        std::complex<double> C_k = Y[k] * std::conj(X[k]);
+        std::complex<double> C_k = Y[k] * std::conj(x[k]);
         double mag = std::abs(C_k);
         if (mag > eps)
         {
@@ -430,16 +815,6 @@ void TFProcessor::estimateDelay()
     
     // Step 9: Safety clamp (±50ms)
     estimatedDelay = juce::jlimit(-0.05, 0.05, estimatedDelay);
-    
-    // Log delay (every 50 updates to avoid spam)
-    static int logCounter = 0;
-    logCounter++;
-    if (logCounter % 50 == 0)
-    {
-        juce::Logger::writeToLog("TFProcessor::estimateDelay - " + 
-                                 juce::String(estimatedDelay * 1000.0, 2) + " ms " +
-                                 (delayLocked ? "(locked)" : "(searching)"));
-    }
 }
 
 void TFProcessor::estimateDelayPhaseBased()
@@ -515,228 +890,351 @@ void TFProcessor::estimateDelayPhaseBased()
     }
 }
 
-void TFProcessor::applyDelayCompensation()
+void TFProcessor::applyDelayCompensationAndSmoothing()
 {
-    int spectrumSize = static_cast<int>(H.size());
+    const int spectrumSize = static_cast<int>(H.size());
     double tau = estimatedDelay;
     
-    // Protection: reset delay if it seems wrong (more than 100ms is suspicious)
-    if (std::abs(tau) > 0.1)
+    // Protection: reset delay if it seems wrong (beyond what any finder may report). Counted,
+    // not logged: this runs on the audio thread (TFController logs new resets)
+    if (std::abs(tau) > maxCompensatedDelay)
     {
+        delayResets.fetch_add(1, std::memory_order_relaxed);
         estimatedDelay = 0.0;
         smoothedDelay = 0.0;
         tau = 0.0;
-        juce::Logger::writeToLog("TFProcessor::applyDelayCompensation - Delay reset (too large: " + juce::String(tau, 4) + "s)");
     }
     
-    // Apply delay compensation in complex domain
-    // H_comp = H * exp(+j*2*pi*f*tau)
-    // This removes the linear phase component due to delay between REF and MEAS channels
-    for (int k = 0; k < spectrumSize; ++k)
+    // Apply fractional-octave smoothing (1/12 octave default, Smaart-like); skipped only if
+    // oct is extremely small
+    const double oct = smoothingOctaves.load();
+    const bool smoothing = oct >= 1.0/96.0;
+    if (smoothing && (oct != smoothingBandsOctaves || static_cast<int>(smoothingFirstBin.size()) != spectrumSize))
+        prepareSmoothingBands(oct);
+    
+    // Delay compensation in complex domain: H_comp = H * exp(+j*2*pi*f*tau), removing the
+    // linear phase due to the delay between REF and MEAS. The rotations come from a table
+    // rebuilt only when the (quantized) delay changes, so the pass below is an independent
+    // complex multiply per bin that the compiler can vectorise.
+    // No rotation if the delay is negligible.
+    const bool rotate = std::abs(tau) > 1e-6;
+    if (rotate)
+    {
+        tau = std::round(tau / delayPhasorResolution) * delayPhasorResolution;
+        if (tau != delayPhasorsTau || static_cast<int>(delayPhasors.size()) != spectrumSize)
+            buildDelayPhasors(tau, spectrumSize);
+        
+        const auto* h = H.data();
+        const auto* phasor = delayPhasors.data();
+        auto* out = H_smoothed.data();
+        for (int k = 0; k < spectrumSize; ++k)
+        {
+            // Written out: std::complex's operator* adds NaN/infinity checks that stop vectorisation
+            const double re = h[k].real(), im = h[k].imag();
+            const double pRe = phasor[k].real(), pIm = phasor[k].imag();
+            out[k] = std::complex<double>(re * pRe - im * pIm, re * pIm + im * pRe);
+        }
+    }
+    else
     {
-        double f = frequencies[k];
-        double phase_comp = 2.0 * juce::MathConstants<double>::pi * f * tau;
-        std::complex<double> comp = std::exp(std::complex<double>(0.0, phase_comp));
-        H_compensated[k] = H[k] * comp;
+        std::copy(H.begin(), H.end(), H_smoothed.begin());
     }
     
-    // Log delay compensation (every 100 delay updates to avoid spam)
-    static int delayLogCounter = 0;
-    delayLogCounter++;
-    if (delayLogCounter % 100 == 0 && std::abs(tau) > 1e-6)
+    // Prefix sums of the coherence-weighted, compensated H (H_smoothed also keeps it as the
+    // unsmoothed fallback), so each band costs two lookups below (and in computeLogOutput(),
+    // which needs them even without smoothing). Serial: every sum carries the previous one.
+    if (smoothing || logPointsPerOctave > 0)
+    {
+        smoothingSumH[0] = std::complex<double>(0.0, 0.0);
+        smoothingSumW[0] = 0.0;
+        
+        for (int k = 0; k < spectrumSize; ++k)
+        {
+            // Weight by coherence
+            const double w = std::max(0.0, std::min(1.0, gamma2[k]));
+            smoothingSumH[k + 1] = smoothingSumH[k] + w * H_smoothed[k];
+            smoothingSumW[k + 1] = smoothingSumW[k] + w;
+        }
+    }
+    
+    if (!smoothing)
+        return;
+    
+    // Fractional-octave smoothing (reads only the prefix sums, so H_smoothed is updated in place)
+    for (int k = 0; k < spectrumSize; ++k)
     {
-        juce::Logger::writeToLog("TFProcessor::applyDelayCompensation - tau=" + juce::String(tau * 1000.0, 2) + "ms");
+        const int first = smoothingFirstBin[k];
+        const int last = smoothingLastBin[k];
+        
+        // Out of range (first < 0), or not enough bins in the band: keep the bin as is
+        if (first < 0 || last - first + 1 < 3)
+            continue;
+        
+        const double sum_w = smoothingSumW[last + 1] - smoothingSumW[first];
+        if (sum_w > eps)
+            H_smoothed[k] = (smoothingSumH[last + 1] - smoothingSumH[first]) / sum_w;
     }
 }
 
-void TFProcessor::applySmoothing()
+void TFProcessor::buildDelayPhasors(double tau, int spectrumSize)
 {
-    int spectrumSize = static_cast<int>(H_compensated.size());
-    double oct = smoothingOctaves.load();
-    
-    // Apply fractional-octave smoothing (1/12 octave default, Smaart-like)
-    // Always apply smoothing for stable display (like Smaart)
-    if (oct < 1.0/96.0)
+    // exp(+j*2*pi*f_k*tau) with f_k = k * sampleRate / fftSize: step^k, by recurrence
+    // re-seeded exactly every phasorReseedBins bins so rounding cannot build up. Serial, but
+    // only when the delay changes. The table is sized with the pipeline, so this never allocates.
+    const double stepAngle = 2.0 * juce::MathConstants<double>::pi * (sampleRate / static_cast<double>(fftSize)) * tau;
+    const std::complex<double> step(std::cos(stepAngle), std::sin(stepAngle));
+    std::complex<double> phasor(1.0, 0.0);
+    
+    const int numBins = juce::jmin(spectrumSize, static_cast<int>(delayPhasors.size()));
+    for (int k = 0; k < numBins; ++k)
     {
-        // Skip smoothing only if oct is extremely small
-        H_smoothed = H_compensated;
-        return;
+        if ((k & (phasorReseedBins - 1)) == 0)
+            phasor = std::polar(1.0, stepAngle * k);
+        
+        delayPhasors[k] = phasor;
+        phasor *= step;
     }
     
-    // Fractional-octave smoothing
+    delayPhasorsTau = tau;
+}
+
+void TFProcessor::prepareSmoothingBands(double oct)
+{
+    smoothingBandsOctaves = oct;
+    computeSmoothingBands(frequencies, oct, smoothingFirstBin, smoothingLastBin, smoothingSumH, smoothingSumW);
+}
+
+void TFProcessor::computeSmoothingBands(const std::vector<float>& binFrequencies, double oct,
+                                        std::vector<int>& firstBin, std::vector<int>& lastBin,
+                                        std::vector<std::complex<double>>& sumH, std::vector<double>& sumW)
+{
+    // Band limits: f1 = f0 * 2^(-oct/2), f2 = f0 * 2^(+oct/2); frequencies are increasing,
+    // so each band is the contiguous bin range [first, last]
+    const int spectrumSize = static_cast<int>(binFrequencies.size());
+    firstBin.assign(spectrumSize, -1);
+    lastBin.assign(spectrumSize, -1);
+    sumH.assign(spectrumSize + 1, std::complex<double>(0.0, 0.0));
+    sumW.assign(spectrumSize + 1, 0.0);
+    
+    const double lowFactor = std::pow(2.0, -oct / 2.0);
+    const double highFactor = std::pow(2.0, +oct / 2.0);
+    
     for (int k = 0; k < spectrumSize; ++k)
     {
-        double f0 = frequencies[k];
+        double f0 = binFrequencies[k];
         if (f0 < 20.0 || f0 > 20000.0)  // Skip out of range
-        {
-            H_smoothed[k] = H_compensated[k];
             continue;
-        }
         
-        // Band limits: f1 = f0 * 2^(-oct/2), f2 = f0 * 2^(+oct/2)
-        double f1 = f0 * std::pow(2.0, -oct / 2.0);
-        double f2 = f0 * std::pow(2.0, +oct / 2.0);
+        const double f1 = f0 * lowFactor;
+        const double f2 = f0 * highFactor;
+        const auto begin = std::lower_bound(binFrequencies.begin(), binFrequencies.end(), f1,
+                                            [](float f, double limit) { return f < limit; });
+        const auto end = std::upper_bound(binFrequencies.begin(), binFrequencies.end(), f2,
+                                          [](double limit, float f) { return limit < f; });
         
-        // Collect bins in band with coherence weighting
-        std::complex<double> sum_H(0.0, 0.0);
-        double sum_w = 0.0;
-        int count = 0;
+        firstBin[k] = static_cast<int>(begin - binFrequencies.begin());
+        lastBin[k] = static_cast<int>(end - binFrequencies.begin()) - 1;
+    }
+}
+
+void TFProcessor::extractMagnitudeAndPhase()
+{
+    const int spectrumSize = static_cast<int>(H_smoothed.size());
+    const double radToDeg = 180.0 / juce::MathConstants<double>::pi;
+    const double minNorm = eps * eps;  // |H| >= eps, as a power
+    
+    // Extract magnitude and phase from averaged complex H, straight into the result buffers
+    // CRITICAL: No averaging in phaseDegrees/phaseRad - averaging is done in complex domain
+    // This ensures fast convergence and stability (Smaart-like)
+    // Blocks of extractBlockBins: |H|^2 and the phase computed once per bin, without atan2 or
+    // sqrt calls, then the (sequential) low-coherence hold over the same bins while they are
+    // still in cache
+    double heldPhase = 0.0;
+    
+    for (int start = 0; start < spectrumSize; start += extractBlockBins)
+    {
+        const int end = juce::jmin(spectrumSize, start + extractBlockBins);
         
-        for (int i = 0; i < spectrumSize; ++i)
+        for (int k = start; k < end; ++k)
         {
-            double f = frequencies[i];
-            if (f >= f1 && f <= f2)
-            {
-                // Weight by coherence
-                double w = std::max(0.0, std::min(1.0, gamma2[i]));
-                sum_H += w * H_compensated[i];
-                sum_w += w;
-                count++;
-            }
+            const double re = H_smoothed[k].real();
+            const double im = H_smoothed[k].imag();
+            
+            // Magnitude in dB from |H|^2: 20*log10(|H|) = 10*log10(|H|^2), no square root
+            magnitudeDb[k] = static_cast<float>(10.0 * std::log10(std::max(re * re + im * im, minNorm)));
+            
+            // Phase in degrees, wrapped to -180..180
+            phaseDegrees[k] = static_cast<float>(fastAtan2(im, re) * radToDeg);
+            
+            // Coherence (0..1)
+            coherence[k] = static_cast<float>(std::max(0.0, std::min(1.0, gamma2[k])));
         }
         
-        // Only smooth if we have enough bins in the band
-        if (sum_w > eps && count >= 3)
+        // Phase along frequency: bins with low coherence keep the phase of the last good bin
+        // below them (DC and bin 1 are taken as they are), so noise does not scatter the trace
+        for (int k = start; k < end; ++k)
         {
-            H_smoothed[k] = sum_H / sum_w;
-        }
-        else
-        {
-            H_smoothed[k] = H_compensated[k];
+            if (k <= 1 || gamma2[k] >= cohMinMath)
+                heldPhase = phaseDegrees[k];
+            else
+                phaseDegrees[k] = static_cast<float>(heldPhase);
         }
     }
 }
 
-void TFProcessor::unwrapPhase()
+void TFProcessor::computeLogOutput()
 {
-    int spectrumSize = static_cast<int>(H_smoothed.size());
-    
-    if (spectrumSize < 2)
-        return;
+    const int numPoints = static_cast<int>(logFrequencies.size());
+    const double radToDeg = 180.0 / juce::MathConstants<double>::pi;
     
-    // Unwrap phase along frequency
-    // Start from bin 1 (skip DC which is often noisy)
-    int startBin = 1;
-    double prev_phase = std::arg(H_smoothed[startBin]);
+    // Bands never narrower than the point spacing, so no bin falls between two points
+    const double bandOctaves = juce::jmax(smoothingOctaves.load(), 1.0 / logPointsPerOctave);
+    if (bandOctaves != logBandsOctaves)
+    {
+        logBandsOctaves = bandOctaves;
+        computeLogBands(frequencies, logFrequencies, bandOctaves, logFirstBin, logLastBin);
+    }
     
-    // Store unwrapped phases
-    std::vector<double> unwrapped_phases(spectrumSize);
-    unwrapped_phases[startBin] = prev_phase;
+    double heldPhase = 0.0;
     
-    // Forward pass: unwrap from low to high frequency
-    for (int k = startBin + 1; k < spectrumSize; ++k)
+    for (int j = 0; j < numPoints; ++j)
     {
-        double curr_phase = std::arg(H_smoothed[k]);
-        double d = curr_phase - prev_phase;
+        const int first = logFirstBin[j];
+        const int last = logLastBin[j];
+        const double sumW = first >= 0 ? smoothingSumW[last + 1] - smoothingSumW[first] : 0.0;
         
-        // Unwrap: if jump > pi, subtract 2pi; if jump < -pi, add 2pi
-        while (d > juce::MathConstants<double>::pi)
-        {
-            curr_phase -= 2.0 * juce::MathConstants<double>::pi;
-            d -= 2.0 * juce::MathConstants<double>::pi;
-        }
-        while (d < -juce::MathConstants<double>::pi)
-        {
-            curr_phase += 2.0 * juce::MathConstants<double>::pi;
-            d += 2.0 * juce::MathConstants<double>::pi;
-        }
+        std::complex<double> h;
+        double pointCoherence;
         
-        // Only update if coherence is good
-        if (gamma2[k] >= cohMinMath)
+        if (first >= 0 && last - first + 1 >= 3 && sumW > eps)
         {
-            unwrapped_phases[k] = curr_phase;
-            H_smoothed[k] = std::polar(std::abs(H_smoothed[k]), curr_phase);
-            prev_phase = curr_phase;
+            // Coherence-weighted band mean (the smoothing kernel itself); the weights are the
+            // clamped coherences, so their sum over the band count is the mean coherence
+            h = (smoothingSumH[last + 1] - smoothingSumH[first]) / sumW;
+            pointCoherence = sumW / (last - first + 1);
         }
         else
         {
-            // Keep previous phase for low coherence bins
-            unwrapped_phases[k] = prev_phase;
-            H_smoothed[k] = std::polar(std::abs(H_smoothed[k]), prev_phase);
+            // Band narrower than the bins (low frequencies): between the two bins around the point
+            const int i = logInterpolationBin[j];
+            const double t = logInterpolationFraction[j];
+            h = (1.0 - t) * H_smoothed[i] + t * H_smoothed[i + 1];
+            pointCoherence = (1.0 - t) * gamma2[i] + t * gamma2[i + 1];
         }
-    }
-    
-    // Backward pass: fix any remaining issues from high to low frequency
-    for (int k = spectrumSize - 2; k >= startBin; --k)
-    {
-        double curr_phase = unwrapped_phases[k];
-        double next_phase = unwrapped_phases[k + 1];
-        double d = next_phase - curr_phase;
         
-        // If there's still a large jump, adjust
-        if (std::abs(d) > juce::MathConstants<double>::pi)
-        {
-            if (d > juce::MathConstants<double>::pi)
-            {
-                curr_phase += 2.0 * juce::MathConstants<double>::pi;
-            }
-            else
-            {
-                curr_phase -= 2.0 * juce::MathConstants<double>::pi;
-            }
-            unwrapped_phases[k] = curr_phase;
-            H_smoothed[k] = std::polar(std::abs(H_smoothed[k]), curr_phase);
-        }
+        logMagnitudeDb[j] = static_cast<float>(10.0 * std::log10(std::max(std::norm(h), eps * eps)));
+        logCoherence[j] = static_cast<float>(std::max(0.0, std::min(1.0, pointCoherence)));
+        
+        // Same low-coherence phase hold as extractMagnitudeAndPhase()
+        const double phase = fastAtan2(h.imag(), h.real()) * radToDeg;
+        if (j == 0 || pointCoherence >= cohMinMath)
+            heldPhase = phase;
+        logPhaseDegrees[j] = static_cast<float>(heldPhase);
     }
 }
 
-void TFProcessor::extractMagnitudeAndPhase()
+void TFProcessor::computeLogGrid(const std::vector<float>& binFrequencies, int pointsPerOctave, std::vector<float>& logFrequencies,
+                                 std::vector<int>& interpolationBin, std::vector<double>& interpolationFraction)
 {
-    int spectrumSize = static_cast<int>(H_smoothed.size());
+    // f_j = logMinFrequency * 2^(j / PPO), up to logMaxFrequency and below Nyquist
+    logFrequencies.clear();
+    interpolationBin.clear();
+    interpolationFraction.clear();
     
-    // Extract magnitude and phase from averaged complex H
-    // CRITICAL: No averaging in phaseDegrees/phaseRad - averaging is done in complex domain
-    // This ensures fast convergence and stability (Smaart-like)
-    for (int k = 0; k < spectrumSize; ++k)
+    const int spectrumSize = static_cast<int>(binFrequencies.size());
+    if (spectrumSize < 2 || pointsPerOctave <= 0)
+        return;
+    
+    const double binWidth = binFrequencies[1];  // bins are k * sampleRate / fftSize
+    const double topFrequency = juce::jmin(logMaxFrequency, static_cast<double>(binFrequencies.back()));
+    const int numPoints = static_cast<int>(std::floor(pointsPerOctave * std::log2(topFrequency / logMinFrequency) + 1.0e-9)) + 1;
+    
+    logFrequencies.reserve(static_cast<size_t>(juce::jmax(0, numPoints)));
+    interpolationBin.reserve(logFrequencies.capacity());
+    interpolationFraction.reserve(logFrequencies.capacity());
+    
+    for (int j = 0; j < numPoints; ++j)
     {
-        // Magnitude in dB: magDb = 20*log10(|Havg|)
-        double mag = std::abs(H_smoothed[k]);
-        magnitudeDb[k] = static_cast<float>(20.0 * std::log10(std::max(mag, eps)));
+        const double f = logMinFrequency * std::pow(2.0, static_cast<double>(j) / pointsPerOctave);
+        const double position = f / binWidth;
+        const int i = juce::jlimit(0, spectrumSize - 2, static_cast<int>(position));
         
-        // Phase in radians: phaseRad = atan2(imag(Havg), real(Havg))
-        // Then convert to degrees
-        double phase_rad = std::atan2(H_smoothed[k].imag(), H_smoothed[k].real());
-        phaseDegrees[k] = static_cast<float>(phase_rad * 180.0 / juce::MathConstants<double>::pi);
-        
-        // Coherence (0..1)
-        coherence[k] = static_cast<float>(std::max(0.0, std::min(1.0, gamma2[k])));
+        logFrequencies.push_back(static_cast<float>(f));
+        interpolationBin.push_back(i);
+        interpolationFraction.push_back(juce::jlimit(0.0, 1.0, position - i));
     }
+}
+
+void TFProcessor::computeLogBands(const std::vector<float>& binFrequencies, const std::vector<float>& logFrequencies,
+                                  double octaves, std::vector<int>& firstBin, std::vector<int>& lastBin)
+{
+    // As computeSmoothingBands(), around the grid points instead of every bin (same sizes each
+    // time for a grid, so no allocation after the first call)
+    const int numPoints = static_cast<int>(logFrequencies.size());
+    firstBin.assign(numPoints, -1);
+    lastBin.assign(numPoints, -1);
+    
+    const double lowFactor = std::pow(2.0, -octaves / 2.0);
+    const double highFactor = std::pow(2.0, +octaves / 2.0);
     
-    // DIAGNOSTIC: Find peak within 20-20k Hz range and calculate expected bin for 1kHz
-    int kPeak = 0;
-    float vPeak = -9999.0f;
-    for (int k = 1; k < spectrumSize; ++k)  // Start from k=1 to skip DC
+    for (int j = 0; j < numPoints; ++j)
     {
-        // Only consider frequencies in 20-20000 Hz range
-        float freq = (k < static_cast<int>(frequencies.size())) ? frequencies[k] : 0.0f;
-        if (freq >= 20.0f && freq <= 20000.0f)
+        const double f1 = logFrequencies[j] * lowFactor;
+        const double f2 = logFrequencies[j] * highFactor;
+        const auto begin = std::lower_bound(binFrequencies.begin(), binFrequencies.end(), f1,
+                                            [](float f, double limit) { return f < limit; });
+        const auto end = std::upper_bound(binFrequencies.begin(), binFrequencies.end(), f2,
+                                          [](double limit, float f) { return limit < f; });
+        
+        if (end > begin)
         {
-            if (magnitudeDb[k] > vPeak)
-            {
-                vPeak = magnitudeDb[k];
-                kPeak = k;
-            }
+            firstBin[j] = static_cast<int>(begin - binFrequencies.begin());
+            lastBin[j] = static_cast<int>(end - binFrequencies.begin()) - 1;
         }
     }
-    
-    // Calculate expected bin for 1kHz: k1k = 1000 * fftSize / sampleRate
-    int k1kExpected = static_cast<int>(1000.0 * fftSize / sampleRate);
-    float freq1kExpected = (k1kExpected < spectrumSize) ? frequencies[k1kExpected] : 0.0f;
-    
-    // Log peak info (every 100 frames to avoid spam)
-    static int frameCounter = 0;
-    frameCounter++;
-    if (kPeak > 0 && frameCounter % 100 == 0)
-    {
-        float peakFreq = (kPeak < static_cast<int>(frequencies.size())) ? frequencies[kPeak] : 0.0f;
-        juce::Logger::writeToLog("TF Peak: k=" + juce::String(kPeak) + 
-                                 " freq=" + juce::String(peakFreq, 2) + " Hz" +
-                                 " mag=" + juce::String(vPeak, 2) + " dB" +
-                                 " Fs=" + juce::String(sampleRate, 1) + 
-                                 " fftSize=" + juce::String(fftSize) +
-                                 " | k@1k expected=" + juce::String(k1kExpected) +
-                                 " freq@k1k=" + juce::String(freq1kExpected, 2) + " Hz");
-    }
+}
+
+double TFProcessor::fastAtan2(double y, double x)
+{
+    // Octant reduction to atan(z), 0 <= z <= 1, then the odd polynomial of Abramowitz & Stegun
+    // 4.4.49 (|error| <= 2e-8 rad, about 1e-6 degrees). Selects instead of branches.
+    const double ax = std::abs(x);
+    const double ay = std::abs(y);
+    const double largest = std::max(ax, ay);
+    const double z = std::min(ax, ay) / (largest > 0.0 ? largest : 1.0);
+    const double s = z * z;
+    
+    double a = z * (1.0 + s * (-0.3333314528 + s * (0.1999355085 + s * (-0.1420889944 + s * (0.1065626393
+                   + s * (-0.0752896400 + s * (0.0429096138 + s * (-0.0161657367 + s * 0.0028662257))))))));
+    a = ay > ax ? 0.5 * juce::MathConstants<double>::pi - a : a;
+    a = x < 0.0 ? juce::MathConstants<double>::pi - a : a;
+    return y < 0.0 ? -a : a;
+}
+
+void TFProcessor::prepareMagnitudeHistory()
+{
+    magnitudeHistory.prepare(getHistorySettings(fftSize, frameDt, sampleRate));
+}
+
+AudioCoPilot::SpectrumHistory::Settings TFProcessor::getHistorySettings(int forFFTSize, double forFrameDt, double forSampleRate) const
+{
+    // One column per processed frame (hop), on a wider dB range than the plot so it can be zoomed later
+    AudioCoPilot::SpectrumHistory::Settings settings;
+    settings.sampleRate = forSampleRate;
+    settings.fftSize = forFFTSize;
+    settings.columnsPerSecond = forFrameDt > 0.0 ? 1.0 / forFrameDt : 10.0;
+    settings.historySeconds = magnitudeHistorySeconds;
+    settings.floorDb = waterfallFloorDb;
+    settings.ceilingDb = waterfallCeilingDb;
+    return settings;
+}
+
+void TFProcessor::setMagnitudeHistorySeconds(double seconds)
+{
+    // processFrame() holds processLock while it writes, so the history can be swapped here
+    juce::ScopedLock lock(processLock);
+    magnitudeHistorySeconds = juce::jlimit(10.0, 3600.0, seconds);
+    prepareMagnitudeHistory();
 }
 
 void TFProcessor::getMagnitudeResponse(std::vector<float>& magnitudeDbOut)
@@ -760,6 +1258,54 @@ void TFProcessor::getCoherence(std::vector<float>& coherenceOut)
     coherenceOut = coherenceBuffer;
 }
 
+void TFProcessor::getResults(std::vector<float>& magnitudeDbOut, std::vector<float>& phaseDegreesOut,
+                             std::vector<float>& coherenceOut)
+{
+    juce::ScopedLock lock(bufferLock);
+    magnitudeDbOut = magnitudeDbBuffer;
+    phaseDegreesOut = phaseDegreesBuffer;
+    coherenceOut = coherenceBuffer;
+}
+
+bool TFProcessor::getLogMagnitudeResponse(std::vector<float>& frequenciesOut, std::vector<float>& magnitudeDbOut,
+                                          std::vector<float>& coherenceOut)
+{
+    juce::ScopedLock lock(bufferLock);
+    if (logFrequenciesBuffer.empty())
+        return false;
+    
+    frequenciesOut = logFrequenciesBuffer;
+    magnitudeDbOut = logMagnitudeDbBuffer;
+    coherenceOut = logCoherenceBuffer;
+    return true;
+}
+
+bool TFProcessor::getLogPhaseResponse(std::vector<float>& frequenciesOut, std::vector<float>& phaseDegreesOut,
+                                      std::vector<float>& coherenceOut)
+{
+    juce::ScopedLock lock(bufferLock);
+    if (logFrequenciesBuffer.empty())
+        return false;
+    
+    frequenciesOut = logFrequenciesBuffer;
+    phaseDegreesOut = logPhaseDegreesBuffer;
+    coherenceOut = logCoherenceBuffer;
+    return true;
+}
+
+void TFProcessor::setExternalDelay(double seconds)
+{
+    externalDelay.store(juce::jlimit(-maxCompensatedDelay, maxCompensatedDelay, seconds));
+    externalDelayValid.store(true);
+}
+
+void TFProcessor::getImpulseResponse(std::vector<float>& impulseResponseOut, std::vector<float>& energyOut)
+{
+    juce::ScopedLock lock(bufferLock);
+    impulseResponseOut = impulseResponseBuffer;
+    energyOut = impulseEnergyBuffer;
+}
+
 void TFProcessor::getFrequencyBins(std::vector<float>& frequenciesOut)
 {
     juce::ScopedLock lock(processLock);
@@ -774,21 +1320,29 @@ void TFProcessor::reset()
     std::fill(Gyy.begin(), Gyy.end(), 0.0);
     std::fill(Gxy.begin(), Gxy.end(), std::complex<double>(0.0, 0.0));
     std::fill(H.begin(), H.end(), std::complex<double>(0.0, 0.0));
-    std::fill(H_compensated.begin(), H_compensated.end(), std::complex<double>(0.0, 0.0));
     std::fill(H_smoothed.begin(), H_smoothed.end(), std::complex<double>(0.0, 0.0));
     std::fill(gamma2.begin(), gamma2.end(), 0.0);
     
     std::fill(magnitudeDb.begin(), magnitudeDb.end(), -60.0f);
     std::fill(phaseDegrees.begin(), phaseDegrees.end(), 0.0f);
     std::fill(coherence.begin(), coherence.end(), 0.0f);
+    std::fill(logMagnitudeDb.begin(), logMagnitudeDb.end(), -60.0f);
+    std::fill(logPhaseDegrees.begin(), logPhaseDegrees.end(), 0.0f);
+    std::fill(logCoherence.begin(), logCoherence.end(), 0.0f);
     
     estimatedDelay = 0.0;
     smoothedDelay = 0.0;
     delayUpdateCounter = 0;
+    externalDelayValid.store(false);
+    framesSincePublish = 0;
     frameCount = 0;
     
-    referenceBuffer.clear();
-    measurementBuffer.clear();
+    if (averaging != nullptr)
+        averaging->reset();
+    framesAveraged.store(0, std::memory_order_relaxed);
+    framesRejected.store(0, std::memory_order_relaxed);
+    
+    clearInputRequested.store(true);  // done by the next processBlock
     
     // Reset double-buffered results
     {
@@ -796,8 +1350,15 @@ void TFProcessor::reset()
         std::fill(magnitudeDbBuffer.begin(), magnitudeDbBuffer.end(), -60.0f);
         std::fill(phaseDegreesBuffer.begin(), phaseDegreesBuffer.end(), 0.0f);
         std::fill(coherenceBuffer.begin(), coherenceBuffer.end(), 0.0f);
+        std::fill(impulseResponseBuffer.begin(), impulseResponseBuffer.end(), 0.0f);
+        std::fill(impulseEnergyBuffer.begin(), impulseEnergyBuffer.end(), 0.0f);
+        std::fill(logMagnitudeDbBuffer.begin(), logMagnitudeDbBuffer.end(), -60.0f);
+        std::fill(logPhaseDegreesBuffer.begin(), logPhaseDegreesBuffer.end(), 0.0f);
+        std::fill(logCoherenceBuffer.begin(), logCoherenceBuffer.end(), 0.0f);
     }
     
     newDataAvailable.store(false);
+    impulseGeneration.fetch_add(1, std::memory_order_release);
+    outputGeneration.fetch_add(1, std::memory_order_release);
 }
 
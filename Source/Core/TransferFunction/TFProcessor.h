@@ -2,30 +2,68 @@
 
 #include "../../JuceHeader.h"
 #include "FFTAnalyzer.h"
+#include "TFAveraging.h"
+#include "../SpectrumHistory.h"
 #include <complex>
 #include <vector>
 #include <atomic>
+#include <limits>
 
 /**
  * TFProcessor - Smaart-style Transfer Function
  * 
  * Implements H1 estimator with:
  * - Cross-spectrum averaging (Gxx, Gyy, Gxy)
- * - Exponential averaging (IIR)
+ * - Averaging: exponential (IIR), FIFO over the last N frames, infinite, or coherence-gated
+ *   (see TFAveragingEngine)
  * - Delay compensation
- * - Phase unwrap
+ * - Phase (wrapped), held across low-coherence bins
  * - Fractional-octave smoothing
  * - Coherence (gamma2)
+ * - Optional log-frequency output at fixed points per octave
+ *
+ * FFT size, overlap and window can change while running (setAnalysisSettings): the new
+ * pipeline is built on a background thread and swapped in by the audio thread between
+ * frames, with the averages carried over onto the new bins.
  */
 class TFProcessor
 {
 public:
+    // Analysis layout
+    struct AnalysisSettings
+    {
+        int fftSize{16384};                                   // minFFTSize .. maxFFTSize, power of 2
+        double overlap{0.75};                                 // minOverlap .. maxOverlap
+        FFTAnalyzer::Window window{FFTAnalyzer::Window::hann};
+        TFAveragingEngine::Settings averaging;
+        int logPointsPerOctave{0};                            // 0: linear bins only (see getLogMagnitudeResponse)
+    };
+    
+    static constexpr int minFFTSize = 4096;
+    static constexpr int maxFFTSize = 131072;
+    static constexpr double minOverlap = 0.5;
+    static constexpr double maxOverlap = 0.9;
+    static constexpr int minLogPointsPerOctave = 6;
+    static constexpr int maxLogPointsPerOctave = 192;
+    static constexpr double logMinFrequency = 20.0;
+    static constexpr double logMaxFrequency = 20000.0;
+    
     TFProcessor();
     ~TFProcessor();
     
-    // Setup processor
+    // Setup processor (fftSize replaces the current settings' size; everything is reset). The
+    // first call is synchronous; later ones (message thread, audio running) go through the
+    // pipeline builder like setAnalysisSettings and take effect on the next audio block
     void prepare(int fftSize, double sampleRate);
     
+    // Message thread. Changes FFT size, overlap and window without stopping: the new pipeline
+    // (FFTs, windows, buffers, waterfall storage) is built on a background thread and picked up
+    // by the audio thread at the start of its next block. The averages are resampled onto the
+    // new bins and then converge with the averaging time, so the display never blanks.
+    // Before the first prepare() the settings are only stored.
+    void setAnalysisSettings(const AnalysisSettings& settings);
+    AnalysisSettings getAnalysisSettings() const { return analysisSettings; }
+    
     // Process audio buffers (called from audio thread)
     // OLD: Separate calls (removed - causes sync issues)
     // void processReference(const float* input, int numSamples);
@@ -34,23 +72,87 @@ public:
     // NEW: Synchronized processing - both channels together
     void processBlock(const float* ref, const float* meas, int numSamples);
     
+    // Multi-pair use (see MultiTFEngine): the reference spectrum and its averaged
+    // auto-spectrum are computed once per hop and shared by every pair
+    struct SharedReference
+    {
+        std::vector<std::complex<double>> X;  // reference spectrum of this hop
+        std::vector<double> Gxx;              // averaged auto-spectrum of the reference
+        double alpha{0.0};                    // averaging coefficient of this hop
+    };
+    
+    // Averaging coefficient for frame number 'frame' (1-based): fast at first, then averagingTime
+    double getFrameAlpha(int frame) const;
+    
+    // Gxx = alpha * Gxx + (1 - alpha) * |X|^2
+    static void updateReferenceAverage(const std::complex<double>* x, double* gxx, int numBins, double alpha);
+    
+    // One hop of this pair against a shared reference; does everything processBlock() does after
+    // the FFTs. Callers serialize calls per processor (pairs may run in parallel with each other).
+    // The shared Gxx is used in exponential averaging only; other modes average their own.
+    void processPairFrame(const SharedReference& reference, const std::vector<std::complex<float>>& measurementSpectrum);
+    
     // Get transfer function results (called from UI thread)
     void getMagnitudeResponse(std::vector<float>& magnitudeDb);
     void getPhaseResponse(std::vector<float>& phaseDegrees);
     void getCoherence(std::vector<float>& coherence);
     
+    // Magnitude, phase and coherence of the same published result (for snapshots)
+    void getResults(std::vector<float>& magnitudeDb, std::vector<float>& phaseDegrees, std::vector<float>& coherence);
+    
     // Get frequency bins (for axis)
     void getFrequencyBins(std::vector<float>& frequencies);
     
+    // Log-frequency output (AnalysisSettings::logPointsPerOctave > 0): the same result on a grid of
+    // fixed points per octave from logMinFrequency to logMaxFrequency (about 480 points at 48 PPO
+    // instead of fftSize / 2 + 1 bins). Each point is the coherence-weighted mean of the compensated
+    // H over max(smoothing, 1 / PPO) octaves around it, so the smoothing is evaluated on the log grid
+    // directly; where that band holds fewer than 3 bins the nearest two bins are interpolated.
+    // Frequencies come with the values (same publish). False, nothing copied, while it is off.
+    bool getLogMagnitudeResponse(std::vector<float>& frequencies, std::vector<float>& magnitudeDb, std::vector<float>& coherence);
+    bool getLogPhaseResponse(std::vector<float>& frequencies, std::vector<float>& phaseDegrees, std::vector<float>& coherence);
+    
+    // Current analysis layout (message thread, set by prepare())
+    int getFFTSize() const { return fftSize; }
+    double getSampleRate() const { return sampleRate; }
+    
+    // Incremented every time new results (or a reset) are published; lets the UI skip
+    // rebuilding its curves when nothing changed
+    uint64_t getOutputGeneration() const { return outputGeneration.load(std::memory_order_acquire); }
+    
+    // Magnitude over time for the waterfall view: one column per published result (fixed memory)
+    AudioCoPilot::SpectrumHistory& getMagnitudeHistory() { return magnitudeHistory; }
+    
+    // Length kept by the magnitude history (seconds); waits for the current frame, then reallocates
+    void setMagnitudeHistorySeconds(double seconds);
+    double getMagnitudeHistorySeconds() const { return magnitudeHistorySeconds; }
+    
     // Get estimated delay between channels (in seconds)
     double getEstimatedDelay() const { return estimatedDelay; }
     
+    // Delay from an external finder (e.g. TFDelayFinder: sub-sample, longer search range). While
+    // set it replaces the built-in per-frame GCC-PHAT and is compensated exactly. Any thread;
+    // reset() clears it. Limited to +/- maxCompensatedDelay.
+    void setExternalDelay(double seconds);
+    void clearExternalDelay() { externalDelayValid.store(false); }
+    bool hasExternalDelay() const { return externalDelayValid.load(); }
+    static constexpr double maxCompensatedDelay = 1.0;
+    
     // Reset processing
     void reset();
     
     // Check if processor is ready
     bool isReady() const { return ready.load(); }
     
+    // Averaging state for the UI (any thread): memory held beyond the averages, frames in the
+    // current average and frames rejected by the coherence gate since the last reset
+    size_t getAveragingMemoryBytes() const { return averagingMemoryBytes.load(std::memory_order_relaxed); }
+    int getFramesAveraged() const { return framesAveraged.load(std::memory_order_relaxed); }
+    int getFramesRejected() const { return framesRejected.load(std::memory_order_relaxed); }
+    
+    // Times an estimate beyond maxCompensatedDelay was thrown away (any thread)
+    uint32_t getDelayResetCount() const { return delayResets.load(std::memory_order_relaxed); }
+    
     // Settings
     void setAveragingTime(double seconds) { averagingTime.store(seconds); }
     double getAveragingTime() const { return averagingTime.load(); }
@@ -58,17 +160,102 @@ public:
     void setSmoothingOctaves(double octaves) { smoothingOctaves.store(octaves); }
     double getSmoothingOctaves() const { return smoothingOctaves.load(); }
     
+    // Display chain (smoothing .. results and waterfall) on every Nth frame only; averaging and
+    // the delay finder still see every frame. For hidden views (AnalysisBudget::displayDivider).
+    void setPublishDivider(int divider) { publishDivider.store(juce::jmax(1, divider)); }
+    int getPublishDivider() const { return publishDivider.load(); }
+    
+    // Impulse response: inverse transform of the averaged H1 on every published frame (off by default)
+    void setImpulseResponseEnabled(bool enabled) { impulseResponseEnabled.store(enabled); }
+    bool isImpulseResponseEnabled() const { return impulseResponseEnabled.load(); }
+    
+    // Latest IR (real part) and its energy |analytic IR|^2, fftSize samples each. Sample i is at
+    // (i - getImpulsePreRoll(size)) / sampleRate seconds, so energy arriving slightly early stays visible.
+    void getImpulseResponse(std::vector<float>& impulseResponse, std::vector<float>& energy);
+    static int getImpulsePreRoll(int impulseSize) { return impulseSize / impulsePreRollDivisor; }
+    uint64_t getImpulseResponseGeneration() const { return impulseGeneration.load(std::memory_order_acquire); }
+    
 private:
     void tryProcessSynchronizedFrames();  // Process frames only when both buffers are ready
     void processFrame();
-    void computeCrossSpectrum();
-    void updateAverages();
-    void estimateDelay();  // GCC-PHAT (fast, uses instantaneous spectrum)
+    void finishFrame(const std::complex<double>* x);  // delay, smoothing, unwrap, publish
+    void updateAverages(const std::complex<double>* x, const double* gxx, double alpha);
+    void updateEstimates(const double* gxx);  // H and gamma2 from the averages
+    void addToAverages(const std::complex<double>* x, double alpha);  // through the averaging engine
+    void estimateDelay(const std::complex<double>* x);  // GCC-PHAT (fast, uses instantaneous spectrum)
     void estimateDelayPhaseBased();  // Fallback method
-    void applyDelayCompensation();
-    void applySmoothing();
-    void unwrapPhase();
-    void extractMagnitudeAndPhase();
+    void applyDelayCompensationAndSmoothing();  // H -> H_smoothed, one pass over H
+    void buildDelayPhasors(double tau, int spectrumSize);
+    void prepareSmoothingBands(double octaves);
+    static void computeSmoothingBands(const std::vector<float>& binFrequencies, double octaves,
+                                      std::vector<int>& firstBin, std::vector<int>& lastBin,
+                                      std::vector<std::complex<double>>& sumH, std::vector<double>& sumW);
+    void extractMagnitudeAndPhase();  // H_smoothed -> magnitudeDb, phaseDegrees, coherence (one pass)
+    void computeLogOutput();  // prefix sums of the smoothing pass -> log grid results
+    static void computeLogGrid(const std::vector<float>& binFrequencies, int pointsPerOctave, std::vector<float>& logFrequencies,
+                               std::vector<int>& interpolationBin, std::vector<double>& interpolationFraction);
+    static void computeLogBands(const std::vector<float>& binFrequencies, const std::vector<float>& logFrequencies,
+                                double octaves, std::vector<int>& firstBin, std::vector<int>& lastBin);
+    static double fastAtan2(double y, double x);
+    void publishFrame(int historyColumns = 1);  // delay compensation .. double buffer and waterfall
+    void computeImpulseResponse();  // averaged H1 -> IR and energy, double-buffered
+    void prepareMagnitudeHistory();
+    AudioCoPilot::SpectrumHistory::Settings getHistorySettings(int forFFTSize, double forFrameDt, double forSampleRate) const;
+    
+    // Everything that depends on the analysis settings. Built off the audio thread, then
+    // exchanged with the processor's members of the same name (vector swaps: no allocation)
+    struct Pipeline
+    {
+        AnalysisSettings settings;
+        double sampleRate{0.0};
+        int fftSize{0};
+        int hopSize{0};
+        double frameDt{0.0};
+        double averagingAlpha{0.0};
+        std::unique_ptr<FFTAnalyzer> referenceFFT;
+        std::unique_ptr<FFTAnalyzer> measurementFFT;
+        std::vector<std::complex<double>> X, Y, Gxy, H, H_smoothed, delayPhasors;
+        std::vector<double> Gxx, Gyy, gamma2;
+        std::unique_ptr<TFAveragingEngine> averaging;
+        std::vector<float> magnitudeDb, phaseDegrees, coherence, frequencies;
+        std::vector<float> magnitudeDbBuffer, phaseDegreesBuffer, coherenceBuffer;
+        std::shared_ptr<const juce::dsp::FFT> phatFFT;
+        int phatFftOrder{0};
+        std::vector<std::complex<float>> phatFftBuffer;
+        std::vector<float> phatTime;
+        std::vector<float> impulseResponse, impulseEnergy, impulseResponseBuffer, impulseEnergyBuffer;
+        double smoothingBandsOctaves{-1.0};
+        std::vector<int> smoothingFirstBin, smoothingLastBin;
+        std::vector<std::complex<double>> smoothingSumH;
+        std::vector<double> smoothingSumW;
+        int logPointsPerOctave{0};
+        std::vector<float> logFrequencies;
+        std::vector<int> logInterpolationBin;
+        std::vector<double> logInterpolationFraction;
+        double logBandsOctaves{-1.0};
+        std::vector<int> logFirstBin, logLastBin;
+        std::vector<float> logMagnitudeDb, logPhaseDegrees, logCoherence;
+        std::vector<float> logFrequenciesBuffer, logMagnitudeDbBuffer, logPhaseDegreesBuffer, logCoherenceBuffer;
+        std::shared_ptr<AudioCoPilot::SpectrumHistory::Columns> historyColumns;
+    };
+    
+    class PipelineBuilder : public juce::Thread
+    {
+    public:
+        PipelineBuilder(TFProcessor& owner, const AnalysisSettings& settings, double sampleRate);
+        void run() override;
+        
+    private:
+        TFProcessor& processor;
+        AnalysisSettings settings;
+        double sampleRate;
+    };
+    
+    static AnalysisSettings clampSettings(const AnalysisSettings& settings);
+    std::unique_ptr<Pipeline> buildPipeline(const AnalysisSettings& settings, double sampleRate) const;
+    void swapPipeline(Pipeline& pipeline);
+    void adoptPipeline(Pipeline& next);
+    void stopPipelineBuilder();
     
     // FFT analyzers
     std::unique_ptr<FFTAnalyzer> referenceFFT;
@@ -89,8 +276,7 @@ private:
     
     // Transfer function
     std::vector<std::complex<double>> H;  // H1 = Gxy / Gxx (averaged)
-    std::vector<std::complex<double>> H_compensated;  // With delay compensation (averaged)
-    std::vector<std::complex<double>> H_smoothed;  // After smoothing (averaged)
+    std::vector<std::complex<double>> H_smoothed;  // After delay compensation and smoothing (averaged)
     
     // Coherence
     std::vector<double> gamma2;  // Magnitude-squared coherence
@@ -113,17 +299,31 @@ private:
     double frameDt{0.0};  // Hop time in seconds
     int frameCount{0};  // Track frame count for adaptive averaging
     static constexpr int fastAveragingFrames = 30;  // Use fast averaging for first 30 frames (~0.5s @ 60fps)
+    std::unique_ptr<TFAveragingEngine> averaging;  // mode from AnalysisSettings::averaging
+    std::atomic<size_t> averagingMemoryBytes{0};
+    std::atomic<int> framesAveraged{0};
+    std::atomic<int> framesRejected{0};
     
     // Delay compensation
     double estimatedDelay{0.0};  // in seconds
     double smoothedDelay{0.0};  // smoothed version
     int delayUpdateCounter{0};
+    std::atomic<double> externalDelay{0.0};
+    std::atomic<bool> externalDelayValid{false};
+    std::atomic<int> publishDivider{1};
+    int framesSincePublish{0};
     static constexpr int delayUpdatePeriod = 100;  // frames
     static constexpr double delayStabilityThreshold = 0.0001;  // 0.1ms threshold (was 0.05ms)
     static constexpr int delayStabilityCount = 3;  // 3 stable updates (was 5)
+    static constexpr int phasorReseedBins = 256;  // delay rotation recurrence restarts exactly (power of 2)
+    static constexpr double delayPhasorResolution = 1.0e-9;  // s; at most 0.005 deg at 24 kHz
+    std::vector<std::complex<double>> delayPhasors;  // exp(+j*2*pi*f_k*tau) for delayPhasorsTau
+    double delayPhasorsTau{std::numeric_limits<double>::quiet_NaN()};
+    std::atomic<uint32_t> delayResets{0};  // delays beyond maxCompensatedDelay thrown away (audio thread)
+    static constexpr int extractBlockBins = 256;  // bins per block of extractMagnitudeAndPhase()
     
     // GCC-PHAT delay finder (fast, uses instantaneous spectrum)
-    std::unique_ptr<juce::dsp::FFT> phatFFT;
+    std::shared_ptr<const juce::dsp::FFT> phatFFT;  // from FFTPlanCache
     int phatFftOrder{0};
     std::vector<std::complex<float>> phatFftBuffer;  // complex spectrum, size fftSize
     std::vector<float> phatTime;                      // size fftSize
@@ -131,18 +331,69 @@ private:
     int stableDelayCount{0};
     bool delayLocked{false};
     
+    // Impulse response (shares the GCC-PHAT inverse FFT; audio side, then double-buffered for the UI)
+    std::atomic<bool> impulseResponseEnabled{false};
+    std::vector<float> impulseResponse;
+    std::vector<float> impulseEnergy;
+    std::vector<float> impulseResponseBuffer;
+    std::vector<float> impulseEnergyBuffer;
+    std::atomic<uint64_t> impulseGeneration{0};
+    static constexpr int impulsePreRollDivisor = 8;  // fftSize / 8 samples before t = 0
+    
     // Smoothing - 1/12 octave default (Smaart-like)
     std::atomic<double> smoothingOctaves{1.0/12.0};  // 1/12 octave default (Smaart-like)
     
+    // Smoothing bands as bin ranges (rebuilt when the width or layout changes), and
+    // prefix sums of w*H and w, so each band costs two lookups instead of a scan
+    double smoothingBandsOctaves{-1.0};
+    std::vector<int> smoothingFirstBin;
+    std::vector<int> smoothingLastBin;
+    std::vector<std::complex<double>> smoothingSumH;
+    std::vector<double> smoothingSumW;
+    
+    // Log-frequency output (empty while off): grid, interpolation between the two bins around each
+    // point, and the band of each point (rebuilt when the smoothing width changes); then the
+    // audio-side results and their double buffers (frequencies included, swapped with them)
+    int logPointsPerOctave{0};
+    std::vector<float> logFrequencies;
+    std::vector<int> logInterpolationBin;
+    std::vector<double> logInterpolationFraction;
+    double logBandsOctaves{-1.0};
+    std::vector<int> logFirstBin;
+    std::vector<int> logLastBin;
+    std::vector<float> logMagnitudeDb;
+    std::vector<float> logPhaseDegrees;
+    std::vector<float> logCoherence;
+    std::vector<float> logFrequenciesBuffer;
+    std::vector<float> logMagnitudeDbBuffer;
+    std::vector<float> logPhaseDegreesBuffer;
+    std::vector<float> logCoherenceBuffer;
+    
     // Processing parameters
     int fftSize{16384};
     double sampleRate{48000.0};
     int hopSize{0};  // NFFT * (1 - overlap)
-    static constexpr double overlap = 0.75;  // 75% overlap
+    double overlap{0.75};  // 75% overlap by default (AnalysisSettings)
+    
+    // Runtime settings: requested (message thread), then built and handed over to the audio thread
+    AnalysisSettings analysisSettings;
+    double preparedSampleRate{48000.0};  // the rate pipelines are built for (sampleRate follows on adoption)
+    std::unique_ptr<PipelineBuilder> pipelineBuilder;
+    std::atomic<Pipeline*> pendingPipeline{nullptr};  // built, waiting for the audio thread
+    std::atomic<Pipeline*> retiredPipeline{nullptr};  // swapped out, freed by the builder
+    std::atomic<bool> resetOnAdopt{false};  // set by a re-prepare: the next adopted pipeline starts from scratch
+    std::atomic<bool> clearInputRequested{false};  // reset() -> processBlock
     
     // State
     std::atomic<bool> ready{false};
     std::atomic<bool> newDataAvailable{false};
+    std::atomic<uint64_t> outputGeneration{0};
+    
+    // Waterfall history (written in processFrame under processLock)
+    AudioCoPilot::SpectrumHistory magnitudeHistory;
+    double magnitudeHistorySeconds{300.0};
+    static constexpr float waterfallFloorDb = -24.0f;
+    static constexpr float waterfallCeilingDb = 24.0f;
     
     // Thread safety
     juce::CriticalSection processLock;
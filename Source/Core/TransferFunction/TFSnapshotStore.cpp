@@ -0,0 +1,317 @@
+#include "TFSnapshotStore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr char snapshotMagic[8] = {'A', 'C', 'P', 'T', 'F', 'S', 'N', 'P'};
+    constexpr uint32_t snapshotVersion = 1;
+    constexpr uint32_t flagQuantized16 = 1u << 0;
+    constexpr uint64_t trackAlignment = 16;
+
+    struct TrackHeader
+    {
+        uint64_t offset;   // from the start of the file
+        float base;        // quantized: value = base + code * step
+        float step;
+    };
+
+    // Plain fixed layout: written and mapped as is (little-endian hosts only)
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint32_t headerBytes;
+        uint32_t numBins;
+        uint32_t fftSize;
+        int32_t referenceChannel;
+        int32_t measurementChannel;
+        uint32_t nameBytes;
+        double sampleRate;
+        double delaySeconds;
+        double averagingTime;
+        double smoothingOctaves;
+        int64_t timeMs;
+        TrackHeader tracks[TFSnapshot::numTracks];
+    };
+
+    static_assert(sizeof(FileHeader) == 128, "snapshot header layout changed");
+
+    uint64_t alignUp(uint64_t value)
+    {
+        return (value + trackAlignment - 1) & ~(trackAlignment - 1);
+    }
+
+    // Range of the finite values (non-finite ones are stored as the minimum)
+    void findRange(const std::vector<float>& values, float& minValue, float& maxValue)
+    {
+        minValue = 0.0f;
+        maxValue = 0.0f;
+        bool first = true;
+
+        for (const float v : values)
+        {
+            if (!std::isfinite(v))
+                continue;
+
+            minValue = first ? v : juce::jmin(minValue, v);
+            maxValue = first ? v : juce::jmax(maxValue, v);
+            first = false;
+        }
+    }
+}
+
+//==============================================================================
+std::shared_ptr<const TFSnapshot> TFSnapshot::load(const juce::File& file, juce::String& error)
+{
+    if (juce::ByteOrder::isBigEndian())
+    {
+        error = "snapshots are little-endian";
+        return nullptr;
+    }
+
+    std::shared_ptr<TFSnapshot> snapshot(new TFSnapshot());
+    snapshot->file = file;
+    snapshot->mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    const auto* data = static_cast<const char*>(snapshot->mapping->getData());
+    const uint64_t size = static_cast<uint64_t>(snapshot->mapping->getSize());
+
+    if (data == nullptr || size < sizeof(FileHeader))
+    {
+        error = "cannot read " + file.getFileName();
+        return nullptr;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(FileHeader));
+
+    if (std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0)
+    {
+        error = file.getFileName() + " is not a transfer function snapshot";
+        return nullptr;
+    }
+
+    if (header.version != snapshotVersion || header.headerBytes < sizeof(FileHeader))
+    {
+        error = file.getFileName() + ": unsupported snapshot version " + juce::String(static_cast<int>(header.version));
+        return nullptr;
+    }
+
+    if (header.numBins < 2 || header.fftSize < 2 || header.sampleRate <= 0.0
+        || static_cast<uint64_t>(header.headerBytes) + header.nameBytes > size)
+    {
+        error = file.getFileName() + ": damaged header";
+        return nullptr;
+    }
+
+    const bool quantized = (header.flags & flagQuantized16) != 0;
+    const uint64_t valueBytes = quantized ? sizeof(uint16_t) : sizeof(float);
+    const uint64_t trackBytes = valueBytes * header.numBins;
+
+    for (int t = 0; t < numTracks; ++t)
+    {
+        const auto& trackHeader = header.tracks[t];
+        if (trackHeader.offset % trackAlignment != 0 || trackHeader.offset > size || size - trackHeader.offset < trackBytes)
+        {
+            error = file.getFileName() + ": truncated";
+            return nullptr;
+        }
+
+        auto& track = snapshot->tracks[static_cast<size_t>(t)];
+        track.numBins = static_cast<int>(header.numBins);
+        track.base = trackHeader.base;
+        track.step = trackHeader.step;
+
+        if (quantized)
+            track.codes = reinterpret_cast<const uint16_t*>(data + trackHeader.offset);
+        else
+            track.values = reinterpret_cast<const float*>(data + trackHeader.offset);
+    }
+
+    auto& metadata = snapshot->metadata;
+    metadata.name = juce::String::fromUTF8(data + header.headerBytes, static_cast<int>(header.nameBytes));
+    metadata.timeMs = header.timeMs;
+    metadata.sampleRate = header.sampleRate;
+    metadata.fftSize = static_cast<int>(header.fftSize);
+    metadata.delaySeconds = header.delaySeconds;
+    metadata.averagingTime = header.averagingTime;
+    metadata.smoothingOctaves = header.smoothingOctaves;
+    metadata.referenceChannel = header.referenceChannel;
+    metadata.measurementChannel = header.measurementChannel;
+
+    snapshot->numBins = static_cast<int>(header.numBins);
+    snapshot->quantized = quantized;
+    return snapshot;
+}
+
+bool TFSnapshot::write(const juce::File& file, const Metadata& metadata,
+                       const std::vector<float>& magnitudeDb,
+                       const std::vector<float>& phaseDegrees,
+                       const std::vector<float>& coherence,
+                       bool quantize16, juce::String& error)
+{
+    const size_t numBins = magnitudeDb.size();
+    if (numBins < 2 || phaseDegrees.size() != numBins || coherence.size() != numBins
+        || metadata.fftSize < 2 || metadata.sampleRate <= 0.0)
+    {
+        error = "no complete measurement to store";
+        return false;
+    }
+
+    const std::vector<float>* trackData[numTracks] = {&magnitudeDb, &phaseDegrees, &coherence};
+    const char* nameUtf8 = metadata.name.toRawUTF8();
+    const uint32_t nameBytes = static_cast<uint32_t>(std::strlen(nameUtf8));
+    const uint64_t valueBytes = quantize16 ? sizeof(uint16_t) : sizeof(float);
+
+    FileHeader header{};
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = snapshotVersion;
+    header.flags = quantize16 ? flagQuantized16 : 0u;
+    header.headerBytes = sizeof(FileHeader);
+    header.numBins = static_cast<uint32_t>(numBins);
+    header.fftSize = static_cast<uint32_t>(metadata.fftSize);
+    header.referenceChannel = metadata.referenceChannel;
+    header.measurementChannel = metadata.measurementChannel;
+    header.nameBytes = nameBytes;
+    header.sampleRate = metadata.sampleRate;
+    header.delaySeconds = metadata.delaySeconds;
+    header.averagingTime = metadata.averagingTime;
+    header.smoothingOctaves = metadata.smoothingOctaves;
+    header.timeMs = metadata.timeMs;
+
+    uint64_t offset = alignUp(sizeof(FileHeader) + nameBytes);
+    for (int t = 0; t < numTracks; ++t)
+    {
+        auto& trackHeader = header.tracks[t];
+        trackHeader.offset = offset;
+        offset = alignUp(offset + valueBytes * numBins);
+
+        if (quantize16)
+        {
+            float minValue = 0.0f, maxValue = 0.0f;
+            findRange(*trackData[t], minValue, maxValue);
+            trackHeader.base = minValue;
+            trackHeader.step = maxValue > minValue ? (maxValue - minValue) / 65535.0f : 1.0f;
+        }
+    }
+
+    juce::FileOutputStream out(file);
+    if (!out.openedOk())
+    {
+        error = "cannot write " + file.getFullPathName();
+        return false;
+    }
+
+    out.setPosition(0);
+    out.truncate();
+
+    std::vector<uint16_t> codes;
+    bool ok = out.write(&header, sizeof(FileHeader)) && out.write(nameUtf8, nameBytes);
+
+    for (int t = 0; t < numTracks && ok; ++t)
+    {
+        const auto& trackHeader = header.tracks[t];
+        const auto& values = *trackData[t];
+
+        // Padding up to the aligned track offset
+        static constexpr char zeros[trackAlignment] = {};
+        const auto padding = static_cast<size_t>(trackHeader.offset - static_cast<uint64_t>(out.getPosition()));
+        ok = out.write(zeros, padding);
+
+        if (quantize16)
+        {
+            codes.resize(numBins);
+            const float inverseStep = 1.0f / trackHeader.step;
+            for (size_t i = 0; i < numBins; ++i)
+            {
+                const float v = std::isfinite(values[i]) ? values[i] : trackHeader.base;
+                codes[i] = static_cast<uint16_t>(juce::jlimit(0, 65535, juce::roundToInt((v - trackHeader.base) * inverseStep)));
+            }
+            ok = ok && out.write(codes.data(), numBins * sizeof(uint16_t));
+        }
+        else
+        {
+            ok = ok && out.write(values.data(), numBins * sizeof(float));
+        }
+    }
+
+    out.flush();
+    if (!ok || out.getStatus().failed())
+    {
+        error = "cannot write " + file.getFullPathName() + ": " + out.getStatus().getErrorMessage();
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+TFSnapshotStore::TFSnapshotStore(const juce::File& dir)
+    : directory(dir)
+{
+}
+
+juce::File TFSnapshotStore::save(const TFSnapshot::Metadata& metadata,
+                                 const std::vector<float>& magnitudeDb,
+                                 const std::vector<float>& phaseDegrees,
+                                 const std::vector<float>& coherence,
+                                 bool quantize16)
+{
+    const auto created = directory.createDirectory();
+    if (created.failed())
+    {
+        lastError = "cannot create " + directory.getFullPathName() + ": " + created.getErrorMessage();
+        return {};
+    }
+
+    // Time first, so listing by name is listing by age
+    const auto stamp = juce::Time(metadata.timeMs).formatted("%Y-%m-%d_%H-%M-%S");
+    const auto fileName = juce::File::createLegalFileName(stamp + " " + metadata.name);
+    const auto file = directory.getChildFile(fileName + TFSnapshot::fileExtension).getNonexistentSibling();
+
+    if (!TFSnapshot::write(file, metadata, magnitudeDb, phaseDegrees, coherence, quantize16, lastError))
+    {
+        file.deleteFile();
+        return {};
+    }
+
+    return file;
+}
+
+juce::Array<juce::File> TFSnapshotStore::list() const
+{
+    auto files = directory.findChildFiles(juce::File::findFiles, false, juce::String("*") + TFSnapshot::fileExtension);
+    files.sort();
+    return files;
+}
+
+std::shared_ptr<const TFSnapshot> TFSnapshotStore::recall(const juce::File& file)
+{
+    const auto path = file.getFullPathName();
+
+    // Drop entries whose snapshot is no longer used anywhere
+    recalled.erase(std::remove_if(recalled.begin(), recalled.end(),
+                                  [](const auto& entry) { return entry.second.expired(); }),
+                   recalled.end());
+
+    for (const auto& entry : recalled)
+        if (entry.first == path)
+            if (auto snapshot = entry.second.lock())
+                return snapshot;
+
+    auto snapshot = TFSnapshot::load(file, lastError);
+    if (snapshot != nullptr)
+        recalled.emplace_back(path, snapshot);
+
+    return snapshot;
+}
+
+bool TFSnapshotStore::remove(const juce::File& file)
+{
+    // An overlay still showing it keeps its mapping (the file disappears once unmapped on POSIX;
+    // on Windows the delete fails while it is mapped)
+    return file.deleteFile();
+}
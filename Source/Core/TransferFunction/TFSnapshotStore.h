@@ -0,0 +1,143 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * TFSnapshot
+ *
+ * One stored transfer function measurement (magnitude, phase, coherence per FFT bin
+ * plus delay and measurement settings), read straight from a memory-mapped file.
+ *
+ * File format (".tfsnap", little-endian, version 1):
+ *   FileHeader (128 bytes)  magic, version, flags, bin count, FFT size, sample rate,
+ *                           delay, averaging, smoothing, channels, time, track table
+ *   name                    UTF-8, nameBytes long
+ *   tracks                  magnitude (dB), phase (degrees), coherence (0..1), each at a
+ *                           16-byte aligned offset: numBins float32, or numBins uint16
+ *                           codes when quantized (value = base + code * step, per track)
+ *
+ * Loading validates the header and maps the file; nothing is parsed or copied per bin.
+ * TrackView decodes on access, so a plot can decimate a snapshot directly from the mapping.
+ */
+class TFSnapshot
+{
+public:
+    enum class Track { magnitude = 0, phase = 1, coherence = 2 };
+    static constexpr int numTracks = 3;
+
+    struct Metadata
+    {
+        juce::String name;
+        juce::int64 timeMs{0};       // milliseconds since 1970 (juce::Time)
+        double sampleRate{0.0};
+        int fftSize{0};
+        double delaySeconds{0.0};
+        double averagingTime{0.0};
+        double smoothingOctaves{0.0};
+        int referenceChannel{0};
+        int measurementChannel{0};
+    };
+
+    // Read-only view of one track inside the mapping
+    class TrackView
+    {
+    public:
+        int size() const { return numBins; }
+
+        float operator[](int bin) const
+        {
+            if (codes != nullptr)
+                return base + step * static_cast<float>(codes[bin]);
+            return values[bin];
+        }
+
+    private:
+        friend class TFSnapshot;
+
+        const float* values{nullptr};
+        const uint16_t* codes{nullptr};
+        float base{0.0f};
+        float step{0.0f};
+        int numBins{0};
+    };
+
+    // Maps and validates a snapshot file; nullptr (and error) if it is not a readable snapshot
+    static std::shared_ptr<const TFSnapshot> load(const juce::File& file, juce::String& error);
+
+    // Writes a snapshot; all three tracks must have the same size. quantize16 stores
+    // 16-bit codes (half the size, error below 0.001 dB over a 60 dB span).
+    static bool write(const juce::File& file, const Metadata& metadata,
+                      const std::vector<float>& magnitudeDb,
+                      const std::vector<float>& phaseDegrees,
+                      const std::vector<float>& coherence,
+                      bool quantize16, juce::String& error);
+
+    const Metadata& getMetadata() const { return metadata; }
+    const juce::File& getFile() const { return file; }
+    int getNumBins() const { return numBins; }
+    bool isQuantized() const { return quantized; }
+
+    // Linear FFT bins, as produced by TFProcessor
+    float getBinFrequency(int bin) const
+    {
+        return static_cast<float>(bin * metadata.sampleRate / static_cast<double>(metadata.fftSize));
+    }
+
+    TrackView getTrack(Track track) const { return tracks[static_cast<size_t>(track)]; }
+
+    static constexpr const char* fileExtension = ".tfsnap";
+
+private:
+    TFSnapshot() = default;
+
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    Metadata metadata;
+    int numBins{0};
+    bool quantized{false};
+    std::array<TrackView, numTracks> tracks;
+};
+
+/**
+ * TFSnapshotStore
+ *
+ * Folder of .tfsnap files: saving, listing and recalling snapshots. Recalled
+ * snapshots are shared; while any overlay holds one, recalling it again returns
+ * the same mapping.
+ */
+class TFSnapshotStore
+{
+public:
+    explicit TFSnapshotStore(const juce::File& directory);
+
+    const juce::File& getDirectory() const { return directory; }
+
+    // Message thread. Writes a new snapshot with a unique file name derived from metadata.name;
+    // returns the file, or a non-existent File on failure (see getLastError()).
+    juce::File save(const TFSnapshot::Metadata& metadata,
+                    const std::vector<float>& magnitudeDb,
+                    const std::vector<float>& phaseDegrees,
+                    const std::vector<float>& coherence,
+                    bool quantize16);
+
+    // Stored snapshots, oldest first
+    juce::Array<juce::File> list() const;
+
+    // Mapped snapshot, or nullptr (see getLastError())
+    std::shared_ptr<const TFSnapshot> recall(const juce::File& file);
+
+    bool remove(const juce::File& file);
+
+    juce::String getLastError() const { return lastError; }
+
+private:
+    juce::File directory;
+    juce::String lastError;
+
+    // Keeps recalled mappings shared without keeping them alive
+    std::vector<std::pair<juce::String, std::weak_ptr<const TFSnapshot>>> recalled;
+};
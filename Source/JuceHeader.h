@@ -12,3 +12,8 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_gui_extra/juce_gui_extra.h>
 #include <juce_dsp/juce_dsp.h>
+
+// Linked only when AUDIOCOPILOT_OPENGL is on (see CMakeLists.txt)
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+#include <juce_opengl/juce_opengl.h>
+#endif
@@ -75,6 +75,18 @@ juce::String LocalizedStrings::getMenuDeviceSelector() const
     return lang == Language::Portuguese_BR ? juce::String::fromUTF8("Seletor de Dispositivo") : "Device Selector";
 }
 
+juce::String LocalizedStrings::getMenuStartSessionRecording() const
+{
+    GET_LANGUAGE_SAFE()
+    return lang == Language::Portuguese_BR ? juce::String::fromUTF8("Gravar Sessão (Todas as Entradas)") : "Record Session (All Inputs)";
+}
+
+juce::String LocalizedStrings::getMenuStopSessionRecording() const
+{
+    GET_LANGUAGE_SAFE()
+    return lang == Language::Portuguese_BR ? juce::String::fromUTF8("Parar Gravação da Sessão") : "Stop Session Recording";
+}
+
 juce::String LocalizedStrings::getMenuModules() const
 {
     GET_LANGUAGE_SAFE()
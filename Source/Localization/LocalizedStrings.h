@@ -30,6 +30,8 @@ public:
     juce::String getMenuLanguage() const;
     juce::String getMenuDevice() const;
     juce::String getMenuDeviceSelector() const;
+    juce::String getMenuStartSessionRecording() const;
+    juce::String getMenuStopSessionRecording() const;
     juce::String getMenuModules() const;
     juce::String getMenuModuleTransferFunction() const;
     juce::String getMenuModuleAntiMasking() const;
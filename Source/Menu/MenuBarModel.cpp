@@ -49,6 +49,9 @@ juce::PopupMenu MenuBarModel::getMenuForIndex(int topLevelMenuIndex, const juce:
         
         case 2: // Device Menu
             menu.addItem(DeviceSelector, strings.getMenuDeviceSelector());
+            menu.addItem(SessionRecording,
+                         isSessionRecording && isSessionRecording() ? strings.getMenuStopSessionRecording()
+                                                                    : strings.getMenuStartSessionRecording());
             menu.addSeparator();
             populateDeviceMenu(menu);
             break;
@@ -116,6 +119,11 @@ void MenuBarModel::menuItemSelected(int menuItemID, int topLevelMenuIndex)
                 moduleActivationCallback(DeviceSelector);
             break;
         
+        case SessionRecording:
+            if (moduleActivationCallback)
+                moduleActivationCallback(SessionRecording);
+            break;
+        
         default:
             // Device selection
             if (menuItemID >= 100 && menuItemID < 200)
@@ -27,6 +27,9 @@ public:
     std::function<void(int)> moduleActivationCallback;
     void setModuleActivationCallback(std::function<void(int)> callback) { moduleActivationCallback = callback; }
     
+    // Session recorder state, for the Device menu item text
+    std::function<bool()> isSessionRecording;
+    
 private:
     DeviceManager& deviceManager;
     
@@ -37,6 +40,7 @@ private:
         LanguageEnglish = 10,
         LanguagePortuguese = 11,
         DeviceSelector = 20,
+        SessionRecording = 21,
         TransferFunction = 30,
         AntiMasking = 31,
         RTA = 32,
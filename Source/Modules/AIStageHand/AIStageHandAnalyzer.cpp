@@ -9,6 +9,7 @@ AIStageHandAnalyzer::AIStageHandAnalyzer(AIStageHandFifo& f, juce::WaitableEvent
       dataAvailable(dataEvent),
       alertCallback(std::move(onAlert))
 {
+    batchScratch.assign(fft->getScratchSize(), 0.0f);
 }
 
 AIStageHandAnalyzer::~AIStageHandAnalyzer()
@@ -44,11 +45,7 @@ void AIStageHandAnalyzer::run()
             if ((int) channelState.size() != channels)
                 resetState(channels);
 
-            for (int ch = 0; ch < channels; ++ch)
-            {
-                auto* ptr = block.getReadPointer(ch);
-                analyzeChannel(ch, ptr, numSamples, channelState[(size_t) ch]);
-            }
+            analyzeBlock(juce::jmin(channels, (int) channelState.size()), numSamples);
 
             if (threadShouldExit())
                 break;
@@ -56,21 +53,33 @@ void AIStageHandAnalyzer::run()
     }
 }
 
-void AIStageHandAnalyzer::analyzeChannel(int channelIndex, const float* data, int numSamples, PeakState& state)
+void AIStageHandAnalyzer::analyzeBlock(int channels, int numSamples)
 {
-    if (data == nullptr || numSamples <= 0)
+    if (channels <= 0 || numSamples <= 0)
         return;
 
     const int samplesToUse = juce::jmin(numSamples, fftSize);
 
-    scratch.setSize(1, fftSize, false, false, true);
-    auto* scratchPtr = scratch.getWritePointer(0);
-    std::fill(scratchPtr, scratchPtr + fftSize, 0.0f);
-    std::copy(data, data + samplesToUse, scratchPtr);
+    // One planar buffer per channel (the transform works in place over 2 * fftSize floats),
+    // all channels transformed in one batch
+    scratch.setSize(channels, fftSize * 2, false, false, true);
+
+    for (int ch = 0; ch < channels; ++ch)
+    {
+        auto* scratchPtr = scratch.getWritePointer(ch);
+        std::copy(block.getReadPointer(ch), block.getReadPointer(ch) + samplesToUse, scratchPtr);
+        std::fill(scratchPtr + samplesToUse, scratchPtr + fftSize * 2, 0.0f);
+        juce::FloatVectorOperations::multiply(scratchPtr, window->samples.data(), fftSize);
+    }
+
+    fft->performFrequencyOnlyForwardBatch(scratch.getArrayOfWritePointers(), channels, batchScratch.data());
 
-    window.multiplyWithWindowingTable(scratchPtr, fftSize);
-    fft.performFrequencyOnlyForwardTransform(scratchPtr);
+    for (int ch = 0; ch < channels; ++ch)
+        analyzeChannel(ch, scratch.getReadPointer(ch), channelState[(size_t) ch]);
+}
 
+void AIStageHandAnalyzer::analyzeChannel(int channelIndex, const float* magnitudes, PeakState& state)
+{
     const double sr = sampleRate.load();
     const float binWidth = (float) (sr / (double) fftSize);
 
@@ -81,9 +90,9 @@ void AIStageHandAnalyzer::analyzeChannel(int channelIndex, const float* data, in
     // magnitude em dB + proeminência
     for (int bin = 1; bin < fftSize / 2 - 1; ++bin)
     {
-        const float mag = scratchPtr[bin];
+        const float mag = magnitudes[bin];
         const float magDb = 20.0f * std::log10(mag + 1e-6f);
-        const float neighbor = 0.5f * (scratchPtr[bin - 1] + scratchPtr[bin + 1]);
+        const float neighbor = 0.5f * (magnitudes[bin - 1] + magnitudes[bin + 1]);
         const float neighborDb = 20.0f * std::log10(neighbor + 1e-6f);
         const float prominence = magDb - neighborDb;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../JuceHeader.h"
+#include "../../Core/FFTPlanCache.h"
 #include "AIStageHandFifo.h"
 
 namespace AudioCoPilot
@@ -48,17 +49,22 @@ private:
 
     static constexpr int fftOrder = 11; // 2048
     static constexpr int fftSize = 1 << fftOrder;
-    juce::dsp::FFT fft { fftOrder };
-    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann };
+    // Shared engine and (normalised) Hann table
+    std::shared_ptr<const FFTEngine> fft { FFTPlanCache::getEngine (fftOrder) };
+    std::shared_ptr<const FFTPlanCache::WindowTable> window { FFTPlanCache::getWindow (fftSize, FFTPlanCache::Window::hann, true) };
 
-    juce::AudioBuffer<float> scratch;
+    juce::AudioBuffer<float> scratch;  // per channel: windowed frame, then magnitudes
+    std::vector<float> batchScratch;   // the engine's batch scratch (FFTEngine::getScratchSize())
     juce::AudioBuffer<float> block;
 
     std::vector<PeakState> channelState;
 
     AIStageHandAlert buildAlert(int channel, float freqHz);
     juce::String suggestionForFreq(float freqHz) const;
-    void analyzeChannel(int channelIndex, const float* data, int numSamples, PeakState& state);
+    // Windows the first channels of block and transforms them as one batch
+    void analyzeBlock(int channels, int numSamples);
+    // Feedback detection on one channel's magnitudes (bins 0 .. fftSize / 2)
+    void analyzeChannel(int channelIndex, const float* magnitudes, PeakState& state);
 };
 
 } // namespace AudioCoPilot
@@ -2,6 +2,7 @@
 
 #include "../../JuceHeader.h"
 #include "../../Core/DeviceManager.h"
+#include "../../Core/AnalysisHost.h"
 #include "AIStageHandFifo.h"
 #include "AIStageHandAnalyzer.h"
 
@@ -14,14 +15,19 @@ namespace AudioCoPilot
  * - Enfileira dados para thread de análise
  * - Exponde alertas e níveis para a UI
  */
-class AIStageHandController : public juce::AudioIODeviceCallback
+class AIStageHandController : public juce::AudioIODeviceCallback,
+                              public AnalysisModule
 {
 public:
     explicit AIStageHandController(DeviceManager& dm);
     ~AIStageHandController() override;
 
-    void activate();
-    void deactivate();
+    void activate() override;
+    void deactivate() override;
+    bool isAnalysisActive() const override { return active.load(); }
+
+    // Alerts matter most while nobody is looking: the analysis always runs at full rate
+    void setBudget(const AnalysisBudget& budget) override { juce::ignoreUnused(budget); }
 
     // UI accessors (thread-safe via atomics / cópias)
     std::vector<float> getChannelRms() const;
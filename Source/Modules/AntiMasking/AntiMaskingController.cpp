@@ -5,6 +5,11 @@ namespace AudioCoPilot
 AntiMaskingController::AntiMaskingController (DeviceManager& dm)
     : deviceManager (dm)
 {
+    AntiMaskingSnapshot initial;
+    for (auto& a : initial.spectraDb)
+        a.fill (-100.0f);
+    snapshotSlot.reset (initial);
+
     deviceManager.addChangeListener (this);
 }
 
@@ -47,6 +52,7 @@ void AntiMaskingController::deactivate()
     if (worker.joinable())
         worker.join();
 
+    logRingStats();
     processor.reset();
 }
 
@@ -58,6 +64,14 @@ int AntiMaskingController::getAvailableInputChannels() const
     return 0;
 }
 
+void AntiMaskingController::logRingStats() const
+{
+    const auto st = getRingStats();
+    juce::Logger::writeToLog ("AntiMaskingController ring stats - capacity: " + juce::String (st.capacity)
+                              + ", hwm: " + juce::String (st.highWaterMark)
+                              + ", overflowed frames: " + juce::String ((juce::int64) st.overflowedFrames));
+}
+
 void AntiMaskingController::setTargetChannel (int channelIndex)
 {
     targetChannel.store (juce::jmax (0, channelIndex));
@@ -126,10 +140,8 @@ void AntiMaskingController::updateSettingsFromDevice()
     currentBlockSize = device->getCurrentBufferSizeSamples();
     processor.prepare (currentSampleRate, currentBlockSize);
 
-    // Preallocate rings (2 seconds per channel)
-    const int cap = (int) (currentSampleRate * 2.0);
-    for (auto& r : ring)
-        r.prepare (cap);
+    // Preallocate ring (2 seconds, all streams)
+    ring.prepare (MaxStreams, (int) (currentSampleRate * 2.0));
 }
 
 void AntiMaskingController::audioDeviceIOCallbackWithContext (const float* const* inputChannelData,
@@ -163,83 +175,97 @@ void AntiMaskingController::audioDeviceIOCallbackWithContext (const float* const
     const int m2 = maskerChannels[2].load();
 
     const int channels[MaxStreams] = { t, m0, m1, m2 };
+    const float* streams[MaxStreams] {};
 
+    // Unconnected streams are written as silence by the ring
     for (int s = 0; s < MaxStreams; ++s)
     {
         const int ch = channels[s];
-        if (ch < 0 || ch >= numInputChannels)
-            continue;
-
-        const float* src = inputChannelData[ch];
-        if (src == nullptr)
-            continue;
-
-        ring[(size_t) s].push (src, numSamples);
+        streams[s] = (ch >= 0 && ch < numInputChannels) ? inputChannelData[ch] : nullptr;
     }
 
+    ring.push (streams, numSamples);
     dataReady.signal();
 }
 
+void AntiMaskingController::publishSnapshot()
+{
+    auto& snap = snapshotSlot.beginWrite();
+    snap.averaged = processor.getAveragedResult();
+
+    // Stream 0 = target, streams 1..3 = maskers (as passed into processor)
+    for (int i = 0; i < MaxStreams; ++i)
+        snap.spectraDb[(size_t) i] = processor.getSpectrumDbForSelectedIndex (i);
+
+    snap.sequence = ++snapshotSequence;
+    snapshotSlot.publish();
+    publishedSequence.store (snapshotSequence, std::memory_order_release);
+}
+
 void AntiMaskingController::workerLoop()
 {
     // Fixed block size for analysis updates (kept small to avoid UI latency)
     constexpr int workN = 512;
 
-    const float* ptrs[MaxStreams] = {
+    const float* ptrs[MaxStreams] {};
+    float* const copyPtrs[MaxStreams] = {
         workBlock[0].data(),
         workBlock[1].data(),
         workBlock[2].data(),
         workBlock[3].data()
     };
 
+    double lastPublishMs = 0.0;
+    bool hasUnpublishedData = false;
+
     while (workerShouldRun.load())
     {
         dataReady.wait (10);
         if (! workerShouldRun.load())
             break;
 
-        // Try to pop a full work block from each enabled stream.
-        // Minimum required: target + at least 1 masker => 2 streams.
-        int selectedCount = 0;
-
-        // target always present (stream 0)
-        const int gotT = ring[0].pop (workBlock[0].data(), workN);
-        if (gotT < workN)
-            continue;
-
-        selectedCount = 1;
-
-        // maskers: only include enabled ones (in order)
-        for (int i = 0; i < 3; ++i)
+        // Drain every complete block that is available, not just one per wake-up,
+        // so the ring never backs up while the worker sleeps.
+        while (ring.available() >= workN)
         {
-            if (! maskerEnabled[(size_t) i].load())
-                continue;
-
-            const int s = i + 1;
-            const int got = ring[(size_t) s].pop (workBlock[(size_t) s].data(), workN);
-            if (got < workN)
-                continue;
-
-            ++selectedCount;
-            if (selectedCount >= 4)
+            const auto region = ring.peek (workN);
+
+            if (region.size2 == 0)
+            {
+                // Contiguous block: analyse straight from the ring
+                for (int s = 0; s < MaxStreams; ++s)
+                    ptrs[s] = ring.getReadPointer (s, region.offset1);
+            }
+            else
+            {
+                // Block straddles the wrap point: copy it out first
+                ring.pop (copyPtrs, workN);
+                for (int s = 0; s < MaxStreams; ++s)
+                    ptrs[s] = copyPtrs[s];
+            }
+
+            // Streams stay at fixed slots (0 = target, 1..3 = maskers);
+            // disabled maskers are ignored by the processor via setMaskerEnabled()
+            processor.setTargetIndex (0);
+            processor.processBlock (ptrs, MaxStreams, workN);
+
+            if (region.size2 == 0)
+                ring.commit (workN);
+
+            hasUnpublishedData = true;
+
+            if (! workerShouldRun.load())
                 break;
         }
 
-        if (selectedCount < 2)
-            continue;
-
-        // The processor expects streams contiguous starting at 0 (target) and then maskers.
-        // Our ptrs are fixed; processor will read only first selectedCount.
-        processor.setTargetIndex (0);
-        processor.processBlock (ptrs, selectedCount, workN);
-
-        // Update latest spectra snapshot for UI
-        // Stream 0 = target, streams 1..3 = maskers (as passed into processor)
-        for (int i = 0; i < 4; ++i)
-            latestSpectraDb[(size_t) i] = processor.getSpectrumDbForSelectedIndex (i);
-
-        sendChangeMessage();
+        // Publish to the UI at a capped rate; views pick it up on their own timer
+        const double nowMs = juce::Time::getMillisecondCounterHiRes();
+        if (hasUnpublishedData && nowMs - lastPublishMs >= snapshotIntervalMs * snapshotDivider.load())
+        {
+            publishSnapshot();
+            lastPublishMs = nowMs;
+            hasUnpublishedData = false;
+        }
     }
 }
 }
-
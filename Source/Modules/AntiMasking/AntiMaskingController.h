@@ -2,82 +2,38 @@
 
 #include "../../JuceHeader.h"
 #include "../../Core/DeviceManager.h"
+#include "../../Core/AnalysisHost.h"
+#include "../../Core/AudioFrameRing.h"
+#include "../../Core/LatestValueSlot.h"
 #include "AntiMaskingProcessor.h"
 #include <atomic>
 #include <thread>
 
 namespace AudioCoPilot
 {
-// SPSC ring buffer for float audio samples (single producer: audio callback, single consumer: worker thread)
-class AudioRingBuffer
+// Everything the UI needs from one analysis update, published as a single consistent value
+struct AntiMaskingSnapshot
 {
-public:
-    void prepare (int capacitySamples)
-    {
-        // capacitySamples must be power of 2 for fast wrap
-        capacity = juce::nextPowerOfTwo (juce::jmax (2, capacitySamples));
-        mask = (size_t) (capacity - 1);
-        buffer.reset (new float[(size_t) capacity]);
-        std::fill (buffer.get(), buffer.get() + capacity, 0.0f);
-        writeIndex.store (0, std::memory_order_release);
-        readIndex.store (0, std::memory_order_release);
-    }
-
-    int getCapacity() const noexcept { return capacity; }
-
-    // Producer: write up to num samples, returns written count
-    int push (const float* src, int num) noexcept
-    {
-        if (buffer == nullptr || src == nullptr || num <= 0) return 0;
-        const size_t w = writeIndex.load (std::memory_order_relaxed);
-        const size_t r = readIndex.load (std::memory_order_acquire);
-        const size_t free = (size_t) capacity - (w - r);
-        const size_t toWrite = (size_t) juce::jmin ((int) free, num);
-        for (size_t i = 0; i < toWrite; ++i)
-            buffer[(w + i) & mask] = src[i];
-        writeIndex.store (w + toWrite, std::memory_order_release);
-        return (int) toWrite;
-    }
-
-    // Consumer: read up to num samples, returns read count
-    int pop (float* dst, int num) noexcept
-    {
-        if (buffer == nullptr || dst == nullptr || num <= 0) return 0;
-        const size_t r = readIndex.load (std::memory_order_relaxed);
-        const size_t w = writeIndex.load (std::memory_order_acquire);
-        const size_t avail = (w - r);
-        const size_t toRead = (size_t) juce::jmin ((int) avail, num);
-        for (size_t i = 0; i < toRead; ++i)
-            dst[i] = buffer[(r + i) & mask];
-        readIndex.store (r + toRead, std::memory_order_release);
-        return (int) toRead;
-    }
-
-    int available() const noexcept
-    {
-        const size_t r = readIndex.load (std::memory_order_acquire);
-        const size_t w = writeIndex.load (std::memory_order_acquire);
-        return (int) (w - r);
-    }
-
-private:
-    int capacity { 0 };
-    size_t mask { 0 };
-    std::unique_ptr<float[]> buffer;
-    std::atomic<size_t> writeIndex { 0 };
-    std::atomic<size_t> readIndex { 0 };
+    MaskingAnalysisResult averaged {};
+    std::array<std::array<float, 24>, 4> spectraDb {};
+    uint64_t sequence { 0 };
 };
 
 class AntiMaskingController : public juce::AudioIODeviceCallback,
                               public juce::ChangeListener,
-                              public juce::ChangeBroadcaster
+                              public juce::ChangeBroadcaster,
+                              public AnalysisModule
 {
 public:
     AntiMaskingController (DeviceManager& dm);
     ~AntiMaskingController() override;
 
-    void activate();
-    void deactivate();
+    void activate() override;
+    void deactivate() override;
+    bool isAnalysisActive() const override { return active.load(); }
+
+    // Hidden: the worker keeps analysing every block, snapshots are published displayDivider times less often
+    void setBudget (const AnalysisBudget& budget) override { snapshotDivider.store (juce::jmax (1, budget.displayDivider)); }
 
     int getAvailableInputChannels() const;
 
@@ -89,8 +45,18 @@ public:
     int getMaskerChannel (int slot) const noexcept { return maskerChannels[(size_t) slot].load(); }
     bool isMaskerEnabled (int slot) const noexcept { return maskerEnabled[(size_t) slot].load(); }
 
-    const MaskingAnalysisResult& getAveragedResult() const noexcept { return processor.getAveragedResult(); }
-    std::array<std::array<float, 24>, 4> getLatestSpectraDb() const noexcept { return latestSpectraDb; }
+    // UI thread only: picks up the snapshot last published by the worker (never blocks the worker).
+    // Returns false if nothing new was published; getters below stay stable until the next poll.
+    bool pollSnapshot() noexcept { return snapshotSlot.update(); }
+
+    // Any thread: sequence of the last published snapshot, lets views skip frames with nothing new
+    uint64_t getSnapshotGeneration() const noexcept { return publishedSequence.load (std::memory_order_acquire); }
+    const AntiMaskingSnapshot& getSnapshot() const noexcept { return snapshotSlot.current(); }
+    const MaskingAnalysisResult& getAveragedResult() const noexcept { return getSnapshot().averaged; }
+    std::array<std::array<float, 24>, 4> getLatestSpectraDb() const noexcept { return getSnapshot().spectraDb; }
+
+    // Ring diagnostics, used to size the analysis ring from real sessions
+    AudioFrameRing::Stats getRingStats() const noexcept { return ring.getStats(); }
 
     // Audio callbacks
     void audioDeviceIOCallbackWithContext (const float* const* inputChannelData,
@@ -108,6 +74,8 @@ public:
 private:
     void updateSettingsFromDevice();
     void workerLoop();
+    void publishSnapshot();
+    void logRingStats() const;
 
     DeviceManager& deviceManager;
     AntiMaskingProcessor processor;
@@ -121,20 +89,19 @@ private:
     std::array<std::atomic<int>, 3> maskerChannels { 1, 2, 3 };
     std::array<std::atomic<bool>, 3> maskerEnabled { true, false, false };
 
-    // ring buffers per selected stream (target + 3 maskers)
+    // One frame ring for all selected streams (target + 3 maskers), so they stay sample-aligned
     static constexpr int MaxStreams = 4;
-    std::array<AudioRingBuffer, MaxStreams> ring;
-    std::array<std::array<float, 1024>, MaxStreams> workBlock {}; // fixed work buffer
+    AudioFrameRing ring;
+    alignas (64) std::array<std::array<float, 1024>, MaxStreams> workBlock {}; // used only when a block wraps
 
     int currentBlockSize { 512 };
     double currentSampleRate { 48000.0 };
 
-    // Updated from worker thread; UI reads (best-effort snapshot). Small, acceptable without locks.
-    std::array<std::array<float, 24>, 4> latestSpectraDb { []{
-        std::array<std::array<float, 24>, 4> x{};
-        for (auto& a : x) a.fill(-100.0f);
-        return x;
-    }() };
+    // UI snapshots are published at most this often; the worker itself drains every block
+    static constexpr double snapshotIntervalMs = 1000.0 / 30.0;
+    std::atomic<int> snapshotDivider { 1 };
+    LatestValueSlot<AntiMaskingSnapshot> snapshotSlot;
+    uint64_t snapshotSequence { 0 };
+    std::atomic<uint64_t> publishedSequence { 0 };
 };
 }
-
@@ -37,21 +37,32 @@ float AntiMaskingFrequencyGraphComponent::dbToY(float db, float height) const
     return height * (1.0f - (db - minDb) / (maxDb - minDb));
 }
 
-void AntiMaskingFrequencyGraphComponent::paint(juce::Graphics& g)
+juce::Rectangle<float> AntiMaskingFrequencyGraphComponent::getGraphArea(juce::Rectangle<float> bounds) const
+{
+    // Graph area with padding
+    return bounds.reduced(60, 40);
+}
+
+void AntiMaskingFrequencyGraphComponent::drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds)
 {
-    auto bounds = getLocalBounds().toFloat();
-    
     // Background
     g.setColour(juce::Colour(0xff0a0a0a));
     g.fillRect(bounds);
     
-    // Graph area with padding
-    auto graphArea = bounds.reduced(60, 40);
+    auto graphArea = getGraphArea(bounds.toFloat());
     
     // Draw grid and axes
     drawGrid(g, graphArea);
     drawFrequencyAxis(g, graphArea);
     drawMagnitudeAxis(g, graphArea);
+}
+
+void AntiMaskingFrequencyGraphComponent::paint(juce::Graphics& g)
+{
+    // Background, grid and axes come from the cached image
+    staticLayer.draw(g, getLocalBounds());
+    
+    auto graphArea = getGraphArea(getLocalBounds().toFloat());
     
     // Draw masking zones first (behind curve)
     drawMaskingZones(g, graphArea);
@@ -180,4 +191,10 @@ void AntiMaskingFrequencyGraphComponent::resized()
     repaint();
 }
 
+void AntiMaskingFrequencyGraphComponent::lookAndFeelChanged()
+{
+    staticLayer.invalidate();
+    repaint();
+}
+
 }
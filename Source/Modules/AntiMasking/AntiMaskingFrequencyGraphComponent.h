@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../JuceHeader.h"
+#include "../../UI/CachedPlotLayer.h"
 #include <array>
 #include <vector>
 
@@ -21,6 +22,7 @@ public:
 
     void paint(juce::Graphics& g) override;
     void resized() override;
+    void lookAndFeelChanged() override;
 
     // Set anti-masking curve (EQ curve)
     void setAntiMaskingCurve(const std::vector<float>& frequencies, 
@@ -36,6 +38,10 @@ public:
     void setMaskingZones(const std::vector<MaskingZone>& zones);
 
 private:
+    // Background, grid and axes (cached in staticLayer)
+    void drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds);
+    juce::Rectangle<float> getGraphArea(juce::Rectangle<float> bounds) const;
+    
     void drawGrid(juce::Graphics& g, juce::Rectangle<float> bounds);
     void drawFrequencyAxis(juce::Graphics& g, juce::Rectangle<float> bounds);
     void drawMagnitudeAxis(juce::Graphics& g, juce::Rectangle<float> bounds);
@@ -45,6 +51,8 @@ private:
     float frequencyToX(float freq, float width) const;
     float dbToY(float db, float height) const;
     
+    CachedPlotLayer staticLayer{[this](juce::Graphics& g, juce::Rectangle<int> bounds) { drawStaticLayer(g, bounds); }};
+    
     std::vector<float> curveFrequencies;
     std::vector<float> curveGainsDb;
     std::vector<MaskingZone> maskingZones;
@@ -65,26 +65,15 @@ AntiMaskingView::AntiMaskingView (AntiMaskingController& c)
     rebuildChannelLists();
 
     strings.addChangeListener (this);
-    // Timer will start when view becomes visible
-}
 
-void AntiMaskingView::visibilityChanged()
-{
-    if (isVisible())
-    {
-        if (! isTimerRunning())
-            startTimerHz (20);
-    }
-    else
-    {
-        if (isTimerRunning())
-            stopTimer();
-    }
+    // Refresh (at most 20 Hz) when the worker publishes a new snapshot and the view is showing
+    FrameScheduler::getInstance().addClient (*this, { [this] { return controller.getSnapshotGeneration(); } },
+                                             [this] { updateFromSnapshot(); }, 20);
 }
 
 AntiMaskingView::~AntiMaskingView()
 {
-    stopTimer();
+    FrameScheduler::getInstance().removeClient (*this);
     controller.removeChangeListener (this);
     LocalizedStrings::getInstance().removeChangeListener (this);
 }
@@ -218,13 +207,11 @@ void AntiMaskingView::changeListenerCallback (juce::ChangeBroadcaster* source)
     }
 }
 
-void AntiMaskingView::timerCallback()
+void AntiMaskingView::updateFromSnapshot()
 {
-    if (! isVisible())
-    {
-        stopTimer();
+    // Nothing new from the worker since the last frame
+    if (! controller.pollSnapshot())
         return;
-    }
     
     const auto& r = controller.getAveragedResult();
     matrix.setResult (r);
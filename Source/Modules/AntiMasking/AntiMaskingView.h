@@ -5,14 +5,14 @@
 #include "MaskingMatrixDisplay.h"
 #include "BarkSpectrumDisplay.h"
 #include "AISuggestionsEngine.h"
+#include "../../UI/FrameScheduler.h"
 
 namespace AudioCoPilot
 {
 class AntiMaskingView : public juce::Component,
                         public juce::ComboBox::Listener,
                         public juce::Button::Listener,
-                        public juce::ChangeListener,
-                        public juce::Timer
+                        public juce::ChangeListener
 {
 public:
     AntiMaskingView (AntiMaskingController& c);
@@ -20,15 +20,14 @@ public:
 
     void resized() override;
     void paint (juce::Graphics& g) override;
-    void visibilityChanged() override;
 
     void comboBoxChanged (juce::ComboBox* comboBoxThatHasChanged) override;
     void buttonClicked (juce::Button* button) override;
     void changeListenerCallback (juce::ChangeBroadcaster* source) override;
-    void timerCallback() override;
 
 private:
     void rebuildChannelLists();
+    void updateFromSnapshot();
 
     AntiMaskingController& controller;
 
@@ -103,11 +103,17 @@ AntiMaskingViewModern::AntiMaskingViewModern(AntiMaskingController& c)
     controller.addChangeListener(this);
     rebuildChannelLists();
     strings.addChangeListener(this);
+
+    // Refresh on a new analysis snapshot, and once a second for the clock in the footer
+    FrameScheduler::getInstance().addClient(*this,
+                                            { [this] { return controller.getSnapshotGeneration(); },
+                                              [] { return (uint64_t) (juce::Time::currentTimeMillis() / 1000); } },
+                                            [this] { updateFromSnapshot(); }, 20);
 }
 
 AntiMaskingViewModern::~AntiMaskingViewModern()
 {
-    stopTimer();
+    FrameScheduler::getInstance().removeClient(*this);
     controller.removeChangeListener(this);
     LocalizedStrings::getInstance().removeChangeListener(this);
 }
@@ -164,30 +170,9 @@ void AntiMaskingViewModern::resized()
     utcTimeLabel.setBounds(footerArea.reduced(10, 0));
 }
 
-void AntiMaskingViewModern::visibilityChanged()
+void AntiMaskingViewModern::updateFromSnapshot()
 {
-    if (isVisible())
-    {
-        if (!isTimerRunning())
-            startTimerHz(20);
-    }
-    else
-    {
-        if (isTimerRunning())
-            stopTimer();
-    }
-}
-
-void AntiMaskingViewModern::timerCallback()
-{
-    if (!isVisible())
-    {
-        stopTimer();
-        return;
-    }
-
-    const auto& result = controller.getAveragedResult();
-    const auto spectra = controller.getLatestSpectraDb();
+    controller.pollSnapshot();
 
     // Update overall masking severity
     overallMaskingSeverity = calculateOverallMaskingSeverity();
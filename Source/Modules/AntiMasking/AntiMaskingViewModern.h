@@ -6,6 +6,7 @@
 #include "AntiMaskingFrequencyGraphComponent.h"
 #include "MaskingSourceCardComponent.h"
 #include "AISuggestionsEngine.h"
+#include "../../UI/FrameScheduler.h"
 #include <array>
 
 namespace AudioCoPilot
@@ -20,8 +21,7 @@ namespace AudioCoPilot
 class AntiMaskingViewModern : public juce::Component,
                               public juce::ComboBox::Listener,
                               public juce::Button::Listener,
-                              public juce::ChangeListener,
-                              public juce::Timer
+                              public juce::ChangeListener
 {
 public:
     AntiMaskingViewModern(AntiMaskingController& c);
@@ -29,15 +29,14 @@ public:
 
     void paint(juce::Graphics& g) override;
     void resized() override;
-    void visibilityChanged() override;
 
     void comboBoxChanged(juce::ComboBox* comboBoxThatHasChanged) override;
     void buttonClicked(juce::Button* button) override;
     void changeListenerCallback(juce::ChangeBroadcaster* source) override;
-    void timerCallback() override;
 
 private:
     void rebuildChannelLists();
+    void updateFromSnapshot();
     void updateFrequencyGraph();
     void updateMaskingSourceCards();
     float calculateOverallMaskingSeverity() const;
@@ -97,13 +97,13 @@ void BarkAnalyzer::performFft() noexcept
     for (int i = 0; i < FftSize; ++i)
         fftBuffer[(size_t) i] = inputBuffer[(size_t) i];
 
-    window.multiplyWithWindowingTable (fftBuffer.data(), FftSize);
+    juce::FloatVectorOperations::multiply (fftBuffer.data(), window->samples.data(), FftSize);
 
     // Second half must exist; clear for safety
     for (int i = 0; i < FftSize; ++i)
         fftBuffer[(size_t) (i + FftSize)] = 0.0f;
 
-    fft.performRealOnlyForwardTransform (fftBuffer.data(), true);
+    fft->performRealForward (fftBuffer.data());
 }
 
 void BarkAnalyzer::calculateBarkLevels() noexcept
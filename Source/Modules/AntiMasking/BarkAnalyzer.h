@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../JuceHeader.h"
+#include "../../Core/FFTPlanCache.h"
 #include <array>
 #include <utility>
 
@@ -41,8 +42,9 @@ private:
     double sr { 48000.0 };
     float smoothingCoeff { 0.0f };
 
-    juce::dsp::FFT fft { FftOrder };
-    juce::dsp::WindowingFunction<float> window { FftSize, juce::dsp::WindowingFunction<float>::hann };
+    // Shared engine and (normalised) Hann table
+    std::shared_ptr<const FFTEngine> fft { FFTPlanCache::getEngine (FftOrder) };
+    std::shared_ptr<const FFTPlanCache::WindowTable> window { FFTPlanCache::getWindow (FftSize, FFTPlanCache::Window::hann, true) };
 
     std::array<float, FftSize> inputBuffer {};
     int inputBufferIndex { 0 };
@@ -39,6 +39,19 @@ RTAResolution RTAController::getResolution() const
     return processor.getResolution();
 }
 
+void RTAController::setSpectrumHistorySeconds(double seconds)
+{
+    // The audio thread writes into the histories: take this callback out while they are reallocated
+    const bool wasActive = active.load();
+    if (wasActive)
+        deviceManager.removeAudioCallback(this);
+    
+    processor.setSpectrumHistorySeconds(seconds);
+    
+    if (wasActive)
+        deviceManager.addAudioCallback(this);
+}
+
 std::vector<float> RTAController::getLevels(int channelIndex)
 {
     // Return copy of the levels for safety
@@ -2,6 +2,7 @@
 
 #include "../../JuceHeader.h"
 #include "../../Core/DeviceManager.h"
+#include "../../Core/AnalysisHost.h"
 #include "RTAProcessor.h"
 #include <atomic>
 
@@ -9,14 +10,19 @@ namespace AudioCoPilot
 {
 
 class RTAController : public juce::AudioIODeviceCallback,
-                      public juce::ChangeBroadcaster
+                      public juce::ChangeBroadcaster,
+                      public AnalysisModule
 {
 public:
     RTAController(DeviceManager& dm);
     ~RTAController() override;
 
-    void activate();
-    void deactivate();
+    void activate() override;
+    void deactivate() override;
+    bool isAnalysisActive() const override { return active.load(); }
+    
+    // Hidden: band levels every displayDivider frames, spectrogram unchanged
+    void setBudget(const AnalysisBudget& budget) override { processor.setBandUpdateDivider(budget.displayDivider); }
     
     // Resolution Control
     void setResolution(RTAResolution res);
@@ -26,6 +32,16 @@ public:
     // Returns levels in dB for requested channel (0 or 1 usually)
     std::vector<float> getLevels(int channelIndex);
     std::vector<float> getFrequencies();
+    
+    // Advances whenever getLevels()/getFrequencies() have something new (for FrameScheduler)
+    uint64_t getGeneration() const { return processor.getOutputGeneration(); }
+    
+    // Spectrogram history of input channel 0 or 1 (kept while the module is active, views may come and go)
+    SpectrumHistory& getSpectrumHistory(int channelIndex) { return processor.getSpectrumHistory(channelIndex); }
+    
+    // How much spectrogram history is kept (seconds). Briefly stops this callback to reallocate.
+    void setSpectrumHistorySeconds(double seconds);
+    double getSpectrumHistorySeconds() const { return processor.getSpectrumHistorySeconds(); }
 
     // Audio callbacks
     void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
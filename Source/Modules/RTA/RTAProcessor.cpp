@@ -5,24 +5,55 @@ namespace AudioCoPilot
 
 RTAProcessor::RTAProcessor()
 {
-    fft = std::make_unique<juce::dsp::FFT>(FFTOrder);
-    window = std::make_unique<juce::dsp::WindowingFunction<float>>(FFTSize, juce::dsp::WindowingFunction<float>::hann);
+    fft = FFTPlanCache::getEngine(FFTOrder);
+    window = FFTPlanCache::getWindow(FFTSize, FFTPlanCache::Window::hann, true);
+    batchScratch.assign(fft->getScratchSize(), 0.0f);  // the engine is fixed from here on
     
     updateFrequencies();
+    prepareSpectrumHistories();
     
     // Initialize output vectors
     for (auto& ch : channels)
     {
         ch.outputLevels.resize(centerFrequencies.size(), -100.0f);
     }
+    
+    outputGeneration.fetch_add(1, std::memory_order_release);
 }
 
 void RTAProcessor::prepare(double newSampleRate)
 {
     sampleRate = newSampleRate;
+    prepareSpectrumHistories();
     reset();
 }
 
+void RTAProcessor::prepareSpectrumHistories()
+{
+    // One column per FFT frame (no overlap), same dB scale as the bars
+    SpectrumHistory::Settings settings;
+    settings.sampleRate = sampleRate;
+    settings.fftSize = FFTSize;
+    settings.columnsPerSecond = sampleRate / (double)FFTSize;
+    settings.historySeconds = spectrumHistorySeconds;
+    settings.floorDb = -100.0f;
+    settings.ceilingDb = 0.0f;
+    
+    for (auto& history : spectrumHistories)
+        history.prepare(settings);
+}
+
+SpectrumHistory& RTAProcessor::getSpectrumHistory(int channelIndex)
+{
+    return spectrumHistories[(size_t)juce::jlimit(0, MaxChannels - 1, channelIndex)];
+}
+
+void RTAProcessor::setSpectrumHistorySeconds(double seconds)
+{
+    spectrumHistorySeconds = juce::jlimit(10.0, 3600.0, seconds);
+    prepareSpectrumHistories();
+}
+
 void RTAProcessor::reset()
 {
     for (auto& ch : channels)
@@ -32,6 +63,8 @@ void RTAProcessor::reset()
         ch.fifoIndex = 0;
         std::fill(ch.outputLevels.begin(), ch.outputLevels.end(), -100.0f);
     }
+    
+    outputGeneration.fetch_add(1, std::memory_order_release);
 }
 
 void RTAProcessor::setResolution(RTAResolution resolution)
@@ -118,52 +151,72 @@ void RTAProcessor::processBlock(const float* const* channelData, int numChannels
     
     int usedChannels = juce::jmin(numChannels, (int)MaxChannels);
     
-    for (int ch = 0; ch < usedChannels; ++ch)
+    // Copy in chunks up to the next full frame; channels fed together fill together,
+    // and the frames completed by a chunk are transformed as one batch
+    int offset = 0;
+    while (offset < numSamples)
     {
-        if (channelData[ch] != nullptr)
+        int chunk = numSamples - offset;
+        for (int ch = 0; ch < usedChannels; ++ch)
+        {
+            if (channelData[ch] != nullptr)
+                chunk = juce::jmin(chunk, FFTSize - channels[ch].fifoIndex);
+        }
+        
+        std::array<int, MaxChannels> fullChannels;
+        int numFull = 0;
+        
+        for (int ch = 0; ch < usedChannels; ++ch)
         {
-            for (int i = 0; i < numSamples; ++i)
+            if (channelData[ch] == nullptr)
+                continue;
+            
+            auto& chData = channels[ch];
+            std::copy(channelData[ch] + offset, channelData[ch] + offset + chunk, chData.fifo.begin() + chData.fifoIndex);
+            chData.fifoIndex += chunk;
+            
+            if (chData.fifoIndex == FFTSize)
             {
-                pushNextSampleIntoFifo(ch, channelData[ch][i]);
+                // Copy to FFT data and apply window
+                std::copy(chData.fifo.begin(), chData.fifo.end(), chData.fftData.begin());
+                std::fill(chData.fftData.begin() + FFTSize, chData.fftData.end(), 0.0f);
+                juce::FloatVectorOperations::multiply(chData.fftData.data(), window->samples.data(), FFTSize);
+                
+                chData.fifoIndex = 0;
+                fullChannels[(size_t)numFull++] = ch;
             }
         }
+        
+        if (numFull > 0)
+            performFFTs(fullChannels.data(), numFull);
+        
+        offset += chunk;
     }
 }
 
-void RTAProcessor::pushNextSampleIntoFifo(int channel, float sample)
+void RTAProcessor::performFFTs(const int* channelIndices, int numChannels)
 {
-    if (channel < 0 || channel >= MaxChannels) return;
+    std::array<float*, MaxChannels> frames;
+    for (int i = 0; i < numChannels; ++i)
+        frames[(size_t)i] = channels[channelIndices[i]].fftData.data();
     
-    auto& chData = channels[channel];
+    fft->performFrequencyOnlyForwardBatch(frames.data(), numChannels, batchScratch.data());
     
-    if (chData.fifoIndex == FFTSize)
+    for (int i = 0; i < numChannels; ++i)
     {
-        if (!chData.fifoIndex) return; // safety
+        const int channel = channelIndices[i];
+        auto& chData = channels[channel];
         
-        // Copy to FFT data
-        std::fill(chData.fftData.begin(), chData.fftData.end(), 0.0f);
-        std::copy(chData.fifo.begin(), chData.fifo.end(), chData.fftData.begin());
+        // Unsmoothed spectrum for the spectrogram (bins 0..N/2 hold the magnitudes now)
+        spectrumHistories[(size_t)channel].pushMagnitudes(chData.fftData.data(), FFTSize / 2 + 1);
         
-        // Apply window
-        window->multiplyWithWindowingTable(chData.fftData.data(), FFTSize);
-        
-        // Perform FFT
-        performFFT(channel);
-        
-        chData.fifoIndex = 0;
+        // Now map linear bins to fractional octave bands
+        if (++chData.framesSinceBands >= bandUpdateDivider.load())
+        {
+            chData.framesSinceBands = 0;
+            mapFFTToBands(channel);
+        }
     }
-    
-    chData.fifo[chData.fifoIndex++] = sample;
-}
-
-void RTAProcessor::performFFT(int channel)
-{
-    auto& chData = channels[channel];
-    
-    fft->performFrequencyOnlyForwardTransform(chData.fftData.data());
-    
-    // Now map linear bins to fractional octave bands
-    mapFFTToBands(channel);
 }
 
 void RTAProcessor::mapFFTToBands(int channel)
@@ -241,6 +294,8 @@ void RTAProcessor::mapFFTToBands(int channel)
         // Clamp
         if (chData.outputLevels[i] < -100.0f) chData.outputLevels[i] = -100.0f;
     }
+    
+    outputGeneration.fetch_add(1, std::memory_order_release);
 }
 
 }
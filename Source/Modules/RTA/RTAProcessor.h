@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../../JuceHeader.h"
+#include "../../Core/FFTPlanCache.h"
+#include "../../Core/SpectrumHistory.h"
 #include <vector>
 #include <array>
 #include <atomic>
@@ -44,24 +46,40 @@ public:
     // Get the center frequencies for the current resolution
     const std::vector<float>& getFrequencies() const;
 
+    // Incremented every time new levels (or a new band layout) are available
+    uint64_t getOutputGeneration() const { return outputGeneration.load(std::memory_order_acquire); }
+    
+    // Spectrogram history of an input (every FFT frame, fixed 1/48 octave grid, independent of the resolution)
+    SpectrumHistory& getSpectrumHistory(int channelIndex);
+    
+    // Length kept by the spectrogram histories. Reallocates them: the audio callback must not be running.
+    void setSpectrumHistorySeconds(double seconds);
+    double getSpectrumHistorySeconds() const { return spectrumHistorySeconds; }
+    
+    // Band levels from every Nth FFT frame only (hidden view); the spectrogram still gets every frame
+    void setBandUpdateDivider(int divider) { bandUpdateDivider.store(juce::jmax(1, divider)); }
+
 private:
     void updateFrequencies();
-    void pushNextSampleIntoFifo(int channel, float sample);
-    void performFFT(int channel);
+    // Transforms the channels' windowed frames in one batch, then updates their outputs
+    void performFFTs(const int* channelIndices, int numChannels);
     void mapFFTToBands(int channel);
+    void prepareSpectrumHistories();
 
     double sampleRate { 48000.0 };
     std::atomic<RTAResolution> currentResolution { RTAResolution::ThirdOctave };
     
-    // FFT
-    std::unique_ptr<juce::dsp::FFT> fft;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    // FFT (shared engine and normalised Hann table, see FFTPlanCache)
+    std::shared_ptr<const FFTEngine> fft;
+    std::shared_ptr<const FFTPlanCache::WindowTable> window;
+    std::vector<float> batchScratch;  // FFTEngine::getScratchSize() floats, so batches don't allocate
     
     // Buffers per channel
     struct ChannelData {
         std::array<float, FFTSize * 2> fftData;
         std::array<float, FFTSize> fifo;
         int fifoIndex { 0 };
+        int framesSinceBands { 0 };
         std::vector<float> outputLevels; // decibels
     };
     
@@ -70,6 +88,13 @@ private:
     // Calculated frequencies and levels
     std::vector<float> centerFrequencies;
     
+    std::atomic<uint64_t> outputGeneration { 0 };
+    std::atomic<int> bandUpdateDivider { 1 };
+    
+    // Quantized spectra for the spectrogram view (fixed memory, see SpectrumHistory)
+    std::array<SpectrumHistory, MaxChannels> spectrumHistories;
+    double spectrumHistorySeconds { 300.0 };
+    
     // Smoothing
     // float releaseSpeed { 0.2f }; // Fixed release for now
 };
@@ -41,43 +41,102 @@ RTAView::RTAView(RTAController& c, DeviceManager& dm)
     };
     addAndMakeVisible(resolutionSelector);
     
-    // Timer will start when view becomes visible
+    spectrogramSelector.addItem("Spectrogram Off", 1);
+    spectrogramSelector.addItem("Spectrogram In 1", 2);
+    spectrogramSelector.addItem("Spectrogram In 2", 3);
+    spectrogramSelector.setSelectedId(1, juce::dontSendNotification);
+    spectrogramSelector.onChange = [this] { updateSpectrogram(); };
+    addAndMakeVisible(spectrogramSelector);
+    addChildComponent(spectrogram);
+    
+    // Repaint when the analyzer has new levels (the scheduler skips us while hidden)
+    FrameScheduler::getInstance().addClient(*this, { [this] { return controller.getGeneration(); } });
+    
+    glRenderer.onFallback = [this] { repaint(); };
+    glRenderer.attachTo(*this);
 }
 
 RTAView::~RTAView()
 {
-    stopTimer();
+    glRenderer.detach();
+    FrameScheduler::getInstance().removeClient(*this);
     deviceSelector = nullptr;
 }
 
-void RTAView::timerCallback()
+void RTAView::updateSpectrogram()
 {
-    if (! isVisible())
-    {
-        stopTimer();
-        return;
-    }
+    const int selectedId = spectrogramSelector.getSelectedId();
+    
+    // The history keeps filling while hidden, so switching inputs shows the past minutes right away
+    spectrogram.setSource(selectedId > 1 ? &controller.getSpectrumHistory(selectedId - 2) : nullptr);
+    spectrogram.setVisible(selectedId > 1);
+    
+    // The bars lose (or get back) the space below them
+    staticLayer.invalidate();
+    resized();
     repaint();
 }
 
-void RTAView::visibilityChanged()
+juce::Rectangle<int> RTAView::getPlotArea(juce::Rectangle<int> bounds) const
 {
-    if (isVisible())
-    {
-        if (! isTimerRunning())
-            startTimerHz(60);
-    }
-    else
+    // Reserve top area for controls
+    bounds.removeFromTop(80);
+    
+    // ...and the bottom part for the spectrogram when it is shown
+    if (spectrogram.isVisible())
+        bounds.removeFromBottom(bounds.getHeight() * 2 / 5);
+    
+    // Margins
+    return bounds.reduced(20, 20);
+}
+
+void RTAView::drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    using namespace DesignSystem;
+    g.fillAll(Colours::getColour(Colours::Surface::Background));
+    
+    auto plotArea = getPlotArea(bounds);
+    if (plotArea.isEmpty()) return;
+    
+    // dB grid (-100 dB at the bottom, 0 dB at the top, same mapping as the bars)
+    g.setFont(Typography::labelSmall());
+    for (float db = -80.0f; db <= -20.0f; db += 20.0f)
     {
-        if (isTimerRunning())
-            stopTimer();
+        float norm = juce::jmap(db, -100.0f, 0.0f, 0.0f, 1.0f);
+        int y = plotArea.getBottom() - juce::roundToInt((float)plotArea.getHeight() * norm);
+        
+        g.setColour(Colours::getColour(Colours::Border::Separator));
+        g.drawHorizontalLine(y, (float)plotArea.getX(), (float)plotArea.getRight());
+        
+        g.setColour(Colours::getColour(Colours::Text::Secondary));
+        g.drawText(juce::String((int)db), plotArea.getX(), y - 14, 40, 12, juce::Justification::centredLeft);
     }
 }
 
+juce::Rectangle<float> RTAView::getBarArea(float db, size_t band, float xStep, juce::Rectangle<int> plotArea)
+{
+    // Map dB -100 to 0 -> height to 0
+    float norm = juce::jmap(db, -100.0f, 0.0f, 0.0f, 1.0f);
+    norm = juce::jlimit(0.0f, 1.0f, norm);
+    
+    float barHeight = (float)plotArea.getHeight() * norm;
+    float x = plotArea.getX() + band * xStep;
+    
+    return { x, (float)plotArea.getBottom() - barHeight, xStep - 1.0f, barHeight };
+}
+
 void RTAView::paint(juce::Graphics& g)
 {
-    using namespace DesignSystem;
-    g.fillAll(Colours::getColour(Colours::Surface::Background));
+    if (glRenderer.isActive())
+    {
+        paintWithOpenGL();
+        return;
+    }
+    
+    RenderStats::ScopedFrame frame(glRenderer.getStats(), RenderStats::Path::software);
+    
+    // Background and grid come from the cached image
+    staticLayer.draw(g, getLocalBounds());
     
     // Get levels
     auto leftLevels = controller.getLevels(0);
@@ -86,49 +145,56 @@ void RTAView::paint(juce::Graphics& g)
     
     if (freqs.empty()) return;
     
-    auto bounds = getLocalBounds();
-    // Reserve top area for controls
-    bounds.removeFromTop(80);
-    
-    // Margins
-    bounds.reduce(20, 20);
-    
+    auto bounds = getPlotArea(getLocalBounds());
     float xStep = (float)bounds.getWidth() / (float)freqs.size();
-    float height = (float)bounds.getHeight();
-    float bottom = (float)bounds.getBottom();
     
     // Draw Left Channel (Input usually)
     g.setColour(leftColor.withAlpha(0.6f));
     for (size_t i = 0; i < leftLevels.size(); ++i)
-    {
-        float db = leftLevels[i];
-        // Map dB -100 to 0 -> height to 0
-        float norm = juce::jmap(db, -100.0f, 0.0f, 0.0f, 1.0f);
-        norm = juce::jlimit(0.0f, 1.0f, norm);
-        
-        float barHeight = height * norm;
-        float x = bounds.getX() + i * xStep;
-        
-        g.fillRect(x, bottom - barHeight, xStep - 1.0f, barHeight);
-    }
+        g.fillRect(getBarArea(leftLevels[i], i, xStep, bounds));
     
     // Draw Right Channel (or Channel 2)
     // "colors differentes quando entrar dois sinais diferentes"
-    // We overlay or put side by side? Overlay is standard RTA.
+    // Overlay, as on a standard RTA: alpha blending keeps the left bars visible behind
     g.setColour(rightColor.withAlpha(0.6f));
     for (size_t i = 0; i < rightLevels.size(); ++i)
+        g.fillRect(getBarArea(rightLevels[i], i, xStep, bounds));
+}
+
+void RTAView::paintWithOpenGL()
+{
+    // Background and bars go to the GL renderer; child controls are still painted by JUCE on top
+    RenderStats::ScopedFrame frame(glRenderer.getStats(), RenderStats::Path::openGL, true);
+    
+    const auto localBounds = getLocalBounds();
+    glRenderer.setBackground(staticLayer.getImage(localBounds, glRenderer.getRenderingScale()), localBounds,
+                             staticLayer.getVersion());
+    
+    glScene.clear();
+    
+    auto leftLevels = controller.getLevels(0);
+    auto rightLevels = controller.getLevels(1);
+    auto freqs = controller.getFrequencies();
+    
+    if (! freqs.empty())
     {
-        float db = rightLevels[i];
-        float norm = juce::jmap(db, -100.0f, 0.0f, 0.0f, 1.0f);
-        norm = juce::jlimit(0.0f, 1.0f, norm);
+        auto bounds = getPlotArea(localBounds);
+        float xStep = (float)bounds.getWidth() / (float)freqs.size();
         
-        float barHeight = height * norm;
-        float x = bounds.getX() + i * xStep;
+        for (size_t i = 0; i < leftLevels.size(); ++i)
+            glScene.addRect(getBarArea(leftLevels[i], i, xStep, bounds), leftColor.withAlpha(0.6f));
         
-        // Draw slightly narrower to see behind? Or just blend mode?
-        // Let's draw it over. Alpha blend handles it.
-        g.fillRect(x, bottom - barHeight, xStep - 1.0f, barHeight);
+        for (size_t i = 0; i < rightLevels.size(); ++i)
+            glScene.addRect(getBarArea(rightLevels[i], i, xStep, bounds), rightColor.withAlpha(0.6f));
     }
+    
+    glRenderer.setScene(glScene, localBounds);
+}
+
+void RTAView::lookAndFeelChanged()
+{
+    staticLayer.invalidate();
+    repaint();
 }
 
 void RTAView::resized()
@@ -144,6 +210,12 @@ void RTAView::resized()
     auto resArea = topBar.removeFromRight(250).reduced(5);
     resolutionLabel.setBounds(resArea.removeFromLeft(100));
     resolutionSelector.setBounds(resArea);
+    
+    spectrogramSelector.setBounds(topBar.removeFromRight(170).reduced(5));
+    
+    // Same horizontal margins as the bars, below them
+    auto content = getLocalBounds().withTrimmedTop(80).reduced(20, 20);
+    spectrogram.setBounds(content.removeFromBottom(content.getHeight() * 2 / 5));
 }
 
 }
@@ -3,12 +3,15 @@
 #include "../../JuceHeader.h"
 #include "RTAController.h"
 #include "../../UI/DeviceSelectorComponent.h"
+#include "../../UI/CachedPlotLayer.h"
+#include "../../UI/FrameScheduler.h"
+#include "../../UI/GLPlotRenderer.h"
+#include "../../UI/SpectrogramComponent.h"
 
 namespace AudioCoPilot
 {
 
-class RTAView : public juce::Component,
-                public juce::Timer
+class RTAView : public juce::Component
 {
 public:
     RTAView(RTAController& controller, DeviceManager& deviceManager);
@@ -16,13 +19,24 @@ public:
 
     void paint(juce::Graphics& g) override;
     void resized() override;
-    void visibilityChanged() override;
-    
-    void timerCallback() override;
+    void lookAndFeelChanged() override;
 
 private:
+    // Background + dB grid, re-rendered only on resize/language/look-and-feel change
+    void drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds);
+    juce::Rectangle<int> getPlotArea(juce::Rectangle<int> bounds) const;
+    static juce::Rectangle<float> getBarArea(float db, size_t band, float xStep, juce::Rectangle<int> plotArea);
+    void paintWithOpenGL();
+    void updateSpectrogram();
+    
     RTAController& controller;
     
+    CachedPlotLayer staticLayer { [this](juce::Graphics& g, juce::Rectangle<int> bounds) { drawStaticLayer(g, bounds); } };
+    
+    // Optional OpenGL path for the bars (software painting whenever it is not active)
+    GLPlotRenderer glRenderer { "RTA" };
+    GLPlotRenderer::Scene glScene;
+    
     // Reusing the existing Selector Device
     std::unique_ptr<DeviceSelectorComponent> deviceSelector;
     
@@ -30,6 +44,10 @@ private:
     juce::ComboBox resolutionSelector;
     juce::Label resolutionLabel;
     
+    // Scrolling spectrogram of one input under the bars (off by default)
+    juce::ComboBox spectrogramSelector;
+    SpectrogramComponent spectrogram { "Spectrogram", SpectrogramComponent::Orientation::spectrogram };
+    
     // Colors for columns
     juce::Colour leftColor { juce::Colours::cyan };
     juce::Colour rightColor { juce::Colours::magenta };
@@ -0,0 +1,113 @@
+#include "../Core/FFTEngine.h"
+#include "../Core/FFTPlanCache.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // The native engine must give JUCE's bins at every size the analyzers use, single and
+    // batched, before it can become the default backend (see FFTEngine.h)
+    class FFTEngineTest : public juce::UnitTest
+    {
+    public:
+        FFTEngineTest() : juce::UnitTest("FFT engine", "FFT") {}
+
+        void runTest() override
+        {
+            using AudioCoPilot::FFTEngine;
+
+            for (int order = minOrder; order <= maxOrder; ++order)
+            {
+                const int size = 1 << order;
+                const auto juceEngine = FFTEngine::create(order, FFTEngine::Backend::juce);
+                const auto nativeEngine = FFTEngine::create(order, FFTEngine::Backend::native);
+
+                beginTest("Native matches JUCE, size " + juce::String(size));
+
+                std::vector<std::vector<float>> inputs;
+                for (int channel = 0; channel < numChannels; ++channel)
+                    inputs.push_back(makeInput(size, channel));
+
+                std::vector<std::vector<float>> expected(inputs), bins(inputs), magnitudes(inputs);
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    juceEngine->performRealForward(expected[static_cast<size_t>(channel)].data());
+                    nativeEngine->performRealForward(bins[static_cast<size_t>(channel)].data());
+                    expectLessOrEqual(relativeDifference(expected[static_cast<size_t>(channel)],
+                                                         bins[static_cast<size_t>(channel)], size + 2),
+                                      tolerance);
+                }
+
+                beginTest("Native batch matches JUCE, size " + juce::String(size));
+
+                // One full group of FFTEngine::batchLanes channels plus a remainder
+                std::vector<float> scratch(nativeEngine->getScratchSize());
+                std::vector<std::vector<float>> batch(inputs);
+                std::vector<float*> pointers;
+                for (auto& channel : batch)
+                    pointers.push_back(channel.data());
+
+                nativeEngine->performRealForwardBatch(pointers.data(), numChannels, scratch.data());
+                for (int channel = 0; channel < numChannels; ++channel)
+                    expectLessOrEqual(relativeDifference(expected[static_cast<size_t>(channel)],
+                                                         batch[static_cast<size_t>(channel)], size + 2),
+                                      tolerance);
+
+                beginTest("Native batched magnitudes match JUCE, size " + juce::String(size));
+
+                expected = inputs;
+                for (auto& channel : expected)
+                    juceEngine->performFrequencyOnlyForward(channel.data());
+
+                pointers.clear();
+                for (auto& channel : magnitudes)
+                    pointers.push_back(channel.data());
+
+                nativeEngine->performFrequencyOnlyForwardBatch(pointers.data(), numChannels, scratch.data());
+                for (int channel = 0; channel < numChannels; ++channel)
+                    expectLessOrEqual(relativeDifference(expected[static_cast<size_t>(channel)],
+                                                         magnitudes[static_cast<size_t>(channel)], size / 2 + 1),
+                                      tolerance);
+            }
+        }
+
+    private:
+        // 1k: MTW levels, 2k: AI Stage Hand, 4k: RTA, Bark, smallest TF; up to the largest TF
+        static constexpr int minOrder = 10;
+        static constexpr int maxOrder = 17;
+        static constexpr int numChannels = AudioCoPilot::FFTEngine::batchLanes + 2;
+
+        // Largest difference allowed, relative to the spectrum's peak (float rounding of the two orders of operations)
+        static constexpr double tolerance = 1.0e-5;
+
+        // Hann-windowed noise plus a tone, as the analyzers feed it, in a 2 * size buffer
+        static std::vector<float> makeInput(int size, int channel)
+        {
+            const auto window = AudioCoPilot::FFTPlanCache::getWindow(size, AudioCoPilot::FFTPlanCache::Window::hann);
+            juce::Random random(11 + channel);
+
+            std::vector<float> input(static_cast<size_t>(2 * size), 0.0f);
+            for (int n = 0; n < size; ++n)
+            {
+                const float tone = 0.5f * std::sin(0.1f * static_cast<float>((channel + 1) * n));
+                input[static_cast<size_t>(n)] = window->samples[static_cast<size_t>(n)] * (tone + random.nextFloat() * 2.0f - 1.0f);
+            }
+            return input;
+        }
+
+        // Largest |a - b| over the first count floats, relative to the largest |a|
+        static double relativeDifference(const std::vector<float>& a, const std::vector<float>& b, int count)
+        {
+            double peak = 0.0, difference = 0.0;
+            for (size_t i = 0; i < static_cast<size_t>(count); ++i)
+            {
+                peak = std::max(peak, std::abs(static_cast<double>(a[i])));
+                difference = std::max(difference, std::abs(static_cast<double>(a[i]) - static_cast<double>(b[i])));
+            }
+            return peak > 0.0 ? difference / peak : difference;
+        }
+    };
+
+    FFTEngineTest fftEngineTest;
+}
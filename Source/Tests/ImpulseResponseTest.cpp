@@ -0,0 +1,57 @@
+#include "../Core/TransferFunction/TFProcessor.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Unit gain system (measurement = reference): H = 1, so the IR must be a unit sample at
+    // t = 0, i.e. a 0 dB energy peak (TFImpulseResponse::Display::peakDb's reference)
+    class ImpulseResponseTest : public juce::UnitTest
+    {
+    public:
+        ImpulseResponseTest() : juce::UnitTest("Impulse response", "TF") {}
+
+        void runTest() override
+        {
+            for (const int fftSize : { TFProcessor::minFFTSize, 16384 })
+            {
+                beginTest("Unit gain gives a 0 dB peak at t = 0, fftSize " + juce::String(fftSize));
+
+                TFProcessor processor;
+                processor.setImpulseResponseEnabled(true);
+                processor.prepare(fftSize, sampleRate);
+
+                juce::Random random(1);
+                std::vector<float> noise(static_cast<size_t>(fftSize * framesToAverage));
+                for (auto& s : noise)
+                    s = random.nextFloat() * 2.0f - 1.0f;
+
+                for (size_t offset = 0; offset + blockSize <= noise.size(); offset += blockSize)
+                    processor.processBlock(noise.data() + offset, noise.data() + offset, blockSize);
+
+                std::vector<float> impulseResponse, energy;
+                processor.getImpulseResponse(impulseResponse, energy);
+                expectEquals(static_cast<int>(impulseResponse.size()), fftSize);
+
+                if (energy.empty())
+                    continue;
+
+                const auto peak = std::max_element(energy.begin(), energy.end());
+                const int peakIndex = static_cast<int>(peak - energy.begin());
+                const float peakDb = 10.0f * std::log10(*peak);
+
+                expectEquals(peakIndex, TFProcessor::getImpulsePreRoll(fftSize));
+                expectWithinAbsoluteError(peakDb, 0.0f, 0.05f);
+                expectWithinAbsoluteError(impulseResponse[static_cast<size_t>(peakIndex)], 1.0f, 0.01f);
+            }
+        }
+
+    private:
+        static constexpr double sampleRate = 48000.0;
+        static constexpr int blockSize = 512;
+        static constexpr int framesToAverage = 16;
+    };
+
+    ImpulseResponseTest impulseResponseTest;
+}
@@ -0,0 +1,200 @@
+#include "../UI/GLPlotRenderer.h"
+#include <cmath>
+#include <cstdio>
+
+// Headless check of both plot render paths: paints a TF-like view through the software
+// path, then creates the OpenGL context on it and renders through GLPlotRenderer, and
+// prints the RenderStats of each. On a machine without a GPU run it under a virtual
+// display with Mesa's software rasterizer:
+//
+//   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./AudioCoPilotRenderCheck
+//
+// Exit code 0 when both paths rendered, 1 when the OpenGL path fell back or never drew a
+// frame, 77 (ctest's skip code) when there is no display or the GL path is disabled.
+namespace
+{
+    constexpr int framesPerPath = 120;
+    constexpr int contextTimeoutMs = 10000;
+    constexpr int renderTimeoutMs = 10000;
+    constexpr int numPoints = 1000;
+
+    // Same split as the live plots: paint() either draws with juce::Graphics or, while the
+    // renderer is active, only fills the scene
+    class CheckView : public juce::Component
+    {
+    public:
+        CheckView()
+        {
+            setSize(1000, 400);
+        }
+
+        GLPlotRenderer renderer{"RenderCheck"};
+
+        void paint(juce::Graphics& g) override
+        {
+            if (renderer.isActive())
+            {
+                paintWithOpenGL();
+                return;
+            }
+
+            RenderStats::ScopedFrame frame(renderer.getStats(), RenderStats::Path::software);
+
+            g.drawImage(getBackground(1.0f), getLocalBounds().toFloat());
+
+            juce::Path curve;
+            for (int i = 0; i < numPoints; ++i)
+            {
+                const auto point = getPoint(i);
+                if (i == 0)
+                    curve.startNewSubPath(point);
+                else
+                    curve.lineTo(point);
+            }
+
+            g.setColour(juce::Colours::cyan);
+            g.strokePath(curve, juce::PathStrokeType(1.5f));
+        }
+
+        void advance()
+        {
+            ++phase;
+            repaint();
+        }
+
+    private:
+        void paintWithOpenGL()
+        {
+            RenderStats::ScopedFrame frame(renderer.getStats(), RenderStats::Path::openGL, true);
+
+            const float scale = renderer.getRenderingScale();
+            renderer.setBackground(getBackground(scale), getLocalBounds(), static_cast<uint64_t>(scale * 1000.0f));
+
+            scene.clear();
+            scene.beginLineStrip(juce::Colours::cyan, 1.5f, true);
+            for (int i = 0; i < numPoints; ++i)
+            {
+                const auto point = getPoint(i);
+                scene.addPoint(point.x, point.y, getCoherence(i));
+            }
+            scene.addRect({10.0f, 10.0f, 40.0f, 20.0f}, juce::Colours::green.withAlpha(0.6f));
+
+            renderer.setScene(scene, getLocalBounds());
+        }
+
+        // Dark background and a grid, at the given physical pixel scale
+        const juce::Image& getBackground(float scale)
+        {
+            if (background.isNull() || backgroundScale != scale)
+            {
+                background = juce::Image(juce::Image::ARGB, juce::roundToInt(getWidth() * scale),
+                                         juce::roundToInt(getHeight() * scale), true);
+                juce::Graphics g(background);
+                g.addTransform(juce::AffineTransform::scale(scale));
+                g.fillAll(juce::Colour(0xff101418));
+                g.setColour(juce::Colours::white.withAlpha(0.15f));
+                for (int x = 0; x < getWidth(); x += 100)
+                    g.drawVerticalLine(x, 0.0f, static_cast<float>(getHeight()));
+                for (int y = 0; y < getHeight(); y += 40)
+                    g.drawHorizontalLine(y, 0.0f, static_cast<float>(getWidth()));
+                backgroundScale = scale;
+            }
+            return background;
+        }
+
+        juce::Point<float> getPoint(int i) const
+        {
+            const float x = static_cast<float>(getWidth()) * static_cast<float>(i) / static_cast<float>(numPoints - 1);
+            const float y = 0.5f * static_cast<float>(getHeight())
+                          * (1.0f + 0.6f * std::sin(0.02f * static_cast<float>(i + phase)));
+            return {x, y};
+        }
+
+        float getCoherence(int i) const
+        {
+            return 0.5f + 0.5f * std::cos(0.005f * static_cast<float>(i + 3 * phase));
+        }
+
+        GLPlotRenderer::Scene scene;
+        juce::Image background;
+        float backgroundScale{0.0f};
+        int phase{0};
+    };
+
+    void printStats(RenderStats& stats, RenderStats::Path path)
+    {
+        const auto summary = stats.getCurrentInterval(path);
+        std::printf("%-8s  %6d frames, avg %.3f ms, max %.3f ms\n", RenderStats::getPathName(path),
+                    summary.frames, summary.averageMs, summary.maxMs);
+    }
+}
+
+int main()
+{
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+#if JUCE_LINUX || JUCE_BSD
+    if (juce::SystemStats::getEnvironmentVariable("DISPLAY", {}).isEmpty())
+    {
+        std::printf("no DISPLAY, skipped (run under xvfb-run)\n");
+        return 77;
+    }
+#endif
+
+    if (!GLPlotRenderer::isAvailable())
+    {
+        std::printf("OpenGL path disabled (AUDIOCOPILOT_RENDERER=software or built without juce_opengl), skipped\n");
+        return 77;
+    }
+
+    auto* messageManager = juce::MessageManager::getInstance();
+    CheckView view;
+
+    // Software path: the renderer is not attached yet, so paint() draws with juce::Graphics
+    for (int frame = 0; frame < framesPerPath; ++frame)
+    {
+        view.advance();
+        view.createComponentSnapshot(view.getLocalBounds());
+    }
+
+    // OpenGL path: on screen, with the context attached
+    bool fellBack = false;
+    view.renderer.onFallback = [&fellBack] { fellBack = true; };
+
+    juce::DocumentWindow window("AudioCoPilot render check", juce::Colours::black, 0);
+    window.setUsingNativeTitleBar(true);
+    window.setContentNonOwned(&view, true);
+    window.setVisible(true);
+    view.renderer.attachTo(view);
+
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(contextTimeoutMs);
+    while (!view.renderer.isActive() && !fellBack && juce::Time::getMillisecondCounter() < deadline)
+        messageManager->runDispatchLoopUntil(20);
+
+    if (view.renderer.isActive())
+    {
+        auto& stats = view.renderer.getStats();
+        const auto renderDeadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(renderTimeoutMs);
+        while (stats.getCurrentInterval(RenderStats::Path::openGL).frames < framesPerPath && !fellBack
+               && juce::Time::getMillisecondCounter() < renderDeadline)
+        {
+            view.advance();
+            messageManager->runDispatchLoopUntil(5);
+        }
+    }
+
+    view.renderer.detach();
+    window.setVisible(false);
+    window.clearContentComponent();
+
+    printStats(view.renderer.getStats(), RenderStats::Path::software);
+    printStats(view.renderer.getStats(), RenderStats::Path::openGL);
+
+    if (fellBack || view.renderer.getStats().getCurrentInterval(RenderStats::Path::openGL).frames == 0)
+    {
+        std::printf("FAILED: %s\n", fellBack ? "OpenGL renderer fell back to software" : "no OpenGL frame rendered");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include "../JuceHeader.h"
+#include <cstdio>
+
+// Usage: AudioCoPilotTests [category]   (no category: run all). Exit code 1 on any failure.
+int main(int argc, char* argv[])
+{
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    if (argc > 1)
+        runner.runTestsInCategory(argv[1]);
+    else
+        runner.runAllTests();
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    std::printf("%d test group(s), %d failure(s)\n", runner.getNumResults(), failures);
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+#include "CachedPlotLayer.h"
+
+CachedPlotLayer::CachedPlotLayer(Renderer renderer)
+    : renderStaticLayer(std::move(renderer))
+{
+    // Labels are localized: re-render when the language changes
+    LocalizedStrings::getInstance().addChangeListener(this);
+}
+
+CachedPlotLayer::~CachedPlotLayer()
+{
+    LocalizedStrings::getInstance().removeChangeListener(this);
+}
+
+void CachedPlotLayer::draw(juce::Graphics& g, juce::Rectangle<int> area)
+{
+    if (area.isEmpty())
+        return;
+    
+    // Physical pixels per logical pixel for this context (2.0 on Retina, 1.5-2.0 on 4K)
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    
+    g.drawImage(getImage(area, scale), area.toFloat());
+}
+
+const juce::Image& CachedPlotLayer::getImage(juce::Rectangle<int> area, float scale)
+{
+    if (area.isEmpty())
+        return image;
+    
+    if (!valid || image.isNull() || area.getWidth() != imageArea.getWidth()
+        || area.getHeight() != imageArea.getHeight() || scale != imageScale)
+    {
+        const int pixelWidth = juce::roundToInt(static_cast<float>(area.getWidth()) * scale);
+        const int pixelHeight = juce::roundToInt(static_cast<float>(area.getHeight()) * scale);
+        
+        image = juce::Image(juce::Image::ARGB, juce::jmax(1, pixelWidth), juce::jmax(1, pixelHeight), true);
+        
+        {
+            juce::Graphics imageGraphics(image);
+            imageGraphics.addTransform(juce::AffineTransform::scale(scale));
+            renderStaticLayer(imageGraphics, area.withZeroOrigin());
+        }
+        
+        imageScale = scale;
+        valid = true;
+        ++version;
+    }
+    
+    imageArea = area;
+    return image;
+}
+
+void CachedPlotLayer::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if (source == &LocalizedStrings::getInstance())
+        invalidate();
+}
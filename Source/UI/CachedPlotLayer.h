@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "../Localization/LocalizedStrings.h"
+#include <functional>
+
+/**
+ * CachedPlotLayer
+ * 
+ * Static layer (background, grid, axes, labels) of a plot, rendered once into a
+ * juce::Image and blitted on every paint, so a timer tick only has to draw the
+ * live trace on top.
+ * 
+ * The image is re-rendered when:
+ * - the layer size or the display scale changes (resize, moving to another screen)
+ * - the language changes (labels), detected here automatically
+ * - the owner calls invalidate() (e.g. from lookAndFeelChanged() for theme changes,
+ *   or when an axis range changes)
+ * 
+ * Rendered at physical pixel resolution, so it stays sharp on HiDPI/4K displays.
+ */
+class CachedPlotLayer : private juce::ChangeListener
+{
+public:
+    // Draws the static content in layer-local coordinates (0, 0, width, height)
+    using Renderer = std::function<void(juce::Graphics&, juce::Rectangle<int>)>;
+    
+    explicit CachedPlotLayer(Renderer renderer);
+    ~CachedPlotLayer() override;
+    
+    // Re-render on the next draw()
+    void invalidate() { valid = false; }
+    
+    // Blits the layer into area, re-rendering it first if needed
+    void draw(juce::Graphics& g, juce::Rectangle<int> area);
+    
+    // The layer image for area at the given physical pixel scale, re-rendered first if needed
+    // (for renderers that blit it themselves, e.g. GLPlotRenderer)
+    const juce::Image& getImage(juce::Rectangle<int> area, float scale);
+    
+    // Incremented on every re-render, so external copies of the image know when to refresh
+    uint64_t getVersion() const { return version; }
+    
+private:
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+    
+    Renderer renderStaticLayer;
+    juce::Image image;
+    juce::Rectangle<int> imageArea;
+    float imageScale{0.0f};
+    uint64_t version{0};
+    bool valid{false};
+    
+    JUCE_DECLARE_NON_COPYABLE(CachedPlotLayer)
+};
@@ -23,21 +23,109 @@ ChannelMeterComponent::ChannelMeterComponent(DeviceStateModel& stateModel, bool
     }
     
     stateModel.addChangeListener(this);
-    // Timer will be started/stopped based on device availability
-    updateTimerState();
+    
+    // ~30 FPS at most, when the audio thread delivered new levels, and on every frame while
+    // a peak hold is still up or falling (it must keep moving after the audio stops)
+    FrameScheduler::getInstance().addClient(*this,
+                                            {[this] { return this->stateModel.getLevelGeneration(); },
+                                             [this] { return hasActivePeakHold() ? static_cast<uint64_t>(juce::Time::getMillisecondCounter()) : 0; }},
+                                            [this] { refreshMeters(); }, 30);
+    
+    glRenderer.onFallback = [this] { repaint(); };
+    glRenderer.attachTo(*this);
 }
 
 ChannelMeterComponent::~ChannelMeterComponent()
 {
-    stopTimer();
+    glRenderer.detach();
+    FrameScheduler::getInstance().removeClient(*this);
     stateModel.removeChangeListener(this);
 }
 
 void ChannelMeterComponent::paint(juce::Graphics& g)
+{
+    // Always check stateModel directly to get latest count
+    int currentChannelCount = isInputChannel 
+        ? stateModel.getNumInputChannels() 
+        : stateModel.getNumOutputChannels();
+    
+    // Update numChannels if it changed (the meter grid in the static layer changes with it)
+    if (currentChannelCount != numChannels)
+    {
+        numChannels = currentChannelCount;
+        staticLayer.invalidate();
+    }
+    
+    if (glRenderer.isActive())
+    {
+        paintWithOpenGL();
+        return;
+    }
+    
+    RenderStats::ScopedFrame frame(glRenderer.getStats(), RenderStats::Path::software);
+    
+    // Background, title, meter tracks, scale and channel labels come from the cached image
+    staticLayer.draw(g, getLocalBounds());
+    
+    forEachMeter([this, &g](int channelIndex, juce::Rectangle<int> meterBounds)
+    {
+        if (channelIndex >= static_cast<int>(meterStates.size()))
+            return;
+        
+        const auto& meterState = meterStates[channelIndex];
+        
+        // RMS level - vertical bar from BOTTOM to TOP
+        g.setColour(getRmsColour(meterState.rmsDb));
+        g.fillRect(getRmsArea(meterState, meterBounds));
+        
+        // Peak hold - horizontal line across the bar (white line)
+        if (meterState.peakHoldDb > minDb)
+        {
+            float peakY = dbToYPosition(meterState.peakHoldDb, meterBarHeight);
+            g.setColour(AudioCoPilot::DesignSystem::Colours::getColour(AudioCoPilot::DesignSystem::Colours::Meter::PeakHold));
+            g.drawHorizontalLine(meterBounds.getY() + peakY, meterBounds.getX(), meterBounds.getRight());
+        }
+    });
+}
+
+void ChannelMeterComponent::paintWithOpenGL()
 {
     using namespace AudioCoPilot::DesignSystem;
     
-    auto bounds = getLocalBounds();
+    // Same layers as the software path, described to the GL renderer instead of painted
+    RenderStats::ScopedFrame frame(glRenderer.getStats(), RenderStats::Path::openGL, true);
+    
+    const auto bounds = getLocalBounds();
+    glRenderer.setBackground(staticLayer.getImage(bounds, glRenderer.getRenderingScale()), bounds,
+                             staticLayer.getVersion());
+    
+    glScene.clear();
+    const auto peakHoldColour = Colours::getColour(Colours::Meter::PeakHold);
+    
+    forEachMeter([this, &peakHoldColour](int channelIndex, juce::Rectangle<int> meterBounds)
+    {
+        if (channelIndex >= static_cast<int>(meterStates.size()))
+            return;
+        
+        const auto& meterState = meterStates[channelIndex];
+        glScene.addRect(getRmsArea(meterState, meterBounds), getRmsColour(meterState.rmsDb));
+        
+        if (meterState.peakHoldDb > minDb)
+        {
+            float peakY = std::floor(dbToYPosition(meterState.peakHoldDb, meterBarHeight));
+            glScene.addRect(juce::Rectangle<float>(static_cast<float>(meterBounds.getX()),
+                                                   static_cast<float>(meterBounds.getY()) + peakY,
+                                                   static_cast<float>(meterBounds.getWidth()), 1.0f),
+                            peakHoldColour);
+        }
+    });
+    
+    glRenderer.setScene(glScene, bounds);
+}
+
+void ChannelMeterComponent::drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    using namespace AudioCoPilot::DesignSystem;
     
     // Background
     g.setColour(Colours::getColour(Colours::Surface::Panel));
@@ -48,24 +136,9 @@ void ChannelMeterComponent::paint(juce::Graphics& g)
     g.setFont(Typography::labelLarge());
     auto& strings = LocalizedStrings::getInstance();
     juce::String title = isInputChannel ? strings.getInputChannels() : strings.getOutputChannels();
-    const int titleHeight = 20;
     g.drawText(title, bounds.removeFromTop(titleHeight), juce::Justification::centred);
     
-    // Calculate channels to draw (up to 64)
-    // Always check stateModel directly to get latest count
-    int currentChannelCount = isInputChannel 
-        ? stateModel.getNumInputChannels() 
-        : stateModel.getNumOutputChannels();
-    
-    int channelsToDraw = (currentChannelCount > 0) ? juce::jmin(currentChannelCount, 64) : 0;
-    
-    // Update numChannels if it changed
-    if (currentChannelCount != numChannels)
-    {
-        numChannels = currentChannelCount;
-    }
-    
-    if (channelsToDraw == 0)
+    if (juce::jmin(numChannels, 64) <= 0)
     {
         // Show placeholder message
         g.setColour(Colours::getColour(Colours::Text::Tertiary));
@@ -74,96 +147,77 @@ void ChannelMeterComponent::paint(juce::Graphics& g)
         return;
     }
     
-    // GRID LAYOUT: Vertical meters in grid (max 16 per row)
-    int currentY = titleHeight + 5;  // Start below title
-    
-    // Calculate number of rows needed (max 16 meters per row)
-    const int numRows = (channelsToDraw + maxMetersPerRow - 1) / maxMetersPerRow;  // Ceiling division
+    g.setFont(labelFont);
     
-    // Calculate meter cell dimensions
-    const int availableWidth = bounds.getWidth() - 20;  // Padding on sides
-    const int cellWidth = (availableWidth - (maxMetersPerRow - 1) * horizontalSpacing) / maxMetersPerRow;
-    const int meterXOffset = (cellWidth - meterBarWidth) / 2;  // Center meter in cell
-    
-    for (int row = 0; row < numRows; ++row)
+    forEachMeter([this, &g](int channelIndex, juce::Rectangle<int> meterBounds)
     {
-        const int rowY = currentY;
-        const int metersInThisRow = juce::jmin(maxMetersPerRow, channelsToDraw - row * maxMetersPerRow);
+        // Meter background (vertical bar)
+        g.setColour(Colours::getColour(Colours::Surface::MeterBackground));
+        g.fillRect(meterBounds);
         
-        for (int col = 0; col < metersInThisRow; ++col)
+        // Meter scale (dB marks) - horizontal lines across the bar
+        g.setColour(Colours::getColour(Colours::Text::Tertiary));
+        for (float db = -60.0f; db <= 0.0f; db += 20.0f)
         {
-            const int channelIndex = row * maxMetersPerRow + col;
-            
-            if (channelIndex >= channelsToDraw)
-                break;
-            
-            const int cellX = 10 + col * (cellWidth + horizontalSpacing);
-            const int meterX = cellX + meterXOffset;
-            
-            // Vertical meter bar (from bottom to top)
-            const int meterY = rowY;
-            
-            // Meter background (vertical bar)
-            g.setColour(Colours::getColour(Colours::Surface::MeterBackground));
-            g.fillRect(meterX, meterY, meterBarWidth, meterBarHeight);
-            
-            // Meter scale (dB marks) - horizontal lines across the bar
-            g.setColour(Colours::getColour(Colours::Text::Tertiary));
-            for (float db = -60.0f; db <= 0.0f; db += 20.0f)
-            {
-                float y = dbToYPosition(db, meterBarHeight);
-                g.drawHorizontalLine(meterY + y, meterX, meterX + meterBarWidth);
-            }
-            
-            // RMS level - vertical bar from BOTTOM to TOP
-            if (channelIndex < static_cast<int>(meterStates.size()))
-            {
-                auto& meterState = meterStates[channelIndex];
-                float rmsY = dbToYPosition(meterState.rmsDb, meterBarHeight);
-                
-                // Draw RMS level from bottom (min) to current level (top)
-                juce::Rectangle<float> rmsRect(
-                    static_cast<float>(meterX),
-                    static_cast<float>(meterY + rmsY),  // Start from RMS level
-                    static_cast<float>(meterBarWidth),
-                    static_cast<float>(meterBarHeight - rmsY)  // Height from RMS to top
-                );
-                
-                // Color gradient: green -> yellow -> orange -> red (bottom to top)
-                juce::Colour rmsColour;
-                if (meterState.rmsDb > -6.0f)
-                    rmsColour = Colours::getColour(Colours::Meter::Red);
-                else if (meterState.rmsDb > -18.0f)
-                    rmsColour = Colours::getColour(Colours::Meter::Amber);
-                else if (meterState.rmsDb > -30.0f)
-                    rmsColour = Colours::getColour(Colours::Meter::Yellow);
-                else
-                    rmsColour = Colours::getColour(Colours::Meter::Green);
-                
-                g.setColour(rmsColour);
-                g.fillRect(rmsRect);
-                
-                // Peak hold - horizontal line across the bar (white line)
-                if (meterState.peakHoldDb > minDb)
-                {
-                    float peakY = dbToYPosition(meterState.peakHoldDb, meterBarHeight);
-                    g.setColour(Colours::getColour(Colours::Meter::PeakHold));
-                    g.drawHorizontalLine(meterY + peakY, meterX, meterX + meterBarWidth);
-                }
-            }
-            
-            // Channel number label BELOW the meter
-            g.setColour(Colours::getColour(Colours::Text::Secondary));
-            g.setFont(labelFont);
-            juce::String label = juce::String(channelIndex + 1);
-            g.drawText(label, cellX, rowY + meterBarHeight + 2, cellWidth, labelHeight, juce::Justification::centred);
+            float y = dbToYPosition(db, meterBarHeight);
+            g.drawHorizontalLine(meterBounds.getY() + y, meterBounds.getX(), meterBounds.getRight());
         }
         
-        // Move to next row
-        currentY += meterBarHeight + labelHeight + verticalSpacing;
+        // Channel number label BELOW the meter (centred in the grid cell)
+        const int cellWidth = getCellWidth();
+        const int cellX = meterBounds.getCentreX() - cellWidth / 2;
+        g.setColour(Colours::getColour(Colours::Text::Secondary));
+        g.drawText(juce::String(channelIndex + 1), cellX, meterBounds.getBottom() + 2, cellWidth, labelHeight,
+                   juce::Justification::centred);
+    });
+}
+
+int ChannelMeterComponent::getCellWidth() const
+{
+    const int availableWidth = getWidth() - 20;  // Padding on sides
+    return (availableWidth - (maxMetersPerRow - 1) * horizontalSpacing) / maxMetersPerRow;
+}
+
+void ChannelMeterComponent::forEachMeter(const std::function<void(int, juce::Rectangle<int>)>& visit) const
+{
+    // GRID LAYOUT: Vertical meters in grid (max 16 per row)
+    const int channelsToDraw = juce::jlimit(0, 64, numChannels);
+    const int cellWidth = getCellWidth();
+    const int meterXOffset = (cellWidth - meterBarWidth) / 2;  // Center meter in cell
+    
+    for (int channelIndex = 0; channelIndex < channelsToDraw; ++channelIndex)
+    {
+        const int row = channelIndex / maxMetersPerRow;
+        const int col = channelIndex % maxMetersPerRow;
+        
+        const int cellX = 10 + col * (cellWidth + horizontalSpacing);
+        const int rowY = titleHeight + 5 + row * (meterBarHeight + labelHeight + verticalSpacing);
+        
+        visit(channelIndex, { cellX + meterXOffset, rowY, meterBarWidth, meterBarHeight });
     }
 }
 
+juce::Rectangle<float> ChannelMeterComponent::getRmsArea(const MeterState& meterState, juce::Rectangle<int> meterBounds) const
+{
+    // From the RMS level down to the bottom of the bar
+    float rmsY = dbToYPosition(meterState.rmsDb, meterBarHeight);
+    return meterBounds.toFloat().withTrimmedTop(rmsY);
+}
+
+juce::Colour ChannelMeterComponent::getRmsColour(float rmsDb) const
+{
+    using namespace AudioCoPilot::DesignSystem;
+    
+    // Color gradient: green -> yellow -> orange -> red (bottom to top)
+    if (rmsDb > -6.0f)
+        return Colours::getColour(Colours::Meter::Red);
+    if (rmsDb > -18.0f)
+        return Colours::getColour(Colours::Meter::Amber);
+    if (rmsDb > -30.0f)
+        return Colours::getColour(Colours::Meter::Yellow);
+    return Colours::getColour(Colours::Meter::Green);
+}
+
 void ChannelMeterComponent::resized()
 {
     // Always recalculate height based on current channel count
@@ -185,7 +239,6 @@ int ChannelMeterComponent::getRequiredWidth() const
 
 int ChannelMeterComponent::getRequiredHeight() const
 {
-    const int titleHeight = 20;
     const int padding = 10;
     
     // Calculate height based on grid layout (max 16 meters per row)
@@ -200,37 +253,30 @@ int ChannelMeterComponent::getRequiredHeight() const
     return titleHeight + (numRows * (meterBarHeight + labelHeight + verticalSpacing)) + padding;
 }
 
-void ChannelMeterComponent::timerCallback()
+void ChannelMeterComponent::refreshMeters()
 {
-    // Only update if we have channels and device is active
+    // Nothing to show without channels
     if (numChannels == 0)
-    {
-        stopTimer();
         return;
-    }
     
     updateMeterLevels();
     
     // Throttle repaint: only repaint if levels actually changed
-    static float lastRMS[64] = {0};
-    static float lastPeak[64] = {0};
     bool needsRepaint = false;
     
-    for (int i = 0; i < numChannels && i < 64; ++i)
+    for (int i = 0; i < numChannels && i < static_cast<int>(meterStates.size()); ++i)
     {
-        if (i < static_cast<int>(meterStates.size()))
+        auto& state = meterStates[i];
+        
+        // Only repaint if change is significant (>0.5dB)
+        if (std::abs(state.rmsDb - state.drawnRmsDb) > 0.5f ||
+            std::abs(state.peakDb - state.drawnPeakDb) > 0.5f ||
+            std::abs(state.peakHoldDb - state.drawnPeakHoldDb) > 0.5f)
         {
-            float currentRMS = meterStates[i].rmsDb;
-            float currentPeak = meterStates[i].peakDb;
-            
-            // Only repaint if change is significant (>0.5dB)
-            if (std::abs(currentRMS - lastRMS[i]) > 0.5f || 
-                std::abs(currentPeak - lastPeak[i]) > 0.5f)
-            {
-                needsRepaint = true;
-                lastRMS[i] = currentRMS;
-                lastPeak[i] = currentPeak;
-            }
+            needsRepaint = true;
+            state.drawnRmsDb = state.rmsDb;
+            state.drawnPeakDb = state.peakDb;
+            state.drawnPeakHoldDb = state.peakHoldDb;
         }
     }
     
@@ -266,12 +312,12 @@ void ChannelMeterComponent::changeListenerCallback(juce::ChangeBroadcaster* sour
                 state.peakDb = minDb;
                 state.peakHoldDb = minDb;
                 state.peakHoldTime = 0.0;
+                state.drawnRmsDb = minDb;
+                state.drawnPeakDb = minDb;
+                state.drawnPeakHoldDb = minDb;
             }
         }
         
-        // Update timer state based on channel availability
-        updateTimerState();
-        
         // CRITICAL: Recalculate and resize component to fit all channels
         int requiredHeight = getRequiredHeight();
         int currentWidth = getWidth();
@@ -283,7 +329,8 @@ void ChannelMeterComponent::changeListenerCallback(juce::ChangeBroadcaster* sour
         // Resize component to fit all channels
         setSize(currentWidth > 0 ? currentWidth : 200, requiredHeight);
         
-        // Repaint when channel count changes
+        // Repaint when channel count changes (grid and labels live in the static layer)
+        staticLayer.invalidate();
         repaint();
         
         // Notify parent to recalculate size
@@ -337,9 +384,23 @@ void ChannelMeterComponent::updateMeterLevels()
         }
         else if (currentTime - meterState.peakHoldTime > meterHoldTime)
         {
-            meterState.peakHoldDb = meterState.peakDb;
+            // Falls from the end of the hold time (or the last update) down to the current peak
+            const double decayStart = juce::jmax(meterState.peakHoldTime + meterHoldTime, lastLevelUpdateTime);
+            const float decayDb = peakHoldDecayDbPerSecond * static_cast<float>(currentTime - decayStart);
+            meterState.peakHoldDb = juce::jmax(meterState.peakDb, meterState.peakHoldDb - decayDb);
         }
     }
+    
+    lastLevelUpdateTime = currentTime;
+}
+
+bool ChannelMeterComponent::hasActivePeakHold() const
+{
+    for (int i = 0; i < numChannels && i < static_cast<int>(meterStates.size()); ++i)
+        if (meterStates[i].peakHoldDb > meterStates[i].peakDb)
+            return true;
+    
+    return false;
 }
 
 float ChannelMeterComponent::levelToDb(float level) const
@@ -362,18 +423,3 @@ float ChannelMeterComponent::dbToXPosition(float db, float width) const
     float normalized = (db - minDb) / (maxDb - minDb);
     return width * normalized;  // Left to right: 0dB at right, -60dB at left
 }
-
-void ChannelMeterComponent::updateTimerState()
-{
-    // Only run timer if we have active channels
-    if (numChannels > 0)
-    {
-        if (!isTimerRunning())
-            startTimer(30); // ~30 FPS update rate
-    }
-    else
-    {
-        if (isTimerRunning())
-            stopTimer();
-    }
-}
@@ -4,6 +4,10 @@
 #include "../Core/DeviceStateModel.h"
 #include "../Localization/LocalizedStrings.h"
 #include "DesignSystem/DesignSystem.h"
+#include "FrameScheduler.h"
+#include "CachedPlotLayer.h"
+#include "GLPlotRenderer.h"
+#include <functional>
 
 /**
  * ChannelMeterComponent
@@ -12,7 +16,6 @@
  * Compact design for header area.
  */
 class ChannelMeterComponent : public juce::Component,
-                              public juce::Timer,
                               public juce::ChangeListener
 {
 public:
@@ -22,7 +25,6 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
     
-    void timerCallback() override;
     void changeListenerCallback(juce::ChangeBroadcaster* source) override;
     
     // Calculate required dimensions based on number of channels
@@ -30,8 +32,21 @@ public:
     int getRequiredHeight() const;
     
 private:
+    struct MeterState;
+    
+    void refreshMeters();  // FrameScheduler frame: new levels arrived, or a peak hold is still falling
     void updateMeterLevels();
-    void updateTimerState(); // Start/stop timer based on device availability
+    bool hasActivePeakHold() const;
+    void paintWithOpenGL();
+    
+    // Background, title, meter tracks, dB marks and channel labels (only change with layout/language)
+    void drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds);
+    
+    // Calls visit(channelIndex, meter bar bounds) for every meter in the grid
+    void forEachMeter(const std::function<void(int, juce::Rectangle<int>)>& visit) const;
+    int getCellWidth() const;
+    juce::Rectangle<float> getRmsArea(const MeterState& meterState, juce::Rectangle<int> meterBounds) const;
+    juce::Colour getRmsColour(float rmsDb) const;
     float levelToDb(float level) const;
     float dbToYPosition(float db, float height) const;  // For vertical meters (legacy)
     float dbToXPosition(float db, float width) const;   // For horizontal meters
@@ -42,6 +57,8 @@ private:
     static constexpr float minDb = -60.0f;
     static constexpr float maxDb = 0.0f;
     static constexpr float meterHoldTime = 0.3f; // seconds
+    static constexpr float peakHoldDecayDbPerSecond = 20.0f;  // after the hold time
+    static constexpr int titleHeight = 20;
     
     struct MeterState
     {
@@ -49,9 +66,15 @@ private:
         float peakDb{-60.0f};
         float peakHoldDb{-60.0f};
         double peakHoldTime{0.0};
+        
+        // Levels at the last repaint, to skip repaints for changes nobody can see
+        float drawnRmsDb{-60.0f};
+        float drawnPeakDb{-60.0f};
+        float drawnPeakHoldDb{-60.0f};
     };
     
     std::vector<MeterState> meterStates;
+    double lastLevelUpdateTime{0.0};
     int numChannels{0};
     
     // Layout constants for vertical meters in grid layout
@@ -63,4 +86,10 @@ private:
     static constexpr int verticalSpacing = 6;  // Vertical spacing between rows (meter + label)
     
     juce::Font labelFont;
+    
+    CachedPlotLayer staticLayer{[this](juce::Graphics& g, juce::Rectangle<int> bounds) { drawStaticLayer(g, bounds); }};
+    
+    // Optional OpenGL path for the level bars (software painting whenever it is not active)
+    GLPlotRenderer glRenderer{isInputChannel ? "InputMeters" : "OutputMeters"};
+    GLPlotRenderer::Scene glScene;
 };
@@ -0,0 +1,197 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+
+FrameScheduler& FrameScheduler::getInstance()
+{
+    static FrameScheduler instance;
+    return instance;
+}
+
+FrameScheduler::~FrameScheduler()
+{
+    stopTimer();
+}
+
+void FrameScheduler::addClient(juce::Component& component, std::vector<GenerationSource> sources,
+                               FrameCallback onFrame, int clientMaxFps)
+{
+    removeClient(component);
+
+    Client client;
+    client.component = &component;
+    client.sources = std::move(sources);
+    client.onFrame = std::move(onFrame);
+    client.minIntervalMs = clientMaxFps > 0 ? 1000.0 / static_cast<double>(clientMaxFps) : 0.0;
+
+    // Start one step behind every source, so the first frame always refreshes the view
+    client.lastSeen.reserve(client.sources.size());
+    for (const auto& source : client.sources)
+        client.lastSeen.push_back(source() - 1);
+
+    clients.push_back(std::move(client));
+    updateClock();
+}
+
+void FrameScheduler::removeClient(juce::Component& component)
+{
+    for (auto& client : clients)
+        if (client.component == &component)
+            client.component = nullptr;
+
+    // While dispatching, the frame loop compacts the list when it is done
+    if (!dispatching)
+    {
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const Client& c) { return c.component == nullptr; }),
+                      clients.end());
+        updateClock();
+    }
+}
+
+void FrameScheduler::attachTo(juce::Component* component)
+{
+    vblankAttachment.reset();
+
+    if (component != nullptr)
+        vblankAttachment = std::make_unique<juce::VBlankAttachment>(component, [this] { onVBlank(); });
+
+    updateClock();
+}
+
+void FrameScheduler::setMaxFps(int fps)
+{
+    maxFps = juce::jlimit(minFps, 240, fps);
+    effectiveFps = maxFps;
+    slowFrames = 0;
+    onTimeFrames = 0;
+    updateClock();
+}
+
+void FrameScheduler::addPaintTime(double milliseconds)
+{
+    paintMicroseconds.fetch_add(static_cast<juce::int64>(milliseconds * 1000.0), std::memory_order_relaxed);
+}
+
+void FrameScheduler::timerCallback()
+{
+    dispatchFrame(juce::Time::getMillisecondCounterHiRes());
+}
+
+void FrameScheduler::onVBlank()
+{
+    if (clients.empty())
+        return;
+
+    // The display may refresh faster than the cap: skip vblanks until a frame is due
+    // (small tolerance so 60 Hz on a 60 Hz display never drops to every other vblank)
+    const double nowMs = juce::Time::getMillisecondCounterHiRes();
+    if (nowMs - lastFrameMs < getFrameIntervalMs() * 0.9)
+        return;
+
+    dispatchFrame(nowMs);
+}
+
+void FrameScheduler::dispatchFrame(double nowMs)
+{
+    const double frameIntervalMs = lastFrameMs > 0.0 ? nowMs - lastFrameMs : getFrameIntervalMs();
+    lastFrameMs = nowMs;
+
+    dispatching = true;
+
+    // Index loop: callbacks may add clients (reallocating the vector) or remove them
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        auto* component = clients[i].component;
+        if (component == nullptr || !component->isShowing())
+            continue;
+
+        if (clients[i].minIntervalMs > 0.0 && nowMs - clients[i].lastFrameMs < clients[i].minIntervalMs * 0.9)
+            continue;
+
+        bool advanced = false;
+        for (size_t s = 0; s < clients[i].sources.size(); ++s)
+        {
+            const uint64_t generation = clients[i].sources[s]();
+            if (generation != clients[i].lastSeen[s])
+            {
+                clients[i].lastSeen[s] = generation;
+                advanced = true;
+            }
+        }
+
+        if (!advanced)
+            continue;
+
+        clients[i].lastFrameMs = nowMs;
+
+        if (clients[i].onFrame != nullptr)
+        {
+            auto onFrame = clients[i].onFrame;
+            onFrame();
+        }
+        else
+        {
+            component->repaint();
+        }
+    }
+
+    dispatching = false;
+
+    clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                 [](const Client& c) { return c.component == nullptr; }),
+                  clients.end());
+
+    // The views painted what the previous frame asked for since then; this frame's repaints
+    // are counted on the next one
+    const double paintMs = static_cast<double>(paintMicroseconds.exchange(0, std::memory_order_relaxed)) / 1000.0;
+    const double dispatchMs = juce::Time::getMillisecondCounterHiRes() - nowMs;
+
+    updateThrottle(frameIntervalMs, dispatchMs + paintMs);
+    updateClock();
+}
+
+void FrameScheduler::updateThrottle(double frameIntervalMs, double workMs)
+{
+    const double budgetMs = getFrameIntervalMs();
+
+    // Late frame (message thread busy elsewhere) or views eating most of the frame budget
+    const bool slow = frameIntervalMs > budgetMs * 2.0 || workMs > budgetMs * 0.5;
+
+    if (slow)
+    {
+        onTimeFrames = 0;
+        if (++slowFrames >= slowFramesBeforeThrottle)
+        {
+            slowFrames = 0;
+            effectiveFps = juce::jmax(juce::jmin(throttleFloorFps, maxFps), effectiveFps * 3 / 4);
+        }
+    }
+    else
+    {
+        slowFrames = 0;
+        if (effectiveFps < maxFps && ++onTimeFrames >= onTimeFramesBeforeRecovery)
+        {
+            onTimeFrames = 0;
+            effectiveFps = juce::jmin(maxFps, effectiveFps + recoveryStepFps);
+        }
+    }
+}
+
+void FrameScheduler::updateClock()
+{
+    // The vblank attachment drives frames when present; the timer is only the fallback
+    const bool needsTimer = !clients.empty() && vblankAttachment == nullptr;
+
+    if (clients.empty())
+        lastFrameMs = 0.0;
+
+    if (!needsTimer)
+    {
+        stopTimer();
+        return;
+    }
+
+    const int intervalMs = juce::roundToInt(getFrameIntervalMs());
+    if (!isTimerRunning() || getTimerInterval() != intervalMs)
+        startTimer(intervalMs);
+}
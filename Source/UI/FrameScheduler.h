@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * FrameScheduler
+ *
+ * One UI clock for every live view, instead of one juce::Timer per component.
+ *
+ * - Analysis modules publish a monotonically increasing generation per result
+ *   (TFProcessor::getOutputGeneration(), RTAController::getGeneration(), ...)
+ * - Views register the generations they depend on; on each frame a view is
+ *   refreshed (onFrame, or repaint() by default) only if one of them advanced
+ *   and the view is actually showing
+ * - Frames follow the display refresh once attachTo() is given the main content
+ *   component (VBlankAttachment), otherwise a plain timer at the FPS cap
+ * - Global FPS cap (setMaxFps) plus an automatic throttle: when frames arrive
+ *   late or dispatching plus the views' painting eats most of the frame budget,
+ *   the effective rate steps down, and climbs back once the message thread keeps
+ *   up again. repaint() only queues the paint, so the paint time is reported by
+ *   the views themselves (RenderStats::ScopedFrame, or ScopedPaintTimer)
+ *
+ * Message thread only.
+ */
+class FrameScheduler : private juce::Timer
+{
+public:
+    using GenerationSource = std::function<uint64_t()>;
+    using FrameCallback = std::function<void()>;
+
+    static FrameScheduler& getInstance();
+
+    // Register a view. onFrame defaults to component.repaint(); maxFps (0 = global cap)
+    // lowers the rate for this view only. Views must call removeClient() before destruction.
+    void addClient(juce::Component& component, std::vector<GenerationSource> sources,
+                   FrameCallback onFrame = nullptr, int maxFps = 0);
+    void removeClient(juce::Component& component);
+
+    // Drive frames from the display refresh of this component's peer (nullptr = timer only)
+    void attachTo(juce::Component* component);
+
+    // Global cap, 10..240 fps
+    void setMaxFps(int fps);
+    int getMaxFps() const { return maxFps; }
+
+    // Current rate after throttling (<= getMaxFps())
+    int getEffectiveFps() const { return effectiveFps; }
+
+    // Time a view spent painting on (or holding) the message thread. Any thread: OpenGL
+    // views paint on the GL thread under the message manager lock
+    void addPaintTime(double milliseconds);
+
+    // Reports the time from construction to destruction with addPaintTime(); for views
+    // whose paint() is not already timed by RenderStats::ScopedFrame
+    class ScopedPaintTimer
+    {
+    public:
+        ScopedPaintTimer() : start(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedPaintTimer()
+        {
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+            getInstance().addPaintTime(juce::Time::highResolutionTicksToSeconds(elapsed) * 1000.0);
+        }
+
+    private:
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedPaintTimer)
+    };
+
+private:
+    FrameScheduler() = default;
+    ~FrameScheduler() override;
+
+    struct Client
+    {
+        juce::Component* component{nullptr};
+        std::vector<GenerationSource> sources;
+        std::vector<uint64_t> lastSeen;
+        FrameCallback onFrame;
+        double minIntervalMs{0.0};
+        double lastFrameMs{0.0};
+    };
+
+    void timerCallback() override;
+    void onVBlank();
+    void dispatchFrame(double nowMs);
+    void updateThrottle(double frameIntervalMs, double workMs);
+    void updateClock();
+    double getFrameIntervalMs() const { return 1000.0 / static_cast<double>(effectiveFps); }
+
+    std::vector<Client> clients;
+    bool dispatching{false};
+
+    std::unique_ptr<juce::VBlankAttachment> vblankAttachment;
+
+    int maxFps{60};
+    int effectiveFps{60};
+    double lastFrameMs{0.0};
+    int slowFrames{0};
+    int onTimeFrames{0};
+
+    // Paint time reported since the last frame (the paints its repaint() calls caused)
+    std::atomic<juce::int64> paintMicroseconds{0};
+
+    static constexpr int minFps = 10;
+    static constexpr int throttleFloorFps = 15;
+    static constexpr int slowFramesBeforeThrottle = 3;   // consecutive late/heavy frames
+    static constexpr int onTimeFramesBeforeRecovery = 60;
+    static constexpr int recoveryStepFps = 5;
+
+    JUCE_DECLARE_NON_COPYABLE(FrameScheduler)
+};
@@ -0,0 +1,513 @@
+#include "GLPlotRenderer.h"
+#include <atomic>
+#include <cstddef>
+
+//==============================================================================
+void GLPlotRenderer::Scene::beginLineStrip(juce::Colour colour, float lineWidth, bool coherenceShading)
+{
+    Batch batch;
+    batch.primitive = Primitive::lineStrip;
+    batch.firstVertex = static_cast<int>(vertices.size());
+    batch.lineWidth = lineWidth;
+    batch.coherenceShading = coherenceShading;
+    batches.push_back(batch);
+    vertexColour = colour;
+}
+
+void GLPlotRenderer::Scene::addPoint(float x, float y, float coherence)
+{
+    jassert(!batches.empty() && batches.back().primitive == Primitive::lineStrip);  // call beginLineStrip() first
+    if (batches.empty() || batches.back().primitive != Primitive::lineStrip)
+        return;
+
+    vertices.push_back(makeVertex(x, y, coherence));
+    ++batches.back().numVertices;
+}
+
+void GLPlotRenderer::Scene::addLine(juce::Point<float> start, juce::Point<float> end, juce::Colour colour, float lineWidth)
+{
+    vertexColour = colour;
+    auto& batch = getBatch(Primitive::lines, lineWidth, false);
+    vertices.push_back(makeVertex(start.x, start.y, 1.0f));
+    vertices.push_back(makeVertex(end.x, end.y, 1.0f));
+    batch.numVertices += 2;
+}
+
+void GLPlotRenderer::Scene::addRect(juce::Rectangle<float> area, juce::Colour colour)
+{
+    if (area.isEmpty())
+        return;
+
+    vertexColour = colour;
+    auto& batch = getBatch(Primitive::triangles, 1.0f, false);
+
+    const float left = area.getX();
+    const float top = area.getY();
+    const float right = area.getRight();
+    const float bottom = area.getBottom();
+
+    vertices.push_back(makeVertex(left, top, 1.0f));
+    vertices.push_back(makeVertex(right, top, 1.0f));
+    vertices.push_back(makeVertex(left, bottom, 1.0f));
+    vertices.push_back(makeVertex(right, top, 1.0f));
+    vertices.push_back(makeVertex(right, bottom, 1.0f));
+    vertices.push_back(makeVertex(left, bottom, 1.0f));
+    batch.numVertices += 6;
+}
+
+GLPlotRenderer::Batch& GLPlotRenderer::Scene::getBatch(Primitive primitive, float lineWidth, bool coherenceShading)
+{
+    // Line strips can't be merged; everything else shares the previous batch if the state matches
+    if (!batches.empty())
+    {
+        auto& last = batches.back();
+        if (primitive != Primitive::lineStrip && last.primitive == primitive
+            && last.lineWidth == lineWidth && last.coherenceShading == coherenceShading)
+            return last;
+    }
+
+    Batch batch;
+    batch.primitive = primitive;
+    batch.firstVertex = static_cast<int>(vertices.size());
+    batch.lineWidth = lineWidth;
+    batch.coherenceShading = coherenceShading;
+    batches.push_back(batch);
+    return batches.back();
+}
+
+GLPlotRenderer::Vertex GLPlotRenderer::Scene::makeVertex(float x, float y, float coherence) const
+{
+    Vertex vertex;
+    vertex.x = x;
+    vertex.y = y;
+    vertex.r = vertexColour.getFloatRed();
+    vertex.g = vertexColour.getFloatGreen();
+    vertex.b = vertexColour.getFloatBlue();
+    vertex.a = vertexColour.getFloatAlpha();
+    vertex.coherence = coherence;
+    return vertex;
+}
+
+//==============================================================================
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+
+namespace
+{
+    // Positions arrive in logical pixels (top-left origin) and are mapped to clip space here
+    const char* const vertexShaderSource =
+        "attribute vec2 position;\n"
+        "attribute vec4 colour;\n"
+        "attribute float coherence;\n"
+        "uniform vec2 viewportSize;\n"
+        "uniform float coherenceShading;\n"
+        "varying vec4 fragmentColour;\n"
+        "varying float fragmentCoherence;\n"
+        "void main()\n"
+        "{\n"
+        "    // Smaart-style alpha: clamp((coh - 0.5) / 0.5, 0, 1), drawn at 0.5 .. 1.0\n"
+        "    fragmentCoherence = mix(1.0, clamp((coherence - 0.5) / 0.5, 0.0, 1.0), coherenceShading);\n"
+        "    fragmentColour = vec4(colour.rgb, colour.a * mix(1.0, 0.5 + 0.5 * fragmentCoherence, coherenceShading));\n"
+        "    vec2 clip = position / viewportSize * 2.0 - 1.0;\n"
+        "    gl_Position = vec4(clip.x, -clip.y, 0.0, 1.0);\n"
+        "}\n";
+
+    const char* const fragmentShaderSource =
+        "varying " JUCE_MEDIUMP " vec4 fragmentColour;\n"
+        "varying " JUCE_MEDIUMP " float fragmentCoherence;\n"
+        "uniform " JUCE_MEDIUMP " float minAlpha;\n"
+        "void main()\n"
+        "{\n"
+        "    if (fragmentCoherence < minAlpha)\n"
+        "        discard;\n"
+        "    gl_FragColor = fragmentColour;\n"
+        "}\n";
+}
+
+struct GLPlotRenderer::Pimpl : private juce::OpenGLRenderer,
+                               private juce::Timer
+{
+    explicit Pimpl(GLPlotRenderer& o) : owner(o) {}
+
+    ~Pimpl() override
+    {
+        detach();
+    }
+
+    void attachTo(juce::Component& component)
+    {
+        if (hasFallenBack)
+            return;
+
+        detach();
+
+        target = &component;
+        context.setRenderer(this);
+        context.setComponentPaintingEnabled(true);
+        context.setContinuousRepainting(false);
+        context.attachTo(component);
+
+        waitedWhileShowingMs = 0;
+        startTimer(watchdogIntervalMs);
+    }
+
+    void detach()
+    {
+        stopTimer();
+
+        // Blocks until the GL thread has called openGLContextClosing()
+        if (context.isAttached())
+            context.detach();
+
+        context.setRenderer(nullptr);
+        target = nullptr;
+        ready = false;
+    }
+
+    bool isActive() const { return ready.load() && !failed.load(); }
+
+    float getRenderingScale() const { return static_cast<float>(context.getRenderingScale()); }
+
+    void setBackground(const juce::Image& image, juce::Rectangle<int> area, uint64_t version)
+    {
+        const juce::ScopedLock lock(sceneLock);
+        if (version == pendingBackgroundVersion && area == backgroundArea)
+            return;
+
+        pendingBackground = image;
+        backgroundArea = area;
+        pendingBackgroundVersion = version;
+    }
+
+    void setScene(Scene& scene, juce::Rectangle<int> viewBounds)
+    {
+        const juce::ScopedLock lock(sceneLock);
+        std::swap(pendingScene, scene);
+        pendingViewBounds = viewBounds;
+        sceneDirty = true;
+    }
+
+    //==============================================================================
+    void newOpenGLContextCreated() override
+    {
+        using namespace juce::gl;
+
+        auto program = std::make_unique<juce::OpenGLShaderProgram>(context);
+        if (!program->addVertexShader(juce::OpenGLHelpers::translateVertexShaderToV3(vertexShaderSource))
+            || !program->addFragmentShader(juce::OpenGLHelpers::translateFragmentShaderToV3(fragmentShaderSource))
+            || !program->link())
+        {
+            juce::Logger::writeToLog("GLPlotRenderer: shader build failed, using software rendering: "
+                                     + program->getLastError());
+            failed = true;
+            return;
+        }
+
+        shader = std::move(program);
+        positionAttribute = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*shader, "position");
+        colourAttribute = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*shader, "colour");
+        coherenceAttribute = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*shader, "coherence");
+        viewportUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "viewportSize");
+        shadingUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "coherenceShading");
+        minAlphaUniform = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*shader, "minAlpha");
+
+        glGenBuffers(1, &vertexBuffer);
+
+        // A new context has none of our GPU resources: upload everything on the next frame
+        uploadedBackgroundVersion = 0;
+        vertexBufferNeedsUpload = true;
+        ready = true;
+
+        // Says which driver is in use (e.g. Mesa llvmpipe on headless machines)
+        juce::Logger::writeToLog("GLPlotRenderer: OpenGL " + getGLString(GL_VERSION) + ", " + getGLString(GL_RENDERER));
+    }
+
+    void renderOpenGL() override
+    {
+        using namespace juce::gl;
+
+        if (shader == nullptr)
+            return;
+
+        RenderStats::ScopedFrame frame(owner.stats, RenderStats::Path::openGL);
+
+        {
+            const juce::ScopedLock lock(sceneLock);
+
+            if (sceneDirty)
+            {
+                std::swap(renderScene, pendingScene);
+                viewBounds = pendingViewBounds;
+                sceneDirty = false;
+                vertexBufferNeedsUpload = true;
+            }
+
+            if (pendingBackgroundVersion != uploadedBackgroundVersion && pendingBackground.isValid())
+            {
+                backgroundTexture.loadImage(pendingBackground);
+                backgroundDrawArea = backgroundArea;
+                uploadedBackgroundVersion = pendingBackgroundVersion;
+            }
+        }
+
+        if (viewBounds.isEmpty())
+            return;
+
+        const float scale = getRenderingScale();
+        const int pixelWidth = juce::roundToInt(scale * static_cast<float>(viewBounds.getWidth()));
+        const int pixelHeight = juce::roundToInt(scale * static_cast<float>(viewBounds.getHeight()));
+
+        glViewport(0, 0, pixelWidth, pixelHeight);
+        juce::OpenGLHelpers::clear(juce::Colours::black);
+
+        // Static layer: already rendered at physical resolution, copied 1:1
+        if (backgroundTexture.getTextureID() != 0)
+        {
+            const auto area = (backgroundDrawArea.toFloat() * scale).toNearestInt();
+            backgroundTexture.bind();
+            context.copyTexture(area, area, pixelWidth, pixelHeight, false);
+            backgroundTexture.unbind();
+        }
+
+        if (renderScene.vertices.empty())
+            return;
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        shader->use();
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+
+        if (vertexBufferNeedsUpload)
+        {
+            glBufferData(GL_ARRAY_BUFFER,
+                         static_cast<GLsizeiptr>(sizeof(Vertex) * renderScene.vertices.size()),
+                         renderScene.vertices.data(), GL_STREAM_DRAW);
+            vertexBufferNeedsUpload = false;
+        }
+
+        viewportUniform->set(static_cast<GLfloat>(viewBounds.getWidth()), static_cast<GLfloat>(viewBounds.getHeight()));
+        minAlphaUniform->set(static_cast<GLfloat>(renderScene.minCoherenceAlpha));
+
+        enableAttribute(*positionAttribute, 2, offsetof(Vertex, x));
+        enableAttribute(*colourAttribute, 4, offsetof(Vertex, r));
+        enableAttribute(*coherenceAttribute, 1, offsetof(Vertex, coherence));
+
+        for (const auto& batch : renderScene.batches)
+        {
+            if (batch.numVertices <= 0)
+                continue;
+
+            shadingUniform->set(batch.coherenceShading ? 1.0f : 0.0f);
+
+            GLenum mode = GL_TRIANGLES;
+            if (batch.primitive != Primitive::triangles)
+            {
+                mode = batch.primitive == Primitive::lineStrip ? GL_LINE_STRIP : GL_LINES;
+                glLineWidth(batch.lineWidth * scale);
+            }
+
+            glDrawArrays(mode, batch.firstVertex, batch.numVertices);
+        }
+
+        disableAttribute(*positionAttribute);
+        disableAttribute(*colourAttribute);
+        disableAttribute(*coherenceAttribute);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void openGLContextClosing() override
+    {
+        using namespace juce::gl;
+
+        ready = false;
+
+        positionAttribute.reset();
+        colourAttribute.reset();
+        coherenceAttribute.reset();
+        viewportUniform.reset();
+        shadingUniform.reset();
+        minAlphaUniform.reset();
+        shader.reset();
+
+        backgroundTexture.release();
+        uploadedBackgroundVersion = 0;
+
+        if (vertexBuffer != 0)
+        {
+            glDeleteBuffers(1, &vertexBuffer);
+            vertexBuffer = 0;
+        }
+    }
+
+    //==============================================================================
+    // Message thread watchdog: fall back if the shader failed or no context ever appeared
+    void timerCallback() override
+    {
+        if (failed)
+        {
+            fallBack();
+            return;
+        }
+
+        if (ready)
+        {
+            stopTimer();
+            return;
+        }
+
+        // Only count time on screen: a hidden view legitimately has no context yet
+        if (target != nullptr && target->isShowing())
+            waitedWhileShowingMs += watchdogIntervalMs;
+
+        if (waitedWhileShowingMs >= contextTimeoutMs)
+        {
+            juce::Logger::writeToLog("GLPlotRenderer: no OpenGL context, using software rendering");
+            fallBack();
+        }
+    }
+
+    void fallBack()
+    {
+        auto* component = target;
+        detach();
+        hasFallenBack = true;
+
+        if (owner.onFallback != nullptr)
+            owner.onFallback();
+        else if (component != nullptr)
+            component->repaint();
+    }
+
+    static juce::String getGLString(juce::gl::GLenum name)
+    {
+        const auto* text = juce::gl::glGetString(name);
+        return text != nullptr ? juce::String(reinterpret_cast<const char*>(text)) : juce::String("unknown");
+    }
+
+    static void enableAttribute(const juce::OpenGLShaderProgram::Attribute& attribute, int numComponents, size_t offset)
+    {
+        using namespace juce::gl;
+
+        // attributeID is -1 (as unsigned) if the shader compiler removed the attribute
+        const auto location = static_cast<GLint>(attribute.attributeID);
+        if (location < 0)
+            return;
+
+        const auto index = static_cast<GLuint>(location);
+        glVertexAttribPointer(index, numComponents, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(sizeof(Vertex)),
+                              reinterpret_cast<const GLvoid*>(offset));
+        glEnableVertexAttribArray(index);
+    }
+
+    static void disableAttribute(const juce::OpenGLShaderProgram::Attribute& attribute)
+    {
+        if (static_cast<juce::gl::GLint>(attribute.attributeID) >= 0)
+            juce::gl::glDisableVertexAttribArray(static_cast<juce::gl::GLuint>(attribute.attributeID));
+    }
+
+    GLPlotRenderer& owner;
+    juce::OpenGLContext context;
+    juce::Component* target{nullptr};
+
+    std::atomic<bool> ready{false};
+    std::atomic<bool> failed{false};
+    bool hasFallenBack{false};
+    int waitedWhileShowingMs{0};
+
+    static constexpr int watchdogIntervalMs = 250;
+    static constexpr int contextTimeoutMs = 3000;
+
+    // Shared between the owner's paint() and the GL thread
+    juce::CriticalSection sceneLock;
+    Scene pendingScene;
+    juce::Rectangle<int> pendingViewBounds;
+    bool sceneDirty{false};
+    juce::Image pendingBackground;
+    juce::Rectangle<int> backgroundArea;
+    uint64_t pendingBackgroundVersion{0};
+
+    // GL thread only
+    Scene renderScene;
+    juce::Rectangle<int> viewBounds;
+    juce::Rectangle<int> backgroundDrawArea;
+    uint64_t uploadedBackgroundVersion{0};
+    bool vertexBufferNeedsUpload{true};
+
+    std::unique_ptr<juce::OpenGLShaderProgram> shader;
+    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> positionAttribute;
+    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> colourAttribute;
+    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> coherenceAttribute;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> viewportUniform;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> shadingUniform;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> minAlphaUniform;
+    juce::OpenGLTexture backgroundTexture;
+    juce::gl::GLuint vertexBuffer{0};
+};
+
+#else
+
+// Built without juce_opengl: the renderer never activates and owners stay on the software path
+struct GLPlotRenderer::Pimpl
+{
+    explicit Pimpl(GLPlotRenderer&) {}
+    void attachTo(juce::Component&) {}
+    void detach() {}
+    bool isActive() const { return false; }
+    float getRenderingScale() const { return 1.0f; }
+    void setBackground(const juce::Image&, juce::Rectangle<int>, uint64_t) {}
+    void setScene(Scene&, juce::Rectangle<int>) {}
+};
+
+#endif
+
+//==============================================================================
+GLPlotRenderer::GLPlotRenderer(const juce::String& viewName)
+    : stats(viewName)
+    , pimpl(std::make_unique<Pimpl>(*this))
+{
+}
+
+GLPlotRenderer::~GLPlotRenderer()
+{
+    pimpl->detach();
+}
+
+bool GLPlotRenderer::isAvailable()
+{
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+    return !juce::SystemStats::getEnvironmentVariable("AUDIOCOPILOT_RENDERER", {}).equalsIgnoreCase("software");
+#else
+    return false;
+#endif
+}
+
+void GLPlotRenderer::attachTo(juce::Component& component)
+{
+    if (isAvailable())
+        pimpl->attachTo(component);
+}
+
+void GLPlotRenderer::detach()
+{
+    pimpl->detach();
+}
+
+bool GLPlotRenderer::isActive() const
+{
+    return pimpl->isActive();
+}
+
+float GLPlotRenderer::getRenderingScale() const
+{
+    return pimpl->getRenderingScale();
+}
+
+void GLPlotRenderer::setBackground(const juce::Image& image, juce::Rectangle<int> area, uint64_t version)
+{
+    pimpl->setBackground(image, area, version);
+}
+
+void GLPlotRenderer::setScene(Scene& scene, juce::Rectangle<int> viewBounds)
+{
+    pimpl->setScene(scene, viewBounds);
+}
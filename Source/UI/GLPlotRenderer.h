@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "RenderStats.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * GLPlotRenderer
+ *
+ * Optional OpenGL path for the live views (TF magnitude/phase, RTA, channel meters).
+ * The owner keeps painting through juce::Graphics as before; while isActive() its
+ * paint() only describes the frame instead:
+ *
+ * - setBackground(): the static layer image (CachedPlotLayer), uploaded as a texture
+ *   only when it was re-rendered
+ * - setScene(): the live data as one vertex buffer (curves as line strips, bars and
+ *   meters as triangles). Curves carry the per-point coherence; the Smaart-style
+ *   coherence -> alpha mapping and the low-coherence cut are done in the shader
+ *
+ * The GL frame is drawn first, then the component's own painting (children, anything
+ * painted while active) is composited on top, so paint() must leave the plot
+ * transparent while the renderer is active.
+ *
+ * Fallback: isActive() stays false until the context exists and the shader compiled.
+ * If that does not happen (no GL driver, compile error, context never created while
+ * showing), the renderer detaches itself and calls onFallback, and the owner simply
+ * keeps using the software path. Without juce_opengl in the build, or with
+ * AUDIOCOPILOT_RENDERER=software in the environment, it never activates.
+ */
+class GLPlotRenderer
+{
+public:
+    struct Vertex
+    {
+        float x{0.0f};
+        float y{0.0f};
+        float r{1.0f};
+        float g{1.0f};
+        float b{1.0f};
+        float a{1.0f};
+        float coherence{1.0f};
+    };
+
+    enum class Primitive { lineStrip, lines, triangles };
+
+    struct Batch
+    {
+        Primitive primitive{Primitive::triangles};
+        int firstVertex{0};
+        int numVertices{0};
+        float lineWidth{1.0f};
+        bool coherenceShading{false};
+    };
+
+    // Geometry of one frame, in component (logical pixel) coordinates
+    struct Scene
+    {
+        std::vector<Vertex> vertices;
+        std::vector<Batch> batches;
+        float minCoherenceAlpha{0.1f};  // below this the coherence-shaded curve is cut
+
+        void clear()
+        {
+            vertices.clear();
+            batches.clear();
+        }
+
+        // Polyline; with coherenceShading the alpha comes from each point's coherence
+        void beginLineStrip(juce::Colour colour, float lineWidth, bool coherenceShading);
+        void addPoint(float x, float y, float coherence = 1.0f);
+
+        // Independent segments and filled rectangles; consecutive calls share one draw call
+        void addLine(juce::Point<float> start, juce::Point<float> end, juce::Colour colour, float lineWidth = 1.0f);
+        void addRect(juce::Rectangle<float> area, juce::Colour colour);
+
+    private:
+        Batch& getBatch(Primitive primitive, float lineWidth, bool coherenceShading);
+        Vertex makeVertex(float x, float y, float coherence) const;
+
+        juce::Colour vertexColour;
+    };
+
+    explicit GLPlotRenderer(const juce::String& viewName);
+    ~GLPlotRenderer();
+
+    // True if this build has the OpenGL path and it was not disabled via AUDIOCOPILOT_RENDERER=software
+    static bool isAvailable();
+
+    // Message thread. No-op if !isAvailable() or the renderer already fell back
+    void attachTo(juce::Component& component);
+    void detach();
+
+    // Any thread: true while frames are drawn by OpenGL (owner's paint() must then only fill the scene)
+    bool isActive() const;
+
+    // Physical pixels per logical pixel of the GL surface (for rendering the background image)
+    float getRenderingScale() const;
+
+    // Called on the message thread once, after falling back to the software renderer
+    std::function<void()> onFallback;
+
+    // Static layer; version must change whenever the image content changes
+    void setBackground(const juce::Image& image, juce::Rectangle<int> area, uint64_t version);
+
+    // Replaces the live geometry for a view of the given size (swapped, so the caller
+    // gets the previous buffers back for reuse)
+    void setScene(Scene& scene, juce::Rectangle<int> viewBounds);
+
+    RenderStats& getStats() { return stats; }
+
+private:
+    RenderStats stats;
+
+    struct Pimpl;
+    std::unique_ptr<Pimpl> pimpl;
+
+    JUCE_DECLARE_NON_COPYABLE(GLPlotRenderer)
+};
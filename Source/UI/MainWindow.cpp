@@ -171,10 +171,16 @@ MainWindow::MainWindow(juce::String name)
     // Initialize audio engine
     audioEngine->initialize();
     
+    // All-input capture to disk (started from the Device menu)
+    sessionRecorder = std::make_unique<SessionRecorder>(*deviceManager);
+    
     // Create content component
     contentComponent = std::make_unique<MainContentComponent>();
     setContentNonOwned(contentComponent.get(), true);
     
+    // Live views refresh in step with this window's display
+    FrameScheduler::getInstance().attachTo(contentComponent.get());
+    
     // Create UI components
     deviceSelector = std::make_unique<DeviceSelectorComponent>(*deviceManager);
     inputMeters = std::make_unique<ChannelMeterComponent>(*deviceStateModel, true);
@@ -205,6 +211,14 @@ MainWindow::MainWindow(juce::String name)
     // Create AI Stage Hand controller
     aiStageHandController = std::make_unique<AudioCoPilot::AIStageHandController>(*deviceManager);
     
+    // All modules analyse in the background from now on (hidden ones on a reduced budget),
+    // so switching views keeps their averages
+    analysisHost = std::make_unique<AnalysisHost>(*deviceManager);
+    analysisHost->addModule(*tfController);
+    analysisHost->addModule(*antiMaskingController);
+    analysisHost->addModule(*rtaController);
+    analysisHost->addModule(*aiStageHandController);
+    
     // Create menu bar
     menuBarModel = std::make_unique<MenuBarModel>(*deviceManager);
     menuBarModel->setModuleActivationCallback([this](int moduleID) {
@@ -224,7 +238,12 @@ MainWindow::MainWindow(juce::String name)
         {
             showAIStageHand();
         }
+        else if (moduleID == 21) // Session recording
+        {
+            toggleSessionRecording();
+        }
     });
+    menuBarModel->isSessionRecording = [this] { return sessionRecorder != nullptr && sessionRecorder->isRecording(); };
     menuBar = std::make_unique<juce::MenuBarComponent>(menuBarModel.get());
     contentComponent->menuBar = menuBar.get();
     
@@ -264,9 +283,12 @@ MainWindow::MainWindow(juce::String name)
 MainWindow::~MainWindow()
 {
     LocalizedStrings::getInstance().removeChangeListener(this);
+    FrameScheduler::getInstance().attachTo(nullptr);
     
-    // Shutdown audio
+    // Shutdown audio (the recorder flushes to disk and the modules stop before the device goes away)
+    sessionRecorder = nullptr;
     hideAIStageHand();
+    analysisHost = nullptr;
     audioEngine->shutdown();
     
     // Remove components
@@ -301,6 +323,38 @@ void MainWindow::changeListenerCallback(juce::ChangeBroadcaster* source)
     }
 }
 
+void MainWindow::toggleSessionRecording()
+{
+    if (sessionRecorder->isRecording())
+    {
+        sessionRecorder->stop();
+        
+        const auto stats = sessionRecorder->getStats();
+        juce::String summary;
+        summary << sessionRecorder->getSessionDirectory().getFullPathName() << "\n\n"
+                << juce::String(static_cast<juce::int64>(stats.writtenFrames)) << " frames in "
+                << stats.numSegments << " segment(s)\n"
+                << juce::String(static_cast<juce::int64>(stats.droppedFrames)) << " frames dropped in "
+                << juce::String(static_cast<juce::int64>(stats.dropouts)) << " dropout(s)\n"
+                << "Spill peak: " << stats.spillHighWaterBlocks << " / " << stats.maxSpillBlocks << " blocks";
+        
+        if (stats.error.isNotEmpty())
+            summary << "\n\n" << stats.error;
+        
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Session Recording", summary);
+    }
+    else
+    {
+        const auto parent = juce::File::getSpecialLocation(juce::File::userMusicDirectory).getChildFile("AudioCoPilot Sessions");
+        
+        if (!sessionRecorder->start(parent))
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Session Recording",
+                                                   sessionRecorder->getStats().error);
+    }
+    
+    menuBarModel->menuItemsChanged();
+}
+
 void MainWindow::setupUI()
 {
     // Add components to content component
@@ -334,8 +388,8 @@ void MainWindow::showTransferFunction()
     tfView = std::make_unique<TransferFunctionView>(*tfController);
     contentComponent->addAndMakeVisible(tfView.get());
     
-    // Activate controller
-    tfController->activate();
+    // Bring the (already running) controller to the foreground
+    analysisHost->setForeground(tfController.get());
     
     // Hide meters, show TF view
     if (inputViewport != nullptr) inputViewport->setVisible(false);
@@ -350,9 +404,9 @@ void MainWindow::hideTransferFunction()
     if (tfView == nullptr)
         return;
     
-    // Deactivate controller
-    if (tfController != nullptr)
-        tfController->deactivate();
+    // Back to the background budget; the averages keep running
+    if (analysisHost != nullptr)
+        analysisHost->setForeground(nullptr);
     
     // Remove view
     contentComponent->removeChildComponent(tfView.get());
@@ -382,7 +436,7 @@ void MainWindow::showAntiMasking()
     antiMaskingView = std::make_unique<AudioCoPilot::AntiMaskingView>(*antiMaskingController);
     contentComponent->addAndMakeVisible(antiMaskingView.get());
 
-    antiMaskingController->activate();
+    analysisHost->setForeground(antiMaskingController.get());
 
     if (inputViewport != nullptr) inputViewport->setVisible(false);
     if (outputViewport != nullptr) outputViewport->setVisible(false);
@@ -396,8 +450,8 @@ void MainWindow::hideAntiMasking()
     if (antiMaskingView == nullptr)
         return;
 
-    if (antiMaskingController != nullptr)
-        antiMaskingController->deactivate();
+    if (analysisHost != nullptr)
+        analysisHost->setForeground(nullptr);
 
     contentComponent->removeChildComponent(antiMaskingView.get());
     antiMaskingView = nullptr;
@@ -424,7 +478,7 @@ void MainWindow::showRTA()
     rtaView = std::make_unique<AudioCoPilot::RTAView>(*rtaController, *deviceManager);
     contentComponent->addAndMakeVisible(rtaView.get());
 
-    rtaController->activate();
+    analysisHost->setForeground(rtaController.get());
 
     if (inputViewport != nullptr) inputViewport->setVisible(false);
     if (outputViewport != nullptr) outputViewport->setVisible(false);
@@ -438,8 +492,8 @@ void MainWindow::hideRTA()
     if (rtaView == nullptr)
         return;
 
-    if (rtaController != nullptr)
-        rtaController->deactivate();
+    if (analysisHost != nullptr)
+        analysisHost->setForeground(nullptr);
 
     contentComponent->removeChildComponent(rtaView.get());
     rtaView = nullptr;
@@ -466,7 +520,7 @@ void MainWindow::showAIStageHand()
     aiStageHandView = std::make_unique<AudioCoPilot::AIStageHandView>(*aiStageHandController);
     contentComponent->addAndMakeVisible(aiStageHandView.get());
 
-    aiStageHandController->activate();
+    analysisHost->setForeground(aiStageHandController.get());
 
     if (inputViewport != nullptr) inputViewport->setVisible(false);
     if (outputViewport != nullptr) outputViewport->setVisible(false);
@@ -480,8 +534,8 @@ void MainWindow::hideAIStageHand()
     if (aiStageHandView == nullptr)
         return;
 
-    if (aiStageHandController != nullptr)
-        aiStageHandController->deactivate();
+    if (analysisHost != nullptr)
+        analysisHost->setForeground(nullptr);
 
     contentComponent->removeChildComponent(aiStageHandView.get());
     aiStageHandView = nullptr;
@@ -4,9 +4,12 @@
 #include "../Core/DeviceManager.h"
 #include "../Core/DeviceStateModel.h"
 #include "../Core/AudioEngine.h"
+#include "../Core/SessionRecorder.h"
+#include "../Core/AnalysisHost.h"
 #include "../Menu/MenuBarModel.h"
 #include "DeviceSelectorComponent.h"
 #include "ChannelMeterComponent.h"
+#include "FrameScheduler.h"
 #include "LookAndFeel/IndustrialLookAndFeel.h"
 #include "DesignSystem/DesignSystem.h"
 
@@ -73,6 +76,7 @@ private:
     std::unique_ptr<DeviceStateModel> deviceStateModel;
     std::unique_ptr<DeviceManager> deviceManager;
     std::unique_ptr<AudioEngine> audioEngine;
+    std::unique_ptr<SessionRecorder> sessionRecorder;
     
     // UI components
     std::unique_ptr<MainContentComponent> contentComponent;
@@ -96,6 +100,9 @@ private:
     std::unique_ptr<AudioCoPilot::AIStageHandController> aiStageHandController;
     std::unique_ptr<AudioCoPilot::AIStageHandView> aiStageHandView;
     
+    // Keeps every module above running; the views only pick which one is in the foreground
+    std::unique_ptr<AnalysisHost> analysisHost;
+    
     // Menu
     std::unique_ptr<MenuBarModel> menuBarModel;
     std::unique_ptr<juce::MenuBarComponent> menuBar;
@@ -116,6 +123,8 @@ private:
 
     void showAIStageHand();
     void hideAIStageHand();
+
+    void toggleSessionRecording();
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
 };
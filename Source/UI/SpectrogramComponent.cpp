@@ -0,0 +1,264 @@
+#include "SpectrogramComponent.h"
+#include <cmath>
+#include <iterator>
+
+SpectrogramComponent::SpectrogramComponent(const juce::String& titleText, Orientation o)
+    : title(titleText), orientation(o), colourMap(makeColourMap())
+{
+    setOpaque(true);
+
+    // New columns arrive at the analysis hop rate (~10-12/s); 30 fps keeps the scroll smooth
+    FrameScheduler::getInstance().addClient(*this, {[this] { return source != nullptr ? source->getGeneration() : 0; }},
+                                            [this] { refresh(); }, 30);
+}
+
+SpectrogramComponent::~SpectrogramComponent()
+{
+    FrameScheduler::getInstance().removeClient(*this);
+}
+
+void SpectrogramComponent::setSource(AudioCoPilot::SpectrumHistory* history)
+{
+    source = history;
+    columns.reset();
+    rebuildImage();
+    repaint();
+}
+
+void SpectrogramComponent::setVisibleSeconds(double seconds)
+{
+    visibleSeconds = juce::jlimit(1.0, 3600.0, seconds);
+    rebuildImage();
+    repaint();
+}
+
+void SpectrogramComponent::refresh()
+{
+    // A re-prepared history (new sample rate, history length, ...) starts over
+    if (source == nullptr || source->getColumns() != columns)
+    {
+        rebuildImage();
+        repaint();
+        return;
+    }
+
+    if (blitNewColumns())
+        repaint();
+}
+
+void SpectrogramComponent::rebuildImage()
+{
+    columns = source != nullptr ? source->getColumns() : nullptr;
+    ring = {};
+    nextSlot = 0;
+    nextColumn = 0;
+
+    if (columns == nullptr)
+        return;
+
+    const int numRows = columns->getNumRows();
+    visibleColumns = juce::jlimit(2, columns->getCapacity(),
+                                  juce::roundToInt(visibleSeconds * columns->getColumnsPerSecond()));
+    columnCodes.assign(static_cast<size_t>(numRows), 0);
+
+    if (orientation == Orientation::spectrogram)
+        ring = juce::Image(juce::Image::ARGB, visibleColumns, numRows, false);
+    else
+        ring = juce::Image(juce::Image::ARGB, numRows, visibleColumns, false);
+
+    ring.clear(ring.getBounds(), juce::Colour(colourMap[0].getInARGBMaskOrder()));
+
+    // Refill what the history still has of the visible span
+    const uint64_t total = columns->getTotal();
+    nextColumn = total > static_cast<uint64_t>(visibleColumns) ? total - static_cast<uint64_t>(visibleColumns) : 0;
+    blitNewColumns();
+}
+
+bool SpectrogramComponent::blitNewColumns()
+{
+    if (columns == nullptr || !ring.isValid())
+        return false;
+
+    const uint64_t total = columns->getTotal();
+    if (total <= nextColumn)
+        return false;
+
+    // After a long time hidden only the last visibleColumns columns can still be on screen
+    uint64_t first = juce::jmax(nextColumn, columns->getOldest());
+    if (total - first > static_cast<uint64_t>(visibleColumns))
+        first = total - static_cast<uint64_t>(visibleColumns);
+
+    nextSlot = static_cast<int>((static_cast<uint64_t>(nextSlot) + (first - nextColumn)) % static_cast<uint64_t>(visibleColumns));
+
+    juce::Image::BitmapData pixels(ring, juce::Image::BitmapData::writeOnly);
+
+    for (uint64_t column = first; column < total; ++column)
+    {
+        // Overwritten while copying (reader far behind): leave the slot at the floor colour
+        if (!columns->readColumn(column, columnCodes.data()))
+            std::fill(columnCodes.begin(), columnCodes.end(), static_cast<uint8_t>(0));
+
+        blitColumn(pixels, columnCodes.data(), nextSlot);
+        nextSlot = (nextSlot + 1) % visibleColumns;
+    }
+
+    nextColumn = total;
+    return true;
+}
+
+void SpectrogramComponent::blitColumn(juce::Image::BitmapData& pixels, const uint8_t* codes, int slot) const
+{
+    const int numRows = columns->getNumRows();
+
+    if (orientation == Orientation::spectrogram)
+    {
+        // One image column, lowest frequency at the bottom
+        auto* pixel = pixels.getPixelPointer(slot, numRows - 1);
+        for (int row = 0; row < numRows; ++row, pixel -= pixels.lineStride)
+            *reinterpret_cast<juce::PixelARGB*>(pixel) = colourMap[codes[row]];
+    }
+    else
+    {
+        // One image line; slots run upwards so the newest line ends up on top
+        auto* pixel = pixels.getLinePointer(visibleColumns - 1 - slot);
+        for (int row = 0; row < numRows; ++row, pixel += pixels.pixelStride)
+            *reinterpret_cast<juce::PixelARGB*>(pixel) = colourMap[codes[row]];
+    }
+}
+
+juce::Rectangle<int> SpectrogramComponent::getPlotArea() const
+{
+    auto bounds = getLocalBounds();
+    bounds.removeFromTop(titleHeight);
+
+    if (orientation == Orientation::spectrogram)
+        bounds.removeFromLeft(axisWidth);
+    else
+        bounds.removeFromBottom(titleHeight);
+
+    return bounds.reduced(4);
+}
+
+void SpectrogramComponent::paint(juce::Graphics& g)
+{
+    FrameScheduler::ScopedPaintTimer paintTimer;
+
+    g.fillAll(juce::Colour(0xff1a1a1a));
+
+    const auto plotArea = getPlotArea();
+    if (plotArea.isEmpty())
+        return;
+
+    if (ring.isValid())
+        drawRing(g, plotArea);
+    else
+    {
+        g.setColour(juce::Colour(0xff101010));
+        g.fillRect(plotArea);
+    }
+
+    drawAxes(g, plotArea);
+}
+
+void SpectrogramComponent::drawRing(juce::Graphics& g, juce::Rectangle<int> plotArea) const
+{
+    // The ring is drawn in two pieces: oldest..end of image, then start of image..newest
+    g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+
+    if (orientation == Orientation::spectrogram)
+    {
+        const int firstCount = visibleColumns - nextSlot;
+        const int split = plotArea.getX() + juce::roundToInt(static_cast<float>(plotArea.getWidth()) * static_cast<float>(firstCount)
+                                                              / static_cast<float>(visibleColumns));
+
+        g.drawImage(ring, plotArea.getX(), plotArea.getY(), split - plotArea.getX(), plotArea.getHeight(),
+                    nextSlot, 0, firstCount, ring.getHeight());
+
+        if (nextSlot > 0)
+            g.drawImage(ring, split, plotArea.getY(), plotArea.getRight() - split, plotArea.getHeight(),
+                        0, 0, nextSlot, ring.getHeight());
+    }
+    else
+    {
+        // Newest line is at image row visibleColumns - nextSlot (mod visibleColumns)
+        const int top = (visibleColumns - nextSlot) % visibleColumns;
+        const int firstCount = visibleColumns - top;
+        const int split = plotArea.getY() + juce::roundToInt(static_cast<float>(plotArea.getHeight()) * static_cast<float>(firstCount)
+                                                              / static_cast<float>(visibleColumns));
+
+        g.drawImage(ring, plotArea.getX(), plotArea.getY(), plotArea.getWidth(), split - plotArea.getY(),
+                    0, top, ring.getWidth(), firstCount);
+
+        if (top > 0)
+            g.drawImage(ring, plotArea.getX(), split, plotArea.getWidth(), plotArea.getBottom() - split,
+                        0, 0, ring.getWidth(), top);
+    }
+}
+
+void SpectrogramComponent::drawAxes(juce::Graphics& g, juce::Rectangle<int> plotArea) const
+{
+    g.setFont(juce::Font(10.0f));
+    g.setColour(juce::Colours::lightgrey);
+    g.drawText(title, getLocalBounds().removeFromTop(titleHeight).reduced(6, 0), juce::Justification::centredLeft);
+
+    if (columns == nullptr)
+        return;
+
+    // Span label: the right/top edge is "now"
+    const double spanSeconds = static_cast<double>(visibleColumns) / columns->getColumnsPerSecond();
+    g.drawText("-" + juce::String(spanSeconds, spanSeconds < 10.0 ? 1 : 0) + " s .. now",
+               getLocalBounds().removeFromTop(titleHeight).reduced(6, 0), juce::Justification::centredRight);
+
+    // Same frequency ticks as the TF plots; rows are log-spaced, so the axis is linear in row index
+    const float ticks[] = {31.5f, 63.0f, 125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 4000.0f, 8000.0f, 16000.0f};
+    const char* const tickLabels[] = {"31.5", "63", "125", "250", "500", "1k", "2k", "4k", "8k", "16k"};
+    const float numRows = static_cast<float>(columns->getNumRows());
+
+    for (size_t i = 0; i < std::size(ticks); ++i)
+    {
+        const float position = (columns->getRowForFrequency(ticks[i]) + 0.5f) / numRows;
+        if (position < 0.0f || position > 1.0f)
+            continue;
+
+        g.setColour(juce::Colours::white.withAlpha(0.15f));
+
+        if (orientation == Orientation::spectrogram)
+        {
+            const int y = plotArea.getBottom() - juce::roundToInt(position * static_cast<float>(plotArea.getHeight()));
+            g.drawHorizontalLine(y, static_cast<float>(plotArea.getX()), static_cast<float>(plotArea.getRight()));
+            g.setColour(juce::Colour(0xff808080));
+            g.drawText(tickLabels[i], 0, y - 6, axisWidth - 2, 12, juce::Justification::centredRight);
+        }
+        else
+        {
+            const int x = plotArea.getX() + juce::roundToInt(position * static_cast<float>(plotArea.getWidth()));
+            g.drawVerticalLine(x, static_cast<float>(plotArea.getY()), static_cast<float>(plotArea.getBottom()));
+            g.setColour(juce::Colour(0xff808080));
+            g.drawText(tickLabels[i], x - 20, plotArea.getBottom() + 2, 40, titleHeight - 4, juce::Justification::centred);
+        }
+    }
+}
+
+void SpectrogramComponent::resized()
+{
+    // The ring is resolution-independent (scaled when drawn): nothing to rebuild
+    repaint();
+}
+
+std::array<juce::PixelARGB, 256> SpectrogramComponent::makeColourMap()
+{
+    juce::ColourGradient gradient;
+    gradient.addColour(0.0, juce::Colour(0xff000000));
+    gradient.addColour(0.2, juce::Colour(0xff0d1b5e));
+    gradient.addColour(0.4, juce::Colour(0xff1565c0));
+    gradient.addColour(0.6, juce::Colour(0xff00bfa5));
+    gradient.addColour(0.8, juce::Colour(0xffffd600));
+    gradient.addColour(0.92, juce::Colour(0xffff3d00));
+    gradient.addColour(1.0, juce::Colour(0xffffffff));
+
+    std::array<juce::PixelARGB, 256> map;
+    for (size_t i = 0; i < map.size(); ++i)
+        map[i] = gradient.getColourAtPosition(static_cast<double>(i) / 255.0).getPixelARGB();
+
+    return map;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "../Core/SpectrumHistory.h"
+#include "FrameScheduler.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+/**
+ * SpectrogramComponent
+ *
+ * Scrolling view of a SpectrumHistory:
+ * - Orientation::spectrogram: time runs right to left (newest column at the right
+ *   edge), frequency upwards on a log axis - feedback hunting on an input
+ * - Orientation::waterfall: frequency left to right on the same log axis as the TF
+ *   plots, newest spectrum on top - TF magnitude over time
+ *
+ * Drawn incrementally: the visible span lives in a persistent image used as a ring,
+ * each frame only the columns that arrived since the last one are colour-mapped into
+ * it (one column blit each), and paint() draws the ring in two pieces. The image is
+ * only rebuilt from the history when the layout, size or visible span changes.
+ */
+class SpectrogramComponent : public juce::Component
+{
+public:
+    enum class Orientation { spectrogram, waterfall };
+
+    SpectrogramComponent(const juce::String& title, Orientation orientation);
+    ~SpectrogramComponent() override;
+
+    // History to show (nullptr = nothing). Message thread; the history must outlive this view
+    // or be replaced first.
+    void setSource(AudioCoPilot::SpectrumHistory* history);
+
+    // Span shown on screen, independent of how much the history keeps
+    void setVisibleSeconds(double seconds);
+    double getVisibleSeconds() const { return visibleSeconds; }
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void refresh();
+    void rebuildImage();
+    bool blitNewColumns();
+    void blitColumn(juce::Image::BitmapData& pixels, const uint8_t* codes, int slot) const;
+    juce::Rectangle<int> getPlotArea() const;
+    void drawRing(juce::Graphics& g, juce::Rectangle<int> plotArea) const;
+    void drawAxes(juce::Graphics& g, juce::Rectangle<int> plotArea) const;
+    static std::array<juce::PixelARGB, 256> makeColourMap();
+
+    juce::String title;
+    Orientation orientation;
+    double visibleSeconds{30.0};
+
+    AudioCoPilot::SpectrumHistory* source{nullptr};
+    std::shared_ptr<const AudioCoPilot::SpectrumHistory::Columns> columns;
+
+    // Ring image: one pixel line per column, visibleColumns lines long
+    juce::Image ring;
+    int visibleColumns{0};
+    int nextSlot{0};            // slot the next column goes to
+    uint64_t nextColumn{0};     // history column that goes there
+    std::vector<uint8_t> columnCodes;
+
+    const std::array<juce::PixelARGB, 256> colourMap;
+
+    static constexpr int axisWidth = 40;
+    static constexpr int titleHeight = 18;
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrogramComponent)
+};
@@ -0,0 +1,203 @@
+#include "ImpulseResponsePlotComponent.h"
+#include <cmath>
+
+ImpulseResponsePlotComponent::ImpulseResponsePlotComponent(TFImpulseResponse& ir)
+    : impulseResponse(ir)
+{
+    // Refresh when the worker publishes a new decimated IR, at most 30Hz
+    FrameScheduler::getInstance().addClient(*this, {[this] { return impulseResponse.getGeneration(); }},
+                                            [this]
+                                            {
+                                                curveDirty = true;
+                                                repaint();
+                                            },
+                                            30);
+}
+
+ImpulseResponsePlotComponent::~ImpulseResponsePlotComponent()
+{
+    FrameScheduler::getInstance().removeClient(*this);
+}
+
+void ImpulseResponsePlotComponent::paint(juce::Graphics& g)
+{
+    FrameScheduler::ScopedPaintTimer paintTimer;
+
+    if (curveDirty)
+        rebuildCurves(getGraphArea());
+
+    // Background, title, grid and labels come from the cached image
+    staticLayer.draw(g, getLocalBounds());
+
+    if (!display.valid)
+        return;
+
+    const auto graphArea = getGraphArea();
+
+    g.setColour(irColour.withAlpha(0.35f));
+    g.fillPath(irPath);
+
+    g.setColour(etcColour);
+    g.strokePath(etcPath, juce::PathStrokeType(1.5f));
+
+    // Arrival (energy peak)
+    if (arrivalX >= graphArea.getX() && arrivalX <= graphArea.getRight())
+    {
+        g.setColour(arrivalColour);
+        g.drawVerticalLine(static_cast<int>(arrivalX), static_cast<float>(graphArea.getY()),
+                           static_cast<float>(graphArea.getBottom()));
+        g.setFont(juce::Font(11.0f));
+        g.drawText(juce::String(display.arrivalMs, 2) + " ms",
+                   static_cast<int>(arrivalX) + 4, graphArea.getY() + 2, 80, 14,
+                   juce::Justification::centredLeft);
+    }
+}
+
+juce::Rectangle<int> ImpulseResponsePlotComponent::getGraphArea() const
+{
+    // Must match the layout used by drawStaticLayer()
+    auto bounds = getLocalBounds();
+    bounds.removeFromTop(25);
+    return bounds.reduced(40);
+}
+
+void ImpulseResponsePlotComponent::rebuildCurves(juce::Rectangle<int> graphArea)
+{
+    curveDirty = false;
+    etcPath.clear();
+    irPath.clear();
+    arrivalX = -1.0f;
+
+    impulseResponse.getDisplay(display);
+
+    const int numColumns = static_cast<int>(display.etcDb.size());
+    if (!display.valid || numColumns < 2 || graphArea.getWidth() <= 0)
+        return;
+
+    // New time range (FFT size or sample rate changed): axis labels move
+    const double startMs = display.startMs;
+    const double endMs = display.startMs + numColumns * display.columnMs;
+    if (startMs != axisStartMs || endMs != axisEndMs)
+    {
+        axisStartMs = startMs;
+        axisEndMs = endMs;
+        staticLayer.invalidate();
+    }
+
+    // ETC as a line, IR as a filled min/max envelope (top edge forward, bottom edge back)
+    for (int c = 0; c < numColumns; ++c)
+    {
+        const float x = timeToX(startMs + (c + 0.5) * display.columnMs, graphArea);
+        const float y = etcToY(display.etcDb[c], graphArea);
+        if (c == 0)
+            etcPath.startNewSubPath(x, y);
+        else
+            etcPath.lineTo(x, y);
+
+        const float top = amplitudeToY(display.irMax[c], graphArea);
+        if (c == 0)
+            irPath.startNewSubPath(x, top);
+        else
+            irPath.lineTo(x, top);
+    }
+
+    for (int c = numColumns; --c >= 0;)
+        irPath.lineTo(timeToX(startMs + (c + 0.5) * display.columnMs, graphArea), amplitudeToY(display.irMin[c], graphArea));
+
+    irPath.closeSubPath();
+
+    arrivalX = timeToX(display.arrivalMs, graphArea);
+}
+
+void ImpulseResponsePlotComponent::drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    // Background
+    g.setColour(juce::Colour(0xff1a1a1a));
+    g.fillRect(bounds);
+
+    // Title
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::Font(14.0f, juce::Font::bold));
+    g.drawText("Impulse Response / ETC", bounds.removeFromTop(25), juce::Justification::centredLeft);
+
+    const auto graphArea = bounds.reduced(40);
+
+    // Axes
+    g.setColour(juce::Colour(0xff404040));
+    g.drawLine(static_cast<float>(graphArea.getX()), static_cast<float>(graphArea.getBottom()),
+               static_cast<float>(graphArea.getRight()), static_cast<float>(graphArea.getBottom()), 1.0f);
+    g.drawLine(static_cast<float>(graphArea.getX()), static_cast<float>(graphArea.getY()),
+               static_cast<float>(graphArea.getX()), static_cast<float>(graphArea.getBottom()), 1.0f);
+
+    g.setFont(juce::Font(10.0f));
+
+    // Time grid: a 1-2-5 step giving roughly 10 divisions
+    const double rangeMs = axisEndMs - axisStartMs;
+    if (rangeMs > 0.0)
+    {
+        const double rough = rangeMs / 10.0;
+        const double decade = std::pow(10.0, std::floor(std::log10(rough)));
+        const double step = rough / decade < 2.0 ? decade : (rough / decade < 5.0 ? 2.0 * decade : 5.0 * decade);
+
+        for (double t = std::ceil(axisStartMs / step) * step; t <= axisEndMs; t += step)
+        {
+            const float x = timeToX(t, graphArea);
+            g.setColour(std::abs(t) < 0.5 * step ? juce::Colour(0xff505050) : juce::Colour(0xff353535));
+            g.drawVerticalLine(static_cast<int>(x), static_cast<float>(graphArea.getY()),
+                               static_cast<float>(graphArea.getBottom()));
+            g.setColour(juce::Colour(0xff505050));
+            g.drawText(juce::String(std::abs(t) < 0.5 * step ? 0.0 : t, step < 1.0 ? 1 : 0),
+                       static_cast<int>(x) - 20, graphArea.getBottom() + 2, 40, 15,
+                       juce::Justification::centred);
+        }
+
+        g.drawText("ms", graphArea.getRight() - 40, graphArea.getBottom() + 16, 40, 15,
+                   juce::Justification::centredRight);
+    }
+
+    // ETC level grid
+    for (float db = maxEtcDb; db >= minEtcDb; db -= 20.0f)
+    {
+        const float y = etcToY(db, graphArea);
+        g.setColour(juce::Colour(0xff353535));
+        g.drawHorizontalLine(static_cast<int>(y), static_cast<float>(graphArea.getX()),
+                             static_cast<float>(graphArea.getRight()));
+        g.setColour(juce::Colour(0xff505050));
+        g.drawText(juce::String(static_cast<int>(db)) + " dB",
+                   0, static_cast<int>(y) - 7, graphArea.getX() - 3, 14,
+                   juce::Justification::centredRight);
+    }
+}
+
+float ImpulseResponsePlotComponent::timeToX(double timeMs, juce::Rectangle<int> graphArea) const
+{
+    // Linear time scale over the whole IR (pre-roll included)
+    const double normalized = (timeMs - axisStartMs) / juce::jmax(1.0e-9, axisEndMs - axisStartMs);
+    return static_cast<float>(graphArea.getX() + normalized * graphArea.getWidth());
+}
+
+float ImpulseResponsePlotComponent::etcToY(float db, juce::Rectangle<int> graphArea) const
+{
+    // 0 dB (peak) at the top, floor at the bottom
+    const float normalized = (juce::jlimit(minEtcDb, maxEtcDb, db) - minEtcDb) / (maxEtcDb - minEtcDb);
+    return graphArea.getY() + graphArea.getHeight() * (1.0f - normalized);
+}
+
+float ImpulseResponsePlotComponent::amplitudeToY(float amplitude, juce::Rectangle<int> graphArea) const
+{
+    // -1 .. 1 over the full height, zero in the middle
+    return graphArea.getCentreY() - 0.5f * graphArea.getHeight() * juce::jlimit(-1.0f, 1.0f, amplitude);
+}
+
+void ImpulseResponsePlotComponent::resized()
+{
+    // staticLayer notices the new size by itself
+    curveDirty = true;
+    repaint();
+}
+
+void ImpulseResponsePlotComponent::lookAndFeelChanged()
+{
+    staticLayer.invalidate();
+    repaint();
+}
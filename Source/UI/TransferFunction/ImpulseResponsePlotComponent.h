@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Core/TransferFunction/TFImpulseResponse.h"
+#include "../CachedPlotLayer.h"
+#include "../FrameScheduler.h"
+
+/**
+ * ImpulseResponsePlotComponent
+ *
+ * Live impulse response of the transfer function: the IR (min/max envelope per column,
+ * normalized) over the ETC in dB, on a linear time axis with the arrival marked.
+ * All decimation is done by TFImpulseResponse's worker; this only maps columns to pixels.
+ */
+class ImpulseResponsePlotComponent : public juce::Component
+{
+public:
+    ImpulseResponsePlotComponent(TFImpulseResponse& impulseResponse);
+    ~ImpulseResponsePlotComponent() override;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    void lookAndFeelChanged() override;
+
+private:
+    // Static layer (background, title, grid, labels), rendered into staticLayer
+    void drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds);
+    juce::Rectangle<int> getGraphArea() const;
+    void rebuildCurves(juce::Rectangle<int> graphArea);
+    float timeToX(double timeMs, juce::Rectangle<int> graphArea) const;
+    float etcToY(float db, juce::Rectangle<int> graphArea) const;
+    float amplitudeToY(float amplitude, juce::Rectangle<int> graphArea) const;
+
+    TFImpulseResponse& impulseResponse;
+    TFImpulseResponse::Display display;
+
+    // Time axis of the current display; the static layer is re-rendered when it changes
+    double axisStartMs{0.0};
+    double axisEndMs{1.0};
+
+    CachedPlotLayer staticLayer{[this](juce::Graphics& g, juce::Rectangle<int> bounds) { drawStaticLayer(g, bounds); }};
+
+    // Cached curves (rebuilt on new data generation or resize)
+    juce::Path etcPath;
+    juce::Path irPath;
+    float arrivalX{-1.0f};
+    bool curveDirty{true};
+
+    static constexpr float minEtcDb = TFImpulseResponse::etcFloorDb;
+    static constexpr float maxEtcDb = 0.0f;
+
+    juce::Colour etcColour = juce::Colour(0xff4fc3f7);
+    juce::Colour irColour = juce::Colours::white;
+    juce::Colour arrivalColour = juce::Colours::orange;
+};
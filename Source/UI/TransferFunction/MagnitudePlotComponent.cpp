@@ -4,20 +4,205 @@
 MagnitudePlotComponent::MagnitudePlotComponent(TFProcessor& proc)
     : processor(proc)
 {
-    // Start timer for real-time updates (30Hz = 33ms for stable Smaart-like display)
-    // Reduced from 60Hz to avoid jitter and improve stability
-    startTimer(33);
+    // Refresh when the processor publishes new results, at most 30Hz for a stable Smaart-like display
+    FrameScheduler::getInstance().addClient(*this, {[this] { return processor.getOutputGeneration(); }},
+                                            [this]
+                                            {
+                                                curveDirty = true;
+                                                repaint();
+                                            },
+                                            30);
+    
+    // Curves built for OpenGL have no paths: rebuild them when falling back to software
+    glRenderer.onFallback = [this]
+    {
+        curveDirty = true;
+        overlaysDirty = true;
+        repaint();
+    };
+    glRenderer.attachTo(*this);
 }
 
 MagnitudePlotComponent::~MagnitudePlotComponent()
 {
-    stopTimer();
+    glRenderer.detach();
+    FrameScheduler::getInstance().removeClient(*this);
 }
 
 void MagnitudePlotComponent::paint(juce::Graphics& g)
 {
+    if (glRenderer.isActive())
+    {
+        paintWithOpenGL();
+        return;
+    }
+    
+    RenderStats::ScopedFrame frame(glRenderer.getStats(), RenderStats::Path::software);
+    
+    // Background, title, grid and labels come from the cached image
+    staticLayer.draw(g, getLocalBounds());
+    
+    // Stored traces first, so the live curve stays on top
+    if (overlaysDirty)
+        rebuildOverlays(getGraphArea());
+    
+    for (const auto& overlay : overlays)
+    {
+        for (const auto& segment : overlay.curveSegments)
+        {
+            g.setColour(overlay.colour.withAlpha(segment.alpha * 0.8f));
+            g.strokePath(segment.path, juce::PathStrokeType(1.5f));
+        }
+    }
+    
+    // Draw magnitude curve with coherence-based alpha (Smaart-style)
+    if (curveDirty)
+        rebuildCurve(getGraphArea());
+    
+    // Spread of the bins behind each pixel column (visible where many bins share a column)
+    g.setColour(graphColour.withAlpha(0.25f));
+    g.strokePath(envelopePath, juce::PathStrokeType(1.0f));
+    
+    for (const auto& segment : curveSegments)
+    {
+        g.setColour(graphColour.withAlpha(segment.alpha));
+        g.strokePath(segment.path, juce::PathStrokeType(2.5f));  // Thicker line
+    }
+}
+
+juce::Rectangle<int> MagnitudePlotComponent::getGraphArea() const
+{
+    // Must match the layout used by drawStaticLayer()
     auto bounds = getLocalBounds();
+    bounds.removeFromTop(25);
+    return bounds.reduced(40);
+}
+
+void MagnitudePlotComponent::rebuildCurve(juce::Rectangle<int> graphArea)
+{
+    curveDirty = false;
+    hasCurveData = false;
+    curveSegments.clear();
+    envelopePath.clear();
+    
+    // Get latest data: the log-frequency output when the processor publishes one, else the bins
+    if (!processor.getLogMagnitudeResponse(frequencies, magnitudeData, coherenceData))
+    {
+        processor.getMagnitudeResponse(magnitudeData);
+        processor.getFrequencyBins(frequencies);
+        processor.getCoherence(coherenceData);
+    }
+    
+    if (magnitudeData.size() < 2 || magnitudeData.size() != frequencies.size())
+        return;
+    
+    // Bin -> pixel column map only changes with width or frequency layout
+    if (decimator.needsPrepare(frequencies, graphArea.getWidth()))
+        decimator.prepare(frequencies, graphArea.getWidth(), minFrequency, maxFrequency);
+    
+    decimator.process(magnitudeData, coherenceData);
+    hasCurveData = true;
+    
+    // The OpenGL path draws straight from the columns, paths are only needed in software
+    if (glRenderer.isActive())
+        return;
     
+    const auto toY = makeValueToY(graphArea);
+    decimator.buildCurve(curveSegments, static_cast<float>(graphArea.getX()), toY);
+    decimator.buildEnvelope(envelopePath, static_cast<float>(graphArea.getX()), toY);
+}
+
+void MagnitudePlotComponent::setOverlays(std::vector<std::shared_ptr<const TFSnapshot>> snapshots)
+{
+    overlays.clear();
+    overlays.reserve(snapshots.size());
+    
+    for (auto& snapshot : snapshots)
+    {
+        if (snapshot == nullptr)
+            continue;
+        
+        Overlay overlay;
+        overlay.snapshot = std::move(snapshot);
+        overlay.colour = getOverlayColour(static_cast<int>(overlays.size()));
+        overlays.push_back(std::move(overlay));
+    }
+    
+    overlaysDirty = true;
+    repaint();
+}
+
+void MagnitudePlotComponent::rebuildOverlays(juce::Rectangle<int> graphArea)
+{
+    overlaysDirty = false;
+    const auto toY = makeValueToY(graphArea);
+    
+    for (auto& overlay : overlays)
+    {
+        // Decoded from the mapping column by column: no per-trace copy of the bins
+        const auto& snapshot = *overlay.snapshot;
+        const auto magnitude = snapshot.getTrack(TFSnapshot::Track::magnitude);
+        const auto coherence = snapshot.getTrack(TFSnapshot::Track::coherence);
+        
+        overlay.decimator.prepareLinear(snapshot.getNumBins(), snapshot.getBinFrequency(1), graphArea.getWidth(),
+                                        minFrequency, maxFrequency);
+        overlay.decimator.process(snapshot.getNumBins(), magnitude, coherence, true);
+        
+        overlay.curveSegments.clear();
+        if (!glRenderer.isActive())
+            overlay.decimator.buildCurve(overlay.curveSegments, static_cast<float>(graphArea.getX()), toY);
+    }
+}
+
+juce::Colour MagnitudePlotComponent::getOverlayColour(int index)
+{
+    static const juce::uint32 palette[] = {0xffff9800, 0xff4caf50, 0xffe91e63, 0xff00bcd4,
+                                           0xffcddc39, 0xff9c27b0, 0xffffeb3b, 0xff8d6e63};
+    return juce::Colour(palette[static_cast<size_t>(index) % (sizeof(palette) / sizeof(palette[0]))]);
+}
+
+PlotDecimator::ValueToY MagnitudePlotComponent::makeValueToY(juce::Rectangle<int> graphArea)
+{
+    const float top = static_cast<float>(graphArea.getY());
+    const float height = static_cast<float>(graphArea.getHeight());
+    return [this, top, height](float magnitudeDb) { return top + magnitudeToY(magnitudeDb, height); };
+}
+
+void MagnitudePlotComponent::paintWithOpenGL()
+{
+    // Nothing is painted here: the frame is described to the renderer, which draws it
+    // below this component's (transparent) painting
+    RenderStats::ScopedFrame frame(glRenderer.getStats(), RenderStats::Path::openGL, true);
+    
+    const auto bounds = getLocalBounds();
+    const auto graphArea = getGraphArea();
+    glRenderer.setBackground(staticLayer.getImage(bounds, glRenderer.getRenderingScale()), bounds,
+                             staticLayer.getVersion());
+    
+    if (overlaysDirty)
+        rebuildOverlays(graphArea);
+    
+    if (curveDirty)
+        rebuildCurve(graphArea);
+    
+    glScene.clear();
+    const auto toY = makeValueToY(graphArea);
+    const float left = static_cast<float>(graphArea.getX());
+    
+    for (const auto& overlay : overlays)
+        overlay.decimator.addCurveToScene(glScene, left, toY, overlay.colour.withAlpha(0.8f), 1.5f);
+    
+    if (hasCurveData)
+    {
+        decimator.addEnvelopeToScene(glScene, left, toY, graphColour.withAlpha(0.25f));
+        decimator.addCurveToScene(glScene, left, toY, graphColour, 2.5f);
+    }
+    
+    glRenderer.setScene(glScene, bounds);
+}
+
+void MagnitudePlotComponent::drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
     // Background
     g.setColour(juce::Colour(0xff1a1a1a));
     g.fillRect(bounds);
@@ -27,24 +212,6 @@ void MagnitudePlotComponent::paint(juce::Graphics& g)
     g.setFont(juce::Font(14.0f, juce::Font::bold));
     g.drawText("Magnitude Response", bounds.removeFromTop(25), juce::Justification::centredLeft);
     
-    // Draw graph
-    drawMagnitudeGraph(g, bounds);
-}
-
-void MagnitudePlotComponent::drawMagnitudeGraph(juce::Graphics& g, juce::Rectangle<int> bounds)
-{
-    // Get latest data
-    processor.getMagnitudeResponse(magnitudeData);
-    processor.getFrequencyBins(frequencies);
-    processor.getCoherence(coherenceData);
-    
-    if (magnitudeData.empty() || frequencies.empty() || magnitudeData.size() != frequencies.size())
-        return;
-    
-    // Ensure coherence data matches
-    if (coherenceData.size() != magnitudeData.size())
-        coherenceData.resize(magnitudeData.size(), 1.0f);
-    
     const float padding = 40.0f;
     auto graphArea = bounds.reduced(static_cast<int>(padding));
     float width = static_cast<float>(graphArea.getWidth());
@@ -104,129 +271,6 @@ void MagnitudePlotComponent::drawMagnitudeGraph(juce::Graphics& g, juce::Rectang
                    5, static_cast<int>(graphArea.getY() + y - 7), 35, 14,
                    juce::Justification::centredRight);
     }
-    
-    // TEMPORARY LOG: Verify 0 dB alignment
-    static int logCounter = 0;
-    logCounter++;
-    if (logCounter % 200 == 0)
-    {
-        float y0 = magnitudeToY(0.0f, height);
-        juce::Logger::writeToLog("PLOT Magnitude Y-axis: y0=" + juce::String(y0, 2) + 
-                                 " minDb=" + juce::String(minMagnitude, 1) + 
-                                 " maxDb=" + juce::String(maxMagnitude, 1) +
-                                 " stepDb=" + juce::String(stepDb, 1) +
-                                 " startDb=" + juce::String(startDb, 1));
-    }
-    
-    // Draw magnitude curve with coherence-based alpha (Smaart-style)
-    if (magnitudeData.size() < 2)
-        return;
-    
-    // Draw in segments based on coherence
-    juce::Path currentSegment;
-    bool segmentStarted = false;
-    
-    // DIAGNOSTIC: Find kPeak and k1k for logging
-    static int plotFrameCounter = 0;
-    plotFrameCounter++;
-    int kPeak = -1;
-    float vPeak = -9999.0f;
-    int k1k = -1;
-    for (size_t i = 0; i < magnitudeData.size(); ++i)
-    {
-        float freq = frequencies[i];
-        
-        // Track peak
-        if (freq >= 20.0f && freq <= 20000.0f && magnitudeData[i] > vPeak)
-        {
-            vPeak = magnitudeData[i];
-            kPeak = static_cast<int>(i);
-        }
-        
-        // Find bin closest to 1kHz
-        if (k1k < 0 && freq >= 1000.0f)
-        {
-            k1k = static_cast<int>(i);
-        }
-    }
-    
-    // Log plot diagnostics (every 200 frames to avoid spam)
-    if (kPeak >= 0 && plotFrameCounter % 200 == 0)
-    {
-        float peakFreq = (kPeak < static_cast<int>(frequencies.size())) ? frequencies[kPeak] : 0.0f;
-        float peakX = frequencyToX(peakFreq, width, minFrequency, maxFrequency);
-        float freq1k = (k1k >= 0 && k1k < static_cast<int>(frequencies.size())) ? frequencies[k1k] : 0.0f;
-        float x1k = (k1k >= 0) ? frequencyToX(freq1k, width, minFrequency, maxFrequency) : 0.0f;
-        
-        juce::Logger::writeToLog("PLOT Magnitude: kPeak=" + juce::String(kPeak) +
-                                 " freqPeak=" + juce::String(peakFreq, 2) + " Hz" +
-                                 " xPeak=" + juce::String(peakX, 2) +
-                                 " | k1k=" + juce::String(k1k) +
-                                 " freq1k=" + juce::String(freq1k, 2) + " Hz" +
-                                 " x1k=" + juce::String(x1k, 2) +
-                                 " | dataSize=" + juce::String(magnitudeData.size()));
-    }
-    
-    for (size_t i = 0; i < magnitudeData.size(); ++i)
-    {
-        float freq = frequencies[i];
-        if (freq < minFrequency || freq > maxFrequency)
-            continue;
-        
-        float coh = (i < coherenceData.size()) ? coherenceData[i] : 1.0f;
-        
-        // Calculate alpha based on coherence (Smaart-style)
-        // alpha = clamp((coh - 0.5)/0.5, 0, 1)
-        float alpha = juce::jlimit(0.0f, 1.0f, (coh - 0.5f) / 0.5f);
-        
-        // Skip points with very low coherence (almost invisible)
-        if (alpha < 0.1f)
-        {
-            // Break path segment
-            if (segmentStarted)
-            {
-                g.setColour(graphColour.withAlpha(0.3f));
-                g.strokePath(currentSegment, juce::PathStrokeType(1.5f));
-                currentSegment.clear();
-                segmentStarted = false;
-            }
-            continue;
-        }
-        
-        float x = frequencyToX(freq, width, minFrequency, maxFrequency);
-        float y = magnitudeToY(magnitudeData[i], height);
-        
-        float graphX = padding + x;
-        float graphY = graphArea.getY() + y;
-        
-        if (!segmentStarted)
-        {
-            currentSegment.startNewSubPath(graphX, graphY);
-            segmentStarted = true;
-        }
-        else
-        {
-            currentSegment.lineTo(graphX, graphY);
-        }
-        
-        // Draw segment when coherence changes significantly or at end
-        if (i == magnitudeData.size() - 1 || 
-            (i > 0 && std::abs(alpha - juce::jlimit(0.0f, 1.0f, (coherenceData[i-1] - 0.5f) / 0.5f)) > 0.3f))
-        {
-            // Stronger color with thicker line (2.5px instead of 1.5px)
-            g.setColour(graphColour.withAlpha(0.5f + alpha * 0.5f));  // Range: 0.5 to 1.0 (stronger)
-            g.strokePath(currentSegment, juce::PathStrokeType(2.5f));  // Thicker line
-            currentSegment.clear();
-            segmentStarted = false;
-        }
-    }
-    
-    // Draw final segment if any
-    if (segmentStarted)
-    {
-        g.setColour(graphColour);  // Full intensity for final segment
-        g.strokePath(currentSegment, juce::PathStrokeType(2.5f));  // Thicker line
-    }
 }
 
 float MagnitudePlotComponent::frequencyToX(float frequency, float width, float minFreq, float maxFreq)
@@ -248,32 +292,14 @@ float MagnitudePlotComponent::magnitudeToY(float magnitudeDb, float height)
 
 void MagnitudePlotComponent::resized()
 {
+    // staticLayer notices the new size by itself
+    curveDirty = true;
+    overlaysDirty = true;
     repaint();
 }
 
-void MagnitudePlotComponent::timerCallback()
+void MagnitudePlotComponent::lookAndFeelChanged()
 {
-    // Only repaint if visible (optimized for real-time performance)
-    if (!isVisible())
-    {
-        stopTimer();
-        return;
-    }
-    
-    // Repaint for real-time updates (60Hz = smooth Smaart-like display)
+    staticLayer.invalidate();
     repaint();
 }
-
-void MagnitudePlotComponent::visibilityChanged()
-{
-    if (isVisible())
-    {
-        if (!isTimerRunning())
-            startTimer(33);  // ~30Hz (33ms) for stable real-time display
-    }
-    else
-    {
-        if (isTimerRunning())
-            stopTimer();
-    }
-}
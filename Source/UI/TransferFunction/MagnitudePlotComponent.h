@@ -2,15 +2,23 @@
 
 #include "../../JuceHeader.h"
 #include "../../Core/TransferFunction/TFProcessor.h"
+#include "../../Core/TransferFunction/TFSnapshotStore.h"
+#include "PlotDecimator.h"
+#include "../CachedPlotLayer.h"
+#include "../FrameScheduler.h"
+#include "../GLPlotRenderer.h"
 
 /**
  * MagnitudePlotComponent
  * 
  * Displays magnitude response of transfer function.
  * Blue graph with logarithmic frequency axis.
+ * The curve is decimated to one point per pixel column and only rebuilt when
+ * the processor publishes new data (or the size changes).
+ * Stored snapshots can be overlaid; they are decimated straight from their file
+ * mappings and only rebuilt when the overlay list or the size changes.
  */
-class MagnitudePlotComponent : public juce::Component,
-                               public juce::Timer
+class MagnitudePlotComponent : public juce::Component
 {
 public:
     MagnitudePlotComponent(TFProcessor& processor);
@@ -18,12 +26,29 @@ public:
     
     void paint(juce::Graphics& g) override;
     void resized() override;
-    void visibilityChanged() override;
+    void lookAndFeelChanged() override;
     
-    void timerCallback() override;
+    // Snapshots drawn under the live curve, each in its own colour (message thread)
+    void setOverlays(std::vector<std::shared_ptr<const TFSnapshot>> snapshots);
+    int getNumOverlays() const { return static_cast<int>(overlays.size()); }
+    static juce::Colour getOverlayColour(int index);
     
 private:
-    void drawMagnitudeGraph(juce::Graphics& g, juce::Rectangle<int> bounds);
+    struct Overlay
+    {
+        std::shared_ptr<const TFSnapshot> snapshot;
+        PlotDecimator decimator;
+        std::vector<PlotDecimator::CurveSegment> curveSegments;
+        juce::Colour colour;
+    };
+    
+    void rebuildOverlays(juce::Rectangle<int> graphArea);
+    // Static layer (background, title, grid, labels), rendered into staticLayer
+    void drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds);
+    juce::Rectangle<int> getGraphArea() const;
+    void rebuildCurve(juce::Rectangle<int> graphArea);
+    PlotDecimator::ValueToY makeValueToY(juce::Rectangle<int> graphArea);
+    void paintWithOpenGL();
     float frequencyToX(float frequency, float width, float minFreq, float maxFreq);
     float magnitudeToY(float magnitudeDb, float height);
     
@@ -33,6 +58,23 @@ private:
     std::vector<float> magnitudeData;
     std::vector<float> coherenceData;  // For coherence-based rendering
     
+    // Grid and labels are only re-rendered on resize, language or look-and-feel change
+    CachedPlotLayer staticLayer{[this](juce::Graphics& g, juce::Rectangle<int> bounds) { drawStaticLayer(g, bounds); }};
+    
+    // Cached curve (rebuilt on new data generation or resize)
+    PlotDecimator decimator;
+    std::vector<PlotDecimator::CurveSegment> curveSegments;
+    juce::Path envelopePath;
+    bool curveDirty{true};
+    bool hasCurveData{false};
+    
+    std::vector<Overlay> overlays;
+    bool overlaysDirty{false};
+    
+    // Optional OpenGL path (software painting whenever it is not active)
+    GLPlotRenderer glRenderer{"MagnitudePlot"};
+    GLPlotRenderer::Scene glScene;
+    
     static constexpr float minFrequency = 20.0f;
     static constexpr float maxFrequency = 20000.0f;
     static constexpr float minMagnitude = -18.0f;  // Smaart-like range
@@ -4,20 +4,124 @@
 PhasePlotComponent::PhasePlotComponent(TFProcessor& proc)
     : processor(proc)
 {
-    // Start timer for real-time updates (30Hz = 33ms for stable Smaart-like display)
-    // Reduced from 60Hz to avoid jitter and improve stability
-    startTimer(33);
+    // Refresh when the processor publishes new results, at most 30Hz for a stable Smaart-like display
+    FrameScheduler::getInstance().addClient(*this, {[this] { return processor.getOutputGeneration(); }},
+                                            [this]
+                                            {
+                                                curveDirty = true;
+                                                repaint();
+                                            },
+                                            30);
+    
+    // Curves built for OpenGL have no paths: rebuild them when falling back to software
+    glRenderer.onFallback = [this]
+    {
+        curveDirty = true;
+        repaint();
+    };
+    glRenderer.attachTo(*this);
 }
 
 PhasePlotComponent::~PhasePlotComponent()
 {
-    stopTimer();
+    glRenderer.detach();
+    FrameScheduler::getInstance().removeClient(*this);
 }
 
 void PhasePlotComponent::paint(juce::Graphics& g)
 {
+    if (glRenderer.isActive())
+    {
+        paintWithOpenGL();
+        return;
+    }
+    
+    RenderStats::ScopedFrame frame(glRenderer.getStats(), RenderStats::Path::software);
+    
+    // Background, title, grid and labels come from the cached image
+    staticLayer.draw(g, getLocalBounds());
+    
+    // Draw phase curve with coherence-based alpha (Smaart-style)
+    if (curveDirty)
+        rebuildCurve(getGraphArea());
+    
+    for (const auto& segment : curveSegments)
+    {
+        g.setColour(graphColour.withAlpha(segment.alpha));
+        g.strokePath(segment.path, juce::PathStrokeType(2.5f));  // Thicker line
+    }
+}
+
+juce::Rectangle<int> PhasePlotComponent::getGraphArea() const
+{
+    // Must match the layout used by drawStaticLayer()
     auto bounds = getLocalBounds();
+    bounds.removeFromTop(25);
+    return bounds.reduced(40);
+}
+
+void PhasePlotComponent::rebuildCurve(juce::Rectangle<int> graphArea)
+{
+    curveDirty = false;
+    hasCurveData = false;
+    curveSegments.clear();
+    
+    // Get latest data: the log-frequency output when the processor publishes one, else the bins
+    if (!processor.getLogPhaseResponse(frequencies, phaseData, coherenceData))
+    {
+        processor.getPhaseResponse(phaseData);
+        processor.getFrequencyBins(frequencies);
+        processor.getCoherence(coherenceData);
+    }
     
+    if (phaseData.size() < 2 || phaseData.size() != frequencies.size())
+        return;
+    
+    // Bin -> pixel column map only changes with width or frequency layout
+    if (decimator.needsPrepare(frequencies, graphArea.getWidth()))
+        decimator.prepare(frequencies, graphArea.getWidth(), minFrequency, maxFrequency);
+    
+    // Circular mean: columns that straddle the +-180 wrap must not average to ~0
+    decimator.process(phaseData, coherenceData, PlotDecimator::Mean::circularDegrees);
+    hasCurveData = true;
+    
+    // The OpenGL path draws straight from the columns, paths are only needed in software
+    if (glRenderer.isActive())
+        return;
+    
+    // No min/max envelope here: a wrap inside a column would draw a full-height bar
+    decimator.buildCurve(curveSegments, static_cast<float>(graphArea.getX()), makeValueToY(graphArea));
+}
+
+PlotDecimator::ValueToY PhasePlotComponent::makeValueToY(juce::Rectangle<int> graphArea)
+{
+    const float top = static_cast<float>(graphArea.getY());
+    const float height = static_cast<float>(graphArea.getHeight());
+    return [this, top, height](float phase) { return top + phaseToY(phase, height); };
+}
+
+void PhasePlotComponent::paintWithOpenGL()
+{
+    // Nothing is painted here: the frame is described to the renderer (see MagnitudePlotComponent)
+    RenderStats::ScopedFrame frame(glRenderer.getStats(), RenderStats::Path::openGL, true);
+    
+    const auto bounds = getLocalBounds();
+    const auto graphArea = getGraphArea();
+    glRenderer.setBackground(staticLayer.getImage(bounds, glRenderer.getRenderingScale()), bounds,
+                             staticLayer.getVersion());
+    
+    if (curveDirty)
+        rebuildCurve(graphArea);
+    
+    glScene.clear();
+    if (hasCurveData)
+        decimator.addCurveToScene(glScene, static_cast<float>(graphArea.getX()), makeValueToY(graphArea), graphColour, 2.5f);
+    
+    glRenderer.setScene(glScene, bounds);
+}
+
+void PhasePlotComponent::drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
     // Background
     g.setColour(juce::Colour(0xff1a1a1a));
     g.fillRect(bounds);
@@ -27,24 +131,6 @@ void PhasePlotComponent::paint(juce::Graphics& g)
     g.setFont(juce::Font(14.0f, juce::Font::bold));
     g.drawText("Phase Response", bounds.removeFromTop(25), juce::Justification::centredLeft);
     
-    // Draw graph
-    drawPhaseGraph(g, bounds);
-}
-
-void PhasePlotComponent::drawPhaseGraph(juce::Graphics& g, juce::Rectangle<int> bounds)
-{
-    // Get latest data
-    processor.getPhaseResponse(phaseData);
-    processor.getFrequencyBins(frequencies);
-    processor.getCoherence(coherenceData);
-    
-    if (phaseData.empty() || frequencies.empty() || phaseData.size() != frequencies.size())
-        return;
-    
-    // Ensure coherence data matches
-    if (coherenceData.size() != phaseData.size())
-        coherenceData.resize(phaseData.size(), 1.0f);
-    
     const float padding = 40.0f;
     auto graphArea = bounds.reduced(static_cast<int>(padding));
     float width = static_cast<float>(graphArea.getWidth());
@@ -99,75 +185,6 @@ void PhasePlotComponent::drawPhaseGraph(juce::Graphics& g, juce::Rectangle<int>
                    5, static_cast<int>(graphArea.getY() + y - 7), 35, 14,
                    juce::Justification::centredRight);
     }
-    
-    // Draw phase curve with coherence-based alpha (Smaart-style)
-    if (phaseData.size() < 2)
-        return;
-    
-    // Draw in segments based on coherence
-    juce::Path currentSegment;
-    bool segmentStarted = false;
-    
-    for (size_t i = 0; i < phaseData.size(); ++i)
-    {
-        float freq = frequencies[i];
-        if (freq < minFrequency || freq > maxFrequency)
-            continue;
-        
-        float coh = (i < coherenceData.size()) ? coherenceData[i] : 1.0f;
-        
-        // Calculate alpha based on coherence (Smaart-style)
-        // alpha = clamp((coh - 0.5)/0.5, 0, 1)
-        float alpha = juce::jlimit(0.0f, 1.0f, (coh - 0.5f) / 0.5f);
-        
-        // Skip points with very low coherence (almost invisible)
-        if (alpha < 0.1f)
-        {
-            // Break path segment
-            if (segmentStarted)
-            {
-                g.setColour(graphColour.withAlpha(0.4f));
-                g.strokePath(currentSegment, juce::PathStrokeType(2.5f));  // Thicker line
-                currentSegment.clear();
-                segmentStarted = false;
-            }
-            continue;
-        }
-        
-        float x = frequencyToX(freq, width, minFrequency, maxFrequency);
-        float y = phaseToY(phaseData[i], height);
-        
-        float graphX = padding + x;
-        float graphY = graphArea.getY() + y;
-        
-        if (!segmentStarted)
-        {
-            currentSegment.startNewSubPath(graphX, graphY);
-            segmentStarted = true;
-        }
-        else
-        {
-            currentSegment.lineTo(graphX, graphY);
-        }
-        
-        // Draw segment when coherence changes significantly or at end
-        if (i == phaseData.size() - 1 || 
-            (i > 0 && std::abs(alpha - juce::jlimit(0.0f, 1.0f, (coherenceData[i-1] - 0.5f) / 0.5f)) > 0.3f))
-        {
-            // Stronger color with thicker line (2.5px instead of 1.5px)
-            g.setColour(graphColour.withAlpha(0.5f + alpha * 0.5f));  // Range: 0.5 to 1.0 (stronger)
-            g.strokePath(currentSegment, juce::PathStrokeType(2.5f));  // Thicker line
-            currentSegment.clear();
-            segmentStarted = false;
-        }
-    }
-    
-    // Draw final segment if any
-    if (segmentStarted)
-    {
-        g.setColour(graphColour);  // Full intensity for final segment
-        g.strokePath(currentSegment, juce::PathStrokeType(2.5f));  // Thicker line
-    }
 }
 
 float PhasePlotComponent::frequencyToX(float frequency, float width, float minFreq, float maxFreq)
@@ -189,32 +206,13 @@ float PhasePlotComponent::phaseToY(float phaseDegrees, float height)
 
 void PhasePlotComponent::resized()
 {
+    // staticLayer notices the new size by itself
+    curveDirty = true;
     repaint();
 }
 
-void PhasePlotComponent::timerCallback()
+void PhasePlotComponent::lookAndFeelChanged()
 {
-    // Only repaint if visible (optimized for real-time performance)
-    if (!isVisible())
-    {
-        stopTimer();
-        return;
-    }
-    
-    // Repaint for real-time updates (60Hz = smooth Smaart-like display)
+    staticLayer.invalidate();
     repaint();
 }
-
-void PhasePlotComponent::visibilityChanged()
-{
-    if (isVisible())
-    {
-        if (!isTimerRunning())
-            startTimer(33);  // ~30Hz (33ms) for stable real-time display
-    }
-    else
-    {
-        if (isTimerRunning())
-            stopTimer();
-    }
-}
@@ -2,15 +2,19 @@
 
 #include "../../JuceHeader.h"
 #include "../../Core/TransferFunction/TFProcessor.h"
+#include "PlotDecimator.h"
+#include "../CachedPlotLayer.h"
+#include "../FrameScheduler.h"
+#include "../GLPlotRenderer.h"
 
 /**
  * PhasePlotComponent
  * 
  * Displays phase response of transfer function.
  * Red graph with logarithmic frequency axis.
+ * Uses the same per-pixel-column decimation and cached curve as MagnitudePlotComponent.
  */
-class PhasePlotComponent : public juce::Component,
-                           public juce::Timer
+class PhasePlotComponent : public juce::Component
 {
 public:
     PhasePlotComponent(TFProcessor& processor);
@@ -18,12 +22,15 @@ public:
     
     void paint(juce::Graphics& g) override;
     void resized() override;
-    void visibilityChanged() override;
-    
-    void timerCallback() override;
+    void lookAndFeelChanged() override;
     
 private:
-    void drawPhaseGraph(juce::Graphics& g, juce::Rectangle<int> bounds);
+    // Static layer (background, title, grid, labels), rendered into staticLayer
+    void drawStaticLayer(juce::Graphics& g, juce::Rectangle<int> bounds);
+    juce::Rectangle<int> getGraphArea() const;
+    void rebuildCurve(juce::Rectangle<int> graphArea);
+    PlotDecimator::ValueToY makeValueToY(juce::Rectangle<int> graphArea);
+    void paintWithOpenGL();
     float frequencyToX(float frequency, float width, float minFreq, float maxFreq);
     float phaseToY(float phaseDegrees, float height);
     
@@ -33,6 +40,19 @@ private:
     std::vector<float> phaseData;
     std::vector<float> coherenceData;  // For coherence-based rendering
     
+    // Grid and labels are only re-rendered on resize, language or look-and-feel change
+    CachedPlotLayer staticLayer{[this](juce::Graphics& g, juce::Rectangle<int> bounds) { drawStaticLayer(g, bounds); }};
+    
+    // Cached curve (rebuilt on new data generation or resize)
+    PlotDecimator decimator;
+    std::vector<PlotDecimator::CurveSegment> curveSegments;
+    bool curveDirty{true};
+    bool hasCurveData{false};
+    
+    // Optional OpenGL path (software painting whenever it is not active)
+    GLPlotRenderer glRenderer{"PhasePlot"};
+    GLPlotRenderer::Scene glScene;
+    
     static constexpr float minFrequency = 20.0f;
     static constexpr float maxFrequency = 20000.0f;
     static constexpr float minPhase = -180.0f;
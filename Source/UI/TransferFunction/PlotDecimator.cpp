@@ -0,0 +1,186 @@
+#include "PlotDecimator.h"
+#include <cmath>
+
+template <typename FrequencyAt>
+void PlotDecimator::prepareRanges(int numBins, FrequencyAt frequencyAt, int numColumns, float minFreq, float maxFreq)
+{
+    numColumns = juce::jmax(0, numColumns);
+    ranges.assign(static_cast<size_t>(numColumns), {});
+    columns.assign(static_cast<size_t>(numColumns), {});
+
+    if (numColumns == 0 || numBins <= 0 || minFreq <= 0.0f || maxFreq <= minFreq)
+        return;
+
+    const float logMin = std::log10(minFreq);
+    const float scale = static_cast<float>(numColumns) / (std::log10(maxFreq) - logMin);
+
+    // Walk the bins once; columns receive contiguous, increasing bin ranges
+    int currentColumn = -1;
+    for (int i = 0; i < numBins; ++i)
+    {
+        const float freq = frequencyAt(i);
+        if (freq < minFreq || freq > maxFreq)
+            continue;
+
+        const int column = juce::jlimit(0, numColumns - 1, static_cast<int>((std::log10(freq) - logMin) * scale));
+        if (column != currentColumn)
+        {
+            ranges[static_cast<size_t>(column)].startBin = i;
+            currentColumn = column;
+        }
+        ranges[static_cast<size_t>(column)].endBin = i + 1;
+    }
+}
+
+void PlotDecimator::prepare(const std::vector<float>& frequencies, int numColumns, float minFreq, float maxFreq)
+{
+    preparedBins = frequencies.size();
+    preparedTopFrequency = frequencies.empty() ? 0.0f : frequencies.back();
+    prepareRanges(static_cast<int>(frequencies.size()), [&frequencies](int i) { return frequencies[static_cast<size_t>(i)]; },
+                  numColumns, minFreq, maxFreq);
+}
+
+void PlotDecimator::prepareLinear(int numBins, float binWidth, int numColumns, float minFreq, float maxFreq)
+{
+    numBins = juce::jmax(0, numBins);
+    preparedBins = static_cast<size_t>(numBins);
+    preparedTopFrequency = numBins > 0 ? static_cast<float>(numBins - 1) * binWidth : 0.0f;
+    prepareRanges(numBins, [binWidth](int i) { return static_cast<float>(i) * binWidth; }, numColumns, minFreq, maxFreq);
+}
+
+bool PlotDecimator::needsPrepare(const std::vector<float>& frequencies, int numColumns) const
+{
+    const float topFrequency = frequencies.empty() ? 0.0f : frequencies.back();
+    return frequencies.size() != preparedBins || topFrequency != preparedTopFrequency
+        || numColumns != getNumColumns();
+}
+
+void PlotDecimator::process(const std::vector<float>& values, const std::vector<float>& coherence, Mean mean)
+{
+    process(static_cast<int>(values.size()), values.data(), coherence.data(), coherence.size() == values.size(), mean);
+}
+
+void PlotDecimator::buildCurve(std::vector<CurveSegment>& segments, float left, const ValueToY& valueToY,
+                               float minAlpha, float alphaStep) const
+{
+    segments.clear();
+
+    CurveSegment current;
+    bool segmentStarted = false;
+    float alphaSum = 0.0f;
+    int points = 0;
+    float previousAlpha = 0.0f;
+    juce::Point<float> previousPoint;
+
+    auto finishSegment = [&]
+    {
+        if (segmentStarted && points > 1)
+        {
+            // Stronger colour for coherent segments: range 0.5 to 1.0
+            current.alpha = 0.5f + 0.5f * (alphaSum / static_cast<float>(points));
+            segments.push_back(std::move(current));
+        }
+        current = CurveSegment();
+        segmentStarted = false;
+        alphaSum = 0.0f;
+        points = 0;
+    };
+
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+        const auto& column = columns[c];
+        if (!column.valid)
+            continue;  // no bin here: the line simply continues to the next column with data
+
+        const float alpha = coherenceToAlpha(column.coherence);
+
+        // Skip points with very low coherence (break the curve)
+        if (alpha < minAlpha)
+        {
+            finishSegment();
+            continue;
+        }
+
+        const juce::Point<float> point(left + static_cast<float>(c) + 0.5f, valueToY(column.mean));
+
+        // Coherence jumped: start a new segment from the previous point, so the curve stays continuous
+        if (segmentStarted && std::abs(alpha - previousAlpha) > alphaStep)
+        {
+            finishSegment();
+            current.path.startNewSubPath(previousPoint);
+            segmentStarted = true;
+            alphaSum = previousAlpha;
+            points = 1;
+        }
+
+        if (!segmentStarted)
+        {
+            current.path.startNewSubPath(point);
+            segmentStarted = true;
+        }
+        else
+        {
+            current.path.lineTo(point);
+        }
+
+        alphaSum += alpha;
+        ++points;
+        previousAlpha = alpha;
+        previousPoint = point;
+    }
+
+    finishSegment();
+}
+
+void PlotDecimator::buildEnvelope(juce::Path& envelope, float left, const ValueToY& valueToY) const
+{
+    envelope.clear();
+
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+        const auto& column = columns[c];
+        if (!column.valid)
+            continue;
+
+        const float yMax = valueToY(column.maxValue);
+        const float yMin = valueToY(column.minValue);
+        if (std::abs(yMin - yMax) < 1.5f)
+            continue;
+
+        const float x = left + static_cast<float>(c) + 0.5f;
+        envelope.startNewSubPath(x, yMax);
+        envelope.lineTo(x, yMin);
+    }
+}
+
+void PlotDecimator::addCurveToScene(GLPlotRenderer::Scene& scene, float left, const ValueToY& valueToY,
+                                    juce::Colour colour, float lineWidth) const
+{
+    scene.beginLineStrip(colour, lineWidth, true);
+
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+        const auto& column = columns[c];
+        if (column.valid)
+            scene.addPoint(left + static_cast<float>(c) + 0.5f, valueToY(column.mean), column.coherence);
+    }
+}
+
+void PlotDecimator::addEnvelopeToScene(GLPlotRenderer::Scene& scene, float left, const ValueToY& valueToY,
+                                       juce::Colour colour) const
+{
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+        const auto& column = columns[c];
+        if (!column.valid)
+            continue;
+
+        const float yMax = valueToY(column.maxValue);
+        const float yMin = valueToY(column.minValue);
+        if (std::abs(yMin - yMax) < 1.5f)
+            continue;
+
+        const float x = left + static_cast<float>(c) + 0.5f;
+        scene.addLine({x, yMax}, {x, yMin}, colour);
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../GLPlotRenderer.h"
+#include <cmath>
+#include <functional>
+#include <vector>
+
+/**
+ * PlotDecimator
+ *
+ * Reduces a linear-bin spectrum (e.g. 8193 bins) to one point per pixel column
+ * of a log-frequency plot, so drawing cost scales with widget width, not FFT size.
+ *
+ * - prepare(): builds the bin -> pixel column map (call on resize or when the
+ *   frequency layout changes). Bins are monotonic, so each column is a contiguous
+ *   bin range and no log10 is needed per bin afterwards.
+ * - process(): one pass over the data, min/max/mean + mean coherence per column. Phase
+ *   (wrapped to +-180 degrees) takes Mean::circularDegrees: the arithmetic mean of a
+ *   column that straddles a wrap would land near 0.
+ * - buildCurve()/buildEnvelope(): turn the columns into paths, split into
+ *   coherence segments (Smaart-style alpha), for the caller to cache and stroke.
+ * - addCurveToScene()/addEnvelopeToScene(): the same for GLPlotRenderer, where the
+ *   coherence segmentation is done by the shader.
+ */
+class PlotDecimator
+{
+public:
+    struct Column
+    {
+        float minValue{0.0f};
+        float maxValue{0.0f};
+        float mean{0.0f};
+        float coherence{0.0f};
+        bool valid{false};  // false when no bin falls into this column
+    };
+
+    // One stroke of the curve with a single colour alpha
+    struct CurveSegment
+    {
+        juce::Path path;
+        float alpha{1.0f};
+    };
+
+    // How process() averages a column's values
+    enum class Mean
+    {
+        arithmetic,
+        circularDegrees  // angle of the sum of unit phasors, weighted by coherence
+    };
+
+    using ValueToY = std::function<float(float)>;
+
+    // Build the bin -> column map for numColumns pixels covering [minFreq, maxFreq] (log scale)
+    void prepare(const std::vector<float>& frequencies, int numColumns, float minFreq, float maxFreq);
+
+    // Same for linear FFT bins (bin * binWidth), without a frequency table (stored snapshots)
+    void prepareLinear(int numBins, float binWidth, int numColumns, float minFreq, float maxFreq);
+
+    // True if prepare() must run again for this layout (bin count, top bin frequency or width changed)
+    bool needsPrepare(const std::vector<float>& frequencies, int numColumns) const;
+
+    // Reduce values (+ optional coherence, same size) to columns
+    void process(const std::vector<float>& values, const std::vector<float>& coherence, Mean mean = Mean::arithmetic);
+
+    // Same for any source indexable with [] (e.g. a snapshot track decoded from a mapping)
+    template <typename Values, typename Coherence>
+    void process(int numValues, const Values& values, const Coherence& coherence, bool hasCoherence,
+                 Mean mean = Mean::arithmetic)
+    {
+        constexpr float degreesToRadians = juce::MathConstants<float>::pi / 180.0f;
+        const bool circular = mean == Mean::circularDegrees;
+
+        for (size_t c = 0; c < ranges.size(); ++c)
+        {
+            const auto& range = ranges[c];
+            auto& column = columns[c];
+            const int end = juce::jmin(range.endBin, numValues);
+
+            column.valid = range.startBin < end;
+            if (!column.valid)
+                continue;
+
+            float minValue = values[range.startBin];
+            float maxValue = minValue;
+            float sum = 0.0f;
+            float cohSum = 0.0f;
+            float sumRe = 0.0f, sumIm = 0.0f;          // circular: weighted phasors
+            float plainRe = 0.0f, plainIm = 0.0f;      // unweighted, if every weight is 0
+
+            for (int i = range.startBin; i < end; ++i)
+            {
+                const float v = values[i];
+                const float coh = hasCoherence ? coherence[i] : 1.0f;
+                minValue = juce::jmin(minValue, v);
+                maxValue = juce::jmax(maxValue, v);
+                sum += v;
+                cohSum += coh;
+
+                if (circular)
+                {
+                    const float re = std::cos(v * degreesToRadians);
+                    const float im = std::sin(v * degreesToRadians);
+                    sumRe += coh * re;
+                    sumIm += coh * im;
+                    plainRe += re;
+                    plainIm += im;
+                }
+            }
+
+            const float count = static_cast<float>(end - range.startBin);
+            column.minValue = minValue;
+            column.maxValue = maxValue;
+            column.coherence = cohSum / count;
+
+            if (!circular)
+                column.mean = sum / count;
+            else if (sumRe != 0.0f || sumIm != 0.0f)
+                column.mean = std::atan2(sumIm, sumRe) / degreesToRadians;
+            else
+                column.mean = std::atan2(plainIm, plainRe) / degreesToRadians;
+        }
+    }
+
+    const std::vector<Column>& getColumns() const { return columns; }
+    int getNumColumns() const { return static_cast<int>(columns.size()); }
+
+    // Mean curve, split where coherence (alpha) changes by more than alphaStep;
+    // columns below minAlpha break the curve. x = left + column + 0.5
+    void buildCurve(std::vector<CurveSegment>& segments, float left, const ValueToY& valueToY,
+                    float minAlpha = 0.1f, float alphaStep = 0.3f) const;
+
+    // Vertical min..max strokes for columns that hold more than one pixel of spread
+    void buildEnvelope(juce::Path& envelope, float left, const ValueToY& valueToY) const;
+
+    // Mean curve as one line strip with per-point coherence (shader applies alpha and the minAlpha cut)
+    void addCurveToScene(GLPlotRenderer::Scene& scene, float left, const ValueToY& valueToY,
+                         juce::Colour colour, float lineWidth) const;
+
+    // buildEnvelope() as line segments
+    void addEnvelopeToScene(GLPlotRenderer::Scene& scene, float left, const ValueToY& valueToY, juce::Colour colour) const;
+
+    // Smaart-style coherence to alpha: clamp((coh - 0.5) / 0.5, 0, 1)
+    static float coherenceToAlpha(float coherence) { return juce::jlimit(0.0f, 1.0f, (coherence - 0.5f) / 0.5f); }
+
+private:
+    struct ColumnRange
+    {
+        int startBin{0};
+        int endBin{0};  // exclusive
+    };
+
+    template <typename FrequencyAt>
+    void prepareRanges(int numBins, FrequencyAt frequencyAt, int numColumns, float minFreq, float maxFreq);
+
+    std::vector<ColumnRange> ranges;
+    std::vector<Column> columns;
+    size_t preparedBins{0};
+    float preparedTopFrequency{0.0f};
+};
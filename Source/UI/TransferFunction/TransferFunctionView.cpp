@@ -1,8 +1,13 @@
 #include "TransferFunctionView.h"
 #include "PhasePlotComponent.h"
 #include "MagnitudePlotComponent.h"
+#include "ImpulseResponsePlotComponent.h"
 #include "TFAutoSuggestionsComponent.h"
+#include "../SpectrogramComponent.h"
 #include "../../Localization/LocalizedStrings.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 
 TransferFunctionView::TransferFunctionView(TFController& ctrl)
     : controller(ctrl)
@@ -45,6 +50,48 @@ TransferFunctionView::TransferFunctionView(TFController& ctrl)
     magnitudePlot = std::make_unique<MagnitudePlotComponent>(controller.getProcessor());
     addAndMakeVisible(magnitudePlot.get());
     
+    // Waterfall (TF magnitude history kept by the processor, shown on demand)
+    waterfall = std::make_unique<SpectrogramComponent>("Magnitude waterfall", SpectrogramComponent::Orientation::waterfall);
+    waterfall->setSource(&controller.getProcessor().getMagnitudeHistory());
+    addChildComponent(waterfall.get());
+    
+    waterfallToggle = std::make_unique<juce::ToggleButton>("Waterfall");
+    waterfallToggle->setColour(juce::ToggleButton::textColourId, juce::Colours::lightgrey);
+    waterfallToggle->onClick = [this]
+    {
+        waterfall->setVisible(waterfallToggle->getToggleState());
+        resized();
+    };
+    addAndMakeVisible(waterfallToggle.get());
+    
+    // Impulse response (inverse FFT of the averaged H1, only computed while shown)
+    impulseResponsePlot = std::make_unique<ImpulseResponsePlotComponent>(controller.getImpulseResponse());
+    addChildComponent(impulseResponsePlot.get());
+    
+    impulseResponseToggle = std::make_unique<juce::ToggleButton>("IR");
+    impulseResponseToggle->setColour(juce::ToggleButton::textColourId, juce::Colours::lightgrey);
+    impulseResponseToggle->onClick = [this]
+    {
+        const bool show = impulseResponseToggle->getToggleState();
+        controller.setImpulseResponseEnabled(show);
+        impulseResponsePlot->setVisible(show);
+        resized();
+    };
+    addAndMakeVisible(impulseResponseToggle.get());
+    
+    // Snapshots: store the live result, overlay stored ones
+    snapshotButton = std::make_unique<juce::TextButton>("Snapshot");
+    snapshotButton->onClick = [this] { saveSnapshot(); };
+    addAndMakeVisible(snapshotButton.get());
+    
+    overlaysButton = std::make_unique<juce::TextButton>("Overlays");
+    overlaysButton->onClick = [this] { showOverlayMenu(); };
+    addAndMakeVisible(overlaysButton.get());
+    
+    analysisButton = std::make_unique<juce::TextButton>("Analysis");
+    analysisButton->onClick = [this] { showAnalysisMenu(); };
+    addAndMakeVisible(analysisButton.get());
+    
     // Auto-suggestions component
     suggestionsComponent = std::make_unique<TFAutoSuggestionsComponent>();
     addAndMakeVisible(suggestionsComponent.get());
@@ -65,6 +112,7 @@ TransferFunctionView::TransferFunctionView(TFController& ctrl)
 TransferFunctionView::~TransferFunctionView()
 {
     stopTimer();
+    controller.setImpulseResponseEnabled(false);
     controller.removeChangeListener(this);
     LocalizedStrings::getInstance().removeChangeListener(this);
 }
@@ -94,12 +142,25 @@ void TransferFunctionView::resized()
     // Delay display
     delayLabel->setBounds(selectorArea.removeFromLeft(60).reduced(5));
     delayValueLabel->setBounds(selectorArea.removeFromLeft(80).reduced(5));
+    waterfallToggle->setBounds(selectorArea.removeFromLeft(100).reduced(5));
+    impulseResponseToggle->setBounds(selectorArea.removeFromLeft(60).reduced(5));
+    snapshotButton->setBounds(selectorArea.removeFromLeft(90).reduced(5));
+    overlaysButton->setBounds(selectorArea.removeFromLeft(90).reduced(5));
+    analysisButton->setBounds(selectorArea.removeFromLeft(90).reduced(5));
     
     // Split remaining space: Plots (left 60%), Suggestions (right 40%)
     const int plotWidth = static_cast<int>(bounds.getWidth() * 0.6f);
     auto plotArea = bounds.removeFromLeft(plotWidth);
     bounds.removeFromLeft(5);  // Spacing
     
+    // Waterfall takes the bottom third when shown
+    if (waterfall->isVisible())
+        waterfall->setBounds(plotArea.removeFromBottom(plotArea.getHeight() / 3).reduced(5));
+    
+    // Impulse response takes the top third of what is left
+    if (impulseResponsePlot->isVisible())
+        impulseResponsePlot->setBounds(plotArea.removeFromTop(plotArea.getHeight() / 3).reduced(5));
+    
     // Split plot area: Phase (top 50%), Magnitude (bottom 50%)
     const int halfHeight = plotArea.getHeight() / 2;
     phasePlot->setBounds(plotArea.removeFromTop(halfHeight).reduced(5));
@@ -181,8 +242,194 @@ void TransferFunctionView::timerCallback()
 
 void TransferFunctionView::updateSuggestions()
 {
-    auto result = controller.getAnalysisResults();
-    auto suggestions = controller.getSuggestions();
+    // Analysis runs in the background; only swap in a finished result we have not shown yet
+    auto analysis = controller.getLatestAnalysis();
+    if (analysis == nullptr || analysis->sequence == lastAnalysisSequence)
+        return;
+    
+    lastAnalysisSequence = analysis->sequence;
+    suggestionsComponent->updateAnalysis(analysis->result, analysis->suggestions);
+}
+
+void TransferFunctionView::saveSnapshot()
+{
+    const auto file = controller.saveSnapshot("Trace " + juce::String(++snapshotCounter));
+    
+    if (!file.existsAsFile())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Snapshot",
+                                               controller.getSnapshotStore().getLastError());
+        return;
+    }
+    
+    // A new snapshot is shown right away, next to the live curve
+    toggleOverlay(file);
+}
+
+void TransferFunctionView::showOverlayMenu()
+{
+    const auto files = controller.getSnapshotStore().list();
+    
+    juce::PopupMenu menu;
+    for (int i = 0; i < files.size(); ++i)
+    {
+        const auto path = files[i].getFullPathName();
+        const bool shown = std::any_of(overlays.begin(), overlays.end(),
+                                       [&path](const auto& snapshot) { return snapshot->getFile().getFullPathName() == path; });
+        menu.addItem(i + 1, files[i].getFileNameWithoutExtension(), true, shown);
+    }
+    
+    if (files.isEmpty())
+        menu.addItem(-1, "No snapshots stored", false, false);
+    
+    menu.addSeparator();
+    menu.addItem(100000, "Clear overlays", !overlays.empty());
+    
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(overlaysButton.get()),
+                       [this, files](int result)
+                       {
+                           if (result == 100000)
+                           {
+                               overlays.clear();
+                               magnitudePlot->setOverlays(overlays);
+                           }
+                           else if (result > 0 && result <= files.size())
+                           {
+                               toggleOverlay(files[result - 1]);
+                           }
+                       });
+}
+
+void TransferFunctionView::toggleOverlay(const juce::File& file)
+{
+    const auto path = file.getFullPathName();
+    const auto shown = std::find_if(overlays.begin(), overlays.end(),
+                                    [&path](const auto& snapshot) { return snapshot->getFile().getFullPathName() == path; });
+    
+    if (shown != overlays.end())
+    {
+        overlays.erase(shown);
+    }
+    else
+    {
+        // Mapped, not parsed: recalling dozens of traces stays instant
+        auto snapshot = controller.getSnapshotStore().recall(file);
+        if (snapshot == nullptr)
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Snapshot",
+                                                   controller.getSnapshotStore().getLastError());
+            return;
+        }
+        
+        overlays.push_back(std::move(snapshot));
+    }
+    
+    magnitudePlot->setOverlays(overlays);
+}
+
+void TransferFunctionView::showAnalysisMenu()
+{
+    auto& processor = controller.getProcessor();
+    const auto current = processor.getAnalysisSettings();
+    
+    // Menu ids: 1000 + FFT size index, 2000 + overlap index, 3000 + window, 4000 averaging
+    // (4000 exponential, 4100 + FIFO length index, 4200 infinite, 4300 + gate threshold index),
+    // 5000 + output resolution index
+    static constexpr int fftSizes[] = {4096, 8192, 16384, 32768, 65536, 131072};
+    static constexpr double overlaps[] = {0.5, 0.67, 0.75, 0.8, 0.9};
+    static constexpr FFTAnalyzer::Window windows[] = {FFTAnalyzer::Window::hann, FFTAnalyzer::Window::blackmanHarris,
+                                                      FFTAnalyzer::Window::flatTop};
+    static constexpr int fifoFrames[] = {4, 8, 16, 32, 64, 128};
+    static constexpr double gateThresholds[] = {0.3, 0.5, 0.7};
+    static constexpr int logPointsPerOctave[] = {0, 24, 48, 96};  // 0: linear bins
+    const double sampleRate = processor.getSampleRate();
+    
+    juce::PopupMenu sizeMenu, overlapMenu, windowMenu;
+    for (int i = 0; i < static_cast<int>(std::size(fftSizes)); ++i)
+        sizeMenu.addItem(1000 + i, juce::String(fftSizes[i] / 1024) + "k  (" + juce::String(sampleRate / fftSizes[i], 2) + " Hz)",
+                         true, fftSizes[i] == current.fftSize);
+    for (int i = 0; i < static_cast<int>(std::size(overlaps)); ++i)
+        overlapMenu.addItem(2000 + i, juce::String(juce::roundToInt(overlaps[i] * 100.0)) + " %", true,
+                            std::abs(overlaps[i] - current.overlap) < 0.005);
+    for (int i = 0; i < static_cast<int>(std::size(windows)); ++i)
+        windowMenu.addItem(3000 + i, FFTAnalyzer::getWindowName(windows[i]), true, windows[i] == current.window);
+    
+    // Averaging modes, each FIFO length with the memory its ring takes at the current FFT size
+    using Averaging = TFAveragingEngine;
+    const auto& averaging = current.averaging;
+    const int numBins = current.fftSize / 2 + 1;
+    
+    juce::PopupMenu averagingMenu;
+    averagingMenu.addItem(4000, Averaging::getModeName(Averaging::Mode::exponential), true,
+                          averaging.mode == Averaging::Mode::exponential);
+    for (int i = 0; i < static_cast<int>(std::size(fifoFrames)); ++i)
+    {
+        Averaging::Settings fifo;
+        fifo.mode = Averaging::Mode::fifo;
+        fifo.fifoFrames = fifoFrames[i];
+        averagingMenu.addItem(4100 + i, "FIFO " + juce::String(fifoFrames[i]) + " frames  (" +
+                                            juce::File::descriptionOfSizeInBytes(static_cast<juce::int64>(
+                                                Averaging::estimateMemoryBytes(fifo, numBins))) + ")",
+                              true, averaging.mode == Averaging::Mode::fifo && averaging.fifoFrames == fifoFrames[i]);
+    }
+    averagingMenu.addItem(4200, Averaging::getModeName(Averaging::Mode::infinite), true,
+                          averaging.mode == Averaging::Mode::infinite);
+    for (int i = 0; i < static_cast<int>(std::size(gateThresholds)); ++i)
+        averagingMenu.addItem(4300 + i, "Coherence-gated  (reject below " + juce::String(gateThresholds[i], 1) + ")", true,
+                              averaging.mode == Averaging::Mode::coherenceGated
+                                  && std::abs(averaging.coherenceThreshold - gateThresholds[i]) < 0.005);
+    
+    averagingMenu.addSeparator();
+    averagingMenu.addItem(4999, "Memory " + juce::File::descriptionOfSizeInBytes(static_cast<juce::int64>(processor.getAveragingMemoryBytes())) +
+                                    ", " + juce::String(processor.getFramesAveraged()) + " frames averaged, " +
+                                    juce::String(processor.getFramesRejected()) + " rejected",
+                          false, false);
+    
+    juce::PopupMenu resolutionMenu;
+    for (int i = 0; i < static_cast<int>(std::size(logPointsPerOctave)); ++i)
+        resolutionMenu.addItem(5000 + i, logPointsPerOctave[i] == 0
+                                             ? "Linear bins  (" + juce::String(numBins) + " points)"
+                                             : juce::String(logPointsPerOctave[i]) + " points per octave",
+                               true, logPointsPerOctave[i] == current.logPointsPerOctave);
+    
+    juce::PopupMenu menu;
+    menu.addSubMenu("FFT size", sizeMenu);
+    menu.addSubMenu("Overlap", overlapMenu);
+    menu.addSubMenu("Window", windowMenu);
+    menu.addSubMenu("Averaging", averagingMenu);
+    menu.addSubMenu("Output resolution", resolutionMenu);
     
-    suggestionsComponent->updateAnalysis(result, suggestions);
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(analysisButton.get()),
+                       [this](int result)
+                       {
+                           if (result < 1000)
+                               return;
+                           
+                           // Re-read: another change may have been applied while the menu was open
+                           auto settings = controller.getProcessor().getAnalysisSettings();
+                           if (result < 2000)
+                               settings.fftSize = fftSizes[result - 1000];
+                           else if (result < 3000)
+                               settings.overlap = overlaps[result - 2000];
+                           else if (result < 4000)
+                               settings.window = windows[result - 3000];
+                           else if (result == 4000)
+                               settings.averaging.mode = TFAveragingEngine::Mode::exponential;
+                           else if (result < 4200)
+                           {
+                               settings.averaging.mode = TFAveragingEngine::Mode::fifo;
+                               settings.averaging.fifoFrames = fifoFrames[result - 4100];
+                           }
+                           else if (result == 4200)
+                               settings.averaging.mode = TFAveragingEngine::Mode::infinite;
+                           else if (result < 5000)
+                           {
+                               settings.averaging.mode = TFAveragingEngine::Mode::coherenceGated;
+                               settings.averaging.coherenceThreshold = gateThresholds[result - 4300];
+                           }
+                           else
+                               settings.logPointsPerOctave = logPointsPerOctave[result - 5000];
+                           
+                           controller.getProcessor().setAnalysisSettings(settings);
+                       });
 }
@@ -28,6 +28,10 @@ public:
 private:
     void updateChannelSelectors();
     void updateSuggestions();
+    void saveSnapshot();
+    void showOverlayMenu();
+    void toggleOverlay(const juce::File& file);
+    void showAnalysisMenu();
     
     TFController& controller;
     
@@ -42,4 +46,23 @@ private:
     std::unique_ptr<class PhasePlotComponent> phasePlot;
     std::unique_ptr<class MagnitudePlotComponent> magnitudePlot;
     std::unique_ptr<class TFAutoSuggestionsComponent> suggestionsComponent;
+    
+    // Magnitude over time, under the magnitude plot when enabled
+    std::unique_ptr<juce::ToggleButton> waterfallToggle;
+    std::unique_ptr<class SpectrogramComponent> waterfall;
+    
+    // Live impulse response / ETC, above the phase plot when enabled (computed only while shown)
+    std::unique_ptr<juce::ToggleButton> impulseResponseToggle;
+    std::unique_ptr<class ImpulseResponsePlotComponent> impulseResponsePlot;
+    
+    // Stored snapshots (saved from the live result, overlaid on the magnitude plot)
+    std::unique_ptr<juce::TextButton> snapshotButton;
+    std::unique_ptr<juce::TextButton> overlaysButton;
+    std::vector<std::shared_ptr<const TFSnapshot>> overlays;
+    int snapshotCounter{0};
+    
+    // FFT size / overlap / window (applied while running, see TFProcessor::setAnalysisSettings)
+    std::unique_ptr<juce::TextButton> analysisButton;
+    
+    uint64_t lastAnalysisSequence{0};  // last auto-analysis shown in suggestionsComponent
 };